@@ -7,6 +7,10 @@
 #include "ajsontools.h"
 #include "anoderecord.h"
 #include "aglobalsettings.h"
+#include "aeventframe.h"
+#include "agridscheduler.h"
+#include "agridsessionpool.h"
+#include "apositionenergyrecords.h"
 
 #include <QThread>
 #include <QCoreApplication>
@@ -14,10 +18,16 @@
 #include <QFile>
 #include <QVariant>
 #include <QVariantList>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+
+#include <algorithm>
+#include <cmath>
 
 AGridRunner::AGridRunner(EventsDataClass & EventsDataHub, const APmHub & PMs, ASimulationManager & simMan) :
     EventsDataHub(EventsDataHub), PMs(PMs), SimMan(simMan)
 {
+    SessionPool = new AGridSessionPool();
     readConfig();
 }
 
@@ -25,6 +35,7 @@ AGridRunner::~AGridRunner()
 {
     writeConfig();
     clearRecords();
+    delete SessionPool;
 }
 
 void AGridRunner::writeConfig()
@@ -36,6 +47,10 @@ void AGridRunner::writeConfig()
     QJsonObject & json = AGlobalSettings::getInstance().RemoteServers;
     json["Servers"] = ar;
     json["Timeout"] = TimeOut;
+    json["EventsPerFrame"] = EventsPerFrame;
+    json["CompressFrames"] = bCompressFrames;
+    json["BatchesPerServer"] = BatchesPerServer;
+    json["SessionKeepAlive"] = SessionPool->getKeepAlive();
 }
 
 void AGridRunner::readConfig()
@@ -46,6 +61,12 @@ void AGridRunner::readConfig()
     if (json.isEmpty()) return;
 
     parseJson(json, "Timeout", TimeOut);
+    parseJson(json, "EventsPerFrame", EventsPerFrame);
+    parseJson(json, "CompressFrames", bCompressFrames);
+    parseJson(json, "BatchesPerServer", BatchesPerServer);
+    int keepAlive = SessionPool->getKeepAlive();
+    parseJson(json, "SessionKeepAlive", keepAlive);
+    SessionPool->setKeepAlive(keepAlive);
     QJsonArray ar = json["Servers"].toArray();
     for (int i=0; i<ar.size(); i++)
     {
@@ -58,6 +79,7 @@ void AGridRunner::readConfig()
 
 void AGridRunner::clearRecords()
 {
+    SessionPool->clear();
     for (ARemoteServerRecord * r : ServerRecords) delete r;
     ServerRecords.clear();
 }
@@ -67,6 +89,7 @@ QString AGridRunner::commonStart()
     if (ServerRecords.isEmpty()) return "Configure at least one dispatcher record!";
 
     onStart();
+    SessionPool->purge(ServerRecords);
 
     bool bEmpty = true;
     for (ARemoteServerRecord* r : ServerRecords)
@@ -85,6 +108,9 @@ QString AGridRunner::CheckStatus()
     const QString err = commonStart();
     if (!err.isEmpty()) return err;
 
+    //servers kept by the pooled sessions are not available from the dispatchers
+    SessionPool->clear();
+
     emit requestStatusLog("Checking status of servers...");
     QVector<AWebSocketWorker_Base*> workers;
 
@@ -180,6 +206,50 @@ QString AGridRunner::Simulate(const QJsonObject* config)
         numEvents = jSourceControlOptions["EventsToDo"].toInt();
     }
 
+    if (pPointSourceSim)
+    {
+        if (PointSourceSimType == 3) return "Custom nodes mode is not yet implemented in distributed simulations";
+        if (PointSourceSimType < 0 || PointSourceSimType > 4) return "Not implemented point source sim type: " + QString::number(PointSourceSimType);
+        if (PointSourceSimType == 4 && SimMan.Nodes.size() < 1) return "There are no nodes defined with a script";
+    }
+
+    //script to modify the config on the server for the batch of events [from, to)
+    auto makeBatchScript = [pPointSourceSim, PointSourceSimType, nodesAr](int from, int to) -> QString
+    {
+        QString modScript;
+        if (pPointSourceSim)
+        {
+            switch (PointSourceSimType)
+            {
+            case 0:
+                modScript = QString("config.Replace(\"SimulationConfig.PointSourcesConfig.ControlOptions.MultipleRunsNumber\", %1)").arg(to - from);
+                break;
+            case 1:
+            case 4:
+                {
+                    QJsonArray ar;
+                    for (int iNode = from; iNode < to; iNode++)
+                        ar.append( nodesAr.at(iNode) );
+                    if (PointSourceSimType == 1) //regular nodes are simulated in 'script' mode
+                        modScript += "config.Replace(\"SimulationConfig.PointSourcesConfig.ControlOptions.Single_Scan_Flood\", 4);";
+                    modScript += "sim.ClearNodes();";
+                    modScript += "var ar = ";
+                    modScript += jsonArrayToString(ar) + ";";
+                    modScript += (PointSourceSimType == 1 ? "sim.AddNodes(ar);" : "sim.AddNodesAndSubnodes(ar);");
+                    modScript += "sim.CountNodes(true)";
+                }
+                break;
+            case 2:
+                modScript = QString("config.Replace(\"SimulationConfig.PointSourcesConfig.FloodOptions.Nodes\", %1)").arg(to - from);
+                break;
+            default:;
+            }
+        }
+        else
+            modScript = QString("config.Replace(\"SimulationConfig.ParticleSourcesConfig.SourceControlOptions.EventsToDo\", %1)").arg(to - from);
+        return modScript;
+    };
+
     emit requestStatusLog("Starting remote simulation...");
     QVector<AWebSocketWorker_Base*> workers;
 
@@ -188,111 +258,25 @@ QString AGridRunner::Simulate(const QJsonObject* config)
 
     waitForWorkersToPauseOrFinish(workers);
 
-    //init distributor of load
-    double sumSpeedfactor = 0;
-    int numThr = 0;
-    for (int i = 0; i < workers.size(); i++)
-        if (ServerRecords.at(i)->NumThreads_Allocated > 0)
-        {
-            numThr++;
-            sumSpeedfactor += ServerRecords.at(i)->SpeedFactor;
-        }
-    if (numThr == 0)
+    const int numActive = countActiveServers();
+    if (numActive == 0)
     {
         emit requestStatusLog("Cannot simulate: there are no active servers");
         return "Cannot simulate: there are no active servers";
     }
 
-    //distributing load over servers and resuming workers
-    int counter = 0;
-    for (int iWorker = 0; iWorker < workers.size(); iWorker++)
-    {
-        if (ServerRecords.at(iWorker)->NumThreads_Allocated > 0)
-        {
-            QString modScript;
+    //events are given to the servers in batches as the servers become free
+    AGridScheduler scheduler(numEvents, getBatchSize(numEvents, numActive), ServerRecords.size());
+    std::vector<AGridSimBatch> results(scheduler.countBatches());
+    emit requestStatusLog( QString("Distributing %1 events in %2 batches over %3 servers").arg(numEvents).arg(scheduler.countBatches()).arg(numActive) );
 
-            double perUnitSpeed = 1.0 * numEvents / sumSpeedfactor;
-            int numEventsToDo = std::ceil(perUnitSpeed * ServerRecords.at(iWorker)->SpeedFactor);
-            if (counter + numEventsToDo > numEvents) numEventsToDo = numEvents - counter;
-
-            if (pPointSourceSim)
-            {
-                qDebug() << "-------- Photon sources ----------";
-                switch (PointSourceSimType)
-                {
-                case 0:
-                    qDebug() << "--- single ---";
-                    qDebug() << "Server #"<<iWorker << "will simulate"<<numEventsToDo<<"runs at single position";
-                    modScript = QString("config.Replace(\"SimulationConfig.PointSourcesConfig.ControlOptions.MultipleRunsNumber\", %1)").arg(numEventsToDo);
-                    break;
-                case 1:
-                    {
-                        qDebug() << "--- regular nodes ---";
-                        qDebug() << "Server #"<<iWorker << "will simulate"<<numEventsToDo<<"custom nodes";
-                        qDebug() << "Changing mode to 'script'";
-                        modScript += "config.Replace(\"SimulationConfig.PointSourcesConfig.ControlOptions.Single_Scan_Flood\", 4);";
-                        QJsonArray ar;
-                        for (int iNode = counter; iNode < counter + numEventsToDo; iNode++)
-                            ar.append( nodesAr.at(iNode) );
-                        modScript += "var ar = ";
-                        modScript += jsonArrayToString(ar) + ";";
-                        modScript += "sim.AddNodes(ar);";
-                        modScript += "sim.CountNodes(true)";
-                    }
-                    break;
-                case 2:
-                    qDebug() << "--- flood ---";
-                    qDebug() << "Server #"<<iWorker << "will simulate"<<numEventsToDo<<"flood events";
-                    modScript = QString("config.Replace(\"SimulationConfig.PointSourcesConfig.FloodOptions.Nodes\", %1)").arg(numEventsToDo);
-                    break;
-                case 3:
-                    /*
-                    {
-                        qDebug() << "--- custom nodes ---";
-                        qDebug() << "Server #"<<iWorker << "will simulate"<<numEventsToDo<<"custom nodes";
-                        QJsonArray ar;
-                        for (int iNode = counter; iNode < counter + numEventsToDo; iNode++)
-                            ar.append( nodesAr.at(iNode) );
-                        QJsonObject json;
-                        json["Nodes"] = ar;
-                        modScript  = "var obj = ";
-                        modScript += jsonToString(json);
-                        modScript += "; config.Replace(\"SimulationConfig.PointSourcesConfig.CustomNodesOptions\", obj)";
-                    }
-                    break;
-                    */
-                    return "Custom nodes mode is not yet implemented in distributed simulations";
-                case 4:
-                    {
-                        qDebug() << "--- script ---";
-                        const int size = SimMan.Nodes.size();
-                        if (size < 1) return "There are nodes defined with a script";
-                        qDebug() << "Server #"<<iWorker << "will simulate"<<numEventsToDo<<"nodes defined in script";
-                        QJsonArray ar;
-                        for (int iNode = counter; iNode < counter + numEventsToDo; iNode++)
-                            ar.append( nodesAr.at(iNode) );
-                        modScript += "var ar = ";
-                        modScript += jsonArrayToString(ar) + ";";
-                        modScript += "sim.AddNodesAndSubnodes(ar);";
-                        modScript += "\"Num nodes: \" + sim.CountNodes(true) + \" with subnodes: \" + sim.CountNodes(false)";
-                    }
-                    break;
-                default:
-                    return "Not implemented point source sim type: " + QString::number(PointSourceSimType);
-                }
-            }
-            else
-            {
-                qDebug() << "-------- Particle sources ----------";
-                qDebug() << "Server #"<<iWorker << "will simulate"<<numEventsToDo<<"particle source events";
-                modScript = QString("config.Replace(\"SimulationConfig.ParticleSourcesConfig.SourceControlOptions.EventsToDo\", %1)").arg(numEventsToDo);
-            }
-
-            workers[iWorker]->setExtraScript(modScript);
-            counter += numEventsToDo;
-        }
-
-        workers[iWorker]->setPaused(false); //resume worker
+    for (AWebSocketWorker_Base * w : workers)
+    {
+        AWebSocketWorker_Sim * sw = static_cast<AWebSocketWorker_Sim*>(w);
+        sw->setScheduler(&scheduler);
+        sw->setBatchScript(makeBatchScript);
+        sw->setResults(&results);
+        w->setPaused(false); //resume worker
     }
 
     waitForWorkersToFinish(workers);
@@ -300,31 +284,60 @@ QString AGridRunner::Simulate(const QJsonObject* config)
     for (AWebSocketWorker_Base* w : workers) delete w;
     workers.clear();
 
-    //loading simulated events
+    reportServerRates(scheduler);
+    for (ARemoteServerRecord * r : ServerRecords) r->clearReceived();
+
+    //collecting simulated events in the order of the batches
     bool bError = false;
     EventsDataHub.clear();
-    for (int i=0; i<ServerRecords.size(); i++)
+    if (!scheduler.isFinished())
     {
-        if ( !ServerRecords.at(i)->FileName.isEmpty() )
+        emit requestStatusLog( QString("%1 of %2 batches were not simulated: no working servers left").arg(scheduler.countBatches() - scheduler.countDone()).arg(scheduler.countBatches()) );
+        bError = true;
+    }
+    else
+    {
+        for (AGridSimBatch & res : results)
         {
-            int numEv = EventsDataHub.loadSimulatedEventsFromTree( ServerRecords.at(i)->FileName, PMs );
-            QString s;
-            if (EventsDataHub.ErrorString.isEmpty())
-                s = QString("%1 events were registered").arg(numEv);
-            else
+            if (res.Events.isEmpty()) continue;
+
+            const bool bFirst = EventsDataHub.Events.isEmpty();
+            QString err;
+            if (res.Events.getNumChannels() != PMs.count())
+                err = "Remote host sent events with a different number of PMs than in this detector configuration!";
+            else if (!res.Scan.isEmpty() && res.Scan.size() != res.Events.size())
+                err = "Remote host sent scan data not matching the events!";
+            else if (!bFirst && EventsDataHub.Scan.isEmpty() != res.Scan.isEmpty())
+                err = "Remote host sent events with scan data different from the other batches!";
+            else if (!bFirst && EventsDataHub.isTimed() != !res.TimedEvents.isEmpty())
+                err = "Remote host sent events with time resolution different from the other batches!";
+            if (!err.isEmpty())
             {
-                s = QString("Error loading events from the TTree file sent by the remote host:\n") + EventsDataHub.ErrorString;
-                ServerRecords[i]->Error = s;
+                emit requestStatusLog("Error loading events sent by the remote host:\n" + err);
                 bError = true;
+                break;
             }
-            requestTextLog(i, s);
-        }
-    else
-        {
-            if ( !ServerRecords.at(i)->Error.isEmpty() )
-                bError = true;
+
+            if (bFirst)
+            {
+                EventsDataHub.Events      = std::move(res.Events);
+                EventsDataHub.TimedEvents = std::move(res.TimedEvents);
+            }
+            else
+            {
+                EventsDataHub.Events.append(res.Events);
+                EventsDataHub.TimedEvents.append(res.TimedEvents);
+            }
+            EventsDataHub.Scan += res.Scan;
+            res.Scan.clear();
+            EventsDataHub.ScanNumberOfRuns = res.NumRuns;
+            EventsDataHub.fSimulatedData = true;
         }
     }
+    for (AGridSimBatch & res : results)
+        for (AScanRecord * sr : res.Scan) delete sr;
+    if (bError) EventsDataHub.clear();
+    else emit requestStatusLog( QString("%1 events were registered").arg(EventsDataHub.countEvents()) );
 
     if (bError)
     {
@@ -346,6 +359,9 @@ QString AGridRunner::Reconstruct(const QJsonObject *config)
     const QString err = commonStart();
     if (!err.isEmpty()) return err;
 
+    if (EventsDataHub.ReconstructionData.isEmpty() || EventsDataHub.ReconstructionData.at(0).size() < EventsDataHub.countEvents())
+        return "Reconstruction data container is not initialized";
+
     emit requestStatusLog("Starting remote reconstruction...");
     QVector<AWebSocketWorker_Base*> workers;
 
@@ -354,45 +370,22 @@ QString AGridRunner::Reconstruct(const QJsonObject *config)
 
     waitForWorkersToPauseOrFinish(workers);
 
-    //init distributor of load
-    double sumSpeedfactor = 0;
-    int numThr = 0;
-    for (int i = 0; i < workers.size(); i++)
-        if (ServerRecords.at(i)->NumThreads_Allocated > 0)
-        {
-            numThr++;
-            sumSpeedfactor += ServerRecords.at(i)->SpeedFactor;
-        }
-    if (numThr == 0)
+    const int numActive = countActiveServers();
+    if (numActive == 0)
     {
         emit requestStatusLog("Cannot reconstruct: there are no active servers");
         return "Cannot reconstruct: there are no active servers";
     }
-    int numEvents = EventsDataHub.countEvents();
-    double perUnitSpeed = 1.0 * numEvents / sumSpeedfactor;
-
-    //distributing load and resuming workers
-    int from = 0;
-    for (int i = 0; i < workers.size(); i++)
-    {
-        ServerRecords[i]->ByteArrayReceived.clear();
-        ServerRecords[i]->EventsFrom = 0;
-        ServerRecords[i]->EventsTo = 0;
-
-        if (ServerRecords.at(i)->NumThreads_Allocated > 0)
-        {
-            ServerRecords[i]->EventsFrom = from;
-            int toDo = std::ceil(perUnitSpeed * ServerRecords.at(i)->SpeedFactor);
-            if (from + toDo > numEvents) toDo = numEvents - from;
-
-            ServerRecords[i]->EventsTo = from + toDo;
-            from += toDo;
 
-            EventsDataHub.packEventsToByteArray(ServerRecords[i]->EventsFrom, ServerRecords[i]->EventsTo, ServerRecords[i]->ByteArrayToSend);
-            qDebug() << "Server #"<<i << "will reconstruct events from "<<ServerRecords[i]->EventsFrom <<"to"<<ServerRecords[i]->EventsTo;
-        }
+    //events are given to the servers in batches as the servers become free
+    const int numEvents = EventsDataHub.countEvents();
+    AGridScheduler scheduler(numEvents, getBatchSize(numEvents, numActive), ServerRecords.size());
+    emit requestStatusLog( QString("Distributing %1 events in %2 batches over %3 servers").arg(numEvents).arg(scheduler.countBatches()).arg(numActive) );
 
-        workers[i]->setPaused(false); //resume worker
+    for (AWebSocketWorker_Base * w : workers)
+    {
+        w->setScheduler(&scheduler);
+        w->setPaused(false); //resume worker
     }
 
     waitForWorkersToFinish(workers);
@@ -400,27 +393,12 @@ QString AGridRunner::Reconstruct(const QJsonObject *config)
     for (AWebSocketWorker_Base* w : workers) delete w;
     workers.clear();
 
-    bool bRecFailed = false;
-    for (int i = 0; i < ServerRecords.size(); i++)
-    {
-        ServerRecords[i]->ByteArrayToSend.clear();
-        ServerRecords[i]->ByteArrayToSend.squeeze();
+    reportServerRates(scheduler);
 
-        if (ServerRecords.at(i)->EventsTo > 0)
-        {
-            if (!ServerRecords.at(i)->Error.isEmpty()) bRecFailed = true;
-            else
-            {
-                bool bOK = EventsDataHub.unpackReconstructedFromByteArray(ServerRecords.at(i)->EventsFrom, ServerRecords.at(i)->EventsTo, ServerRecords.at(i)->ByteArrayReceived);
-                if (!bOK)
-                {
-                    ServerRecords[i]->Error = "Failed to set reconstruction data using the obtained data";
-                    emit requestTextLog(i, ServerRecords[i]->Error);
-                    bRecFailed = true;
-                }
-            }
-        }
-    }
+    //reconstruction results are already set by the workers for the accepted batches
+    const bool bRecFailed = !scheduler.isFinished();
+    if (bRecFailed)
+        emit requestStatusLog( QString("%1 of %2 batches were not reconstructed: no working servers left").arg(scheduler.countBatches() - scheduler.countDone()).arg(scheduler.countBatches()) );
 
     if (bRecFailed) emit requestStatusLog("Reconstruction failed!");
     else
@@ -589,6 +567,51 @@ void AGridRunner::Abort()
     bAbortRequested = true;
 }
 
+void AGridRunner::SetFrameOptions(int eventsPerFrame, bool bCompress)
+{
+    EventsPerFrame = std::max(1, eventsPerFrame);
+    bCompressFrames = bCompress;
+}
+
+void AGridRunner::SetBatchesPerServer(int batches)
+{
+    BatchesPerServer = std::max(1, batches);
+}
+
+void AGridRunner::SetSessionKeepAlive(int ms)
+{
+    SessionPool->setKeepAlive(ms);
+}
+
+void AGridRunner::CloseSessions()
+{
+    SessionPool->clear();
+}
+
+int AGridRunner::countActiveServers() const
+{
+    int num = 0;
+    for (const ARemoteServerRecord * r : ServerRecords)
+        if (r->NumThreads_Allocated > 0) num++;
+    return num;
+}
+
+int AGridRunner::getBatchSize(int numEvents, int numServers) const
+{
+    const int numBatches = std::max(1, numServers * BatchesPerServer);
+    return std::max(1, (int)std::ceil(1.0 * numEvents / numBatches));
+}
+
+void AGridRunner::reportServerRates(const AGridScheduler & scheduler)
+{
+    for (int i = 0; i < ServerRecords.size(); i++)
+    {
+        const double rate = scheduler.getRate(i);
+        if (rate > 0)
+            emit requestTextLog(i, QString("Accepted batches: %1, events per second: %2").arg(scheduler.countProcessed(i)).arg(rate, 0, 'g', 4));
+    }
+}
+
 void AGridRunner::SetTimeout(int timeout)
 {
     TimeOut = timeout;
@@ -757,6 +780,8 @@ AWebSocketWorker_Base* AGridRunner::startCheckStatusOfServer(int index, ARemoteS
 AWebSocketWorker_Base *AGridRunner::startSim(int index, ARemoteServerRecord *serverRecord, const QJsonObject* config)
 {
     AWebSocketWorker_Base* worker = new AWebSocketWorker_Sim(index, serverRecord, TimeOut, config);
+    worker->setFrameOptions(EventsPerFrame, bCompressFrames);
+    worker->setSession(SessionPool->get(serverRecord), SessionPool->getServerIdleTime());
 
     startInNewThread(worker);
     return worker;
@@ -764,7 +789,9 @@ AWebSocketWorker_Base *AGridRunner::startSim(int index, ARemoteServerRecord *ser
 
 AWebSocketWorker_Base *AGridRunner::startRec(int index, ARemoteServerRecord *serverrecord, const QJsonObject *config)
 {
-    AWebSocketWorker_Base* worker = new AWebSocketWorker_Rec(index, serverrecord, TimeOut, config);
+    AWebSocketWorker_Base* worker = new AWebSocketWorker_Rec(index, serverrecord, TimeOut, config, EventsDataHub);
+    worker->setFrameOptions(EventsPerFrame, bCompressFrames);
+    worker->setSession(SessionPool->get(serverrecord), SessionPool->getServerIdleTime());
 
     startInNewThread(worker);
     return worker;
@@ -774,6 +801,7 @@ AWebSocketWorker_Base *AGridRunner::startScriptWorker(int index, ARemoteServerRe
 {
     serverrecord->Error.clear();
     AWebSocketWorker_Base * worker = new AWorker_Script(index, serverrecord, TimeOut, &config, script, data);
+    worker->setSession(SessionPool->get(serverrecord), SessionPool->getServerIdleTime());
 
     startInNewThread(worker);
     return worker;
@@ -783,6 +811,7 @@ AWebSocketWorker_Base *AGridRunner::startUploadWorker(int index, ARemoteServerRe
 {
     serverrecord->Error.clear();
     AWebSocketWorker_Base * worker = new AWorker_Upload(index, serverrecord, TimeOut, fileName);
+    worker->setSession(SessionPool->get(serverrecord), SessionPool->getServerIdleTime());
 
     startInNewThread(worker);
     return worker;
@@ -798,6 +827,8 @@ void AGridRunner::startInNewThread(AWebSocketWorker_Base* worker)
     QObject::connect(t, &QThread::finished, t, &QThread::deleteLater);
 
     worker->moveToThread(t);
+    AGridSession * session = worker->getSession();
+    if (session && session->Socket) session->Socket->MoveToThread(t);
 
     worker->setStarted(); //otherwise problems on start - in first check it will be still false
     t->start();
@@ -808,6 +839,13 @@ void AGridRunner::startInNewThread(AWebSocketWorker_Base* worker)
 AWebSocketWorker_Base::AWebSocketWorker_Base(int index, ARemoteServerRecord *rec, int timeOut, const QJsonObject *config) :
     index(index), rec(rec), TimeOut(timeOut), config(config) {}
 
+void AWebSocketWorker_Base::setSession(AGridSession *session, int idleTime)
+{
+    Session = session;
+    ServerIdleTime = idleTime;
+    PoolThread = QThread::currentThread();
+}
+
 void AWebSocketWorker_Base::RequestAbort()
 {
     if (ants2socket) ants2socket->ExternalAbort();
@@ -948,22 +986,126 @@ bool AWebSocketWorker_Base::establishSession()
 {
     ants2socket = 0;
 
-    if (rec->bEnabled)
+    if (!rec->bEnabled)
     {
-        bool bOK = allocateAntsServer();
-        if (bOK)
-            ants2socket = connectToAntsServer();
+        rec->NumThreads_Allocated = 0;
+        return false;
+    }
+
+    if (Session && Session->Socket)
+    {
+        AWebSocketSession * socket = Session->Socket;
+        Session->Socket = nullptr;
+        if (socket->ConfirmSendPossible())
+        {
+            emit requestTextLog(index, "Using the open session with the ants2 server");
+            socket->SetTimeout(TimeOut);
+            ants2socket = socket;
+            rec->Status = ARemoteServerRecord::Alive;
+            rec->NumThreads_Allocated = Session->NumThreads;
+            return true;
+        }
+        emit requestTextLog(index, "Pooled session was closed by the server");
+        delete socket;
+    }
+
+    bool bOK = allocateAntsServer();
+    if (bOK)
+        ants2socket = connectToAntsServer();
+
+    if (ants2socket && Session)
+    {
+        Session->IP = rec->IP;
+        Session->Port = rec->Port;
+        Session->NumThreads = rec->NumThreads_Allocated;
+        if (!requestKeepAlive()) Session = nullptr;
     }
-    else rec->NumThreads_Allocated = 0;
 
     return ants2socket;
 }
 
+bool AWebSocketWorker_Base::requestKeepAlive()
+{
+    //by default the server exits soon after the client becomes idle
+    QJsonObject js;
+    js["idle"] = ServerIdleTime;
+    bool bOK = ants2socket->SendText("__" + jsonToString(js));
+    QJsonObject ro = strToObject(ants2socket->GetTextReply());
+    if (!bOK || !ro.contains("result") || !ro["result"].toBool())
+    {
+        emit requestTextLog(index, "Server does not support persistent sessions");
+        return false;
+    }
+    return true;
+}
+
+void AWebSocketWorker_Base::releaseSession()
+{
+    if (!ants2socket) return;
+
+    ants2socket->SetBinaryFrameHandler(nullptr);
+    if (Session && !bExternalAbort && rec->Error.isEmpty() && ants2socket->ConfirmSendPossible())
+    {
+        ants2socket->MoveToThread(PoolThread);
+        Session->Socket = ants2socket;
+        Session->LastUsed.start();
+        emit requestTextLog(index, "Session is kept open for the next job");
+    }
+    else
+    {
+        ants2socket->Disconnect();
+        delete ants2socket;
+    }
+    ants2socket = nullptr;
+}
+
+bool AWebSocketWorker_Base::evaluateQuery(const QString & Script, QJsonValue & Result)
+{
+    bool bOK = ants2socket->SendText(Script);
+    QJsonObject ro = strToObject(ants2socket->GetTextReply());
+    if (!bOK || !ro.contains("evaluation")) return false;
+
+    Result = ro["evaluation"];
+    return true;
+}
+
 bool AWebSocketWorker_Base::sendAnts2Config()
 {
-    qDebug() << "Sending config...";
-    emit requestTextLog(index, "Sending config file...");
-    bool bOK = ants2socket->SendJson(*config);
+    //config sections are identified by the hash of their content; the server remembers the hashes of the sections it got from us
+    static const QStringList Sections = {"DetectorConfig", "SimulationConfig", "ReconstructionConfig"};
+    QJsonObject hashes;
+    for (const QString & key : Sections)
+        if (config->contains(key))
+        {
+            const QByteArray ba = QJsonDocument(config->value(key).toObject()).toBinaryData();
+            hashes[key] = QString(QCryptographicHash::hash(ba, QCryptographicHash::Md5).toHex());
+        }
+
+    QJsonObject known;
+    QJsonValue res;
+    if (evaluateQuery("server.GetConfigHashes(config.GetConfig())", res))
+        known = res.toObject();
+
+    QJsonObject sections;
+    //a new detector requires to reload the other settings as well
+    const bool bAll = ( hashes.value("DetectorConfig") != known.value("DetectorConfig") );
+    for (const QString & key : hashes.keys())
+        if (bAll || hashes.value(key) != known.value(key))
+            sections[key] = config->value(key);
+
+    if (sections.isEmpty())
+    {
+        emit requestTextLog(index, "Config is already set on the server");
+        return true;
+    }
+
+    QJsonObject js;
+    js["Sections"] = sections;
+    js["Hashes"]   = hashes;
+
+    qDebug() << "Sending config sections:" << sections.keys();
+    emit requestTextLog(index, QString("Sending config (%1)...").arg(sections.keys().join(", ")));
+    bool bOK = ants2socket->SendJson(js);
     QString reply = ants2socket->GetTextReply();
     QJsonObject ro = strToObject(reply);
     if (!bOK || !ro.contains("result") || !ro["result"].toBool())
@@ -972,9 +1114,11 @@ bool AWebSocketWorker_Base::sendAnts2Config()
         return false;
     }
     emit requestTextLog(index, "Sending script to setup configuration...");
-    QString Script = "var c = server.GetBufferAsObject();"
-                     "var ok = config.SetConfig(c);"
-                     "if (!ok) core.abort(\"Failed to set config\");true";
+    QString Script = "var p = server.GetBufferAsObject();"
+                     "var ok = config.SetConfigSections(p.Sections);"
+                     "if (!ok) core.abort(\"Failed to set config\");"
+                     "server.StoreConfigHashes(p.Hashes, config.GetConfig());"
+                     "server.ClearBuffer();true";
     bOK = ants2socket->SendText(Script);
     reply = ants2socket->GetTextReply();
     ro = strToObject(reply);
@@ -988,6 +1132,22 @@ bool AWebSocketWorker_Base::sendAnts2Config()
 
 bool AWebSocketWorker_Base::uploadFile(const QString &LocalFileName, const QString &RemoteFileName)
 {
+    //the server can already have this file, e.g. from the previous job of a farm script
+    QFile file(LocalFileName);
+    if (file.open(QIODevice::ReadOnly))
+    {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(&file);
+        file.close();
+
+        QJsonValue res;
+        if (evaluateQuery("server.GetFileHash(\"" + RemoteFileName + "\")", res) && res.toString() == QString(hash.result().toHex()))
+        {
+            emit requestTextLog(index, "Server already has this file");
+            return true;
+        }
+    }
+
     //send file to remote server buffer
     emit requestTextLog(index, "Sending file to the server...");
     bool ok = ants2socket->SendFile(LocalFileName);
@@ -1114,6 +1274,73 @@ bool AWebSocketWorker_Base::evaluateScript(const QString & Script, QVariant * Re
     return true;
 }
 
+bool AWebSocketWorker_Base::processBatches()
+{
+    while (!bExternalAbort)
+    {
+        int iBatch, from, to;
+        const AGridScheduler::ATakeResult res = Scheduler->take(index, iBatch, from, to);
+        if (res == AGridScheduler::Finished) return true;
+        if (res == AGridScheduler::Wait)
+        {
+            //all batches are running: one of them can still be returned to the queue or re-issued
+            QThread::msleep(50);
+            QCoreApplication::processEvents();
+            continue;
+        }
+
+        if (!runBatch(iBatch, from, to))
+        {
+            Scheduler->fail(index, iBatch); //the batch goes back to the queue, this server drops out
+            return false;
+        }
+    }
+    return false;
+}
+
+bool AWebSocketWorker_Base::runBatch(int, int, int)
+{
+    rec->Error = "This worker does not support batch processing";
+    return false;
+}
+
+bool AWebSocketWorker_Base::runStreamingScript(const QString &Script, std::function<bool (const QByteArray &)> frameHandler)
+{
+    FrameError.clear();
+    ants2socket->SetBinaryFrameHandler(frameHandler);
+
+    bool bOK = ants2socket->SendText(Script);
+    QString reply = ants2socket->GetTextReply();
+    if (!bOK)
+        rec->Error = "Failed to send script to ANTS2 server";
+    else if (reply.isEmpty())
+        rec->Error = "Got no reply after sending a script to ANTS2 server";
+    else
+    {
+        QJsonObject ro = strToObject(reply);
+        while ( !ro.contains("binary") && !ro.contains("error") ) //after the server has sent all frames, the reply is "{ \"binary\" : \"frames\" }"
+        {
+            if (ro.contains("progress")) rec->Progress = ro["progress"].toInt();
+            else emit requestTextLog(index, reply);
+
+            bOK = ants2socket->ResumeWaitForAnswer();
+            reply = ants2socket->GetTextReply();
+            if (!bOK || reply.isEmpty())
+            {
+                rec->Error = ants2socket->GetError();
+                if (rec->Error.isEmpty()) rec->Error = "Connection lost";
+                break;
+            }
+            ro = strToObject(reply);
+        }
+        if (ro.contains("error")) rec->Error = "Server reported error:<br>" + ro["error"].toString();
+    }
+
+    ants2socket->SetBinaryFrameHandler(nullptr);
+    if (rec->Error.isEmpty()) rec->Error = FrameError;
+    return rec->Error.isEmpty();
+}
+
 AWebSocketWorker_Check::AWebSocketWorker_Check(int index, ARemoteServerRecord *rec, int timeOut) :
     AWebSocketWorker_Base(index, rec, timeOut) {}
 
@@ -1189,7 +1416,7 @@ void AWebSocketWorker_Sim::run()
 {
     bRunning = true;
 
-    rec->FileName.clear();
+    rec->clearReceived();
 
     bool bOK = establishSession();
     if (!bOK)
@@ -1200,7 +1427,7 @@ void AWebSocketWorker_Sim::run()
     else
     {
         bPaused = true;
-        //waiting while main thread will set events to reconstruct
+        //waiting while main thread will set up the scheduler
         while (bPaused && !bExternalAbort)
         {
             QThread::usleep(100);
@@ -1215,8 +1442,8 @@ void AWebSocketWorker_Sim::run()
                 emit requestTextLog(index, rec->Error);
             }
             else rec->Progress = 100;
-            ants2socket->Disconnect();
         }
+        releaseSession();
     }
 
     bRunning = false;
@@ -1240,116 +1467,83 @@ void AWebSocketWorker_Sim::runSimulation()
         return;
     }
 
-    emit requestTextLog(index, "Sending config file...");
-    bool bOK = ants2socket->SendJson(*config);
-    QString reply = ants2socket->GetTextReply();
-    QJsonObject ro = strToObject(reply);
-    if (!bOK || !ro.contains("result") || !ro["result"].toBool())
-    {
-        rec->Error = "Failed to send config";
-        return;
-    }
+    if (!sendAnts2Config()) return;  //rec->Error is set inside
 
-    emit requestTextLog(index, "Sending script to setup configuration...");
-    QString Script = "var c = server.GetBufferAsObject();"
-                     "var ok = config.SetConfig(c);"
-                     "if (!ok) core.abort(\"Failed to set config\");";
-    bOK = ants2socket->SendText(Script);
-    reply = ants2socket->GetTextReply();
-    ro = strToObject(reply);
-    if (!bOK || !ro.contains("result") || !ro["result"].toBool())
+    rec->TimeElapsed = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    bool bOK = processBatches();
+    if (bOK)
     {
-        rec->Error = "failed to setup config on the ants2 server";
-        return;
+        rec->TimeElapsed = timer.elapsed();
+        emit requestTextLog(index, "Server has finished simulation");
     }
+    else if (rec->Error.isEmpty()) rec->Error = "Aborted";
+}
+
+bool AWebSocketWorker_Sim::runBatch(int iBatch, int from, int to)
+{
+    emit requestTextLog(index, QString("Simulating batch #%1: events from %2 to %3").arg(iBatch).arg(from).arg(to));
 
     QJsonObject jsSimSet = (*config)["SimulationConfig"].toObject();
     QString modeSetup = jsSimSet["Mode"].toString();
     bool bPhotonSource = (modeSetup == "PointSim"); //Photon simulator
-    const QString RemoteSimTreeFileName = QString("SimTree-") + QString::number(index) + ".root";
 
-    Script = extraScript;
+    QString Script = BatchScript(from, to);
     Script += ";";
     Script += "server.SetAcceptExternalProgressReport(true);";
     if (bPhotonSource)
         Script += "sim.RunPhotonSources(" + QString::number(rec->NumThreads_Allocated) + ", true);";
     else
         Script += "sim.RunParticleSources(" + QString::number(rec->NumThreads_Allocated) + ", true);";
-    Script += "var fileName = \"" + RemoteSimTreeFileName + "\";";
-    Script += "var ok = sim.SaveAsTree(fileName);";
-    Script += "if (!ok) core.abort(\"Failed to save simulation data\");";
     Script += "server.SetAcceptExternalProgressReport(false);";
-    Script += "server.SendFile(fileName);";
+    Script += QString("server.SendSimulationFrames(%1, %2);").arg(EventsPerFrame).arg(bCompressFrames ? "true" : "false");
     //  qDebug() << Script;
 
-    rec->TimeElapsed = 0;
-    QElapsedTimer timer;
-    timer.start();
-
-    //execute the script on remote server
-    emit requestTextLog(index, "Sending simulation script...");
-    bOK = ants2socket->SendText(Script);
-    if (!bOK)
-    {
-        rec->Error = "Failed to send script to ANTS2 server";
-        return;
-    }
-
-    reply = ants2socket->GetTextReply();
-    if (reply.isEmpty())
-    {
-        rec->Error = "Got no reply after sending a script to ANTS2 server";
-        return;
-    }
-    emit requestTextLog(index, reply);
-    QJsonObject obj = strToObject(reply);
-    if (obj.contains("error"))
-    {
-        rec->Error = obj["error"].toString();
-        return;
-    }
-
-    while ( !obj.contains("binary") ) //after server send back the file with sim, the reply is "{ \"binary\" : \"file\" }"
+    //simulated events are streamed back in frames, which are stored in the server record as they arrive
+    rec->clearReceived();
+    bool bOK = runStreamingScript(Script, [this](const QByteArray & ba){return onSimulationFrame(ba);});
+    if (bOK)
     {
-        emit requestTextLog(index, reply);
-        bool bOK = ants2socket->ResumeWaitForAnswer();
-        reply = ants2socket->GetTextReply();
-        if (!bOK || reply.isEmpty())
+        if (Scheduler->complete(index, iBatch))
         {
-            rec->Error = ants2socket->GetError();
-            break;
+            AGridSimBatch & res = (*Results)[iBatch];
+            res.Events      = std::move(rec->ReceivedEvents);
+            res.TimedEvents = std::move(rec->ReceivedTimedEvents);
+            res.Scan        = rec->ReceivedScan;
+            res.NumRuns     = rec->ReceivedNumRuns;
+            rec->ReceivedScan.clear();
         }
-        obj = strToObject(reply);
-        if (obj.contains("progress"))
-            rec->Progress = obj["progress"].toInt();
+        else emit requestTextLog(index, QString("Batch #%1 was already simulated by another server").arg(iBatch));
     }
+    rec->clearReceived();
+    return bOK;
+}
 
-    if (rec->Error.isEmpty())
-    {
-        rec->TimeElapsed = timer.elapsed();
-        rec->Progress = 100;
-        emit requestTextLog(index, "Server has finished simulation");
-
-        const QByteArray& ba = ants2socket->GetBinaryReply();
-        qDebug() << "ByteArray to save size:"<<ba.size();
+bool AWebSocketWorker_Sim::onSimulationFrame(const QByteArray &ba)
+{
+    if (!AEventFrame::isFrame(ba)) return false;
 
-        QString LocalSimTreeFileName = RemoteSimTreeFileName; // !!!!!!!!!!!!!!
-        QFile saveFile(LocalSimTreeFileName);
-        if ( !saveFile.open(QIODevice::WriteOnly) )
-            rec->Error = QString("Failed to save sim data to file: ") + LocalSimTreeFileName;
-        else
+    AEventFrame frame;
+    bool bOK = frame.read(ba);
+    if (bOK)
+    {
+        switch (frame.getType())
         {
-            saveFile.write(ba);
-            saveFile.close();
-            rec->FileName = LocalSimTreeFileName;
-            emit requestTextLog(index, QString("Sim results saved in ") + LocalSimTreeFileName);
+        case AEventFrame::Events:      bOK = frame.appendEvents(rec->ReceivedEvents);      break;
+        case AEventFrame::TimedEvents: bOK = frame.appendEvents(rec->ReceivedTimedEvents); break;
+        case AEventFrame::Scan:        bOK = frame.appendScan(rec->ReceivedScan);          break;
+        default:                       bOK = false;
         }
     }
-    else rec->Progress = 0;
+    if (!bOK && FrameError.isEmpty())
+        FrameError = "Failed to read simulation data sent by the server " + frame.ErrorString;
+    return true;
 }
 
-AWebSocketWorker_Rec::AWebSocketWorker_Rec(int index, ARemoteServerRecord *rec, int timeOut, const QJsonObject *config) :
-    AWebSocketWorker_Base(index, rec, timeOut, config) {}
+AWebSocketWorker_Rec::AWebSocketWorker_Rec(int index, ARemoteServerRecord *rec, int timeOut, const QJsonObject *config, EventsDataClass & EventsDataHub) :
+    AWebSocketWorker_Base(index, rec, timeOut, config), EventsDataHub(EventsDataHub) {}
 
 void AWebSocketWorker_Rec::run()
 {
@@ -1364,7 +1558,7 @@ void AWebSocketWorker_Rec::run()
     else
     {
         bPaused = true;
-        //waiting while main thread will set events to reconstruct
+        //waiting while main thread will set up the scheduler
         while (bPaused && !bExternalAbort)
         {
             QThread::usleep(100);
@@ -1379,8 +1573,8 @@ void AWebSocketWorker_Rec::run()
                 emit requestTextLog(index, rec->Error);
             }
             else rec->Progress = 100;
-            ants2socket->Disconnect();
         }
+        releaseSession();
     }
 
     bRunning = false;
@@ -1389,8 +1583,6 @@ void AWebSocketWorker_Rec::run()
 
 void AWebSocketWorker_Rec::runReconstruction()
 {
-    emit requestTextLog(index, QString("Reconstructing events from %1 to %2").arg(rec->EventsFrom).arg(rec->EventsTo));
-
     rec->Error.clear();
 
     if (!ants2socket || !ants2socket->ConfirmSendPossible())
@@ -1405,83 +1597,89 @@ void AWebSocketWorker_Rec::runReconstruction()
         return;
     }
 
-    qDebug() << "Sending config...";
-    emit requestTextLog(index, "Sending config file...");
-    bool bOK = ants2socket->SendJson(*config);
-    QString reply = ants2socket->GetTextReply();
-    QJsonObject ro = strToObject(reply);
-    if (!bOK || !ro.contains("result") || !ro["result"].toBool())
-    {
-        rec->Error = "Failed to send config";
-        return;
-    }
-    emit requestTextLog(index, "Sending script to setup configuration...");
-    QString Script = "var c = server.GetBufferAsObject();"
-                     "var ok = config.SetConfig(c);"
-                     "if (!ok) core.abort(\"Failed to set config\");";
-    bOK = ants2socket->SendText(Script);
-    reply = ants2socket->GetTextReply();
-    ro = strToObject(reply);
-    if (!bOK || !ro.contains("result") || !ro["result"].toBool())
-    {
-        rec->Error = "failed to setup config on the ants2 server";
-        return;
-    }
+    if (!sendAnts2Config()) return;  //rec->Error is set inside
 
-    //sending events
-    emit requestTextLog(index, "Sending events to the server...");
-    bOK = ants2socket->SendQByteArray(rec->ByteArrayToSend);
-    reply = ants2socket->GetTextReply();
-    ro = strToObject(reply);
-    if (!bOK || !ro.contains("result") || !ro["result"].toBool())
-    {
-        rec->Error = "Failed to send events to remote server";
-        return;
-    }
+    bool bOK = processBatches();
+    if (bOK) emit requestTextLog(index, "Remote reconstruction finished");
+    else if (rec->Error.isEmpty()) rec->Error = "Aborted";
+}
 
-    emit requestTextLog(index, "Setting event signals at the remote server...");
-    Script = "server.GetBufferAsEvents()";
-    bOK = ants2socket->SendText(Script);
-    reply = ants2socket->GetTextReply();
-    ro = strToObject(reply);
-    if ( !bOK || !ro.contains("result") || !ro["result"].toBool() )
+bool AWebSocketWorker_Rec::runBatch(int iBatch, int from, int to)
+{
+    emit requestTextLog(index, QString("Reconstructing batch #%1: events from %2 to %3").arg(iBatch).arg(from).arg(to));
+
+    //sending events: each frame is appended to the event data on the server as it arrives
+    const int numEvents = to - from;
+    QByteArray ba;
+    int iFrom = from;
+    do
     {
-        rec->Error = "Failed to set events on server.";
-        return;
+        const int iTo = std::min(iFrom + EventsPerFrame, to);
+        AEventFrame::packEvents(EventsDataHub.Events, false, iFrom, iTo, iFrom - from, numEvents, bCompressFrames, ba);
+        bool bOK = ants2socket->SendQByteArray(ba);
+        QJsonObject ro = strToObject(ants2socket->GetTextReply());
+        if (!bOK || !ro.contains("result") || !ro["result"].toBool())
+        {
+            rec->Error = "Failed to send events to remote server";
+            if (ro.contains("error")) rec->Error += ": " + ro["error"].toString();
+            return false;
+        }
+        iFrom = iTo;
     }
+    while (iFrom < to);
+    ba.clear();
 
-    emit requestTextLog(index, "Starting reconstruction...");
-    Script = "server.SetAcceptExternalProgressReport(true);"; //even if not showing to the user, still want to send reports to see that the server is alive
+    QString Script = "server.SetAcceptExternalProgressReport(true);"; //even if not showing to the user, still want to send reports to see that the server is alive
     Script += "rec.ReconstructEvents(" + QString::number(rec->NumThreads_Allocated) + ", false);";
-    Script += "server.SendReconstructionData()";
-    bOK = ants2socket->SendText(Script);
-    reply = ants2socket->GetTextReply();
-    ro = strToObject(reply);
-    if ( !bOK || ro.contains("error") )
+    Script += QString("server.SendReconstructionFrames(%1, %2)").arg(EventsPerFrame).arg(bCompressFrames ? "true" : "false");
+
+    //results are validated on arrival, but set only if this is the first result for the batch
+    NumReceived = 0;
+    BatchSize = numEvents;
+    ReceivedFrames.clear();
+    bool bOK = runStreamingScript(Script, [this](const QByteArray & ba){return onReconstructionFrame(ba);});
+    if (bOK && NumReceived != numEvents)
     {
-        const QString err = ro["error"].toString();
-        rec->Error = "Server reported error:<br>" + err;
-        return;
+        rec->Error = QString("Server sent reconstruction data for %1 events instead of %2").arg(NumReceived).arg(numEvents);
+        bOK = false;
     }
 
-    while ( !ro.contains("binary") ) //after sending the file, the reply is "{ \"binary\" : \"qbytearray\" }"
+    if (bOK)
     {
-        emit requestTextLog(index, reply);
-        bOK = ants2socket->ResumeWaitForAnswer();
-        reply = ants2socket->GetTextReply();
-        ro = strToObject(reply);
-        if (!bOK)
+        if (Scheduler->complete(index, iBatch))
         {
-            emit requestTextLog(index, "Reconstruction failed!");
-            emit requestTextLog(index, ants2socket->GetError());
-            return;
+            //each batch has its own range of reconstruction records -> no conflict with the other workers
+            for (const QByteArray & frameBa : ReceivedFrames)
+            {
+                AEventFrame frame;
+                if (!frame.read(frameBa) || !EventsDataHub.setReconstructedFromEventFrame(from, frame))
+                    qWarning() << "Failed to set reconstruction data for batch" << iBatch;
+            }
         }
-        if (ro.contains("progress"))
-            rec->Progress = ro["progress"].toInt();
+        else emit requestTextLog(index, QString("Batch #%1 was already reconstructed by another server").arg(iBatch));
     }
+    ReceivedFrames.clear();
+    return bOK;
+}
 
-    rec->ByteArrayReceived = ants2socket->GetBinaryReply();
-    emit requestTextLog(index, "Remote reconstruction finished");
+bool AWebSocketWorker_Rec::onReconstructionFrame(const QByteArray &ba)
+{
+    if (!AEventFrame::isFrame(ba)) return false;
+
+    AEventFrame frame;
+    bool bOK = frame.read(ba);
+    if (bOK)
+    {
+        bOK = ( frame.getType() == AEventFrame::Reconstruction && frame.getTotalEvents() == BatchSize );
+        if (bOK)
+        {
+            NumReceived += frame.getNumEvents();
+            ReceivedFrames << ba;
+        }
+    }
+    if (!bOK && FrameError.isEmpty())
+        FrameError = "Failed to read reconstruction data sent by the server " + frame.ErrorString;
+    return true;
 }
 
 AWorker_Script::AWorker_Script(int index, ARemoteServerRecord *rec, int timeOut, const QJsonObject *config, const QString & script, AGridScriptResources & data) :
@@ -1510,7 +1708,7 @@ void AWorker_Script::run()
 
     runEvalScript();
 
-    ants2socket->Disconnect();
+    releaseSession();
 
     if (!rec->Error.isEmpty() || bExternalAbort)
     {
@@ -1533,7 +1731,6 @@ void AWorker_Script::run()
     return;
 }
 
-#include <QJsonDocument>
 void AWorker_Script::runEvalScript()
 {
     rec->Error.clear(); //?
@@ -1604,7 +1801,7 @@ void AWorker_Upload::run()
 
     emit requestTextLog(index, "Uploading file...");
     bool ok = uploadFile(FileName, QFileInfo(FileName).fileName());
-    ants2socket->Disconnect();
+    releaseSession();
     if (!ok) return;
 
     if (!rec->Error.isEmpty() || bExternalAbort)
@@ -7,6 +7,10 @@
 #include <QVariant>
 #include <QString>
 
+#include "aeventstore.h"
+
+#include <functional>
+
 class EventsDataClass;
 class APmHub;
 class ASimulationManager;
@@ -14,7 +18,22 @@ class ARemoteServerRecord;
 class AWebSocketSession;
 class AWebSocketWorker_Base;
 class QJsonObject;
+class QJsonValue;
+class QThread;
+class AGridScheduler;
+class AGridSessionPool;
+struct AGridSession;
 struct AGridScriptResources;
+struct AScanRecord;
+
+// simulation results of one batch of events
+struct AGridSimBatch
+{
+    AEventStore           Events;
+    AEventStore           TimedEvents;
+    QVector<AScanRecord*> Scan;     // owned until moved to EventsDataHub
+    int                   NumRuns = 1;
+};
 
 class AGridRunner : public QObject
 {
@@ -34,6 +53,10 @@ public:
     void Abort();
 
     void SetTimeout(int timeout);
+    void SetFrameOptions(int eventsPerFrame, bool bCompress);
+    void SetBatchesPerServer(int batches);
+    void SetSessionKeepAlive(int ms);   //0 - sessions are closed after each job
+    void CloseSessions();
 
     void writeConfig();
     void readConfig();
@@ -49,6 +72,10 @@ private:
     const APmHub & PMs;
     ASimulationManager & SimMan;
     int TimeOut = 5000;
+    int EventsPerFrame = 10000;   //events and reconstruction results are transferred in frames of this size
+    bool bCompressFrames = false;
+    int BatchesPerServer = 8;     //events are distributed dynamically in batches, on average this number per server
+    AGridSessionPool * SessionPool = nullptr;
 
     bool bAbortRequested = false;
 
@@ -70,6 +97,10 @@ private:
 
     void doAbort(QVector<AWebSocketWorker_Base *> &workers);
 
+    int  countActiveServers() const;
+    int  getBatchSize(int numEvents, int numServers) const;
+    void reportServerRates(const AGridScheduler & scheduler);
+
     void onStart();
     QString commonStart();
 
@@ -95,7 +126,10 @@ public:
     void setStarted() {bRunning = true;}
     void setPaused(bool flag) {bPaused = flag;}
 
-    void setExtraScript(const QString& script) {extraScript = script;}
+    void setScheduler(AGridScheduler * scheduler) {Scheduler = scheduler;}
+    void setFrameOptions(int eventsPerFrame, bool bCompress) {EventsPerFrame = eventsPerFrame; bCompressFrames = bCompress;}
+    void setSession(AGridSession * session, int idleTime);  //call from the thread of the pool
+    AGridSession * getSession() {return Session;}
 
     void RequestAbort();
 
@@ -117,17 +151,34 @@ protected:
     const QJsonObject* config;
     AWebSocketSession* ants2socket = nullptr;
 
-    QString extraScript; //e.g. script to modify config according to distribution of sim events
+    AGridScheduler * Scheduler = nullptr;
+
+    AGridSession * Session = nullptr;  //persistent session from the pool, nullptr if pooling is disabled
+    int  ServerIdleTime = 0;           //ms, server is asked to keep the session open this long between jobs
+    QThread * PoolThread = nullptr;    //released session is moved back to this thread
+
+    int     EventsPerFrame = 10000;
+    bool    bCompressFrames = false;
+    QString FrameError;  //frames are processed on arrival, the error is reported after the reply
 
     AWebSocketSession* connectToServer(int port);
     bool               allocateAntsServer();
     AWebSocketSession* connectToAntsServer();
-    bool               establishSession();
+    bool               establishSession();   //reuses the pooled session if it is still open
+    void               releaseSession();     //session is returned to the pool if the job was successful, otherwise closed
+    bool               requestKeepAlive();
+    bool               evaluateQuery(const QString & Script, QJsonValue & Result); //short script without progress reports
 
-    bool               sendAnts2Config();
-    bool               uploadFile(const QString & LocalFileName, const QString & RemoteFileName);
+    bool               sendAnts2Config();    //only the config sections which are not already set on the server are sent
+    bool               uploadFile(const QString & LocalFileName, const QString & RemoteFileName); //skipped if the server has the file with the same checksum
     bool               evaluateScript(const QString & Script, QVariant * Result = nullptr);
 
+    // takes batches from the scheduler until all are done; false if this server has failed or abort was requested
+    bool               processBatches();
+    virtual bool       runBatch(int iBatch, int from, int to);
+    // sends the script and waits for its final reply; binary frames arriving meanwhile are given to the handler
+    bool               runStreamingScript(const QString & Script, std::function<bool(const QByteArray&)> frameHandler);
+
 signals:
     void finished();
     void requestTextLog(int index, const QString message);
@@ -157,24 +208,43 @@ class AWebSocketWorker_Sim : public AWebSocketWorker_Base
 public:
     AWebSocketWorker_Sim(int index, ARemoteServerRecord* rec, int timeOut, const QJsonObject* config);
 
+    void setBatchScript(std::function<QString(int, int)> script) {BatchScript = script;}
+    void setResults(std::vector<AGridSimBatch> * results) {Results = results;}
+
 public slots:
     virtual void run() override;
 
+protected:
+    bool runBatch(int iBatch, int from, int to) override;
+
 private:    
+    std::function<QString(int, int)> BatchScript;   //script to modify config for the batch of events [from, to)
+    std::vector<AGridSimBatch> * Results = nullptr;
+
     void runSimulation();
+    bool onSimulationFrame(const QByteArray & ba);
 };
 
 class AWebSocketWorker_Rec : public AWebSocketWorker_Base
 {
     Q_OBJECT
 public:
-    AWebSocketWorker_Rec(int index, ARemoteServerRecord* rec, int timeOut, const QJsonObject* config);
+    AWebSocketWorker_Rec(int index, ARemoteServerRecord* rec, int timeOut, const QJsonObject* config, EventsDataClass & EventsDataHub);
 
 public slots:
     virtual void run() override;
 
+protected:
+    bool runBatch(int iBatch, int from, int to) override;
+
 private:
+    EventsDataClass & EventsDataHub;
+    int NumReceived = 0;
+    int BatchSize = 0;
+    QVector<QByteArray> ReceivedFrames;  //applied only if the batch result is accepted by the scheduler
+
     void runReconstruction();
+    bool onReconstructionFrame(const QByteArray & ba);
 };
 
 class AWorker_Script : public AWebSocketWorker_Base
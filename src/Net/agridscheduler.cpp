@@ -0,0 +1,163 @@
+#include "agridscheduler.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+AGridScheduler::AGridScheduler(int numEvents, int batchEvents, int numServers)
+{
+    batchEvents = std::max(1, batchEvents);
+    for (int from = 0; from < numEvents; from += batchEvents)
+    {
+        ABatchRecord b;
+        b.From = from;
+        b.To   = std::min(from + batchEvents, numEvents);
+        Batches << b;
+    }
+    Servers.resize(numServers);
+    Timer.start();
+}
+
+AGridScheduler::ATakeResult AGridScheduler::take(int iServer, int & iBatch, int & from, int & to)
+{
+    QMutexLocker lock(&Mutex);
+
+    if (NumDone == Batches.size()) return Finished;
+    const qint64 now = Timer.elapsed();
+
+    iBatch = -1;
+    for (int i = 0; i < Batches.size(); i++)
+        if (Batches.at(i).Status == Pending)
+        {
+            iBatch = i;
+            break;
+        }
+
+    if (iBatch < 0)
+    {
+        // speculative copy of the batch which is expected to finish last, if this server is expected to finish it earlier
+        double myRate = rate(iServer);
+        if (myRate == 0) myRate = averageRate();
+        if (myRate == 0) return Wait;
+
+        double latest = 0;
+        for (int i = 0; i < Batches.size(); i++)
+        {
+            const ABatchRecord & b = Batches.at(i);
+            if (b.Status != Running || b.Runners.size() >= MaxRunners || b.Runners.contains(iServer)) continue;
+
+            const double finish = expectedFinish(b);
+            const double myFinish = now + 1000.0 * (b.To - b.From) / myRate;
+            if (myFinish < finish && finish > latest)
+            {
+                latest = finish;
+                iBatch = i;
+            }
+        }
+        if (iBatch < 0) return Wait;
+    }
+
+    ABatchRecord & b = Batches[iBatch];
+    b.Status = Running;
+    b.Runners << iServer;
+    b.StartTimes << now;
+    from = b.From;
+    to   = b.To;
+    return Batch;
+}
+
+bool AGridScheduler::complete(int iServer, int iBatch)
+{
+    QMutexLocker lock(&Mutex);
+
+    ABatchRecord & b = Batches[iBatch];
+    const int index = b.Runners.indexOf(iServer);
+    if (index >= 0)
+    {
+        AServerStat & s = Servers[iServer];
+        s.Events += b.To - b.From;
+        s.TimeMs += std::max((qint64)1, Timer.elapsed() - b.StartTimes.at(index));
+        b.Runners.remove(index);
+        b.StartTimes.remove(index);
+    }
+
+    if (b.Status == Done) return false;
+
+    b.Status = Done;
+    NumDone++;
+    Servers[iServer].Accepted++;
+    return true;
+}
+
+void AGridScheduler::fail(int iServer, int iBatch)
+{
+    QMutexLocker lock(&Mutex);
+
+    ABatchRecord & b = Batches[iBatch];
+    const int index = b.Runners.indexOf(iServer);
+    if (index >= 0)
+    {
+        b.Runners.remove(index);
+        b.StartTimes.remove(index);
+    }
+    if (b.Status == Running && b.Runners.isEmpty()) b.Status = Pending;
+}
+
+bool AGridScheduler::isFinished() const
+{
+    QMutexLocker lock(&Mutex);
+    return NumDone == Batches.size();
+}
+
+int AGridScheduler::countDone() const
+{
+    QMutexLocker lock(&Mutex);
+    return NumDone;
+}
+
+int AGridScheduler::countProcessed(int iServer) const
+{
+    QMutexLocker lock(&Mutex);
+    return Servers.at(iServer).Accepted;
+}
+
+double AGridScheduler::getRate(int iServer) const
+{
+    QMutexLocker lock(&Mutex);
+    return rate(iServer);
+}
+
+double AGridScheduler::rate(int iServer) const
+{
+    const AServerStat & s = Servers.at(iServer);
+    return (s.TimeMs > 0 ? 1000.0 * s.Events / s.TimeMs : 0);
+}
+
+double AGridScheduler::averageRate() const
+{
+    double sum = 0;
+    int num = 0;
+    for (int i = 0; i < Servers.size(); i++)
+    {
+        const double r = rate(i);
+        if (r > 0)
+        {
+            sum += r;
+            num++;
+        }
+    }
+    return (num > 0 ? sum / num : 0);
+}
+
+double AGridScheduler::expectedFinish(const ABatchRecord & b) const
+{
+    double finish = 1e100;
+    for (int i = 0; i < b.Runners.size(); i++)
+    {
+        double r = rate(b.Runners.at(i));
+        if (r == 0) r = averageRate();
+        if (r == 0) return 0;     // nothing known yet: no speculation
+        finish = std::min(finish, b.StartTimes.at(i) + 1000.0 * (b.To - b.From) / r);
+    }
+    return finish;
+}
@@ -0,0 +1,65 @@
+#ifndef AGRIDSCHEDULER_H
+#define AGRIDSCHEDULER_H
+
+#include <QVector>
+#include <QMutex>
+#include <QElapsedTimer>
+
+// Dynamic distribution of the events of a grid run between the servers
+// Events [0, NumEvents) are split in batches, which the workers take one at a time when they are free,
+// so faster servers process more batches. The event rate of each server is measured on every completed batch
+// When there are no batches left in the queue, a free worker re-issues the batch expected to finish last (speculative execution),
+// the first result of a batch is accepted. Batches of a server which dropped out are returned to the queue
+// Thread-safe: used concurrently by all workers
+class AGridScheduler
+{
+public:
+    AGridScheduler(int numEvents, int batchEvents, int numServers);
+
+    enum ATakeResult {Batch, Wait, Finished};
+
+    // Wait: all batches are running and speculation does not pay off - ask again later
+    ATakeResult take(int iServer, int & iBatch, int & from, int & to);
+    // returns true if the result has to be used (first completion of the batch)
+    bool        complete(int iServer, int iBatch);
+    void        fail(int iServer, int iBatch);
+
+    bool   isFinished() const;
+    int    countBatches() const {return Batches.size();}
+    int    countDone() const;
+    int    countProcessed(int iServer) const;  // batches accepted from this server
+    double getRate(int iServer) const;         // events per second, 0 if not yet measured
+
+    static const int MaxRunners = 2;           // a batch can run on the original server and one speculative copy
+
+private:
+    enum AStatus {Pending, Running, Done};
+
+    struct ABatchRecord
+    {
+        int  From;
+        int  To;
+        AStatus Status = Pending;
+        QVector<int> Runners;                  // servers which currently process the batch
+        QVector<qint64> StartTimes;            // ms since scheduler start, per runner
+    };
+
+    struct AServerStat
+    {
+        qint64 Events = 0;
+        qint64 TimeMs = 0;
+        int    Accepted = 0;
+    };
+
+    mutable QMutex        Mutex;
+    QElapsedTimer         Timer;
+    QVector<ABatchRecord> Batches;
+    QVector<AServerStat>  Servers;
+    int                   NumDone = 0;
+
+    double rate(int iServer) const;            // no lock
+    double averageRate() const;                // no lock
+    double expectedFinish(const ABatchRecord & b) const; // ms since scheduler start, no lock
+};
+
+#endif // AGRIDSCHEDULER_H
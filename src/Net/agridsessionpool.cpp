@@ -0,0 +1,87 @@
+#include "agridsessionpool.h"
+#include "aremoteserverrecord.h"
+#include "awebsocketsession.h"
+
+#include <QVector>
+#include <QDebug>
+
+#include <algorithm>
+
+AGridSessionPool::~AGridSessionPool()
+{
+    clear();
+}
+
+void AGridSessionPool::setKeepAlive(int ms)
+{
+    KeepAlive = std::max(0, ms);
+    if (KeepAlive == 0) clear();
+}
+
+AGridSession * AGridSessionPool::get(const ARemoteServerRecord * rec)
+{
+    if (!isEnabled()) return nullptr;
+
+    AGridSession * s = Sessions.value(rec, nullptr);
+    if (!s)
+    {
+        s = new AGridSession();
+        Sessions[rec] = s;
+    }
+    else if (s->Socket)
+    {
+        if (isExpired(s) || !rec->bEnabled || s->IP != rec->IP || s->Port != rec->Port)
+            close(s);
+    }
+    return s;
+}
+
+void AGridSessionPool::purge(const QVector<ARemoteServerRecord *> & records)
+{
+    for (auto it = Sessions.begin(); it != Sessions.end(); )
+    {
+        AGridSession * s = it.value();
+        if (!records.contains(const_cast<ARemoteServerRecord*>(it.key())))
+        {
+            close(s);
+            delete s;
+            it = Sessions.erase(it);
+            continue;
+        }
+        if (s->Socket && isExpired(s)) close(s);
+        ++it;
+    }
+}
+
+void AGridSessionPool::clear()
+{
+    for (AGridSession * s : Sessions)
+    {
+        close(s);
+        delete s;
+    }
+    Sessions.clear();
+}
+
+int AGridSessionPool::countOpen() const
+{
+    int num = 0;
+    for (const AGridSession * s : Sessions)
+        if (s->Socket) num++;
+    return num;
+}
+
+bool AGridSessionPool::isExpired(const AGridSession * s) const
+{
+    return !s->LastUsed.isValid() || s->LastUsed.elapsed() > KeepAlive;
+}
+
+void AGridSessionPool::close(AGridSession * s)
+{
+    if (!s->Socket) return;
+
+    qDebug() << "Closing pooled session with" << s->IP << s->Port;
+    s->Socket->Disconnect();
+    delete s->Socket;
+    s->Socket = nullptr;
+}
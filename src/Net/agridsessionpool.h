@@ -0,0 +1,57 @@
+#ifndef AGRIDSESSIONPOOL_H
+#define AGRIDSESSIONPOOL_H
+
+#include <QMap>
+#include <QVector>
+#include <QString>
+#include <QElapsedTimer>
+
+class ARemoteServerRecord;
+class AWebSocketSession;
+
+// Session with an ANTS2 server which is kept open between grid jobs
+// While idle, the socket lives in the thread of the grid runner; the runner moves it to the thread of the worker for the job
+struct AGridSession
+{
+    AWebSocketSession * Socket = nullptr;  // nullptr if there is no open session or it is in use by a worker
+    QString       IP;                      // dispatcher of the session
+    int           Port = 0;
+    int           NumThreads = 0;          // threads allocated by the dispatcher
+    QElapsedTimer LastUsed;
+};
+
+// Keeps one session per server record, so repeated short jobs (e.g. farm.evaluateScript in a loop)
+// do not request a new server from the dispatcher, connect and validate the ticket every time
+// Config sections and files already present on the server are not sent again (see AWebSocketWorker_Base)
+// Not thread-safe: used only from the thread of the grid runner
+class AGridSessionPool
+{
+public:
+    ~AGridSessionPool();
+
+    // ms; sessions unused for longer are closed. The server is asked to wait a bit longer before self-destruct on idle
+    void setKeepAlive(int ms);
+    int  getKeepAlive() const {return KeepAlive;}
+    int  getServerIdleTime() const {return KeepAlive + ServerIdleMargin;}
+    bool isEnabled() const {return KeepAlive > 0;}
+
+    // nullptr if pooling is disabled; an expired session, or a session with another dispatcher, is closed
+    AGridSession * get(const ARemoteServerRecord * rec);
+
+    // closes expired sessions and the sessions of the records not in the list
+    void purge(const QVector<ARemoteServerRecord*> & records);
+    void clear();
+
+    int  countOpen() const;
+
+private:
+    int KeepAlive = 60000;
+    static const int ServerIdleMargin = 5000;
+
+    QMap<const ARemoteServerRecord*, AGridSession*> Sessions;
+
+    bool isExpired(const AGridSession * s) const;
+    static void close(AGridSession * s);
+};
+
+#endif // AGRIDSESSIONPOOL_H
@@ -180,6 +180,19 @@ void ANetworkModule::OnWebSocketTextMessageReceived(QString message)
                 return;
             }
         }
+        else if (json.contains("idle"))
+        {
+            //grid client keeps the session open between its jobs
+            int idle = json["idle"].toInt();
+            if (idle > MaxSelfDestructOnIdle) idle = MaxSelfDestructOnIdle;
+            qDebug() << "  Self-destruct on idle after" << idle << "ms requested";
+            if (bSingleConnectionMode && idle > 0)
+            {
+                SelfDestructOnIdle = idle;
+                IdleTimer.setInterval(SelfDestructOnIdle);
+            }
+            WebSocketServer->sendOK();
+        }
         else
         {
             qDebug() << "  System message not recognized!";
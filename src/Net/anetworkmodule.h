@@ -71,6 +71,7 @@ private:
   bool bTicketChecked = true;
   bool bSingleConnectionMode = false;
   int  SelfDestructOnIdle = 10000; //milliseconds
+  static const int MaxSelfDestructOnIdle = 600000; //milliseconds, limit for the idle time requested by the client
   QTimer IdleTimer;
 };
 
@@ -1,6 +1,12 @@
 #include "aremoteserverrecord.h"
 
 #include "ajsontools.h"
+#include "apositionenergyrecords.h"
+
+ARemoteServerRecord::~ARemoteServerRecord()
+{
+    clearReceived();
+}
 
 const QJsonObject ARemoteServerRecord::WriteToJson()
 {
@@ -25,3 +31,11 @@ void ARemoteServerRecord::ReadFromJson(const QJsonObject &json)
     parseJson(json, "SpeedFactor", SpeedFactor);
     parseJson(json, "NumThreads", NumThreads_Possible);
 }
+
+void ARemoteServerRecord::clearReceived()
+{
+    ReceivedEvents.clear();
+    ReceivedTimedEvents.clear();
+    for (AScanRecord * s : ReceivedScan) delete s;
+    ReceivedScan.clear();
+}
@@ -1,18 +1,22 @@
 #ifndef AREMOTESERVERRECORD_H
 #define AREMOTESERVERRECORD_H
 
+#include "aeventstore.h"
+
 #include <QString>
 #include <QJsonObject>
-#include <QByteArray>
+#include <QVector>
 
 class AWebSocketSession;
 class QThread;
+struct AScanRecord;
 
 class ARemoteServerRecord
 {
 public:
     ARemoteServerRecord(QString Name, QString IP, int Port) : Name(Name), IP(IP), Port(Port) {}
     ARemoteServerRecord() {}
+    ~ARemoteServerRecord();
 
     enum ServerStatus {Unknown = 0, Connecting, Alive, Dead, Busy};
 
@@ -30,11 +34,10 @@ public:
     int     Progress = 0;
     int     AntsServerPort = -1;
     QString AntsServerTicket;
-    QString FileName; //local file where sim tree is saved
-    int     EventsFrom;
-    int     EventsTo;
-    QByteArray ByteArrayToSend;
-    QByteArray ByteArrayReceived;
+    AEventStore           ReceivedEvents;       //simulation results streamed by the server in event frames
+    AEventStore           ReceivedTimedEvents;
+    QVector<AScanRecord*> ReceivedScan;         //owned until moved to EventsDataHub
+    int                   ReceivedNumRuns = 1;
     qint64  TimeElapsed; //for rating
 
     //error-related
@@ -45,6 +48,8 @@ public:
 public:
     const QJsonObject WriteToJson();
     void              ReadFromJson(const QJsonObject& json);
+
+    void              clearReceived();
 };
 
 #endif // AREMOTESERVERRECORD_H
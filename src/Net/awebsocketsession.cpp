@@ -153,6 +153,11 @@ bool AWebSocketSession::waitForReply()
             Error = "Aborted!";
             return false;
         }
+        if (bFrameReceived)
+        {
+            bFrameReceived = false;
+            timer.restart();
+        }
         if (timer.elapsed() > timeout)
         {
             qDebug() << "||| Timeout on waiting for reply";
@@ -235,6 +240,12 @@ void AWebSocketSession::ExternalAbort()
     fExternalAbort = true;
 }
 
+void AWebSocketSession::MoveToThread(QThread *thread)
+{
+    socket->moveToThread(thread);
+    moveToThread(thread);
+}
+
 void AWebSocketSession::onConnect()
 {
     qDebug() << "Connected to server";
@@ -287,6 +298,12 @@ void AWebSocketSession::onTextMessageReceived(const QString &message)
 
 void AWebSocketSession::onBinaryMessageReceived(const QByteArray &message)
 {
+    if (BinaryFrameHandler && BinaryFrameHandler(message))
+    {
+        bFrameReceived = true;
+        return;
+    }
+
     qDebug() << "Binary message received. Size = " << message.length();
     TextReply = "#binary";
     BinaryReply = message;
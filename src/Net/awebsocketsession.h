@@ -6,8 +6,11 @@
 #include <QByteArray>
 #include <QAbstractSocket>
 
+#include <functional>
+
 class QWebSocket;
 class QJsonObject;
+class QThread;
 
 class AWebSocketSession : public QObject
 {
@@ -36,12 +39,19 @@ public:
 
     void  ExternalAbort();
 
+    // the session and its socket have to be in the same thread; call from the thread the session currently lives in
+    void  MoveToThread(QThread * thread);
+
     void  SetTimeout(int milliseconds) {timeout = milliseconds;}
     void  SetIntervalBetweenEventProcessing(int milliseconds) {sleepDuration = milliseconds;}
     quint16 GetPeerPort() {return peerPort;} //used as part of the unique names for remote files
 
     bool ConfirmSendPossible();
 
+    // binary messages consumed by the handler (it returns true) are not stored as the reply and do not end waiting for the reply,
+    // but restart the timeout -> used to receive a stream of frames in a single request
+    void SetBinaryFrameHandler(std::function<bool(const QByteArray&)> handler) {BinaryFrameHandler = handler;}
+
 public:
     enum  ServerState {Idle = 0, Connecting, ConnectionFailed, Connected, Aborted};
 
@@ -70,6 +80,9 @@ private:
 
     quint16 peerPort = 0;
 
+    std::function<bool(const QByteArray&)> BinaryFrameHandler;
+    bool bFrameReceived = false;
+
 private:    
     bool waitForReply();
 };
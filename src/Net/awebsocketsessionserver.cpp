@@ -175,6 +175,13 @@ void AWebSocketSessionServer::ReplyWithQByteArray(const QByteArray &ba)
     bReplied = true;
 }
 
+void AWebSocketSessionServer::SendBinaryFrame(const QByteArray &ba)
+{
+    if ( !assureCanReply() ) return;
+
+    client->sendBinaryMessage(ba);
+}
+
 void AWebSocketSessionServer::ReplyProgress(int percents)
 {
     if ( !assureCanReply() ) return;
@@ -241,12 +248,24 @@ void AWebSocketSessionServer::onTextMessageReceived(const QString &message)
 
 void AWebSocketSessionServer::onBinaryMessageReceived(const QByteArray &message)
 {
-    ReceivedBinary = message;
     NumFrames = 0; Progress = 0;
 
     //emit reportToGUI("    Binary message received");
     emit restartIdleTimer();
 
+    if (BinaryFrameHandler)
+    {
+        QString error;
+        if (BinaryFrameHandler(message, error))
+        {
+            if (error.isEmpty()) sendOK();
+            else sendError(error);
+            return;
+        }
+    }
+
+    ReceivedBinary = message;
+
     if (bDebug) qDebug() << "Binary message received. Length =" << message.length();
 
     sendOK();
@@ -7,6 +7,8 @@
 
 #include <QAbstractSocket>
 
+#include <functional>
+
 class QWebSocketServer;
 class QWebSocket;
 class QHostAddress;
@@ -28,6 +30,11 @@ public:
     void ReplyWithBinaryObject(const QVariant& object);
     void ReplyWithBinaryObject_asJSON(const QVariant& object);
     void ReplyWithQByteArray(const QByteArray & ba);
+    void SendBinaryFrame(const QByteArray & ba);  //no text confirmation - the sequence of frames is closed by a text reply
+
+    // binary messages consumed by the handler (it returns true) are not stored in the buffer;
+    // the client gets OK, or the error if the handler set it
+    void SetBinaryFrameHandler(std::function<bool(const QByteArray&, QString&)> handler) {BinaryFrameHandler = handler;}
 
     void ReplyProgress(int percents);
     void SetCanRetranslateProgress(bool flag) {bRetranslateProgress = flag;}
@@ -74,6 +81,7 @@ private:
     //int CompressionLevel = -1;
 
     QByteArray ReceivedBinary;
+    std::function<bool(const QByteArray&, QString&)> BinaryFrameHandler;
 
     bool bReplied = false;
     bool bRetranslateProgress = false;
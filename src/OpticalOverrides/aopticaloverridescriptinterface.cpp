@@ -23,6 +23,7 @@ void AOpticalOverrideScriptInterface::configure(APhoton *photon, const double *n
     bResultAlreadySet = true;
     ReturnResult = AOpticalOverride::NotTriggered;
     Status = AOpticalOverride::Fresnel;
+    Action = FresnelAction;
 }
 
 AOpticalOverride::OpticalOverrideResultEnum AOpticalOverrideScriptInterface::getResult(AOpticalOverride::ScatterStatusEnum& status)
@@ -53,11 +54,27 @@ AOpticalOverride::OpticalOverrideResultEnum AOpticalOverrideScriptInterface::get
     }
 }
 
+void AOpticalOverrideScriptInterface::applyAction(ActionEnum action)
+{
+    switch (action)
+    {
+    case AbsorbAction:         Absorb(); break;
+    case SpecularAction:       SpecularReflection(); break;
+    case IsotropicAction:      Isotropic(); break;
+    case LambertBackAction:    LambertBack(); break;
+    case LambertForwardAction: LambertForward(); break;
+    case SnellAction:          if (!TryTransmissionSnell()) SpecularReflection(); break; //total internal reflection within the angular bin
+    case DirectAction:         TransmissionDirect(); break;
+    default:                   Fresnel(); break;
+    }
+}
+
 void AOpticalOverrideScriptInterface::Absorb()
 {
     ReturnResult = AOpticalOverride::Absorbed;
     Status = AOpticalOverride::Absorption;
     bResultAlreadySet = true;
+    setAction(AbsorbAction);
 }
 
 void AOpticalOverrideScriptInterface::Fresnel()
@@ -65,6 +82,7 @@ void AOpticalOverrideScriptInterface::Fresnel()
     ReturnResult = AOpticalOverride::NotTriggered;
     Status = AOpticalOverride::Fresnel;
     bResultAlreadySet = true;
+    setAction(FresnelAction);
 }
 
 bool AOpticalOverrideScriptInterface::TryTransmissionSnell()
@@ -86,6 +104,7 @@ bool AOpticalOverrideScriptInterface::TryTransmissionSnell()
     ReturnResult = AOpticalOverride::Forward;
     Status = AOpticalOverride::Transmission;
     bResultAlreadySet = true;
+    setAction(SnellAction);
 
     return true;
 }
@@ -95,6 +114,7 @@ void AOpticalOverrideScriptInterface::TransmissionDirect()
     ReturnResult = AOpticalOverride::Forward;
     Status = AOpticalOverride::Transmission;
     bResultAlreadySet = true;
+    setAction(DirectAction);
 }
 
 QVariant AOpticalOverrideScriptInterface::GetNormal()
@@ -123,12 +143,14 @@ void AOpticalOverrideScriptInterface::SpecularReflection()
     Status = AOpticalOverride::SpikeReflection;
     ReturnResult = AOpticalOverride::Back;
     bResultAlreadySet = true;
+    setAction(SpecularAction);
 }
 
 void AOpticalOverrideScriptInterface::Isotropic()
 {
     Photon->RandomDir(RandGen);
     bResultAlreadySet = false;
+    setAction(IsotropicAction);
 }
 
 void AOpticalOverrideScriptInterface::LambertBack()
@@ -148,6 +170,7 @@ void AOpticalOverrideScriptInterface::LambertBack()
     Status = AOpticalOverride::LambertianReflection;
     ReturnResult = AOpticalOverride::Back;
     bResultAlreadySet = true;
+    setAction(LambertBackAction);
     //emit requestAbort();
 }
 
@@ -168,6 +191,7 @@ void AOpticalOverrideScriptInterface::LambertForward()
     Status = AOpticalOverride::Transmission;
     ReturnResult = AOpticalOverride::Forward;
     bResultAlreadySet = true;
+    setAction(LambertForwardAction);
 }
 
 QVariant AOpticalOverrideScriptInterface::GetDirection()
@@ -183,18 +207,21 @@ void AOpticalOverrideScriptInterface::SetDirection(double vx, double vy, double
     Photon->v[1] = vy;
     Photon->v[2] = vz;
     bResultAlreadySet = false;
+    setAction(CustomAction);
 }
 
 void AOpticalOverrideScriptInterface::SetTime(double time)
 {
     Photon->time = time;
-    Photon->SimStat->timeChanged++;
+    if (Photon->SimStat) Photon->SimStat->timeChanged++;
+    setAction(CustomAction);
 }
 
 void AOpticalOverrideScriptInterface::AddTime(double dt)
 {
     Photon->time += dt;
-    Photon->SimStat->timeChanged++;
+    if (Photon->SimStat) Photon->SimStat->timeChanged++;
+    setAction(CustomAction);
 }
 
 double AOpticalOverrideScriptInterface::getWaveIndex()
@@ -205,7 +232,8 @@ double AOpticalOverrideScriptInterface::getWaveIndex()
 void AOpticalOverrideScriptInterface::setWaveIndex(int waveIndex)
 {
     Photon->waveIndex = waveIndex;
-    Photon->SimStat->wavelengthChanged++;
+    if (Photon->SimStat) Photon->SimStat->wavelengthChanged++;
+    setAction(CustomAction);
 }
 
 double AOpticalOverrideScriptInterface::getRefractiveIndexFrom()
@@ -220,6 +248,7 @@ double AOpticalOverrideScriptInterface::GetRefractiveIndexTo()
 
 QVariant AOpticalOverrideScriptInterface::GetPosition()
 {
+    setAction(CustomAction);
     QVariantList vl;
     vl << Photon->r[0] << Photon->r[1] << Photon->r[2];
     return vl;
@@ -232,5 +261,6 @@ void AOpticalOverrideScriptInterface::Console(const QString text)
 
 double AOpticalOverrideScriptInterface::GetTime()
 {
+    setAction(CustomAction);
     return Photon->time;
 }
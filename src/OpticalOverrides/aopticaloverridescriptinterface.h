@@ -20,6 +20,13 @@ public:
     void configure(APhoton *Photon, const double *NormalVector, int MatFrom, int MatTo);
     AOpticalOverride::OpticalOverrideResultEnum getResult(AOpticalOverride::ScatterStatusEnum& status);
 
+    //last directive called by the script; Custom if the script modified the photon directly or used its position / time
+    //used to tabulate scripts which only select one of the directives at random
+    enum ActionEnum {FresnelAction = 0, AbsorbAction, SpecularAction, IsotropicAction, LambertBackAction, LambertForwardAction,
+                     SnellAction, DirectAction, NumActions, CustomAction = NumActions};
+    ActionEnum getAction() const {return Action;}
+    void applyAction(ActionEnum action); //repeats the directive for the configured photon
+
 public slots:
 
     //ToDo: meddling test! -> e.g. dir was changed and then Lambert called
@@ -65,6 +72,9 @@ private:
     bool bResultAlreadySet;
     AOpticalOverride::OpticalOverrideResultEnum ReturnResult; //{NotTriggered, Absorbed, Forward, Back, _Error_};
     AOpticalOverride::ScatterStatusEnum Status;
+    ActionEnum Action;
+
+    void setAction(ActionEnum action) {if (Action != CustomAction) Action = action;}
 
 signals:
     void requestAbort(const QScriptValue &result = QScriptValue());
@@ -4,14 +4,19 @@
 #include "aopticaloverridescriptinterface.h"
 #include "amath_si.h"
 #include "ajsontools.h"
+#include "aphoton.h"
+
+#include "TMath.h"
+#include "TRandom2.h"
 
 #ifdef GUI
 #include "ascriptwindow.h"
 #include "ajavascriptmanager.h"
 #include <guiutils.h>
-#include "TRandom2.h"
-#include "aphoton.h"
 #include <QFrame>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QPushButton>
@@ -21,6 +26,12 @@
 
 #include <QDebug>
 #include <QJsonObject>
+#include <QScriptEngine>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 
 AScriptOpticalOverride::AScriptOpticalOverride(AMaterialParticleCollection *MatCollection, int MatFrom, int MatTo)
     : AOpticalOverride(MatCollection, MatFrom, MatTo) {}
@@ -29,15 +40,138 @@ AScriptOpticalOverride::~AScriptOpticalOverride() {}
 
 AOpticalOverride::OpticalOverrideResultEnum AScriptOpticalOverride::calculate(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector)
 {
+    const auto start = std::chrono::steady_clock::now();
+
+    //the interface object registered in the engine of this thread is the photon proxy: it is only re-pointed to the photon
     Resources.overrideInterface->configure(Photon, NormalVector, MatFrom, MatTo);
-    Resources.evaluateScript(Script);
-    return Resources.overrideInterface->getResult(Status);
+    if (TabulatedWaves == 0 || !sampleTabulated(Resources, Photon, NormalVector))
+        Resources.evaluateScript(Script);
+    const OpticalOverrideResultEnum result = Resources.overrideInterface->getResult(Status);
+
+    AScriptOverrideTiming & timing = Resources.ScriptOverrideTiming[this];
+    timing.NumPhotons++;
+    timing.NumNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void AScriptOpticalOverride::addTiming(const AScriptOverrideTiming & timing)
+{
+    NumPhotons.fetch_add(timing.NumPhotons, std::memory_order_relaxed);
+    NumNanoseconds.fetch_add(timing.NumNanoseconds, std::memory_order_relaxed);
+}
+
+bool AScriptOpticalOverride::sampleTabulated(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector)
+{
+    const int iWave = Photon->waveIndex + 1;
+    if (iWave < 0 || iWave >= TabulatedWaves) return false;
+
+    double cosTheta = 0;
+    for (int i=0; i<3; i++) cosTheta += Photon->v[i] * NormalVector[i];
+    const double angle = acos(std::min(1.0, fabs(cosTheta)));
+    const int iAngle = std::min(TabulationAngleBins - 1, (int)(angle / (0.5 * TMath::Pi()) * TabulationAngleBins));
+
+    const int numActions = AOpticalOverrideScriptInterface::NumActions;
+    const double * cumulative = TabulatedCumulative.constData() + (iWave * TabulationAngleBins + iAngle) * numActions;
+    const double rnd = Resources.RandGen->Rndm();
+    int iAction = 0;
+    while (iAction < numActions - 1 && rnd >= cumulative[iAction]) iAction++;
+
+    Resources.overrideInterface->applyAction(static_cast<AOpticalOverrideScriptInterface::ActionEnum>(iAction));
+    return true;
+}
+
+void AScriptOpticalOverride::initializeWaveResolved()
+{
+    NumPhotons = 0;
+    NumNanoseconds = 0;
+
+    TabulatedWaves = 0;
+    TabulatedCumulative.clear();
+    TabulationError.clear();
+    TabulationTime = 0;
+    if (bTabulate) tabulate();
+}
+
+void AScriptOpticalOverride::tabulate()
+{
+    if (!checkOverrideData().isEmpty())
+    {
+        TabulationError = "script error";
+        return;
+    }
+
+    bool bWaveResolved;
+    double WaveFrom, WaveTo, WaveStep;
+    int WaveNodes;
+    MatCollection->GetWave(bWaveResolved, WaveFrom, WaveTo, WaveStep, WaveNodes);
+    const int numWaves = 1 + (bWaveResolved ? WaveNodes : 0);  //first row is for photons without wavelength
+    const int numActions = AOpticalOverrideScriptInterface::NumActions;
+    const int numSamples = std::max(1, TabulationSamples);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    TRandom2 RandGen;
+    ATracerStateful Resources(&RandGen);
+    Resources.generateScriptInfrastructure(MatCollection);
+    AOpticalOverrideScriptInterface * proxy = Resources.overrideInterface;
+
+    APhoton Photon;
+    Photon.r[0] = Photon.r[1] = Photon.r[2] = 0;
+    const double Normal[3] = {0, 0, 1.0};
+
+    QVector<double> table(numWaves * TabulationAngleBins * numActions, 0);
+    for (int iWave = 0; iWave < numWaves; iWave++)
+        for (int iAngle = 0; iAngle < TabulationAngleBins; iAngle++)
+        {
+            const double angle = (iAngle + 0.5) / TabulationAngleBins * 0.5 * TMath::Pi();
+            double * bin = table.data() + (iWave * TabulationAngleBins + iAngle) * numActions;
+
+            for (int iSample = 0; iSample < numSamples; iSample++)
+            {
+                Photon.v[0] = sin(angle); Photon.v[1] = 0; Photon.v[2] = cos(angle);
+                Photon.time = 0;
+                Photon.waveIndex = iWave - 1;
+
+                proxy->configure(&Photon, Normal, MatFrom, MatTo);
+                Resources.evaluateScript(Script);
+                if (Resources.ScriptEngine->hasUncaughtException())
+                {
+                    TabulationError = "script exception: " + Resources.ScriptEngine->uncaughtException().toString();
+                    qWarning() << "Script override" << MatFrom << "->" << MatTo << "not tabulated:" << TabulationError;
+                    return;
+                }
+                const int iAction = proxy->getAction();
+                if (iAction >= numActions)
+                {
+                    TabulationError = "script modifies or uses photon properties";
+                    qWarning() << "Script override" << MatFrom << "->" << MatTo << "not tabulated:" << TabulationError;
+                    return;
+                }
+                bin[iAction] += 1.0;
+            }
+
+            double sum = 0;
+            for (int iAction = 0; iAction < numActions; iAction++)
+            {
+                sum += bin[iAction];
+                bin[iAction] = sum / numSamples;
+            }
+            bin[numActions - 1] = 1.0;
+        }
+
+    TabulatedCumulative = table;
+    TabulatedWaves = numWaves;
+    TabulationTime = timer.elapsed();
 }
 
 const QString AScriptOpticalOverride::getReportLine() const
 {
     QString s = Script.simplified().left(40);
     s += "...";
+    if (bTabulate) s += (TabulatedWaves > 0 ? " [tabulated]" : " [not tabulated]");
+    const long long ns = NumNanoseconds;
+    if (ns > 0) s += QString(" %1 ph/s").arg(1e9 * NumPhotons / ns, 0, 'g', 3);
     return s;
 }
 
@@ -45,6 +179,11 @@ const QString AScriptOpticalOverride::getLongReportLine() const
 {
     QString s = "--> Custom script <--\n";
     s += Script;
+    if (bTabulate)
+    {
+        s += "\n--> Tabulated: ";
+        s += (TabulatedWaves > 0 ? QString("yes, in %1 ms").arg(TabulationTime) : "no " + TabulationError);
+    }
     return s;
 }
 
@@ -53,10 +192,15 @@ void AScriptOpticalOverride::writeToJson(QJsonObject &json) const
     AOpticalOverride::writeToJson(json);
 
     json["Script"] = Script;
+    json["Tabulate"] = bTabulate;
+    json["TabulationSamples"] = TabulationSamples;
 }
 
 bool AScriptOpticalOverride::readFromJson(const QJsonObject &json)
 {
+    bTabulate = false;
+    parseJson(json, "Tabulate", bTabulate);
+    parseJson(json, "TabulationSamples", TabulationSamples);
     return parseJson(json, "Script", Script);
 }
 
@@ -82,12 +226,24 @@ QWidget *AScriptOpticalOverride::getEditWidget(QWidget *caller, GraphWindowClass
         QObject::connect(pb, &QPushButton::clicked, [caller, pte, this] {openScriptWindow(caller); pte->clear(); pte->appendPlainText(Script);
             pte->moveCursor(QTextCursor::Start); pte->ensureCursorVisible();});
     l->addWidget(pb);
+        QHBoxLayout* h = new QHBoxLayout();
+            QCheckBox* cb = new QCheckBox("Tabulate (script selects directives at random), samples per bin:");
+            cb->setToolTip("The script is sampled before simulation into (wavelength, angle of incidence) -> directive probability table.\n"
+                           "Use only if the script calls directives and does not modify or use other photon properties.");
+            cb->setChecked(bTabulate);
+            QObject::connect(cb, &QCheckBox::clicked, [this](bool checked) { this->bTabulate = checked; } );
+        h->addWidget(cb);
+            QSpinBox* sb = new QSpinBox();
+            sb->setRange(1, 1000000);
+            sb->setValue(TabulationSamples);
+            QObject::connect(sb, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), [this](int value) { this->TabulationSamples = value; } );
+        h->addWidget(sb);
+    l->addLayout(h);
 
     return f;
 }
 #endif
 
-#include <QScriptEngine>
 const QString AScriptOpticalOverride::checkOverrideData()
 {
     if (Script.isEmpty()) return "Script not defined!";
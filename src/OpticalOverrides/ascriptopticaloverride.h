@@ -4,6 +4,11 @@
 #include "aopticaloverride.h"
 
 #include <QString>
+#include <QVector>
+
+#include <atomic>
+
+struct AScriptOverrideTiming;
 
 class AScriptOpticalOverride : public AOpticalOverride
 {
@@ -18,6 +23,8 @@ public:
   virtual const QString getReportLine() const override;
   virtual const QString getLongReportLine() const;
 
+  virtual void initializeWaveResolved() override; //builds the table if tabulation is on
+
   virtual void writeToJson(QJsonObject &json) const override;
   virtual bool readFromJson(const QJsonObject &json) override;
 
@@ -26,10 +33,29 @@ public:
 #endif
   virtual const QString checkOverrideData() override;
 
+  void addTiming(const AScriptOverrideTiming & timing);  //collected per thread, see ATracerStateful
+
 private:
   QString Script = "if (math.random() < 0.25) photon.LambertForward()\n"
                    "else photon.SpecularReflection()";
 
+  //tabulation mode: for scripts which only select one of the directives at random depending on the wavelength and
+  //the angle of incidence, the script is sampled before the simulation into (wave, angle) -> directive probability table
+  bool bTabulate = false;
+  int  TabulationSamples = 1000;               //per (wave, angle) bin
+  static const int TabulationAngleBins = 45;   //2 degree bins
+  int  TabulatedWaves = 0;                     //0 - table is not available; first row is for waveIndex = -1
+  QVector<double> TabulatedCumulative;         //cumulative probabilities of the directives for each (wave, angle) bin
+  QString TabulationError;
+  qint64  TabulationTime = 0;                  //ms
+
+  //measured performance, reset before every simulation; per-thread counters are added when the photon tracers are deleted
+  std::atomic<long long> NumPhotons{0};
+  std::atomic<long long> NumNanoseconds{0};
+
+  void tabulate();
+  bool sampleTabulated(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector); //false if outside of the table
+
 #ifdef GUI
   void openScriptWindow(QWidget* caller);
 #endif
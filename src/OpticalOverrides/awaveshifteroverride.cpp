@@ -96,7 +96,7 @@ AOpticalOverride::OpticalOverrideResultEnum AWaveshifterOverride::calculate(ATra
                 Status = Absorption;
                 return Absorbed;
               }
-            wavelength = Spectrum->GetRandom();
+            wavelength = GetRandomFromHist(Spectrum, Resources.RandGen);
             waveIndex = (wavelength - WaveFrom)/WaveStep;
         }
         while (waveIndex < Photon->waveIndex); //conserving energy
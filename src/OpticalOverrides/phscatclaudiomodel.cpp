@@ -8,7 +8,12 @@
 #include <QDebug>
 #include <QVector>
 #include <QJsonObject>
+#include <QElapsedTimer>
 
+#include <algorithm>
+#include <cmath>
+
+#include "TMath.h"
 #include "TRandom2.h"
 #include "TVector3.h"
 
@@ -20,6 +25,9 @@
 #include <QFrame>
 #include <QDoubleValidator>
 #include <QComboBox>
+#include <QCheckBox>
+#include <QPushButton>
+#include "amessage.h"
 #endif
 
 #define MODEL_VERSION 3
@@ -44,6 +52,7 @@ const QString PhScatClaudioModel::getReportLine() const
     case cooktorrance : s += "cook"; break;
     case bivariatecauchy : s += "biv"; break;
     }
+    if (bTabulated) s += " / tab";
     return s;
 }
 
@@ -67,6 +76,8 @@ const QString PhScatClaudioModel::getLongReportLine() const
         case cooktorrance : s += "cooktorrance"; break;
         case bivariatecauchy : s += "bivariatecauchy"; break;
         }
+        s += QString("\nTabulated sampling: %1").arg(bTabulated ? "on" : "off");
+        if (!TablesReport.isEmpty()) s += "\n" + TablesReport;
         return s;
 }
 
@@ -79,6 +90,10 @@ void PhScatClaudioModel::writeToJson(QJsonObject &json) const
   json["Albedo"] = albedo;
   json["HDmodel"] = HeightDistribution;
   json["SDmodel"] = SlopeDistribution;  
+
+  json["Tabulated"] = bTabulated;
+  json["TabulationTolerance"] = TabulationTolerance;
+  json["ValidateTables"] = bValidateTables;
 }
 
 bool PhScatClaudioModel::readFromJson(const QJsonObject &json)
@@ -96,16 +111,22 @@ bool PhScatClaudioModel::readFromJson(const QJsonObject &json)
     if (ival<0 || ival>2) return false;
     SlopeDistribution = static_cast<SlopeDistrEnum>(ival);
 
+    bTabulated = false; // configurations without the key keep the exact sampling
+    parseJson(json, "Tabulated", bTabulated);
+    parseJson(json, "TabulationTolerance", TabulationTolerance);
+    parseJson(json, "ValidateTables", bValidateTables);
+
     return true;
 }
 
 #ifdef GUI
-QWidget *PhScatClaudioModel::getEditWidget(QWidget *, GraphWindowClass *)
+QWidget *PhScatClaudioModel::getEditWidget(QWidget *caller, GraphWindowClass *)
 {
     QFrame* f = new QFrame();
     f->setFrameStyle(QFrame::Box);
 
-    QHBoxLayout* hl = new QHBoxLayout(f);
+    QVBoxLayout* vl = new QVBoxLayout(f);
+    QHBoxLayout* hl = new QHBoxLayout();
         QVBoxLayout* l = new QVBoxLayout();
             QLabel* lab = new QLabel("Sigma alpha:");
         l->addWidget(lab);
@@ -146,6 +167,23 @@ QWidget *PhScatClaudioModel::getEditWidget(QWidget *, GraphWindowClass *)
             QObject::connect(com, static_cast<void (QComboBox::*)(int)>(&QComboBox::activated), [this](int index) { this->SlopeDistribution = static_cast<SlopeDistrEnum>(index); } );
         l->addWidget(com);
     hl->addLayout(l);
+    vl->addLayout(hl);
+
+    hl = new QHBoxLayout();
+        QCheckBox* cb = new QCheckBox("Tabulated sampling, tolerance:");
+        cb->setToolTip("Inverse CDF tables built before simulation replace the rejection sampling of the lobes");
+        cb->setChecked(bTabulated);
+        QObject::connect(cb, &QCheckBox::clicked, [this](bool checked) { this->bTabulated = checked; } );
+    hl->addWidget(cb);
+        le = new QLineEdit(QString::number(TabulationTolerance));
+        le->setValidator(val);
+        QObject::connect(le, &QLineEdit::editingFinished, [le, this]() { this->TabulationTolerance = le->text().toDouble(); } );
+    hl->addWidget(le);
+        QPushButton* pb = new QPushButton("Validate");
+        pb->setToolTip("Compare tabulated and model sampling for the current configuration");
+        QObject::connect(pb, &QPushButton::clicked, [caller, this]() { buildTables(); message(validateTables(), caller); } );
+    hl->addWidget(pb);
+    vl->addLayout(hl);
 
     return f;
 }
@@ -158,6 +196,7 @@ const QString PhScatClaudioModel::checkOverrideData()
     if (albedo < 0 || albedo > 1.0) return "albedo should be within [0, 1.0] range";
     if (HeightDistribution < 0 || HeightDistribution > 2) return "hight distribution model can be 0, 1 or 2";
     if (SlopeDistribution < 0 || SlopeDistribution > 2) return "slope distribution model can be 0, 1 or 2";
+    if (bTabulated && TabulationTolerance <= 0) return "tabulation tolerance should be > 0";
     return "";
 }
 
@@ -197,6 +236,443 @@ double PhScatClaudioModel::Fresnel(double E1_perp, double E1_parl, double cosinc
   return 1.0;
 }
 
+// ============= Tabulated sampling ===========
+
+static const int    LobeNodesNumber = 91;                   // incidence angle nodes: 0 .. 90 degrees
+static const double LobeNodeStep = 0.5*TMath::Pi() / (LobeNodesNumber-1);
+static const int    LobeMaxBins = 128;
+static const int    DiffuseMaxBins = 4096;
+
+// max difference of the cumulatives of n coarse and 2n fine bins at the coarse bin edges
+static double compareCumulatives(const QVector<double> & coarse, const QVector<double> & fine)
+{
+  double sumCoarse = 0, sumFine = 0;
+  for (double v : coarse) sumCoarse += v;
+  for (double v : fine)   sumFine += v;
+  if (sumCoarse == 0 && sumFine == 0) return 0;
+  if (sumCoarse == 0 || sumFine == 0) return 1.0;
+
+  double cumCoarse = 0, cumFine = 0, maxDiff = 0;
+  for (int i=0; i<coarse.size(); i++)
+    {
+      cumCoarse += coarse.at(i);
+      cumFine += fine.at(2*i) + fine.at(2*i+1);
+      maxDiff = std::max(maxDiff, fabs(cumCoarse/sumCoarse - cumFine/sumFine));
+    }
+  return maxDiff;
+}
+
+// marginal distribution of the lobe cells of the node over the slope random number or over the azimuth
+static QVector<double> lobeMarginal(const QVector<double> & cells, int bins, int iNode, bool bSlope)
+{
+  const int nv = bins / 2;
+  QVector<double> m(bSlope ? bins : nv, 0);
+  const double * c = cells.constData() + iNode*bins*nv;
+  for (int iU=0; iU<bins; iU++)
+    for (int iV=0; iV<nv; iV++)
+      m[bSlope ? iU : iV] += c[iU*nv + iV];
+  return m;
+}
+
+AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModel::calculate(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector)
+{
+  OpticalOverrideResultEnum result;
+  if (LobeNodes > 0 && calculateTabulated(Resources, Photon, NormalVector, result)) return result;
+  return calculateAnalytical(Resources, Photon, NormalVector);
+}
+
+void PhScatClaudioModel::initializeWaveResolved()
+{
+  buildTables();
+
+  if (bValidateTables && LobeNodes > 0)
+    {
+      TablesReport += "\n" + validateTables();
+    }
+}
+
+void PhScatClaudioModel::clearTables()
+{
+  LobeNodes = 0;
+  LobeBins = 0;
+  LobeAcceptance.clear();
+  LobeSlope.clear();
+  LobeAzimuth.clear();
+  DiffuseWaves = 0;
+  DiffuseBins = 0;
+  DiffuseAbsorption.clear();
+  DiffuseSin2.clear();
+  TablesReport.clear();
+}
+
+void PhScatClaudioModel::buildTables()
+{
+  clearTables();
+  if (!bTabulated || sigma_alpha <= 0 || !checkOverrideData().isEmpty()) return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // grids are refined until the cumulative distributions stop changing by more than the tolerance
+  QVector<double> cells, finer;
+  int bins = 16;
+  computeLobeCells(bins, cells);
+  double lobeConvergence = 1.0;
+  while (bins < LobeMaxBins)
+    {
+      computeLobeCells(2*bins, finer);
+      lobeConvergence = 0;
+      for (int iNode=0; iNode<LobeNodesNumber; iNode++)
+        {
+          lobeConvergence = std::max(lobeConvergence, compareCumulatives(lobeMarginal(cells, bins, iNode, true),  lobeMarginal(finer, 2*bins, iNode, true)));
+          lobeConvergence = std::max(lobeConvergence, compareCumulatives(lobeMarginal(cells, bins, iNode, false), lobeMarginal(finer, 2*bins, iNode, false)));
+        }
+      bins *= 2;
+      cells.swap(finer);
+      if (lobeConvergence < TabulationTolerance) break;
+    }
+
+  const int nv = bins / 2;
+  LobeBins = bins;
+  LobeAcceptance.resize(LobeNodesNumber);
+  LobeSlope.resize(LobeNodesNumber);
+  LobeAzimuth.resize(LobeNodesNumber * bins);
+  for (int iNode=0; iNode<LobeNodesNumber; iNode++)
+    {
+      QVector<double> slope(bins, 0);
+      for (int iU=0; iU<bins; iU++)
+        {
+          const int index = iNode*bins + iU;
+          const QVector<double> azimuth = cells.mid(index*nv, nv);
+          for (double v : azimuth) slope[iU] += v;
+          LobeAzimuth[index].configure(azimuth);
+        }
+      LobeSlope[iNode].configure(slope);
+      double sum = 0;
+      for (double v : slope) sum += v;
+      LobeAcceptance[iNode] = sum / (bins * nv);
+    }
+
+  bool bWaveResolved;
+  double WaveFrom, WaveTo, WaveStep;
+  int WaveNodes;
+  MatCollection->GetWave(bWaveResolved, WaveFrom, WaveTo, WaveStep, WaveNodes);
+  const int numWaves = 1 + (bWaveResolved ? WaveNodes : 0);   //first row is for photons without wavelength
+
+  bins = 64;
+  computeDiffuseCells(numWaves, bins, cells);
+  double diffuseConvergence = 1.0;
+  while (bins < DiffuseMaxBins)
+    {
+      computeDiffuseCells(numWaves, 2*bins, finer);
+      diffuseConvergence = 0;
+      for (int iWave=0; iWave<numWaves; iWave++)
+        diffuseConvergence = std::max(diffuseConvergence, compareCumulatives(cells.mid(iWave*bins, bins), finer.mid(iWave*2*bins, 2*bins)));
+      bins *= 2;
+      cells.swap(finer);
+      if (diffuseConvergence < TabulationTolerance) break;
+    }
+
+  DiffuseBins = bins;
+  DiffuseAbsorption.resize(numWaves);
+  DiffuseSin2.resize(numWaves);
+  for (int iWave=0; iWave<numWaves; iWave++)
+    {
+      const QVector<double> sin2 = cells.mid(iWave*bins, bins);
+      DiffuseSin2[iWave].configure(sin2);
+      double acceptance = 0;
+      for (double v : sin2) acceptance += v;
+      acceptance /= bins;
+      // the model checks albedo before every attempt: absorption wins over the attempts rejected by the Fresnel term
+      const double denominator = (1.0 - albedo) + albedo * acceptance;
+      DiffuseAbsorption[iWave] = (denominator > 0 ? (1.0 - albedo) / denominator : -1.0);
+    }
+
+  LobeNodes = LobeNodesNumber;
+  DiffuseWaves = numWaves;
+
+  TablesReport = QString("Tables: lobe %1x%2 per %3 angles (CDF convergence %4), diffuse %5 bins per %6 waves (CDF convergence %7), built in %8 ms")
+                 .arg(LobeBins).arg(LobeBins/2).arg(LobeNodes).arg(lobeConvergence, 0, 'g', 3)
+                 .arg(DiffuseBins).arg(DiffuseWaves).arg(diffuseConvergence, 0, 'g', 3).arg(timer.elapsed());
+}
+
+void PhScatClaudioModel::computeLobeCells(int bins, QVector<double> & cells)
+{
+  // acceptance of the rejection loop of the model for slope random number u and azimuth psi
+  // relative to the plane of incidence, averaged over subSamples^2 points in each cell
+  const int subSamples = 2;
+  const int nu = bins * subSamples;
+  const int nv = bins / 2;
+  QVector<double> cosAlpha(nu), sinAlpha(nu), cosPsi(nv * subSamples);
+  for (int i=0; i<nu; i++)
+    {
+      const double alpha = SlopeAngle( (i + 0.5) / nu );
+      cosAlpha[i] = cos(alpha);
+      sinAlpha[i] = sin(alpha);
+    }
+  for (int i=0; i<cosPsi.size(); i++) cosPsi[i] = cos( TMath::Pi() * (i + 0.5) / cosPsi.size() );
+
+  cells.fill(0, LobeNodesNumber * bins * nv);
+  for (int iNode=0; iNode<LobeNodesNumber; iNode++)
+    {
+      const double costi = cos(iNode * LobeNodeStep);
+      const double sinti = sin(iNode * LobeNodeStep);
+      if (costi < 1.0e-10) continue; // grazing incidence: the model never accepts
+      const double gni = GnFunc(costi);
+
+      double * c = cells.data() + iNode*bins*nv;
+      for (int iU=0; iU<bins; iU++)
+        for (int iV=0; iV<nv; iV++)
+          {
+            double sum = 0;
+            for (int su=0; su<subSamples; su++)
+              for (int sv=0; sv<subSamples; sv++)
+                {
+                  const int ku = iU*subSamples + su;
+                  const double costl = costi * cosAlpha[ku] - sinti * sinAlpha[ku] * cosPsi[iV*subSamples + sv];
+                  if (costl < 0) continue;
+                  const double weight_microfacet = gni * costl / (costi * cosAlpha[ku]);
+                  sum += std::min(1.0, weight_microfacet / 1.5);
+                }
+            c[iU*nv + iV] = sum / (subSamples * subSamples);
+          }
+    }
+}
+
+void PhScatClaudioModel::computeDiffuseCells(int numWaves, int bins, QVector<double> & cells)
+{
+  // acceptance of the Fresnel term of the diffuse loop for sin^2 of the angle with the local normal;
+  // the shadowing term depends on the local normal and stays in the (shorter) rejection loop
+  const int subSamples = 4;
+  const DiffuseModelEnum model = getDiffuseModel();
+  const double E = sqrt(2.0)/2.0;
+
+  cells.fill(0, numWaves * bins);
+  for (int iWave=0; iWave<numWaves; iWave++)
+    {
+      const double Rindex1 = (*MatCollection)[MatFrom]->getRefractiveIndex(iWave - 1);
+      const double Rindex2 = (*MatCollection)[MatTo]->getRefractiveIndex(iWave - 1);
+      for (int iBin=0; iBin<bins; iBin++)
+        {
+          double sum = 0;
+          for (int s=0; s<subSamples; s++)
+            {
+              const double sintdsquared = (iBin + (s + 0.5) / subSamples) / bins;
+              const double sintd = sqrt(sintdsquared);
+              const double costd = sqrt(1.0 - sintdsquared);
+              if (model == DiffuseV2)
+                {
+                  const double sintinter = Rindex1*sintd/Rindex2;
+                  if (sintinter < 1.0) sum += 1.0 - Fresnel(E, E, sqrt(1.0 - sintinter*sintinter), Rindex2, Rindex1);
+                }
+              else
+                {
+                  const double sintinter = Rindex2*sintd/Rindex1;
+                  if (sintinter < 1.0) sum += 1.0 - Fresnel(E, E, costd, Rindex2, Rindex1);
+                }
+            }
+          cells[iWave*bins + iBin] = sum / subSamples;
+        }
+    }
+}
+
+bool PhScatClaudioModel::calculateTabulated(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector, OpticalOverrideResultEnum & result)
+{
+  const int iWave = Photon->waveIndex + 1;
+  if (iWave < 0 || iWave >= DiffuseWaves || DiffuseAbsorption.at(iWave) < 0) return false;
+
+  TVector3 K(Photon->v);
+  //ANTS2 SPECIFIC: navigator gives normal in the direction of the photon, while Claudio's model assumes the opposite direction
+  TVector3 GlobalNormal(-NormalVector[0], -NormalVector[1], -NormalVector[2]);
+  const double costi = - GlobalNormal * K;
+  if (costi <= 0) return false;
+
+  // lobe table: random choice between the two closest incidence angle nodes = linear interpolation
+  const double x = acos(std::min(1.0, costi)) / LobeNodeStep;
+  int iNode = (int)x;
+  if (Resources.RandGen->Rndm() < x - iNode) iNode++;
+  if (iNode >= LobeNodes || LobeAcceptance.at(iNode) <= 0) return false;
+
+  const double Rindex1 = (*MatCollection)[MatFrom]->getRefractiveIndex(Photon->waveIndex);
+  const double Rindex2 = (*MatCollection)[MatTo]->getRefractiveIndex(Photon->waveIndex);
+
+  const double gni = GnFunc(costi);
+  const double lambda = SpikeIntensity(Photon->waveIndex, costi);
+
+  TVector3 ScatNormal = GlobalNormal;
+  double costl, gnr;
+  if (Resources.RandGen->Rndm() < lambda)
+    {
+      Status = SpikeReflection;
+      costl = costi;
+      gnr = gni;
+    }
+  else
+    {
+      Status = LobeReflection;
+      const int nv = LobeBins / 2;
+
+      // frame: e1 - along the projection of the photon direction on the surface
+      TVector3 e1 = K + costi * GlobalNormal;
+      if (e1.Mag2() < 1.0e-20) e1 = GlobalNormal.Orthogonal();
+      e1 = e1.Unit();
+      const TVector3 e2 = GlobalNormal.Cross(e1);
+
+      // cells at the edge of the accepted region are sampled uniformly, so facets facing away from the photon
+      // can still be drawn: they are rejected as in the analytical model
+      int counter = 100;
+      do
+        {
+          if (--counter < 0) return false;
+
+          double fraction;
+          const int iU = LobeSlope.at(iNode).sample(Resources.RandGen, fraction);
+          const double alpha = SlopeAngle( (iU + fraction) / LobeBins );
+          const int iV = LobeAzimuth.at(iNode*LobeBins + iU).sample(Resources.RandGen, fraction);
+          const double psi = (Resources.RandGen->Rndm() < 0.5 ? TMath::Pi() : -TMath::Pi()) * (iV + fraction) / nv;
+
+          const double CosAlpha = cos(alpha);
+          const double SinAlpha = sin(alpha);
+          ScatNormal = SinAlpha*cos(psi) * e1 + SinAlpha*sin(psi) * e2 + CosAlpha * GlobalNormal;
+
+          costl = - K * ScatNormal;
+          const double costr = 2.0 * costl*CosAlpha - costi;
+          gnr = GnFunc(costr);
+        }
+      while (costl < 0);
+    }
+
+  //no polarization -> assuming 50% / 50%
+  const double E = sqrt(2.0)/2.0;
+  const double Amp_tot = ( Fresnel(E, 0, costl, Rindex1, Rindex2) + Fresnel(0, E, costl, Rindex1, Rindex2) ) * gnr;
+
+  if (Resources.RandGen->Rndm() < Amp_tot)
+    K = 2.0 * costl * ScatNormal + K;
+  else
+    {
+      const DiffuseModelEnum model = getDiffuseModel();
+      const ACustomRandomSampling & sin2sampler = DiffuseSin2.at(iWave);
+      const double probAbsorption = DiffuseAbsorption.at(iWave);
+      double gnd = 1.0;
+      do
+        {
+          if (Resources.RandGen->Rndm() < probAbsorption)
+            {
+              Status = Absorption;
+              result = Absorbed;
+              return true;
+            }
+
+          Status = LambertianReflection;
+
+          double fraction;
+          const int iBin = sin2sampler.sample(Resources.RandGen, fraction);
+          const double sintd = sqrt( (iBin + fraction) / DiffuseBins );
+          const double phid = 2.0 * TMath::Pi() * Resources.RandGen->Rndm();
+          // V2d1, V2d2: refracted diffuse light; the last bin before total internal reflection can overshoot
+          const double sinte = (model == DiffuseV2 ? sintd : std::min(1.0, Rindex2*sintd/Rindex1));
+          const double coste = sqrt(std::max(0.0, 1.0 - sinte*sinte));
+
+          K.SetXYZ(sinte*cos(phid), sinte*sin(phid), coste);
+          K.RotateUz(ScatNormal);
+          if (model != DiffuseV2d1) gnd = GnFunc( GlobalNormal * K );
+        }
+      while (model != DiffuseV2d1 && Resources.RandGen->Rndm() > gnd);
+    }
+
+  Photon->v[0] = K.X();
+  Photon->v[1] = K.Y();
+  Photon->v[2] = K.Z();
+  result = Back;
+  return true;
+}
+
+const QString PhScatClaudioModel::validateTables(int numPhotons)
+{
+  if (LobeNodes == 0) return "Sampling tables are not built (tabulation is off or sigma alpha is 0)";
+
+  // both paths are run for the same configuration; compared are the fractions of the interaction types
+  // and the distributions of the polar and azimuthal angles of the reflected photons
+  const int numStatus = 5;   // absorption, spike, lobe, lambertian, other
+  const int numCosBins = 10;
+  const int numPhiBins = 6;
+  const int numCategories = numStatus + numCosBins + numPhiBins;
+
+  TRandom2 RandGen;
+  ATracerStateful Resources(&RandGen);
+  const double Normal[3] = {0, 0, 1.0}; //as given by the navigator: along the photon direction
+
+  QVector<int> waves = {-1};
+  if (DiffuseWaves > 1) waves << (DiffuseWaves - 1) / 2;
+  const QVector<double> angles = {0, 20.0, 40.0, 60.0, 75.0, 85.0};
+
+  QString report = QString("Validation with %1 photons per point, tolerance %2:").arg(numPhotons).arg(TabulationTolerance);
+  bool bOK = true;
+  APhoton Photon;
+  for (int iWave : waves)
+    for (double angle : angles)
+      {
+        QVector<double> fractions[2];
+        for (int iPath=0; iPath<2; iPath++)
+          {
+            QVector<double> & f = fractions[iPath];
+            f.fill(0, numCategories);
+            for (int i=0; i<numPhotons; i++)
+              {
+                Photon.r[0] = Photon.r[1] = Photon.r[2] = 0;
+                Photon.v[0] = sin(angle * TMath::DegToRad());
+                Photon.v[1] = 0;
+                Photon.v[2] = cos(angle * TMath::DegToRad());
+                Photon.time = 0;
+                Photon.waveIndex = iWave;
+
+                OpticalOverrideResultEnum result;
+                if (iPath == 0 || !calculateTabulated(Resources, &Photon, Normal, result))
+                  result = calculateAnalytical(Resources, &Photon, Normal);
+
+                int iStatus;
+                switch (Status)
+                  {
+                  case Absorption :           iStatus = 0; break;
+                  case SpikeReflection :      iStatus = 1; break;
+                  case LobeReflection :       iStatus = 2; break;
+                  case LambertianReflection : iStatus = 3; break;
+                  default :                   iStatus = 4; break;
+                  }
+                f[iStatus]++;
+
+                if (result == Back)
+                  {
+                    const double cosOut = -Photon.v[2];
+                    const int iCos = std::min(numCosBins - 1, std::max(0, (int)(cosOut * numCosBins)));
+                    f[numStatus + iCos]++;
+                    const double phi = fabs(atan2(Photon.v[1], Photon.v[0]));
+                    const int iPhi = std::min(numPhiBins - 1, (int)(phi / TMath::Pi() * numPhiBins));
+                    f[numStatus + numCosBins + iPhi]++;
+                  }
+              }
+            for (double & v : f) v /= numPhotons;
+          }
+
+        double maxDiff = 0;
+        bool bPointOK = true;
+        for (int i=0; i<numCategories; i++)
+          {
+            const double a = fractions[0].at(i);
+            const double t = fractions[1].at(i);
+            const double diff = fabs(a - t);
+            const double sigma = sqrt( (a*(1.0-a) + t*(1.0-t)) / numPhotons );
+            maxDiff = std::max(maxDiff, diff);
+            if (diff > TabulationTolerance + 4.0*sigma) bPointOK = false;
+          }
+        if (!bPointOK) bOK = false;
+        report += QString("\nwave index %1, angle %2: max difference %3%4").arg(iWave).arg(angle).arg(maxDiff, 0, 'g', 3).arg(bPointOK ? "" : " - FAILED");
+      }
+
+  report += (bOK ? "\nValidation passed" : "\nValidation FAILED: tabulated sampling deviates from the model");
+  return report;
+}
+
 // ============= Model dependent methods ===========
 
 // ------- newer model  - V2
@@ -219,7 +695,7 @@ double PhScatClaudioModelV2::GnFunc(double cost)
     return 0;
 }
 
-AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2::calculate(ATracerStateful &Resources, APhoton *Photon, const double* NormalVector)
+AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2::calculateAnalytical(ATracerStateful &Resources, APhoton *Photon, const double* NormalVector)
 {
   TVector3 K(Photon->v);                // photon direction
   //qDebug() << "Photon direction (i,j,k):"<<K.x()<<K.y()<<K.z();
@@ -385,7 +861,7 @@ AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2::calculate(ATra
   return Back;
 }
 
-AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2d2::calculate(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector)
+AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2d2::calculateAnalytical(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector)
 {
   TVector3 K(Photon->v);                // photon direction
   //qDebug() << "Photon direction (i,j,k):"<<K.x()<<K.y()<<K.z();
@@ -553,7 +1029,7 @@ AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2d2::calculate(AT
   return Back;
 }
 
-AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2d1::calculate(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector)
+AOpticalOverride::OpticalOverrideResultEnum PhScatClaudioModelV2d1::calculateAnalytical(ATracerStateful &Resources, APhoton *Photon, const double *NormalVector)
 {
   TVector3 K(Photon->v);                // photon direction
     //qDebug() << "Photon direction (i,j,k):"<<K.x()<<K.y()<<K.z();
@@ -2,6 +2,9 @@
 #define PHSCATCLAUDIOMODEL_H
 
 #include "aopticaloverride.h"
+#include "acustomrandomsampling.h"
+
+#include <QVector>
 
 class TRandom2;
 class APhoton;
@@ -18,8 +21,11 @@ public:
   PhScatClaudioModel(AMaterialParticleCollection* MatCollection, int MatFrom, int MatTo)
     : AOpticalOverride(MatCollection, MatFrom, MatTo) {}
 
-  //virtual OpticalOverrideResultEnum calculate(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) = 0;
+  virtual OpticalOverrideResultEnum calculate(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) override;
     //unitary vectors! iWave - photon wave index, -1 if no wave-resolved
+    //uses the sampling tables if they are built, otherwise the model (rejection sampling)
+
+  virtual void initializeWaveResolved() override; //builds the sampling tables
 
   //virtual const QString getType() const override = 0;
   virtual const QString getAbbreviation() const override {return "Clau";}
@@ -43,13 +49,46 @@ public:
   HeightDistrEnum HeightDistribution = empirical;     // model for heights distribution
   SlopeDistrEnum SlopeDistribution = trowbridgereitz; // model for distribution of slopes
 
+  // tabulated sampling (only if sigma_alpha > 0): tables of the accepted specular lobe microfacets over the angle
+  // of incidence and of the accepted diffuse directions over the wave index replace the rejection loops
+  bool   bTabulated = false;  // off by default: the exact rejection sampling is kept unless requested
+  double TabulationTolerance = 1.0e-3;  // max difference of the tabulated and the model cumulative distributions
+  bool   bValidateTables = false;       // compare the tabulated and the model sampling after the tables are built
+
+  const QString validateTables(int numPhotons = 100000); // returns report; tables should be already built
+
 protected:
+  enum DiffuseModelEnum {DiffuseV2, DiffuseV2d1, DiffuseV2d2};
+
+  virtual OpticalOverrideResultEnum calculateAnalytical(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) = 0;
+  virtual DiffuseModelEnum getDiffuseModel() const = 0;
+
   double SpikeIntensity(int iWave, double costi);
   double Fresnel(double E1_perp, double E1_parl, double cosinc, double Rinda1, double Rinda2);
 
   virtual double GnFunc(double cost) = 0; // shadowing functions
   virtual double SlopeAngle(double random_num) = 0;
 
+private:
+  // lobe: accepted (slope random number, azimuth relative to the plane of incidence) on LobeBins x LobeBins/2 grid
+  // (azimuth is symmetric, only [0, pi] is tabulated) for each incidence angle node; nodes are 1 degree apart
+  int LobeNodes = 0;                                 // 0 - tables are not built
+  int LobeBins = 0;
+  QVector<double> LobeAcceptance;                    // [iNode] acceptance of the rejection loop, 0 - node can not be used
+  QVector<ACustomRandomSampling> LobeSlope;          // [iNode]
+  QVector<ACustomRandomSampling> LobeAzimuth;        // [iNode*LobeBins + iSlope]
+  // diffuse: accepted sin^2 of the angle with the local normal for each wave index (+1)
+  int DiffuseWaves = 0;
+  int DiffuseBins = 0;
+  QVector<double> DiffuseAbsorption;                 // [iWave+1] probability to be absorbed before the Fresnel term is accepted, -1 - not available
+  QVector<ACustomRandomSampling> DiffuseSin2;        // [iWave+1]
+  QString TablesReport;
+
+  void clearTables();
+  void buildTables();
+  void computeLobeCells(int bins, QVector<double>& cells);                    // mean acceptance in the grid cells
+  void computeDiffuseCells(int numWaves, int bins, QVector<double>& cells);   // mean acceptance of the Fresnel term in the bins
+  bool calculateTabulated(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector, OpticalOverrideResultEnum& result); //false - outside of the tables
 };
 
 class PhScatClaudioModelV2 : public PhScatClaudioModel
@@ -57,10 +96,11 @@ class PhScatClaudioModelV2 : public PhScatClaudioModel
 public:
   PhScatClaudioModelV2(AMaterialParticleCollection* MatCollection, int MatFrom, int MatTo)
     : PhScatClaudioModel(MatCollection, MatFrom, MatTo) {}
-  virtual OpticalOverrideResultEnum calculate(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) override;
   virtual const QString getType() const override {return "Claudio_Model_V2";}
 
 protected:
+  virtual OpticalOverrideResultEnum calculateAnalytical(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) override;
+  virtual DiffuseModelEnum getDiffuseModel() const override {return DiffuseV2;}
   virtual double GnFunc(double cost) override;
   virtual double SlopeAngle(double random_num) override;
 };
@@ -70,8 +110,11 @@ class PhScatClaudioModelV2d1 : public PhScatClaudioModelV2
 public:
   PhScatClaudioModelV2d1(AMaterialParticleCollection* MatCollection, int MatFrom, int MatTo)
     : PhScatClaudioModelV2(MatCollection, MatFrom, MatTo) {}
-  virtual OpticalOverrideResultEnum calculate(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) override;
   virtual const QString getType() const override {return "Claudio_Model_V2d1";}
+
+protected:
+  virtual OpticalOverrideResultEnum calculateAnalytical(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) override;
+  virtual DiffuseModelEnum getDiffuseModel() const override {return DiffuseV2d1;}
 };
 
 class PhScatClaudioModelV2d2 : public PhScatClaudioModelV2
@@ -79,8 +122,11 @@ class PhScatClaudioModelV2d2 : public PhScatClaudioModelV2
 public:
   PhScatClaudioModelV2d2(AMaterialParticleCollection* MatCollection, int MatFrom, int MatTo)
     : PhScatClaudioModelV2(MatCollection, MatFrom, MatTo) {}
-  virtual OpticalOverrideResultEnum calculate(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) override;
   virtual const QString getType() const override {return "ClaudioModel";}
+
+protected:
+  virtual OpticalOverrideResultEnum calculateAnalytical(ATracerStateful& Resources, APhoton* Photon, const double* NormalVector) override;
+  virtual DiffuseModelEnum getDiffuseModel() const override {return DiffuseV2d2;}
 };
 
 #endif // PHSCATCLAUDIOMODEL_H
@@ -12,6 +12,7 @@
 #include "acalibratorsignalperphel.h"
 #include "detectorclass.h"
 #include "tmpobjhubclass.h"
+#include "asimdgridmanager.h"
 
 #ifdef ANTS_FLANN
 #include "nnmoduleclass.h"
@@ -113,12 +114,33 @@ bool AReconstructionManager::reconstructAll(QJsonObject &json, int numThreads, b
 
       //main algorithm
         //qDebug() << "--> Performing reconstruction with the algorithm:"<<RecSet.at(CurrentGroup).ReconstructionAlgorithm;
-      bool fMultiThreaded = (NumThreads>0) && ( RecSet.at(CurrentGroup).ReconstructionAlgorithm == 1 || RecSet.at(CurrentGroup).ReconstructionAlgorithm == 2 );
+      bool fMultiThreaded = (NumThreads>0) && ( RecSet.at(CurrentGroup).ReconstructionAlgorithm == 1 || RecSet.at(CurrentGroup).ReconstructionAlgorithm == 2 || RecSet.at(CurrentGroup).ReconstructionAlgorithm == 6 );
+      if (RecSet.at(CurrentGroup).ReconstructionAlgorithm == 6)
+      {
+          SimdGrid = new ASimdGridManager(PMs, PMgroups, LRFs->getOldModule(), EventsDataHub, &RecSet[CurrentGroup], CurrentGroup);
+          if (!SimdGrid->Configure())
+          {
+              ErrorString = SimdGrid->GetLastError();
+              delete SimdGrid; SimdGrid = nullptr;
+              PMgroups->clearActiveSensorGroups();
+              bBusy = false;
+              emit ReconstructionFinished(false, fShow);
+              return false;
+          }
+      }
       if (fMultiThreaded)
       {
           todo.clear();
+          QTime algTimer;
+          algTimer.start();
           distributeWork(RecSet.at(CurrentGroup).ReconstructionAlgorithm, todo);
           fOK = run(todo);
+          if (SimdGrid)
+          {
+              SimdGrid->SetElapsedTime(algTimer.elapsed(), EventsDataHub->Events.size());
+              qDebug() << "Rate (us/event) reported by SIMD grid module:" << SimdGrid->GetUsPerEvent();
+              delete SimdGrid; SimdGrid = nullptr;
+          }
       }
       else
       {
@@ -195,6 +217,7 @@ bool AReconstructionManager::reconstructAll(QJsonObject &json, int numThreads, b
               }
 
               KNNmodule->Reconstructor.readFromJson(RecSet[CurrentGroup].kNNrecSet);
+              KNNmodule->Reconstructor.SearchSettings.NumThreads = NumThreads;
               bool ok = KNNmodule->Reconstructor.reconstructEvents();
               if (!ok)
               {
@@ -248,6 +271,7 @@ bool AReconstructionManager::reconstructAll(QJsonObject &json, int numThreads, b
               && RecSet.at(CurrentGroup).ReconstructionAlgorithm != 0
               && RecSet.at(CurrentGroup).ReconstructionAlgorithm != 4
               && RecSet.at(CurrentGroup).ReconstructionAlgorithm != 5 //might make sense to activate!
+              && RecSet.at(CurrentGroup).ReconstructionAlgorithm != 6
               && !(RecSet.at(CurrentGroup).ReconstructionAlgorithm == 2 && RecSet.at(CurrentGroup).MultipleEventOption == 1);
       if (fDoChi2Calc)
       {
@@ -284,7 +308,7 @@ bool AReconstructionManager::reconstructAll(QJsonObject &json, int numThreads, b
 
 void AReconstructionManager::distributeWork(int Algorithm, QList<AReconstructionWorker*> &todo)
 // Algorithm options:
-//0 - CoG reconstruction, 1 - MG, 2 - RootMini
+//0 - CoG reconstruction, 1 - MG, 2 - RootMini, 6 - MG on CPU with SIMD
 //10 - Calculate Chi2, 11 - process event filters
 { 
   numEvents = EventsDataHub->Events.size();
@@ -306,6 +330,9 @@ void AReconstructionManager::distributeWork(int Algorithm, QList<AReconstruction
       case 1:
           todo << new CGonCPUreconstructorClass(PMs, PMgroups, LRFs, EventsDataHub, &RecSet[CurrentGroup], CurrentGroup, from, to);
           break;
+      case 6:
+          todo << new CGsimdReconstructorClass(PMs, PMgroups, LRFs, EventsDataHub, &RecSet[CurrentGroup], CurrentGroup, from, to, SimdGrid);
+          break;
       case 2:
           if (RecSet.at(CurrentGroup).MultipleEventOption == 1) //in the case of 2(chose best single or double), first single is calculated
                todo << new RootMinDoubleReconstructorClass(PMs, PMgroups, LRFs, EventsDataHub, &RecSet[CurrentGroup], CurrentGroup, from, to);
@@ -315,7 +342,7 @@ void AReconstructionManager::distributeWork(int Algorithm, QList<AReconstruction
           todo << new Chi2calculatorClass(PMs, PMgroups, LRFs, EventsDataHub, &RecSet[CurrentGroup], CurrentGroup, from, to);
           break;
       case 11:
-          todo << new EventFilterClass(PMs, PMgroups, LRFs, EventsDataHub, &RecSet[CurrentGroup], &FiltSet[CurrentGroup], CurrentGroup, from, to);
+          todo << new EventFilterClass(PMs, PMgroups, LRFs, EventsDataHub, &RecSet[CurrentGroup], &FiltSet[CurrentGroup], KNNfilterDists, Detector->GeoManager, CurrentGroup, from, to);
           break;
       case 12:
           todo << new RootMinDoubleReconstructorClass(PMs, PMgroups, LRFs, EventsDataHub, &RecSet[CurrentGroup], CurrentGroup, from, to);
@@ -336,20 +363,60 @@ void AReconstructionManager::doFilters()
     bBusy = true;
     for (CurrentGroup=0; CurrentGroup<FiltSet.size(); CurrentGroup++)
     {
+        //all filters are checked in one pass over the events, split between the threads
+        KNNfilterDists = prepareKNNfilter();
+        prepareSharedFilterData();
+
         //qDebug() << "...Running multithread filters for sensor group"<<CurrentGroup;
         todo.clear();
         distributeWork(11, todo);
         //bool fOK =
         run(todo);
         //qDebug() << "...OK?"<<fOK;
-        //additional filters which has to be checked in single thread
-        //qDebug() << "...single thread filters";
-        singleThreadEventFilters();
-        //qDebug() << "...done!";
     }
+    KNNfilterDists = nullptr;
     bBusy = false;
 }
 
+void AReconstructionManager::prepareSharedFilterData()
+{
+    AEventFilteringSettings & FiltS = FiltSet[CurrentGroup];
+
+    //cuts are evaluated concurrently: precalculated data have to be ready before the threads start
+    if (FiltS.fCorrelationFilters)
+        for (CorrelationFilterStructure * cf : FiltS.CorrelationFilters)
+            if (cf->Active) cf->getCut()->prepare();
+
+    //each thread finds volumes with its own navigator
+    if (FiltS.fSpF_LimitToObj && NumThreads > 1)
+        Detector->GeoManager->SetMaxThreads(NumThreads);
+}
+
+const QVector<float>* AReconstructionManager::prepareKNNfilter()
+{
+#ifdef ANTS_FLANN
+  const AEventFilteringSettings & FiltS = FiltSet.at(CurrentGroup);
+  if (!FiltS.fKNNfilter) return nullptr;
+
+  if (FiltSet.size() > 1)
+    {
+      qWarning() << "kNN filter is disabled in multi group configuration!";
+      return nullptr;
+    }
+
+  qDebug() << "  Preparing kNN module..";
+  KNNfilterClass & Filter = KNNmodule->Filter;
+  Filter.SearchSettings.NumThreads = NumThreads;
+  Filter.SearchSettings.Checks = FiltS.KNNfilterChecks;
+  Filter.SearchSettings.Eps    = FiltS.KNNfilterEps;
+  bool ok = Filter.prepareNNfilter(FiltS.KNNfilterAverageOver+1); //reuses old data set or calculates new
+    //+1 - module assumes 0 is the point itself, therefore incrementing by 1
+  qDebug() << "  Done!";
+  if (ok && Filter.getAverageDists().size() == EventsDataHub->Events.size()) return &Filter.getAverageDists();
+#endif
+  return nullptr;
+}
+
 bool AReconstructionManager::fillSettingsAndVerify(QJsonObject &json, bool fCheckLRFs)
 {
   if (EventsDataHub->isEmpty())
@@ -414,7 +481,7 @@ bool AReconstructionManager::fillSettingsAndVerify(QJsonObject &json, bool fChec
           return false;
       }
 
-      int Alg = RecS.ReconstructionAlgorithm; // 0 - CoG, 1 -CGonCPU, 2-RootMin, 3 - ANN, 4-CUDA
+      int Alg = RecS.ReconstructionAlgorithm; // 0 - CoG, 1 -CGonCPU, 2-RootMin, 3 - ANN, 4-CUDA, 5 - kNN, 6 - CG on CPU with SIMD
 
       if (fCheckLRFs)
       {
@@ -663,113 +730,6 @@ void AReconstructionManager::assureReconstructionDataContainersExist()
     }
 }
 
-void AReconstructionManager::singleThreadEventFilters()
-{
-  //qDebug() << "Running single thread filters";
-  //GoodEvent status already set by multithread filters!
-
-  int numEvents = EventsDataHub->Events.size();
-  AEventFilteringSettings* FiltS = &FiltSet[CurrentGroup];
-
-#ifdef ANTS_FLANN  
-  if (FiltS->fKNNfilter)
-    {
-      if (FiltSet.size()==1)
-      {
-          qDebug() << "  Preparing kNN module..";
-          KNNmodule->Filter.prepareNNfilter(FiltS->KNNfilterAverageOver+1); //reuses old data set or calculates new
-            //+1 - module assumes 0 is the point itself, therefore incrementing by 1
-          qDebug() << "  Done!";
-      }
-      else qWarning() << "kNN filter is disabled in multi group configuration!";
-    }
-#endif
-
-  TGeoNavigator* navi = 0;
-  if (FiltS->fSpF_LimitToObj)
-      navi = Detector->GeoManager->GetCurrentNavigator();
-  else FiltS->fSpF_LimitToObj = false;
-
-  // main cycle
-  for (int iev=0; iev<numEvents; iev++)
-    {
-      AReconRecord* rec = EventsDataHub->ReconstructionData[CurrentGroup][iev];
-      if (!rec->GoodEvent) continue;
-
-      //spatial to specific volume     
-      if (FiltS->fSpF_LimitToObj)
-      {
-          //at least one of the points shoud be inside this volume
-          APositionEnergyBuffer &Points = (FiltS->SpF_RecOrScan == 0) ? rec->Points : EventsDataHub->Scan.at(iev)->Points;
-          bool fNotFound = true;
-          for (int iPoint = 0; iPoint<Points.size(); iPoint++)
-          {
-              TGeoNode* node = navi->FindNode(Points[iPoint].r[0], Points[iPoint].r[1], Points[iPoint].r[2]);
-              if (node && TString(node->GetVolume()->GetName()) == FiltS->SpF_LimitToObj)
-              {
-                  fNotFound = false;
-                  break;
-              }
-          }
-          if (fNotFound)
-          {
-              rec->GoodEvent = false;
-              continue;
-          }
-      }
-
-      //correlation
-      if (FiltS->fCorrelationFilters)
-        {
-          bool pass = true;
-
-          for (int ifilter = 0; ifilter<FiltS->CorrelationFilters.size(); ifilter++)
-            if (FiltS->CorrelationFilters.at(ifilter)->Active)
-             {
-                /*
-              qDebug()<<"First:"<<CorrelationFilters->at(ifilter)->getCorrelationUnitX()->getType()<<CorrelationFilters->at(ifilter)->getCorrelationUnitX()->Channels;
-              qDebug()<<"Second:"<<CorrelationFilters->at(ifilter)->getCorrelationUnitX()->getType()<<CorrelationFilters->at(ifilter)->getCorrelationUnitX()->Channels;
-              qDebug()<<"Cut:"<<CorrelationFilters->at(ifilter)->getCut()->getType()<<CorrelationFilters->at(ifilter)->getCut()->Data;
-              qDebug()<<"Current event:"<<CurrentEvent;
-              qDebug()<<"Adress of Events in X:"<<CorrelationFilters->at(ifilter)->getCorrelationUnitX()->Events;
-              qDebug()<<"Actual Events address:"<<&Events;
-              qDebug()<<"Events in X:"<<*(CorrelationFilters->at(ifilter)->getCorrelationUnitX()->Events);
-              qDebug()<<"Val_X:"<<CorrelationFilters->at(ifilter)->getCorrelationUnitX()->getValue(CurrentEvent);
-              qDebug()<<"Val_Y:"<<CorrelationFilters->at(ifilter)->getCorrelationUnitY()->getValue(CurrentEvent);
-              */
-              if (!FiltS->CorrelationFilters.at(ifilter)->getCut()->filter( FiltS->CorrelationFilters.at(ifilter)->getCorrelationUnitX()->getValue(iev),
-                                                                      FiltS->CorrelationFilters.at(ifilter)->getCorrelationUnitY()->getValue(iev) ))
-                {
-                  pass = false;
-                  break;
-                }
-//                  qDebug()<<"   #"<<ifilter<<" :"<<pass;
-             }
-          if (!pass)
-          {
-              rec->GoodEvent = false;
-              continue;
-          }
-        }
-
-      //kNN
-#ifdef ANTS_FLANN
-          //kNNfilter - can be activated only if ANTS_FLANN is defined
-          if (FiltS->fKNNfilter)
-            {
-              float dist = KNNmodule->Filter.getAverageDist(iev);
-              if (dist<FiltS->KNNfilterMin || dist>FiltS->KNNfilterMax)
-              {
-                  rec->GoodEvent = false;
-                  continue;
-              }
-            }          
-#endif
-  }
-
-  //qDebug() << "Single thread filters done!";
-}
-
 void AReconstructionManager::onRequestClearKNNfilter()
 {
 #ifdef ANTS_FLANN
@@ -23,6 +23,7 @@ class ALrfModuleSelector;
 class TmpObjHubClass;
 class DynamicPassivesHandler;
 class AReconstructionWorker;
+class ASimdGridManager;
 class NNmoduleClass;
 class ACalibratorSignalPerPhEl_Stat;
 class ACalibratorSignalPerPhEl_Peaks;
@@ -82,9 +83,12 @@ private:
   QVector<AEventFilteringSettings> FiltSet;
   int NumThreads;
   int MaxThreads = -1;
+  const QVector<float>* KNNfilterDists = nullptr; //prepared before the multithread filter pass
 
   bool bBusy;
 
+  ASimdGridManager* SimdGrid = nullptr; // tables shared by CGsimdReconstructorClass workers
+
   std::atomic<bool> fDoingCopyLRFs;
  
   bool run(QList<AReconstructionWorker*> reconstructorList);
@@ -99,7 +103,8 @@ private:
   bool configureFilters(QJsonObject &json);
   void distributeWork(int Algorithm, QList<AReconstructionWorker*> &todo);
   void doFilters();
-  void singleThreadEventFilters(); //used to process Volume-specific spatial, correlation and kNN filters which HAS to be one thread  
+  const QVector<float>* prepareKNNfilter(); //average distances to the neighbours for the event filter workers, nullptr if kNN filter is not active
+  void prepareSharedFilterData();           //has to be called before the threaded pass of the event filters  
   void assureReconstructionDataContainersExist();
 
 public slots:
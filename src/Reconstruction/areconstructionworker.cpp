@@ -6,12 +6,45 @@
 #include "dynamicpassiveshandler.h"
 #include "apositionenergyrecords.h"
 #include "aeventfilteringsettings.h"
+#include "asimdgridmanager.h"
+#include "CorrelationFilters.h"
 
 #include <QDebug>
 
 #include "TMath.h"
 #include "Math/Functor.h"
+#include "Math/IFunction.h"
 #include "Minuit2/Minuit2Minimizer.h"
+#include "TGeoManager.h"
+
+#include <cmath>
+#include <algorithm>
+
+// chi2 / ML with analytic gradient for Minuit2 (Migrad does not need numerical derivatives then)
+class AFunc_Gradient : public ROOT::Math::IGradientFunctionMultiDim
+{
+public:
+    AFunc_Gradient(RootMinReconstructorClass * Reconstructor) : Reconstructor(Reconstructor) {}
+
+    virtual ROOT::Math::IMultiGenFunction * Clone() const {return new AFunc_Gradient(Reconstructor);}
+    virtual unsigned int NDim() const {return 4;}
+    virtual void Gradient(const double *p, double *grad) const {double f; FdF(p, f, grad);}
+    virtual void FdF(const double *p, double & f, double *grad) const
+    {
+        if (!Reconstructor->evalWithGradient(p, f, grad))
+        {
+            f = Reconstructor->penaltyValue();
+            for (int i = 0; i < 4; i++) grad[i] = 0;
+        }
+        else Reconstructor->LastMiniValue = f;
+    }
+
+private:
+    virtual double DoEval(const double *p) const {double f, grad[4]; FdF(p, f, grad); return f;}
+    virtual double DoDerivative(const double *p, unsigned int icoord) const {double f, grad[4]; FdF(p, f, grad); return grad[icoord];}
+
+    RootMinReconstructorClass * Reconstructor = nullptr;
+};
 
 AReconstructionWorker::AReconstructionWorker(APmHub* PMs,
                APmGroupsManager* PMgroups,
@@ -47,7 +80,7 @@ void CoGReconstructorClass::execute()
   for (int iev=EventsFrom; iev<EventsTo; iev++)
     {
       AReconRecord* rec = EventsDataHub->ReconstructionData[ThisPmGroup][iev];
-      const QVector< float >* PMsignals = &EventsDataHub->Events[iev];
+      const AConstEventSpan PMsignals = EventsDataHub->Events.at(iev);
 
       rec->fScriptFiltered = false;
 
@@ -58,8 +91,8 @@ void CoGReconstructorClass::execute()
        if (!PMgroups->isTMPPassive(i))
         if (!PMgroups->isStaticPassive(i) || RecSet->fIncludePassive) //if fIncludePassive is true, max signal PM can be passive
           {
-            //double sig = PMsignals->at(i) / Detector->PMs->at(i).relGain;
-            double sig = PMsignals->at(i) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(i).gain;
+            //double sig = PMsignals.at(i) / Detector->PMs->at(i).relGain;
+            double sig = PMsignals.at(i) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(i).gain;
             if (sig > maxSignal)
               {
                 maxSignal = sig;
@@ -72,8 +105,8 @@ void CoGReconstructorClass::execute()
       for (int i=0; i<PMs->count(); i++)
         if (PMgroups->isActive(i))
           {
-            //double sig = PMsignals->at(i) / Detector->PMs->at(i).relGain;
-            double sig = PMsignals->at(i) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(i).gain;
+            //double sig = PMsignals.at(i) / Detector->PMs->at(i).relGain;
+            double sig = PMsignals.at(i) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(i).gain;
             if (RecSet->fCoGIgnoreBySignal)
               {
                 if (sig < RecSet->CoGIgnoreThresholdLow) continue; //ignore this PM
@@ -104,8 +137,8 @@ void CoGReconstructorClass::execute()
           {
              for (int ipm=0; ipm<PMs->count(); ipm++)
                {
-                 //double sig = PMsignals->at(ipm) / Detector->PMs->at(ipm).relGain;
-                 double sig = PMsignals->at(ipm) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).gain;
+                 //double sig = PMsignals.at(ipm) / Detector->PMs->at(ipm).relGain;
+                 double sig = PMsignals.at(ipm) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).gain;
 
                  //bool fActive = !Detector->PMs->at(ipm).isStaticPassive();
                  bool fActive = PMgroups->isActive(ipm);
@@ -147,8 +180,8 @@ void CoGReconstructorClass::execute()
             SumY = 0;
             for (int ipm=0; ipm<PMs->count(); ipm++)
               {
-                //double sig = PMsignals->at(ipm) / Detector->PMs->at(ipm).relGain;
-                double sig = PMsignals->at(ipm) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).gain;
+                //double sig = PMsignals.at(ipm) / Detector->PMs->at(ipm).relGain;
+                double sig = PMsignals.at(ipm) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).gain;
 
                 //bool fActive = !Detector->PMs->at(ipm).isStaticPassive();
                 bool fActive = PMgroups->isActive(ipm);
@@ -208,6 +241,8 @@ RootMinReconstructorClass::RootMinReconstructorClass(APmHub* PMs,
     switch (RecSet->RMminuitOption)
     {
     case 0:
+    case 2: // Migrad with analytic gradient
+    case 3: // Levenberg-Marquardt, Migrad is used only with custom formula
         //RootMinimizer = ROOT::Math::Factory::CreateMinimizer("Minuit2", "Migrad");
         RootMinimizer = new ROOT::Minuit2::Minuit2Minimizer(ROOT::Minuit2::kMigrad);
         break;
@@ -247,13 +282,23 @@ RootMinReconstructorClass::RootMinReconstructorClass(APmHub* PMs,
         break;
       }
     }
-    RootMinimizer->SetFunction(*FunctorLSML);
+
+    const bool bAnalytic = (RecSet->RMtype == 0 || RecSet->RMtype == 1);
+    if (bAnalytic && RecSet->RMminuitOption == 2)
+    {
+        GradFunc = new AFunc_Gradient(this);
+        RootMinimizer->SetFunction(*GradFunc);
+    }
+    else RootMinimizer->SetFunction(*FunctorLSML);
+
+    fLevenbergMarquardt = (bAnalytic && RecSet->RMminuitOption == 3);
 }
 
 RootMinReconstructorClass::~RootMinReconstructorClass()
 {
     delete RootMinimizer;
     delete FunctorLSML;
+    delete GradFunc;
     //delete Func;  // seems ROOT deletes it automatically - otherwise double-delete does not work well on TFormula based functor
 }
 
@@ -270,50 +315,62 @@ void RootMinReconstructorClass::execute()
         AReconRecord *rec = EventsDataHub->ReconstructionData[ThisPmGroup][iev];
         if (rec->ReconstructionOK)
         {
-            PMsignals = &EventsDataHub->Events[iev];
+            PMsignals = EventsDataHub->Events.at(iev);
             if (RecSet->fUseDynamicPassives) DynamicPassives->calculateDynamicPassives(iev, rec);
 
             if (RecSet->RMtype == 1)
                 LastMiniValue = 1.e100; // reset for the new event
             else
                 LastMiniValue = 1.e6; //reset for the new event
-            //set variables to minimize
+            //start position
+            double startX, startY;
             if (RecSet->RMstartOption == 1)
             {
                 //starting from XY of the centre of the PM with max signal
-                RootMinimizer->SetVariable(0, "x", PMs->X(rec->iPMwithMaxSignal), RecSet->RMstepX);
-                RootMinimizer->SetVariable(1, "y", PMs->Y(rec->iPMwithMaxSignal), RecSet->RMstepY);
+                startX = PMs->X(rec->iPMwithMaxSignal);
+                startY = PMs->Y(rec->iPMwithMaxSignal);
             }
             else if (RecSet->RMstartOption == 2 && !EventsDataHub->isScanEmpty())
             {
                 //start from true XY position
-                RootMinimizer->SetVariable(0, "x", EventsDataHub->Scan[iev]->Points[0].r[0], RecSet->RMstepX);
-                RootMinimizer->SetVariable(1, "y", EventsDataHub->Scan[iev]->Points[0].r[1], RecSet->RMstepY);
+                startX = EventsDataHub->Scan[iev]->Points[0].r[0];
+                startY = EventsDataHub->Scan[iev]->Points[0].r[1];
             }
             else
             {
                 //else start from CoG data
-                RootMinimizer->SetVariable(0, "x", rec->xCoG, RecSet->RMstepX);
-                RootMinimizer->SetVariable(1, "y", rec->yCoG, RecSet->RMstepY);
+                startX = rec->xCoG;
+                startY = rec->yCoG;
             }
-            if (RecSet->fReconstructZ) RootMinimizer->SetVariable(2, "z", rec->zCoG, RecSet->RMstepZ);
-            else RootMinimizer->SetFixedVariable(2, "z", rec->zCoG);
-            if (RecSet->fReconstructEnergy) RootMinimizer->SetLowerLimitedVariable(3, "e", RecSet->SuggestedEnergy, RecSet->RMstepEnergy, 0.);
-            else RootMinimizer->SetFixedVariable(3, "e", RecSet->SuggestedEnergy);
 
-            // do the minimization
-            bool fOK = RootMinimizer->Minimize();
-            //double MinValue = RootMinimizer->MinValue();
-            //if (MinValue != MinValue)
-            //  qDebug()<<"nan detected! Minimization success? "<<fOK;
+            bool fOK;
+            double result[4] = {startX, startY, rec->zCoG, RecSet->SuggestedEnergy};
+            if (fLevenbergMarquardt) fOK = minimizeLM(result);
+            else
+            {
+                //set variables to minimize
+                RootMinimizer->SetVariable(0, "x", startX, RecSet->RMstepX);
+                RootMinimizer->SetVariable(1, "y", startY, RecSet->RMstepY);
+                if (RecSet->fReconstructZ) RootMinimizer->SetVariable(2, "z", rec->zCoG, RecSet->RMstepZ);
+                else RootMinimizer->SetFixedVariable(2, "z", rec->zCoG);
+                if (RecSet->fReconstructEnergy) RootMinimizer->SetLowerLimitedVariable(3, "e", RecSet->SuggestedEnergy, RecSet->RMstepEnergy, 0.);
+                else RootMinimizer->SetFixedVariable(3, "e", RecSet->SuggestedEnergy);
+
+                // do the minimization
+                fOK = RootMinimizer->Minimize();
+                //double MinValue = RootMinimizer->MinValue();
+                //if (MinValue != MinValue)
+                //  qDebug()<<"nan detected! Minimization success? "<<fOK;
+                if (fOK)
+                    for (int i = 0; i < 4; i++) result[i] = RootMinimizer->X()[i];
+            }
 
             if (fOK)
             {
-                const double *xs = RootMinimizer->X();
-                rec->Points[0].r[0] = xs[0];
-                rec->Points[0].r[1] = xs[1];
-                rec->Points[0].r[2] = xs[2];
-                rec->Points[0].energy = xs[3];
+                rec->Points[0].r[0] = result[0];
+                rec->Points[0].r[1] = result[1];
+                rec->Points[0].r[2] = result[2];
+                rec->Points[0].energy = result[3];
                 //already have "OK and Good" status from CoG
             }
             else
@@ -332,6 +389,187 @@ void RootMinReconstructorClass::execute()
     fFinished = true;
 }
 
+double RootMinReconstructorClass::penaltyValue()
+{
+    if (RecSet->RMtype == 1) return LastMiniValue + fabs(LastMiniValue) * 0.25;
+    return LastMiniValue *= 1.25;
+}
+
+bool RootMinReconstructorClass::evalWithGradient(const double *p, double & value, double *grad, double *fisher) //0-x, 1-y, 2-z, 3-energy
+{
+    LRFs.getLRFsAndGradients(p, LRFvalues, LRFgradX, LRFgradY);
+
+    const bool bZ = RecSet->fReconstructZ;
+    if (bZ)
+    {
+        // LRFs do not provide derivative over z
+        const double h = 1e-3;
+        const double pz[3] = {p[0], p[1], p[2] + h};
+        LRFs.getLRFs(pz, LRFgradZ);
+        for (size_t ipm = 0; ipm < LRFgradZ.size(); ipm++)
+            LRFgradZ[ipm] = (LRFgradZ[ipm] - LRFvalues[ipm]) / h;
+    }
+
+    const bool bML = (RecSet->RMtype == 1);
+    const bool bWeighted = !bML && RecSet->fWeightedChi2calculation;
+    if (bWeighted) LRFs.getLRFErrs(p, LRFerrors);
+
+    const double energy = p[3];
+    double sum = 0;
+    double g[4] = {0, 0, 0, 0};
+    double F[16];
+    for (int i = 0; i < 16; i++) F[i] = 0;
+
+    for (int ipm = 0; ipm < (int)LRFvalues.size(); ipm++)
+    {
+        if (!DynamicPassives->isActive(ipm)) continue;
+
+        const double LRFhere = LRFvalues[ipm];
+        const double mu = LRFhere * energy;
+        if (mu <= 0) return false;
+
+        // derivatives of the expected signal over x, y, z and energy
+        const double d[4] = {energy * LRFgradX[ipm], energy * LRFgradY[ipm], (bZ ? energy * LRFgradZ[ipm] : 0), LRFhere};
+        const double sig = PMsignals.at(ipm);
+        double dValue; // d(value)/d(mu)
+        double w;      // weight for the Fisher / Gauss-Newton matrix
+        if (bML)
+        {
+            sum -= sig * log(mu) - mu;
+            dValue = 1.0 - sig / mu;
+            w = 1.0 / mu;
+        }
+        else if (bWeighted)
+        {
+            // sigma2 = mu + (err*energy)^2, derivative of the error LRF over the position is neglected
+            const double delta = mu - sig;
+            const double err = LRFerrors[ipm];
+            const double sigma2 = mu + err * err * energy * energy;
+            const double ratio = delta / sigma2;
+            sum += delta * ratio;
+            dValue = 2.0 * ratio - ratio * ratio;
+            g[3] -= ratio * ratio * 2.0 * err * err * energy;
+            w = 2.0 / sigma2;
+        }
+        else
+        {
+            const double delta = mu - sig;
+            sum += delta * delta;
+            dValue = 2.0 * delta;
+            w = 2.0;
+        }
+
+        for (int k = 0; k < 4; k++)
+        {
+            g[k] += dValue * d[k];
+            if (fisher)
+                for (int l = 0; l < 4; l++) F[4*k + l] += w * d[k] * d[l];
+        }
+    }
+
+    value = sum;
+    for (int k = 0; k < 4; k++) grad[k] = g[k];
+    if (fisher)
+        for (int i = 0; i < 16; i++) fisher[i] = F[i];
+    return true;
+}
+
+// Cholesky solution of A*x = b for a small symmetric matrix (n x n, row-major); false if A is not positive definite
+static bool solveCholesky(int n, double *A, const double *b, double *x)
+{
+    for (int j = 0; j < n; j++)
+    {
+        double d = A[j*n + j];
+        for (int k = 0; k < j; k++) d -= A[j*n + k] * A[j*n + k];
+        if (!(d > 0)) return false;
+        d = sqrt(d);
+        A[j*n + j] = d;
+        for (int i = j + 1; i < n; i++)
+        {
+            double s = A[i*n + j];
+            for (int k = 0; k < j; k++) s -= A[i*n + k] * A[j*n + k];
+            A[i*n + j] = s / d;
+        }
+    }
+    for (int i = 0; i < n; i++)
+    {
+        double s = b[i];
+        for (int k = 0; k < i; k++) s -= A[i*n + k] * x[k];
+        x[i] = s / A[i*n + i];
+    }
+    for (int i = n - 1; i >= 0; i--)
+    {
+        double s = x[i];
+        for (int k = i + 1; k < n; k++) s -= A[k*n + i] * x[k];
+        x[i] = s / A[i*n + i];
+    }
+    return true;
+}
+
+bool RootMinReconstructorClass::minimizeLM(double *p)
+{
+    double value, grad[4], fisher[16];
+    if (!evalWithGradient(p, value, grad, fisher)) return false; //start point is outside of the LRF range
+
+    const double EdmLimit = 0.002 * 0.001; // Minuit2 criterion with the tolerance used for Migrad
+    double lambda = 1.0e-3;
+    for (int iter = 0; iter < RecSet->RMmaxCalls; iter++)
+    {
+        // free parameters with non-zero sensitivity: x, y, (z), (energy)
+        int free[4];
+        int nFree = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            if (k == 2 && !RecSet->fReconstructZ) continue;
+            if (k == 3 && !RecSet->fReconstructEnergy) continue;
+            if (fisher[5*k] > 0) free[nFree++] = k;
+        }
+        if (nFree == 0) return false;
+
+        // (F + lambda * diag(F)) * step = -grad
+        double A[16], b[4], step[4];
+        for (int i = 0; i < nFree; i++)
+        {
+            for (int j = 0; j < nFree; j++) A[i*nFree + j] = fisher[4*free[i] + free[j]];
+            A[i*nFree + i] *= 1.0 + lambda;
+            b[i] = -grad[free[i]];
+        }
+        if (!solveCholesky(nFree, A, b, step))
+        {
+            lambda *= 10.0;
+            if (lambda > 1.0e8) return false;
+            continue;
+        }
+
+        double edm = 0;
+        double trial[4] = {p[0], p[1], p[2], p[3]};
+        for (int i = 0; i < nFree; i++)
+        {
+            trial[free[i]] += step[i];
+            edm -= 0.5 * grad[free[i]] * step[i];
+        }
+        if (trial[3] <= 0) trial[3] = 0.1 * p[3]; // energy is kept positive
+
+        double tValue, tGrad[4], tFisher[16];
+        if (evalWithGradient(trial, tValue, tGrad, tFisher) && tValue <= value)
+        {
+            for (int k = 0; k < 4; k++) p[k] = trial[k];
+            value = tValue;
+            for (int k = 0; k < 4; k++) grad[k] = tGrad[k];
+            for (int i = 0; i < 16; i++) fisher[i] = tFisher[i];
+            lambda = std::max(0.1 * lambda, 1.0e-9);
+            if (edm < EdmLimit) return true;
+        }
+        else
+        {
+            if (edm < EdmLimit) return true; // already at the minimum within the precision
+            lambda *= 10.0;
+            if (lambda > 1.0e8) return false;
+        }
+    }
+    return false; //iteration limit
+}
+
 RootMinDoubleReconstructorClass::RootMinDoubleReconstructorClass(APmHub* PMs,
                                                                  APmGroupsManager* PMgroups,
                                                                  ALrfModuleSelector *LRFs,
@@ -344,6 +582,8 @@ RootMinDoubleReconstructorClass::RootMinDoubleReconstructorClass(APmHub* PMs,
     switch (RecSet->RMminuitOption)
     {
     case 0:
+    case 2: // analytic gradient options are implemented only for single events
+    case 3:
         //RootMinimizer = ROOT::Math::Factory::CreateMinimizer("Minuit2", "Migrad");
         RootMinimizer = new ROOT::Minuit2::Minuit2Minimizer(ROOT::Minuit2::kMigrad);
         break;
@@ -392,7 +632,7 @@ void RootMinDoubleReconstructorClass::execute()
         AReconRecord *rec = EventsDataHub->ReconstructionData[ThisPmGroup][iev];
         if (rec->ReconstructionOK || rec->chi2 == -1) //chi2=-1 if single rec failed, but CoG was ok
         {
-            PMsignals = &EventsDataHub->Events[iev];
+            PMsignals = EventsDataHub->Events.at(iev);
             if (RecSet->fUseDynamicPassives) DynamicPassives->calculateDynamicPassives(iev, rec);
 
             //=== Reconstructing as double event ===
@@ -401,12 +641,12 @@ void RootMinDoubleReconstructorClass::execute()
             // for the moment, have a weak procedure to find the second starting coordinate - XY of PM with the second strongest signal
             int ipmWithSecondMaxSignal = 0;
             double SecondMaxSignal = -1.0e10;
-            for (int ipm=0; ipm < PMsignals->count(); ipm++)
+            for (int ipm=0; ipm < PMsignals.count(); ipm++)
                 if (DynamicPassives->isStaticActive(ipm))
                 {
                     if (ipm == rec->iPMwithMaxSignal) continue;
-                    //double sig = PMsignals->at(ipm) / Detector->PMs->at(ipm).relGain;
-                    double sig = PMsignals->at(ipm) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).gain;
+                    //double sig = PMsignals.at(ipm) / Detector->PMs->at(ipm).relGain;
+                    double sig = PMsignals.at(ipm) / PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).gain;
                     if (sig > SecondMaxSignal)
                     {
                         SecondMaxSignal = sig;
@@ -477,7 +717,7 @@ double RootMinDoubleReconstructorClass::calculateChi2DoubleEvent(const double *r
   double energy2 = result[7];
   double sum = 0;
 
-  for (int ipm = 0; ipm < PMsignals->count(); ipm++)
+  for (int ipm = 0; ipm < PMsignals.count(); ipm++)
     if (DynamicPassives->isActive(ipm))
      {
        double LRFhere1 = LRFs.getLRF(ipm, x1, y1, z1) * energy1;
@@ -485,7 +725,7 @@ double RootMinDoubleReconstructorClass::calculateChi2DoubleEvent(const double *r
        if (LRFhere1 == 0 || LRFhere2 == 0) return 1.0e20;
 
        double LRFhere = LRFhere1 + LRFhere2;
-       double delta = LRFhere - PMsignals->at(ipm);
+       double delta = LRFhere - PMsignals.at(ipm);
        if (RecSet->fWeightedChi2calculation)
          {
            double sigma2;
@@ -563,7 +803,7 @@ double Chi2static(const double *p) //0-x, 1-y, 2-z, 3-energy, 4-pointer to RootM
        if (LRFhere <= 0)
            return Reconstructor->LastMiniValue *= 1.25; //if LRFs are not defined for this coordinates
 
-       double delta = (LRFhere - Reconstructor->PMsignals->at(ipm));
+       double delta = (LRFhere - Reconstructor->PMsignals.at(ipm));
        if (Reconstructor->RecSet->fWeightedChi2calculation)
          {
             double sigma2;
@@ -580,19 +820,23 @@ double Chi2static(const double *p) //0-x, 1-y, 2-z, 3-energy, 4-pointer to RootM
 
 double AFunc_Chi2::operator()(const double *p) //0-x, 1-y, 2-z, 3-energy
 {
+    const bool bWeighted = Reconstructor->RecSet->fWeightedChi2calculation;
+    Reconstructor->LRFs.getLRFs(p, LRFvalues);
+    if (bWeighted) Reconstructor->LRFs.getLRFErrs(p, LRFerrors);
+
     double sum = 0;
-    for (int ipm = 0; ipm < Reconstructor->PMs->count(); ipm++)
+    for (int ipm = 0; ipm < (int)LRFvalues.size(); ipm++)
         if (Reconstructor->DynamicPassives->isActive(ipm))
         {
-            double LRFhere = Reconstructor->LRFs.getLRF(ipm, p)*p[3];
+            double LRFhere = LRFvalues[ipm]*p[3];
             if (LRFhere <= 0)
                 return Reconstructor->LastMiniValue *= 1.25; //if LRFs are not defined for this coordinates
 
-            double delta = (LRFhere - Reconstructor->PMsignals->at(ipm));
-            if (Reconstructor->RecSet->fWeightedChi2calculation)
+            double delta = (LRFhere - Reconstructor->PMsignals.at(ipm));
+            if (bWeighted)
             {
                 double sigma2;
-                double err = Reconstructor->LRFs.getLRFErr(ipm, p)*p[3];
+                double err = LRFerrors[ipm]*p[3];
                 sigma2 = LRFhere + err*err; // if err is not calculated, 0 is returned
                 sum += delta*delta/sigma2;
             }
@@ -620,7 +864,7 @@ double Chi2staticDouble(const double *p)
   //RootMinDoubleReconstructorClass* Reconstructor = reinterpret_cast<RootMinDoubleReconstructorClass*>(intPoint);
   RootMinDoubleReconstructorClass* Reconstructor = (RootMinDoubleReconstructorClass*)thisvalue;
   //  qDebug() << X1 << Y1<< Z1 << energy1<< "    "<< X2 << Y2<<Z2<<energy2;
-  //for (int ipm = 0; ipm < Reconstructor->PMsignals->count(); ipm++)
+  //for (int ipm = 0; ipm < Reconstructor->PMsignals.count(); ipm++)
   for (int ipm = 0; ipm < Reconstructor->PMs->count(); ipm++)
     if (Reconstructor->DynamicPassives->isActive(ipm))
      {
@@ -630,7 +874,7 @@ double Chi2staticDouble(const double *p)
          return Reconstructor->LastMiniValue *= 1.25;  // if LRFs are not defined for these coordinates
 
        double LRFhere = LRFhere1 + LRFhere2;
-       double delta = (LRFhere - Reconstructor->PMsignals->at(ipm));
+       double delta = (LRFhere - Reconstructor->PMsignals.at(ipm));
        if (Reconstructor->RecSet->fWeightedChi2calculation)
          {
            double sigma2;
@@ -667,7 +911,7 @@ double AFunc_Chi2double::operator()(const double *p)
                 return Reconstructor->LastMiniValue *= 1.25;  // if LRFs are not defined for these coordinates
 
             double LRFhere = LRFhere1 + LRFhere2;
-            double delta = (LRFhere - Reconstructor->PMsignals->at(ipm));
+            double delta = (LRFhere - Reconstructor->PMsignals.at(ipm));
             if (Reconstructor->RecSet->fWeightedChi2calculation)
             {
                 double sigma2;
@@ -693,7 +937,7 @@ double MLstatic(const double *p) //0-x, 1-y, 2-z, 3-energy, 4-pointer to RootMin
   //RootMinReconstructorClass* Reconstructor = reinterpret_cast<RootMinReconstructorClass*>(intPoint);
   RootMinReconstructorClass* Reconstructor = (RootMinReconstructorClass*)thisvalue;
 
-  //for (int ipm = 0; ipm < Reconstructor->PMsignals->count(); ipm++)
+  //for (int ipm = 0; ipm < Reconstructor->PMsignals.count(); ipm++)
   for (int ipm = 0; ipm < Reconstructor->PMs->count(); ipm++)
     if (Reconstructor->DynamicPassives->isActive(ipm))
       {
@@ -702,7 +946,7 @@ double MLstatic(const double *p) //0-x, 1-y, 2-z, 3-energy, 4-pointer to RootMin
            //return Reconstructor->LastMiniValue += fabs(Reconstructor->LastMiniValue) * 0.25;
            return Reconstructor->LastMiniValue + fabs(Reconstructor->LastMiniValue) * 0.25;
 
-       sum += Reconstructor->PMsignals->at(ipm)*log(LRFhere) - LRFhere; //measures probability
+       sum += Reconstructor->PMsignals.at(ipm)*log(LRFhere) - LRFhere; //measures probability
      }
     //qDebug() << "Log Likelihood = " << sum;
   return Reconstructor->LastMiniValue = -sum; //-probability, since we use minimizer
@@ -711,16 +955,18 @@ double MLstatic(const double *p) //0-x, 1-y, 2-z, 3-energy, 4-pointer to RootMin
 
 double AFunc_ML::operator()(const double *p) //0-x, 1-y, 2-z, 3-energy
 {
+    Reconstructor->LRFs.getLRFs(p, LRFvalues);
+
     double sum = 0;
-    for (int ipm = 0; ipm < Reconstructor->PMs->count(); ipm++)
+    for (int ipm = 0; ipm < (int)LRFvalues.size(); ipm++)
         if (Reconstructor->DynamicPassives->isActive(ipm))
         {
-            double LRFhere = Reconstructor->LRFs.getLRF(ipm, p)*p[3];
+            double LRFhere = LRFvalues[ipm]*p[3];
             if (LRFhere <= 0)
                 //return Reconstructor->LastMiniValue += fabs(Reconstructor->LastMiniValue) * 0.25;
                 return Reconstructor->LastMiniValue + fabs(Reconstructor->LastMiniValue) * 0.25;
 
-            sum += Reconstructor->PMsignals->at(ipm)*log(LRFhere) - LRFhere; //measures probability
+            sum += Reconstructor->PMsignals.at(ipm)*log(LRFhere) - LRFhere; //measures probability
         }
     return Reconstructor->LastMiniValue = -sum; //-probability, since we use minimizer
 }
@@ -744,7 +990,7 @@ double MLstaticDouble(const double *p) //0-x, 1-y, 2-z, 3-energy, 4567 x1y1z1en1
   //RootMinDoubleReconstructorClass* Reconstructor = reinterpret_cast<RootMinDoubleReconstructorClass*>(intPoint);
   RootMinDoubleReconstructorClass* Reconstructor = (RootMinDoubleReconstructorClass*)thisvalue;
 
-  //for (int ipm = 0; ipm < Reconstructor->PMsignals->count(); ipm++)
+  //for (int ipm = 0; ipm < Reconstructor->PMsignals.count(); ipm++)
   for (int ipm = 0; ipm < Reconstructor->PMs->count(); ipm++)
     if (Reconstructor->DynamicPassives->isActive(ipm))
       {
@@ -754,7 +1000,7 @@ double MLstaticDouble(const double *p) //0-x, 1-y, 2-z, 3-energy, 4567 x1y1z1en1
            return Reconstructor->LastMiniValue += fabs(Reconstructor->LastMiniValue) * 0.25;
        double LRFhere = LRFhere1 + LRFhere2;
 
-       sum += Reconstructor->PMsignals->at(ipm)*log(LRFhere) - LRFhere; //measures probability
+       sum += Reconstructor->PMsignals.at(ipm)*log(LRFhere) - LRFhere; //measures probability
      }
     //qDebug() << "Log Likelihood = " << sum;
   return Reconstructor->LastMiniValue = -sum; //-probability, since we use minimizer
@@ -782,7 +1028,7 @@ double AFunc_MLdouble::operator()(const double *p)
                 return Reconstructor->LastMiniValue += fabs(Reconstructor->LastMiniValue) * 0.25;
             double LRFhere = LRFhere1 + LRFhere2;
 
-            sum += Reconstructor->PMsignals->at(ipm)*log(LRFhere) - LRFhere;
+            sum += Reconstructor->PMsignals.at(ipm)*log(LRFhere) - LRFhere;
         }
 
     return Reconstructor->LastMiniValue = -sum; //-probability, since doing minimization
@@ -823,11 +1069,19 @@ void EventFilterClass::execute()
     const bool fDoRecEnergyFilter = FiltSet->fEnergyFilter && EventsDataHub->fReconstructionDataReady;
     const bool fDoLoadedEnergyFilter = FiltSet->fLoadedEnergyFilter && !EventsDataHub->isScanEmpty();
     const bool fDoChi2Filter = FiltSet->fChi2Filter && EventsDataHub->fReconstructionDataReady;
+    const bool fDoCorrelationFilters = FiltSet->fCorrelationFilters && !FiltSet->CorrelationFilters.isEmpty();
+
+    TGeoNavigator* navi = nullptr;
+    if (FiltSet->fSpF_LimitToObj && GeoManager)
+    {
+        navi = GeoManager->GetCurrentNavigator();
+        if (!navi) navi = GeoManager->AddNavigator();
+    }
 
     for (int iev=EventsFrom; iev<EventsTo; iev++)
     {
         AReconRecord *rec = EventsDataHub->ReconstructionData[ThisPmGroup][iev];
-        const QVector< float >* PMsignals = &EventsDataHub->Events[iev];
+        const AConstEventSpan PMsignals = EventsDataHub->Events.at(iev);
 
         //reconstruction performed and failed -> definitely bad event
         if (EventsDataHub->fReconstructionDataReady && !rec->ReconstructionOK) goto BadEventLabel;
@@ -844,7 +1098,7 @@ void EventFilterClass::execute()
                 if (PMgroups->isPmBelongsToGroupFast(ipm, ThisPmGroup))
                     if (!PMgroups->isStaticPassive(ipm) || FiltSet->fCutOffsForPassivePMs)
                     {
-                        double sig = PMsignals->at(ipm);
+                        double sig = PMsignals.at(ipm);
                         if (FiltSet->fSumCutUsesGains) sig /= PMgroups->getGainFast(ipm, ThisPmGroup);//  Groups.at(ThisPmGroup)->PMS.at(ipm).gain;
                         if (FiltSet->fCutOffFilter)
                             //if (sig < PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).cutOffMin || sig > PMgroups->Groups.at(ThisPmGroup)->PMS.at(ipm).cutOffMax) goto BadEventLabel;
@@ -857,7 +1111,7 @@ void EventFilterClass::execute()
 
         if (fDoLoadedEnergyFilter)
         {
-            //double energy = PMsignals->at(PMs->count());  //energy channel is always the last one, pm numbering starts with 0
+            //double energy = PMsignals.at(PMs->count());  //energy channel is always the last one, pm numbering starts with 0
             const double& energy = EventsDataHub->Scan.at(iev)->Points[0].energy;
             if (energy < FiltSet->LoadedEnergyFilterMin || energy > FiltSet->LoadedEnergyFilterMax) goto BadEventLabel;
         }
@@ -926,6 +1180,22 @@ void EventFilterClass::execute()
         if (fDoChi2Filter)
             if (rec->chi2 < FiltSet->Chi2FilterMin || rec->chi2 > FiltSet->Chi2FilterMax) goto BadEventLabel;
 
+        if (KNNdists)
+        {
+            const float & dist = KNNdists->at(iev);
+            if (dist < FiltSet->KNNfilterMin || dist > FiltSet->KNNfilterMax) goto BadEventLabel;
+        }
+
+        if (fDoCorrelationFilters)
+            if (!passCorrelationFilters(iev)) goto BadEventLabel;
+
+        //the most expensive one is the last
+        if (navi)
+        {
+            const APositionEnergyBuffer & Points = (FiltSet->SpF_RecOrScan == 0) ? rec->Points : EventsDataHub->Scan.at(iev)->Points;
+            if (!isInsideFilterObject(navi, Points)) goto BadEventLabel;
+        }
+
         //if come to this point, its a good event
         rec->GoodEvent = true;
         continue;
@@ -938,6 +1208,25 @@ BadEventLabel:
     fFinished = true;
 }
 
+bool EventFilterClass::isInsideFilterObject(TGeoNavigator * navi, const APositionEnergyBuffer & Points) const
+{
+    //at least one of the points shoud be inside this volume
+    for (int iPoint = 0; iPoint<Points.size(); iPoint++)
+    {
+        TGeoNode* node = navi->FindNode(Points[iPoint].r[0], Points[iPoint].r[1], Points[iPoint].r[2]);
+        if (node && FiltSet->SpF_LimitToObj == node->GetVolume()->GetName()) return true;
+    }
+    return false;
+}
+
+bool EventFilterClass::passCorrelationFilters(int iev) const
+{
+    for (CorrelationFilterStructure * cf : FiltSet->CorrelationFilters)
+        if (cf->Active)
+            if (!cf->getCut()->filter( cf->getCorrelationUnitX()->getValue(iev), cf->getCorrelationUnitY()->getValue(iev) )) return false;
+    return true;
+}
+
 void CGonCPUreconstructorClass::execute()
 {
   //qDebug() << "CConCPU starting";
@@ -1098,6 +1387,25 @@ void CGonCPUreconstructorClass::execute()
   fFinished = true;
 }
 
+void CGsimdReconstructorClass::execute()
+{
+  fFinished = false;
+  float Factor = 100.0/(EventsTo-EventsFrom);
+  eventsProcessed = 0;
+  ASimdGridScratch scratch;
+
+  for (int iev=EventsFrom; iev<EventsTo; iev++)
+    {
+      if (fStopRequested) break;
+      Grid->ReconstructEvent(iev, scratch);
+      eventsProcessed++;
+      Progress = eventsProcessed*Factor;
+    }
+
+  emit finished();
+  fFinished = true;
+}
+
 void CGonCPUreconstructorClass::executeSliced3Dold()
 {
     fFinished = false;
@@ -1285,7 +1593,7 @@ double AFunc_TFormula::operator()(const double *p)
             par[4] = Reconstructor->LRFs.getLRF(ipm, p)*p[3];
             if (par[4] <= 0)
                 return Reconstructor->LastMiniValue + fabs(Reconstructor->LastMiniValue) * 0.25;
-            par[5] = Reconstructor->PMsignals->at(ipm);
+            par[5] = Reconstructor->PMsignals.at(ipm);
             par[6] = Reconstructor->LRFs.getLRFErr(ipm, p);
 
             sum += tform->EvalPar(nullptr, par);
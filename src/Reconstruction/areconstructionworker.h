@@ -4,6 +4,7 @@
 #include <QObject>
 #include "alrfmoduleselector.h"
 #include "afunctorbase.h"
+#include "aeventstore.h"
 
 class ReconstructionSettings;
 class APmHub;
@@ -13,6 +14,11 @@ class DynamicPassivesHandler;
 class EventsDataClass;
 struct AReconRecord;
 class AEventFilteringSettings;
+class ASimdGridManager;
+class AFunc_Gradient;
+class TGeoManager;
+class TGeoNavigator;
+class APositionEnergyBuffer;
 namespace ROOT { namespace Minuit2 { class Minuit2Minimizer; } }
 namespace ROOT { namespace Math { class Functor; } }
 
@@ -110,6 +116,28 @@ private:
   double BestSlEnergy;
 };
 
+// ------ Contracting grids on CPU, SIMD (model of the GPU version) ------
+class CGsimdReconstructorClass : public AReconstructionWorker
+{
+  Q_OBJECT
+public:
+  CGsimdReconstructorClass(APmHub* PMs,
+                           APmGroupsManager* PMgroups,
+                           ALrfModuleSelector* LRFs,
+                           EventsDataClass *EventsDataHub,
+                           ReconstructionSettings *RecSet,
+                           int CurrentGroup,
+                           int EventsFrom, int EventsTo,
+                           const ASimdGridManager* Grid)
+    : AReconstructionWorker(PMs, PMgroups, LRFs, EventsDataHub, RecSet, CurrentGroup, EventsFrom, EventsTo), Grid(Grid) {}
+  ~CGsimdReconstructorClass(){}
+public slots:
+  virtual void execute();
+
+private:
+  const ASimdGridManager* Grid;
+};
+
 // ------ Root minimizer - single point events ------
 class RootMinReconstructorClass : public AReconstructionWorker
 {
@@ -125,7 +153,13 @@ public:
     ~RootMinReconstructorClass();
 
     double LastMiniValue;
-    const QVector< float >* PMsignals;
+    AConstEventSpan PMsignals;
+
+    // chi2 or -ln(likelihood) with the analytic gradient over x, y, z, energy (Minuit2 option 2 and 3)
+    // fisher (4x4, optional): Gauss-Newton matrix for chi2 / Fisher information for likelihood
+    // returns false if the LRF of any active PM is not positive at this point
+    bool evalWithGradient(const double *p, double & value, double *grad, double *fisher = nullptr);
+    double penaltyValue(); // returned to Minuit2 outside of the LRF range, same as in AFunc_Chi2 / AFunc_ML
 
 public slots:
     virtual void execute();
@@ -134,6 +168,13 @@ protected:
     ROOT::Math::Functor *FunctorLSML = nullptr;
     ROOT::Minuit2::Minuit2Minimizer* RootMinimizer = nullptr;
     AFunctorBase * Func = nullptr;
+    AFunc_Gradient * GradFunc = nullptr;
+    bool fLevenbergMarquardt = false;
+
+private:
+    bool minimizeLM(double *p); // Levenberg-Marquardt, p (x, y, z, energy) is the start point and the result
+
+    std::vector<double> LRFvalues, LRFgradX, LRFgradY, LRFgradZ, LRFerrors;
 };
 
 // ------ Root minimizer with double events ------
@@ -152,7 +193,7 @@ public:
     ~RootMinDoubleReconstructorClass();
 
     double LastMiniValue;
-    const QVector< float > * PMsignals;
+    AConstEventSpan PMsignals;
 
 public slots:
     virtual void execute();
@@ -195,15 +236,22 @@ public:
                      EventsDataClass *EventsDataHub,
                      ReconstructionSettings *RecSet,
                      AEventFilteringSettings *FiltSet,
+                     const QVector<float>* KNNdists,
+                     TGeoManager* GeoManager,
                      int CurrentGroup,
                      int EventsFrom, int EventsTo)
-        : AReconstructionWorker(PMs, PMgroups, LRFs, EventsDataHub, RecSet, CurrentGroup, EventsFrom, EventsTo), FiltSet(FiltSet) {}
+        : AReconstructionWorker(PMs, PMgroups, LRFs, EventsDataHub, RecSet, CurrentGroup, EventsFrom, EventsTo), FiltSet(FiltSet), KNNdists(KNNdists), GeoManager(GeoManager) {}
     ~EventFilterClass(){}
 public slots:
   virtual void execute();
 
 private:
    AEventFilteringSettings* FiltSet;
+   const QVector<float>* KNNdists; //average distance to the kNN neighbours, nullptr if the kNN filter is not active
+   TGeoManager* GeoManager;        //for the spatial filter limited to an object, every thread uses own navigator
+
+   bool isInsideFilterObject(TGeoNavigator* navi, const APositionEnergyBuffer & Points) const;
+   bool passCorrelationFilters(int iev) const;
 };
     //double Chi2static(const double *p);
 class AFunc_Chi2 : public AFunctorBase
@@ -213,6 +261,8 @@ public:
     double operator()(const double *p);
 private:
     RootMinReconstructorClass * Reconstructor = nullptr;
+    std::vector<double> LRFvalues; // all PMs for the current position
+    std::vector<double> LRFerrors;
 };
     //double Chi2staticDouble(const double *p);
 class AFunc_Chi2double : public AFunctorBase
@@ -231,6 +281,7 @@ public:
     double operator()(const double *p);
 private:
     RootMinReconstructorClass * Reconstructor = nullptr;
+    std::vector<double> LRFvalues; // all PMs for the current position
 };
     //double MLstaticDouble(const double *p);
 class AFunc_MLdouble : public AFunctorBase
@@ -0,0 +1,813 @@
+#include "asimdgridmanager.h"
+#include "apmhub.h"
+#include "apmgroupsmanager.h"
+#include "sensorlrfs.h"
+#include "eventsdataclass.h"
+#include "reconstructionsettings.h"
+#include "lrfaxial.h"
+#include "lrfcaxial.h"
+#include "lrfxy.h"
+#include "lrfcomposite.h"
+#include "bspline3.h"
+#ifdef TPS3M
+#include "tpspline3m.h"
+#else
+#include "tpspline3.h"
+#endif
+#include "lrfsliced3d.h"
+#include "apositionenergyrecords.h"
+#include "ajsontools.h"
+
+#include <QDebug>
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ---- SIMD backends: all nodes of the grid are processed in lanes of Width floats ----
+namespace
+{
+#if defined(__AVX512F__)
+typedef __m512    VFloat;
+typedef __m512i   VInt;
+typedef __mmask16 VMask;
+const int Width = 16;
+inline VFloat vLoad(const float * p)            {return _mm512_loadu_ps(p);}
+inline void   vStore(float * p, VFloat a)       {_mm512_storeu_ps(p, a);}
+inline VFloat vSet(float a)                     {return _mm512_set1_ps(a);}
+inline VFloat vAdd(VFloat a, VFloat b)          {return _mm512_add_ps(a, b);}
+inline VFloat vSub(VFloat a, VFloat b)          {return _mm512_sub_ps(a, b);}
+inline VFloat vMul(VFloat a, VFloat b)          {return _mm512_mul_ps(a, b);}
+inline VFloat vDiv(VFloat a, VFloat b)          {return _mm512_div_ps(a, b);}
+inline VFloat vFma(VFloat a, VFloat b, VFloat c){return _mm512_fmadd_ps(a, b, c);}
+inline VFloat vSqrt(VFloat a)                   {return _mm512_sqrt_ps(a);}
+inline VFloat vMax(VFloat a, VFloat b)          {return _mm512_max_ps(a, b);}
+inline VMask  vLt(VFloat a, VFloat b)           {return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);}
+inline VMask  vLe(VFloat a, VFloat b)           {return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ);}
+inline VMask  vOr(VMask a, VMask b)             {return a | b;}
+inline VMask  vNoMask()                         {return 0;}
+inline VFloat vSelect(VMask m, VFloat a, VFloat b) {return _mm512_mask_blend_ps(m, b, a);}
+inline VInt   vTrunc(VFloat a)                  {return _mm512_cvttps_epi32(a);}
+inline VFloat vToFloat(VInt a)                  {return _mm512_cvtepi32_ps(a);}
+inline VInt   vSetI(int a)                      {return _mm512_set1_epi32(a);}
+inline VInt   vAddI(VInt a, VInt b)             {return _mm512_add_epi32(a, b);}
+inline VInt   vSubI(VInt a, VInt b)             {return _mm512_sub_epi32(a, b);}
+inline VInt   vMulI(VInt a, VInt b)             {return _mm512_mullo_epi32(a, b);}
+inline VInt   vClampI(VInt a, int lo, int hi)   {return _mm512_min_epi32(_mm512_max_epi32(a, vSetI(lo)), vSetI(hi));}
+inline VFloat vGather(const float * base, VInt i) {return _mm512_i32gather_ps(i, base, 4);}
+inline VInt   vBits(VFloat a)                   {return _mm512_castps_si512(a);}
+inline VFloat vFromBits(VInt a)                 {return _mm512_castsi512_ps(a);}
+inline VInt   vShift23(VInt a)                  {return _mm512_srli_epi32(a, 23);}
+inline VInt   vAndI(VInt a, VInt b)             {return _mm512_and_si512(a, b);}
+inline VInt   vOrI(VInt a, VInt b)              {return _mm512_or_si512(a, b);}
+#elif defined(__AVX2__)
+typedef __m256  VFloat;
+typedef __m256i VInt;
+typedef __m256  VMask;
+const int Width = 8;
+inline VFloat vLoad(const float * p)            {return _mm256_loadu_ps(p);}
+inline void   vStore(float * p, VFloat a)       {_mm256_storeu_ps(p, a);}
+inline VFloat vSet(float a)                     {return _mm256_set1_ps(a);}
+inline VFloat vAdd(VFloat a, VFloat b)          {return _mm256_add_ps(a, b);}
+inline VFloat vSub(VFloat a, VFloat b)          {return _mm256_sub_ps(a, b);}
+inline VFloat vMul(VFloat a, VFloat b)          {return _mm256_mul_ps(a, b);}
+inline VFloat vDiv(VFloat a, VFloat b)          {return _mm256_div_ps(a, b);}
+#ifdef __FMA__
+inline VFloat vFma(VFloat a, VFloat b, VFloat c){return _mm256_fmadd_ps(a, b, c);}
+#else
+inline VFloat vFma(VFloat a, VFloat b, VFloat c){return _mm256_add_ps(_mm256_mul_ps(a, b), c);}
+#endif
+inline VFloat vSqrt(VFloat a)                   {return _mm256_sqrt_ps(a);}
+inline VFloat vMax(VFloat a, VFloat b)          {return _mm256_max_ps(a, b);}
+inline VMask  vLt(VFloat a, VFloat b)           {return _mm256_cmp_ps(a, b, _CMP_LT_OQ);}
+inline VMask  vLe(VFloat a, VFloat b)           {return _mm256_cmp_ps(a, b, _CMP_LE_OQ);}
+inline VMask  vOr(VMask a, VMask b)             {return _mm256_or_ps(a, b);}
+inline VMask  vNoMask()                         {return _mm256_setzero_ps();}
+inline VFloat vSelect(VMask m, VFloat a, VFloat b) {return _mm256_blendv_ps(b, a, m);}
+inline VInt   vTrunc(VFloat a)                  {return _mm256_cvttps_epi32(a);}
+inline VFloat vToFloat(VInt a)                  {return _mm256_cvtepi32_ps(a);}
+inline VInt   vSetI(int a)                      {return _mm256_set1_epi32(a);}
+inline VInt   vAddI(VInt a, VInt b)             {return _mm256_add_epi32(a, b);}
+inline VInt   vSubI(VInt a, VInt b)             {return _mm256_sub_epi32(a, b);}
+inline VInt   vMulI(VInt a, VInt b)             {return _mm256_mullo_epi32(a, b);}
+inline VInt   vClampI(VInt a, int lo, int hi)   {return _mm256_min_epi32(_mm256_max_epi32(a, vSetI(lo)), vSetI(hi));}
+inline VFloat vGather(const float * base, VInt i) {return _mm256_i32gather_ps(base, i, 4);}
+inline VInt   vBits(VFloat a)                   {return _mm256_castps_si256(a);}
+inline VFloat vFromBits(VInt a)                 {return _mm256_castsi256_ps(a);}
+inline VInt   vShift23(VInt a)                  {return _mm256_srli_epi32(a, 23);}
+inline VInt   vAndI(VInt a, VInt b)             {return _mm256_and_si256(a, b);}
+inline VInt   vOrI(VInt a, VInt b)              {return _mm256_or_si256(a, b);}
+#else
+typedef float VFloat;
+typedef int   VInt;
+typedef bool  VMask;
+const int Width = 1;
+inline VFloat vLoad(const float * p)            {return *p;}
+inline void   vStore(float * p, VFloat a)       {*p = a;}
+inline VFloat vSet(float a)                     {return a;}
+inline VFloat vAdd(VFloat a, VFloat b)          {return a + b;}
+inline VFloat vSub(VFloat a, VFloat b)          {return a - b;}
+inline VFloat vMul(VFloat a, VFloat b)          {return a * b;}
+inline VFloat vDiv(VFloat a, VFloat b)          {return a / b;}
+inline VFloat vFma(VFloat a, VFloat b, VFloat c){return a * b + c;}
+inline VFloat vSqrt(VFloat a)                   {return std::sqrt(a);}
+inline VFloat vMax(VFloat a, VFloat b)          {return std::max(a, b);}
+inline VMask  vLt(VFloat a, VFloat b)           {return a < b;}
+inline VMask  vLe(VFloat a, VFloat b)           {return a <= b;}
+inline VMask  vOr(VMask a, VMask b)             {return a || b;}
+inline VMask  vNoMask()                         {return false;}
+inline VFloat vSelect(VMask m, VFloat a, VFloat b) {return m ? a : b;}
+inline VInt   vTrunc(VFloat a)                  {return (a < 2.0e9f && a > -2.0e9f) ? (int)a : INT32_MIN;}
+inline VFloat vToFloat(VInt a)                  {return a;}
+inline VInt   vSetI(int a)                      {return a;}
+inline VInt   vAddI(VInt a, VInt b)             {return a + b;}
+inline VInt   vSubI(VInt a, VInt b)             {return a - b;}
+inline VInt   vMulI(VInt a, VInt b)             {return a * b;}
+inline VInt   vClampI(VInt a, int lo, int hi)   {return std::min(std::max(a, lo), hi);}
+inline VFloat vGather(const float * base, VInt i) {return base[i];}
+#endif
+
+// natural log with the accuracy of __logf used by the GPU kernels (Cephes polynomial)
+inline VFloat vLog(VFloat x)
+{
+#if defined(__AVX512F__) || defined(__AVX2__)
+    x = vMax(x, vSet(1.0e-30f));
+    const VInt bits = vBits(x);
+    VFloat e = vToFloat(vSubI(vShift23(bits), vSetI(126)));
+    VFloat m = vFromBits(vOrI(vAndI(bits, vSetI(0x007fffff)), vSetI(0x3f000000))); // [0.5, 1)
+
+    const VMask small = vLt(m, vSet(0.707106781186547524f));
+    e = vSelect(small, vSub(e, vSet(1.0f)), e);
+    m = vSub(vSelect(small, vAdd(m, m), m), vSet(1.0f));
+
+    const VFloat z = vMul(m, m);
+    VFloat y = vSet(7.0376836292E-2f);
+    y = vFma(y, m, vSet(-1.1514610310E-1f));
+    y = vFma(y, m, vSet( 1.1676998740E-1f));
+    y = vFma(y, m, vSet(-1.2420140846E-1f));
+    y = vFma(y, m, vSet( 1.4249322787E-1f));
+    y = vFma(y, m, vSet(-1.6668057665E-1f));
+    y = vFma(y, m, vSet( 2.0000714765E-1f));
+    y = vFma(y, m, vSet(-2.4999993993E-1f));
+    y = vFma(y, m, vSet( 3.3333331174E-1f));
+    y = vMul(vMul(y, m), z);
+    y = vFma(e, vSet(-2.12194440e-4f), y);
+    y = vFma(z, vSet(-0.5f), y);
+    return vAdd(vAdd(m, y), vMul(e, vSet(0.693359375f)));
+#else
+    return std::log(x);
+#endif
+}
+
+// cubic B-spline on the uniform grid with nint intervals: coef[ix .. ix+3]
+inline VFloat vSpline1D(const float * coef, VFloat xi, int nint)
+{
+    const VInt   ix = vClampI(vTrunc(xi), 0, nint-1);
+    const VFloat xf = vSub(xi, vToFloat(ix));
+
+    const VFloat c0 = vGather(coef, ix);
+    const VFloat c1 = vGather(coef, vAddI(ix, vSetI(1)));
+    const VFloat c2 = vGather(coef, vAddI(ix, vSetI(2)));
+    const VFloat c3 = vGather(coef, vAddI(ix, vSetI(3)));
+
+    const VFloat a2 = vAdd(vAdd(c0, c1), c2);                         // c0 + c1 + c2
+    const VFloat a1 = vMul(c1, vSet(3.0f));                           // 3*c1
+    const VFloat p0 = vAdd(a2, a1);                                   // c0 + 4*c1 + c2
+    const VFloat p2 = vMul(vSub(a2, a1), vSet(3.0f));                 // 3*c0 - 6*c1 + 3*c2
+    const VFloat p1 = vMul(vSub(c2, c0), vSet(3.0f));                 // 3*c2 - 3*c0
+    const VFloat p3 = vAdd(vSub(vSub(vAdd(c0, c0), a1), p2), c3);     // -c0 + 3*c1 - 3*c2 + c3
+
+    const VFloat poly = vFma(xf, vFma(xf, vFma(xf, p3, p2), p1), p0);
+    return vMul(poly, vSet(1.0f/6.0f));
+}
+
+// bicubic B-spline: (nintx+3) x (ninty+3) coefficients, x runs fastest
+inline VFloat vSpline2D(const float * coef, VFloat xi, VFloat yi, int nintx, int ninty)
+{
+    const VInt   ix  = vClampI(vTrunc(xi), 0, nintx-1);
+    const VInt   iy  = vClampI(vTrunc(yi), 0, ninty-1);
+    const VFloat xf  = vSub(xi, vToFloat(ix));
+    const VFloat yf  = vSub(yi, vToFloat(iy));
+    const VFloat xff = vSub(vSet(1.0f), xf);
+    const VFloat yff = vSub(vSet(1.0f), yf);
+
+    VFloat xx[4], yy[4];
+    xx[0] = vMul(vMul(xff, xff), xff);
+    xx[1] = vFma(vMul(xf, xf), vSub(vMul(xf, vSet(3.0f)), vSet(6.0f)), vSet(4.0f));
+    xx[2] = vFma(xf, vFma(xf, vAdd(vMul(xf, vSet(-3.0f)), vSet(3.0f)), vSet(3.0f)), vSet(1.0f));
+    xx[3] = vMul(vMul(xf, xf), xf);
+    yy[0] = vMul(vMul(yff, yff), yff);
+    yy[1] = vFma(vMul(yf, yf), vSub(vMul(yf, vSet(3.0f)), vSet(6.0f)), vSet(4.0f));
+    yy[2] = vFma(yf, vFma(yf, vAdd(vMul(yf, vSet(-3.0f)), vSet(3.0f)), vSet(3.0f)), vSet(1.0f));
+    yy[3] = vMul(vMul(yf, yf), yf);
+
+    const int nbasx = nintx + 3;
+    const VInt k0 = vAddI(vMulI(iy, vSetI(nbasx)), ix);
+    VFloat lrf = vSet(0);
+    for (int jy = 0; jy < 4; jy++)
+    {
+        const VInt k = vAddI(k0, vSetI(jy * nbasx));
+        VFloat row = vMul(vGather(coef, k), xx[0]);
+        row = vFma(vGather(coef, vAddI(k, vSetI(1))), xx[1], row);
+        row = vFma(vGather(coef, vAddI(k, vSetI(2))), xx[2], row);
+        row = vFma(vGather(coef, vAddI(k, vSetI(3))), xx[3], row);
+        lrf = vFma(row, yy[jy], lrf);
+    }
+    return vMul(lrf, vSet(1.0f/36.0f));
+}
+
+// ---- LRF evaluators: row is the flattened lrf data of one PM ----
+struct AAxialEval
+{
+    int   floatsPerPM;
+    bool  bCompressed;
+    float r0, a, b, lam2;
+    static const bool bIgnoredAffectRange = false;
+
+    float compress(float r) const
+    {
+        const float dr = r - r0;
+        return b + dr*a - std::sqrt(dr*dr + lam2);
+    }
+
+    VFloat operator()(const float * row, float pmX, float pmY, VFloat X, VFloat Y, VMask & out) const
+    {
+        const VFloat dx = vSub(X, vSet(pmX));
+        const VFloat dy = vSub(Y, vSet(pmY));
+        VFloat r = vSqrt(vFma(dx, dx, vMul(dy, dy)));
+        float  rmax = row[floatsPerPM-1];
+        out = vOr(out, vLt(vSet(rmax), r));
+
+        if (bCompressed)
+        {
+            const VFloat dr = vSub(r, vSet(r0));
+            r = vSub(vFma(dr, vSet(a), vSet(b)), vSqrt(vFma(dr, dr, vSet(lam2))));
+            r = vMax(r, vSet(0));
+            rmax = compress(rmax);
+        }
+        const int nint = floatsPerPM - 4;
+        return vSpline1D(row, vMul(r, vSet(nint / rmax)), nint);
+    }
+};
+
+struct AXYEval
+{
+    int floatsPerPM;
+    int coefOffset;  // 0 for XY, axial part size for Composite
+    int nintx, ninty;
+    static const bool bIgnoredAffectRange = true;
+
+    VFloat operator()(const float * row, float, float, VFloat X, VFloat Y, VMask & out) const
+    {
+        const float * par = row + floatsPerPM - 9; //dx, dy, sinphi, cosphi, flip,  minX, maxX, minY, maxY
+        const VFloat xtmp = vAdd(X, vSet(par[0]));
+        const VFloat ytmp = vAdd(Y, vSet(par[1]));
+        const VFloat XL = vSub(vMul(xtmp, vSet(par[3])), vMul(ytmp, vSet(par[2])));
+        VFloat YL = vFma(xtmp, vSet(par[2]), vMul(ytmp, vSet(par[3])));
+        if (par[4] > 0) YL = vSub(vSet(0), YL); //with flip
+
+        out = vOr(out, vOr(vLt(XL, vSet(par[5])), vLt(vSet(par[6]), XL)));
+        out = vOr(out, vOr(vLt(YL, vSet(par[7])), vLt(vSet(par[8]), YL)));
+
+        const VFloat xi = vMul(vSub(XL, vSet(par[5])), vSet(nintx / (par[6] - par[5])));
+        const VFloat yi = vMul(vSub(YL, vSet(par[7])), vSet(ninty / (par[8] - par[7])));
+        return vSpline2D(row + coefOffset, xi, yi, nintx, ninty);
+    }
+};
+
+struct ACompositeEval
+{
+    AAxialEval Axial;
+    AXYEval    XY;
+    static const bool bIgnoredAffectRange = false;
+
+    VFloat operator()(const float * row, float pmX, float pmY, VFloat X, VFloat Y, VMask & out) const
+    {
+        const VFloat lrfAxial = Axial(row, pmX, pmY, X, Y, out);
+        return vAdd(lrfAxial, XY(row, pmX, pmY, X, Y, out));
+    }
+};
+} // namespace
+
+// ---------------------------------------------------
+
+void ASimdGridScratch::resize(int numNodes, int numPMs)
+{
+  const int numPadded = (numNodes + Width - 1) / Width * Width;
+  NodeX.resize(numPadded);
+  NodeY.resize(numPadded);
+  SumLRF.resize(numPadded);
+  SumSig2overLRF.resize(numPadded);
+  SumSigLnLRF.resize(numPadded);
+  Bad.resize(numPadded);
+  Signal.resize(numPMs);
+  Used.resize(numPMs);
+}
+
+ASimdGridManager::ASimdGridManager(APmHub* PMs, APmGroupsManager* PMgroups, SensorLRFs* SensLRF, EventsDataClass *eventsDataHub, ReconstructionSettings *RecSet, int currentGroup) :
+   PMs(PMs), PMgroups(PMgroups), SensLRF(SensLRF), EventsDataHub(eventsDataHub), CurrentGroup(currentGroup)
+{
+  QJsonObject js = RecSet->CGonCUDAsettings;
+  BlockSizeXY = 7;
+  Iterations = 6;
+  Scale = 10.0;
+  ScaleReductionFactor = 2.0;
+  OffsetOption = 0;
+  OffsetX = OffsetY = 0;
+  MLorChi2 = 1;
+  parseJson(js, "ThreadBlockXY", BlockSizeXY);
+  parseJson(js, "Iterations", Iterations);
+  parseJson(js, "StartX", OffsetX);
+  parseJson(js, "StartY", OffsetY);
+  parseJson(js, "OptimizeMLChi2", MLorChi2);
+  //have to invert - GUI has changed (same as for CUDA):
+  if (MLorChi2 == 0) MLorChi2 = 1;
+  else MLorChi2 = 0;
+  parseJson(js, "ScaleReduction", ScaleReductionFactor);
+  parseJson(js, "StartStep", Scale);
+  parseJson(js, "StartOption", OffsetOption);
+
+  IgnoreLowSigPMs = RecSet->fUseDynamicPassivesSignal;
+  IgnoreThresholdLow = RecSet->SignalThresholdLow;
+  IgnoreThresholdHigh = RecSet->SignalThresholdHigh;
+  IgnoreFarPMs = RecSet->fUseDynamicPassivesDistance;
+  IgnoreDistance = RecSet->MaxDistance;
+}
+
+QString ASimdGridManager::GetInstructionSet()
+{
+#if defined(__AVX512F__)
+  return "AVX-512";
+#elif defined(__AVX2__)
+  return "AVX2";
+#else
+  return "scalar";
+#endif
+}
+
+bool ASimdGridManager::Configure()
+{
+  if (EventsDataHub->Events.isEmpty())
+    {
+      LastError = "There are no events to reconstruct!";
+      return false;
+    }
+  if (OffsetOption == 3 && EventsDataHub->isScanEmpty() )
+    {
+      LastError = "Start from true XY selected, but scan data are empty!";
+      return false;
+    }
+  if (!SensLRF->isAllLRFsDefined())
+    {
+      LastError = "LRFs are not defined!";
+      return false;
+    }
+  if (BlockSizeXY < 1 || Iterations < 1)
+    {
+      LastError = "Invalid grid settings!";
+      return false;
+    }
+  numPMs = PMs->count();
+  numPMsStaticActive = PMgroups->countActives();
+  if (numPMsStaticActive<2)
+    {
+      LastError = "Not enough active PMs: "+QString::number(numPMsStaticActive)+" are defined!";
+      return false;
+    }
+
+  int iFirstActivePM = 0;
+  for (;iFirstActivePM<numPMs; iFirstActivePM++)
+    if (PMgroups->isActive(iFirstActivePM)) break;
+  const LRF2* lrf =  (*SensLRF)[iFirstActivePM];
+  const QString method = lrf->type();
+  if (method == "Axial") Method = 0;
+  else if (method == "XY") Method = 1;
+  else if (method == "Sliced3D") Method = 2;
+  else if (method == "ComprAxial") Method = 3;
+  else if (method == "Composite") Method = 4;
+  else
+    {
+      LastError = "Unknown/non-implemented LRF parametrization method.\nCurrently implemented: Axial, Compessed_Axial, XY, Sliced3D, Composite";
+      return false;
+    }
+
+  //all LRFs of the active PMs have to have the same type and settings
+  QJsonObject json0 = lrf->reportSettings();
+  for (int ipm=iFirstActivePM+1; ipm<numPMs; ipm++)
+    if (PMgroups->isActive(ipm) && json0 != (*SensLRF)[ipm]->reportSettings())
+      {
+        LastError = "All lrfs have to have the same settings!";
+        return false;
+      }
+
+  ActivePMs.clear();
+  PMsX.clear();
+  PMsY.clear();
+  lrfData.clear();
+  SliceZ.clear();
+  ConfigurePMcenters();
+  switch (Method)
+    {
+    case 0:
+    case 3:
+      ConfigureLRFs_Axial();
+      break;
+    case 1:
+      ConfigureLRFs_XY();
+      break;
+    case 2:
+      ConfigureLRFs_Sliced3D();
+      break;
+    case 4:
+      ConfigureLRFs_Composite();
+      break;
+    }
+
+  qDebug() << "-->Grid reconstruction on CPU, method:" << method << "Active PMs:" << numPMsStaticActive << "Instruction set:" << GetInstructionSet();
+  LastError = "";
+  return true;
+}
+
+void ASimdGridManager::SetElapsedTime(double ms, int numEvents)
+{
+  usPerEvent = (numEvents > 0) ? 1000.0*ms/numEvents : 0;
+}
+
+void ASimdGridManager::ConfigurePMcenters()
+{
+   for (int ipm=0; ipm<numPMs; ipm++)
+    if (PMgroups->isActive(ipm))
+      {
+        ActivePMs.append(ipm);
+        PMsX.append(PMs->X(ipm));
+        PMsY.append(PMs->Y(ipm));
+      }
+}
+
+void ASimdGridManager::ConfigureLRFs_Axial()
+{
+  LRFaxial *lrf = (LRFaxial*)(*SensLRF)[ActivePMs.first()];
+  int RadialNodes = lrf->getNint();
+
+  lrfFloatsPerPM = RadialNodes+3+1; // (nodes+3) spline coefficients + maxRadius
+  lrfData.resize(1);
+  lrfData[0].resize(numPMsStaticActive * lrfFloatsPerPM);
+  for (int ipm = 0; ipm < numPMsStaticActive; ipm++)
+    {
+      LRFaxial *lrf = (LRFaxial*)(*SensLRF)[ActivePMs.at(ipm)];
+      double gain = SensLRF->getIteration()->sensor(ActivePMs.at(ipm))->GetGain();
+      std::vector <Bspline3::value_type> coef = lrf->getSpline()->GetCoef();
+      for (int i=0; i<lrfFloatsPerPM-1; i++)
+         lrfData[0][lrfFloatsPerPM*ipm + i] = coef[i]*gain;
+      lrfData[0][lrfFloatsPerPM*ipm + lrfFloatsPerPM-1] = lrf->getRmax();
+    }
+
+  fCompressed = (Method == 3);
+  if (fCompressed)
+    {
+      LRFcAxial *lrf = (LRFcAxial*)(*SensLRF)[ActivePMs.first()];
+      comp_r0 = lrf->getCompr_r0();
+      comp_a = lrf->getCompr_a();
+      comp_b = lrf->getCompr_b();
+      comp_lam2 = lrf->getCompr_lam2();
+    }
+}
+
+void ASimdGridManager::ConfigureLRFs_XY()
+{
+  LRFxy *lrf = (LRFxy*)(*SensLRF)[ActivePMs.first()];
+  p1 = lrf->getNintX();
+  p2 = lrf->getNintY();
+
+  int nodesDataSize = (p1+3) * (p2+3);  //(nodes+3) coeff in x * (nodes+3) coeff in y
+  lrfFloatsPerPM = nodesDataSize + 9; // adding:   dx, dy, sinphi, cosphi, flip,  minX, maxX, minY, maxY
+  lrfData.resize(1);
+  lrfData[0].resize(numPMsStaticActive * lrfFloatsPerPM);
+
+  for (int ipm = 0; ipm < numPMsStaticActive; ipm++)
+    {
+      PMsensor *sensor = SensLRF->getIteration()->sensor(ActivePMs.at(ipm));
+      LRFxy *lrf = (LRFxy*)sensor->GetLRF();
+      double gain = sensor->GetGain();
+      std::vector <double> coef = lrf->getSpline()->GetCoef();
+      float * row = lrfData[0].data() + lrfFloatsPerPM*ipm;
+      for (int i=0; i<nodesDataSize; i++) row[i] = coef[i] * gain;
+
+      double dx, dy, phi;
+      bool fFlip;
+      sensor->GetTransform(&dx, &dy, &phi, &fFlip);
+      row[lrfFloatsPerPM-9] = dx;
+      row[lrfFloatsPerPM-8] = dy;
+      row[lrfFloatsPerPM-7] = sin(phi);
+      row[lrfFloatsPerPM-6] = cos(phi);
+      row[lrfFloatsPerPM-5] = (fFlip ? 1.0 : -1.0);
+      row[lrfFloatsPerPM-4] = lrf->getXmin();
+      row[lrfFloatsPerPM-3] = lrf->getXmax();
+      row[lrfFloatsPerPM-2] = lrf->getYmin();
+      row[lrfFloatsPerPM-1] = lrf->getYmax();
+    }
+}
+
+void ASimdGridManager::ConfigureLRFs_Sliced3D()
+{
+  LRFsliced3D *lrf = (LRFsliced3D*)(*SensLRF)[ActivePMs.first()];
+  p1 = lrf->getNintX();
+  p2 = lrf->getNintY();
+  int zSlices = lrf->getNintZ();
+  for (int iz=0; iz<zSlices; iz++) SliceZ.append(lrf->getSliceMedianZ(iz)); //like in CPU based
+
+  int nodesDataSize = (p1+3) * (p2+3);
+  lrfFloatsPerPM = nodesDataSize + 9;
+  lrfData.resize(zSlices);
+
+  for (int iz=0; iz<zSlices; iz++)
+    {
+      lrfData[iz].resize(numPMsStaticActive * lrfFloatsPerPM);
+      for (int ipm = 0; ipm < numPMsStaticActive; ipm++)
+        {
+          LRFsliced3D *lrf = (LRFsliced3D*)(*SensLRF)[ActivePMs.at(ipm)];
+          const PMsensor *sensor = SensLRF->getIteration()->sensor(ActivePMs.at(ipm));
+          double gain = sensor->GetGain();
+          std::vector <double> coef = lrf->getSpline(iz)->GetCoef();
+          float * row = lrfData[iz].data() + lrfFloatsPerPM*ipm;
+          for (int i=0; i<nodesDataSize; i++) row[i] = coef[i] * gain;
+
+          double dx, dy, phi;
+          bool fFlip;
+          sensor->GetTransform(&dx, &dy, &phi, &fFlip);
+          row[lrfFloatsPerPM-9] = dx;
+          row[lrfFloatsPerPM-8] = dy;
+          row[lrfFloatsPerPM-7] = sin(phi);
+          row[lrfFloatsPerPM-6] = cos(phi);
+          row[lrfFloatsPerPM-5] = (fFlip ? 1.0 : -1.0);
+          row[lrfFloatsPerPM-4] = lrf->getXmin();
+          row[lrfFloatsPerPM-3] = lrf->getXmax();
+          row[lrfFloatsPerPM-2] = lrf->getYmin();
+          row[lrfFloatsPerPM-1] = lrf->getYmax();
+        }
+    }
+}
+
+void ASimdGridManager::ConfigureLRFs_Composite()
+{
+  const LRFcomposite* lrfComposite = dynamic_cast<const LRFcomposite*>( (*SensLRF)[ActivePMs.first()] );
+  const LRFaxial *lrfAxial = dynamic_cast<const LRFaxial*>( lrfComposite->lrfdeck.at(0) );
+  lrfFloatsAxialPerPM = lrfAxial->getNint()+3+1; // (nodes+3) spline coefficients + maxRadius
+  fCompressed = (lrfAxial->type() == "ComprAxial");
+  if (fCompressed)
+    {
+      const LRFcAxial *lrfCA = dynamic_cast<const LRFcAxial*>( lrfComposite->lrfdeck.at(0) );
+      comp_r0 = lrfCA->getCompr_r0();
+      comp_a = lrfCA->getCompr_a();
+      comp_b = lrfCA->getCompr_b();
+      comp_lam2 = lrfCA->getCompr_lam2();
+    }
+  const LRFxy *lrfXY = dynamic_cast<const LRFxy*>( lrfComposite->lrfdeck.at(1) );
+  p1 = lrfXY->getNintX();
+  p2 = lrfXY->getNintY();
+  int XYnodesDataSize = (p1+3) * (p2+3);
+  lrfFloatsPerPM = lrfFloatsAxialPerPM + XYnodesDataSize + 9;
+  lrfData.resize(1);
+  lrfData[0].resize(numPMsStaticActive * lrfFloatsPerPM);
+
+  for (int ipm = 0; ipm < numPMsStaticActive; ipm++)
+    {
+      const LRFcomposite *lrfComposite = dynamic_cast<const LRFcomposite*>( (*SensLRF)[ActivePMs.at(ipm)] );
+      const LRFaxial *lrfAxial = dynamic_cast<const LRFaxial*>( lrfComposite->lrfdeck.at(0) );
+      const LRFxy *lrfXY = dynamic_cast<const LRFxy*>( lrfComposite->lrfdeck.at(1) );
+      PMsensor *sensor = SensLRF->getIteration()->sensor(ActivePMs.at(ipm));
+      double gain = sensor->GetGain();
+      float * row = lrfData[0].data() + lrfFloatsPerPM*ipm;
+
+      std::vector<Bspline3::value_type> coefAxial = lrfAxial->getSpline()->GetCoef();
+      for (int i=0; i<lrfFloatsAxialPerPM-1; i++) row[i] = coefAxial[i]*gain;
+      row[lrfFloatsAxialPerPM-1] = lrfAxial->getRmax();
+
+      std::vector<double> coef = lrfXY->getSpline()->GetCoef();
+      for (int i=0; i<XYnodesDataSize; i++) row[lrfFloatsAxialPerPM + i] = coef[i] * gain;
+
+      double dx, dy, phi;
+      bool fFlip;
+      sensor->GetTransform(&dx, &dy, &phi, &fFlip);
+      row[lrfFloatsPerPM-9] = dx;
+      row[lrfFloatsPerPM-8] = dy;
+      row[lrfFloatsPerPM-7] = sin(phi);
+      row[lrfFloatsPerPM-6] = cos(phi);
+      row[lrfFloatsPerPM-5] = (fFlip ? 1.0 : -1.0);
+      row[lrfFloatsPerPM-4] = lrfXY->getXmin();
+      row[lrfFloatsPerPM-3] = lrfXY->getXmax();
+      row[lrfFloatsPerPM-2] = lrfXY->getYmin();
+      row[lrfFloatsPerPM-1] = lrfXY->getYmax();
+    }
+}
+
+bool ASimdGridManager::getStartXY(int iev, float &X, float &Y) const
+{
+  switch (OffsetOption)
+  {
+  case 0: //CoG XY -> center of grid
+    {
+      const AReconRecord* thisEv = EventsDataHub->ReconstructionData.at(0).at(iev);
+      if (!thisEv->ReconstructionOK) return false;
+      X = thisEv->xCoG;
+      Y = thisEv->yCoG;
+      return true;
+    }
+  case 1: //PM with maximum signal (corrected for gain) -> center of grid
+    {
+      const AReconRecord* thisEv = EventsDataHub->ReconstructionData.at(0).at(iev);
+      if (!thisEv->ReconstructionOK) return false;
+      X = PMs->X(thisEv->iPMwithMaxSignal);
+      Y = PMs->Y(thisEv->iPMwithMaxSignal);
+      return true;
+    }
+  case 2: //fixed initial grid center
+    X = OffsetX;
+    Y = OffsetY;
+    return true;
+  case 3: //true XY position
+    X = EventsDataHub->Scan.at(iev)->Points[0].r[0];
+    Y = EventsDataHub->Scan.at(iev)->Points[0].r[1];
+    return true;
+  default:
+    return false;
+  }
+}
+
+template <class Eval>
+void ASimdGridManager::evaluateNodes(const Eval & eval, const float * lrf, int numPadded, ASimdGridScratch & s) const
+{
+  const bool bML = (MLorChi2 == 0);
+  for (int ipm = 0; ipm < numPMsStaticActive; ipm++)
+    {
+      const bool bUsed = s.Used[ipm];
+      if (!bUsed && !Eval::bIgnoredAffectRange) continue;
+
+      const float * row = lrf + lrfFloatsPerPM * ipm;
+      const VFloat tsig  = vSet(s.Signal[ipm]);
+      const VFloat tsig2 = vSet(s.Signal[ipm] * s.Signal[ipm]);
+
+      for (int n = 0; n < numPadded; n += Width)
+        {
+          VMask bad = vNoMask();
+          VFloat lrfVal = eval(row, PMsX.at(ipm), PMsY.at(ipm), vLoad(&s.NodeX[n]), vLoad(&s.NodeY[n]), bad);
+          if (bUsed) bad = vOr(bad, vLe(lrfVal, vSet(0)));
+          vStore(&s.Bad[n], vSelect(bad, vSet(1.0f), vLoad(&s.Bad[n])));
+          if (!bUsed) continue;
+
+          lrfVal = vSelect(bad, vSet(1.0f), lrfVal); //keeps the sums finite, the node is discarded anyway
+          vStore(&s.SumLRF[n], vAdd(vLoad(&s.SumLRF[n]), lrfVal));
+          vStore(&s.SumSig2overLRF[n], vAdd(vLoad(&s.SumSig2overLRF[n]), vDiv(tsig2, lrfVal)));
+          if (bML) vStore(&s.SumSigLnLRF[n], vFma(tsig, vLog(lrfVal), vLoad(&s.SumSigLnLRF[n])));
+        }
+    }
+}
+
+void ASimdGridManager::runGrid(const float * lrf, float X0, float Y0, float sumSig, int activePMs, ASimdGridScratch &s, AGridResult &result) const
+{
+  const int numNodes  = BlockSizeXY * BlockSizeXY;
+  const int numPadded = s.NodeX.size();
+  const float half = -0.5f * (BlockSizeXY - 1);
+  const bool bML = (MLorChi2 == 0);
+
+  float Xoffset = X0;
+  float Yoffset = Y0;
+  float scale = Scale;
+  int   bestNode = -1;
+  float bestEnergy = 0, bestChi2 = 1.0e10, bestProb = -1.0e10;
+
+  for (int iter = 0; iter < Iterations; iter++)
+    {
+      for (int n = 0; n < numPadded; n++)
+        {
+          s.NodeX[n] = Xoffset + scale * (half + n % BlockSizeXY);
+          s.NodeY[n] = Yoffset + scale * (half + n / BlockSizeXY);
+          s.SumLRF[n] = s.SumSig2overLRF[n] = s.SumSigLnLRF[n] = 0;
+          s.Bad[n] = (n < numNodes ? 0 : 1.0f);
+        }
+
+      switch (Method)
+        {
+        case 0:
+        case 3:
+          evaluateNodes(AAxialEval{lrfFloatsPerPM, fCompressed, comp_r0, comp_a, comp_b, comp_lam2}, lrf, numPadded, s);
+          break;
+        case 1:
+        case 2:
+          evaluateNodes(AXYEval{lrfFloatsPerPM, 0, p1, p2}, lrf, numPadded, s);
+          break;
+        case 4:
+          evaluateNodes(ACompositeEval{AAxialEval{lrfFloatsAxialPerPM, fCompressed, comp_r0, comp_a, comp_b, comp_lam2},
+                                       AXYEval{lrfFloatsPerPM, lrfFloatsAxialPerPM, p1, p2}}, lrf, numPadded, s);
+          break;
+        }
+
+      //energy ("naive" approach), probability and chi2 of the nodes; looking for the best one
+      bestNode = -1;
+      bestChi2 = 1.0e10;
+      bestProb = -1.0e10;
+      for (int n = 0; n < numNodes; n++)
+        {
+          float energy = (s.SumLRF[n] > 0 ? sumSig / s.SumLRF[n] : 1.0f);
+          if (s.Bad[n] != 0 || energy < 1.0e-10) continue;
+
+          const float chi2 = s.SumSig2overLRF[n]/energy - 2.0f*sumSig + s.SumLRF[n]*energy;
+          if (bML)
+            {
+              const float prob = s.SumSigLnLRF[n] + sumSig * std::log(energy) - s.SumLRF[n]*energy;
+              if (prob <= bestProb) continue;
+              bestProb = prob;
+            }
+          else if (chi2 >= bestChi2) continue;
+
+          bestNode = n;
+          bestChi2 = chi2;
+          bestEnergy = energy;
+        }
+
+      if (bestNode < 0) break; //all nodes are outside of the LRF range
+      Xoffset += scale * (half + bestNode % BlockSizeXY);
+      Yoffset += scale * (half + bestNode / BlockSizeXY);
+      scale /= ScaleReductionFactor;
+    }
+
+  int df = activePMs - 4;  //-1 -2XY -1energy
+  if (df < 1) df = 1;
+
+  result.bGood = (bestNode >= 0);
+  result.X = Xoffset;
+  result.Y = Yoffset;
+  result.Energy = bestEnergy;
+  result.Chi2 = (result.bGood ? bestChi2 / df : 1.0e10);
+  result.Probability = bestProb;
+}
+
+void ASimdGridManager::ReconstructEvent(int iev, ASimdGridScratch &s) const
+{
+  float X0, Y0;
+  if (!getStartXY(iev, X0, Y0)) return; //CoG failed, no need to process
+
+  s.resize(BlockSizeXY * BlockSizeXY, numPMsStaticActive);
+  AConstEventSpan signals = EventsDataHub->Events.at(iev);
+  const float ignoreDistance2 = IgnoreDistance * IgnoreDistance;
+  float sumSig = 0;
+  int activePMs = 0;
+  for (int ipm = 0; ipm < numPMsStaticActive; ipm++)
+    {
+      const float tsig = signals[ActivePMs.at(ipm)];
+      s.Signal[ipm] = tsig;
+
+      bool bUsed = true;
+      if (IgnoreLowSigPMs && (tsig < IgnoreThresholdLow || tsig > IgnoreThresholdHigh)) bUsed = false;
+      if (IgnoreFarPMs)
+        {
+          const float dx = PMsX.at(ipm) - X0;
+          const float dy = PMsY.at(ipm) - Y0;
+          if (dx*dx + dy*dy > ignoreDistance2) bUsed = false;
+        }
+      s.Used[ipm] = bUsed;
+      if (bUsed)
+        {
+          sumSig += tsig;
+          activePMs++;
+        }
+    }
+
+  AReconRecord* rec = EventsDataHub->ReconstructionData[CurrentGroup][iev];
+  AGridResult best;
+  int iBestSlice = 0;
+  for (int iz = 0; iz < lrfData.size(); iz++)
+    {
+      AGridResult res;
+      runGrid(lrfData.at(iz).data(), X0, Y0, sumSig, activePMs, s, res);
+      bool bBetter;
+      if (iz == 0) bBetter = true;
+      else if (MLorChi2 == 0) bBetter = (res.Probability > best.Probability);
+      else bBetter = (res.Chi2 < best.Chi2);
+      if (bBetter)
+        {
+          best = res;
+          iBestSlice = iz;
+        }
+    }
+
+  rec->chi2 = best.Chi2;
+  if (best.bGood)
+    {
+      rec->Points[0].r[0] = best.X;
+      rec->Points[0].r[1] = best.Y;
+      rec->Points[0].r[2] = (SliceZ.isEmpty() ? rec->zCoG : SliceZ.at(iBestSlice)); //StarterZ or loaded - already in zCoG
+      rec->Points[0].energy = best.Energy;
+      rec->ReconstructionOK = true;
+      rec->GoodEvent = true;
+    }
+  else
+    {
+      rec->ReconstructionOK = false;
+      rec->GoodEvent = false;
+    }
+}
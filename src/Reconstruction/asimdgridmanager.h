@@ -0,0 +1,113 @@
+#ifndef ASIMDGRIDMANAGER_H
+#define ASIMDGRIDMANAGER_H
+
+#include <QVector>
+#include <QString>
+
+#include <vector>
+
+class EventsDataClass;
+class APmHub;
+class APmGroupsManager;
+class SensorLRFs;
+class ReconstructionSettings;
+
+// per-thread working buffers for the grid nodes (structure of arrays, padded to the SIMD width)
+struct ASimdGridScratch
+{
+  std::vector<float> NodeX;
+  std::vector<float> NodeY;
+  std::vector<float> SumLRF;
+  std::vector<float> SumSig2overLRF;
+  std::vector<float> SumSigLnLRF;
+  std::vector<float> Bad;
+  std::vector<float> Signal;
+  std::vector<char>  Used;
+
+  void resize(int numNodes, int numPMs);
+};
+
+// Contracting grids on CPU with the same model as CudaManagerClass (settings are taken from CGonCUDAsettings):
+// LRFs of the active PMs are flattened to the same float tables as for the GPU,
+// then all nodes of the grid are evaluated with SIMD instructions (AVX-512 / AVX2 if enabled at compile time, scalar otherwise)
+// Configure() runs in the GUI thread, ReconstructEvent() is thread-safe (see CGsimdReconstructorClass)
+class ASimdGridManager
+{
+public:
+  ASimdGridManager(APmHub* PMs, APmGroupsManager* PMgroups, SensorLRFs* SensLRF, EventsDataClass* eventsDataHub, ReconstructionSettings* RecSet, int currentGroup);
+
+  bool           Configure();
+  void           ReconstructEvent(int iev, ASimdGridScratch & scratch) const;
+
+  void           SetElapsedTime(double ms, int numEvents);
+  double         GetUsPerEvent() const {return usPerEvent;}
+  const QString& GetLastError() const {return LastError;}
+  static QString GetInstructionSet();
+
+private:
+  struct AGridResult
+  {
+    float X, Y, Energy, Chi2, Probability;
+    bool  bGood;
+  };
+
+  void           ConfigurePMcenters();
+  void           ConfigureLRFs_Axial();
+  void           ConfigureLRFs_XY();
+  void           ConfigureLRFs_Sliced3D();
+  void           ConfigureLRFs_Composite();
+
+  bool           getStartXY(int iev, float & X, float & Y) const;
+  void           runGrid(const float * lrfData, float X0, float Y0, float sumSig, int activePMs, ASimdGridScratch & s, AGridResult & result) const;
+  template <class Eval>
+  void           evaluateNodes(const Eval & eval, const float * lrfData, int numPadded, ASimdGridScratch & s) const;
+
+private:
+  APmHub* PMs;
+  APmGroupsManager* PMgroups;
+  SensorLRFs* SensLRF;
+  EventsDataClass* EventsDataHub;
+  int CurrentGroup;
+
+  //outside configuration data
+  int Method = 0; //0 - Axial 2D; 1 - XY; 2 - Slices; 3 - compressed axial; 4 - Composite
+  int BlockSizeXY;
+  int Iterations;
+  float Scale;
+  float ScaleReductionFactor;
+  int OffsetOption;
+  float OffsetX;
+  float OffsetY;
+  int MLorChi2;
+  bool IgnoreLowSigPMs;
+  float IgnoreThresholdLow, IgnoreThresholdHigh;
+  bool IgnoreFarPMs;
+  float IgnoreDistance;
+  bool fCompressed = false;
+  float comp_r0 = 0;
+  float comp_a = 0;
+  float comp_b = 0;
+  float comp_lam2 = 0;
+
+  //PM data
+  QVector<int> ActivePMs; //index of the actual PM for each table entry
+  QVector<float> PMsX;
+  QVector<float> PMsY;
+  int numPMs = 0;
+  int numPMsStaticActive = 0;
+
+  //lrf data: [slice][ipm * lrfFloatsPerPM + i], one slice for 2D methods
+  QVector< QVector<float> > lrfData;
+  int lrfFloatsPerPM = 0;
+  int lrfFloatsAxialPerPM = 0; //used only for Composite lrfs
+  int p1 = 0; //parameters - nintx for XY
+  int p2 = 0; //parameters - ninty for XY
+
+  //Slices
+  QVector<float> SliceZ;
+
+  double usPerEvent = 0;
+  QString LastError;
+};
+
+#endif // ASIMDGRIDMANAGER_H
@@ -0,0 +1,7 @@
+# Stand-alone check of the G4ants streaming channel (AG4StreamChannel):
+# g4streamstub plays the role of G4ants and sends canned deposition frames,
+# g4streamcheck runs it in several modes and verifies what the channel decodes.
+# Build with qmake, then run check/g4streamcheck (the path of the stub can be given as the argument)
+
+TEMPLATE = subdirs
+SUBDIRS = stub check
@@ -0,0 +1,14 @@
+QT       -= gui
+QT       += network
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TARGET = g4streamcheck
+TEMPLATE = app
+
+INCLUDEPATH += .. ../..
+
+SOURCES += g4streamcheck.cpp \
+    ../../ag4streamchannel.cpp
+HEADERS += ../g4streamcanned.h \
+    ../../ag4streamchannel.h
@@ -0,0 +1,188 @@
+// Checks AG4StreamChannel against g4streamstub: the deposition frames have to be decoded to the canned records
+// also when they arrive in pieces, and a stream which ends without RunEnd has to be reported as a failure
+// after all complete frames are delivered; a frame header with an impossible size has to be rejected
+//
+// Usage: g4streamcheck [path to g4streamstub]; the exit code is the number of failed checks
+
+#include "g4streamcanned.h"
+#include "aparticlerecord.h"
+#include "aenergydepositioncell.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDebug>
+
+static int Failures = 0;
+
+static void check(bool ok, const QString & what)
+{
+    if (ok) qDebug() << "  ok:" << what;
+    else
+    {
+        Failures++;
+        qWarning() << "  FAILED:" << what;
+    }
+}
+
+struct AStubRunResult
+{
+    bool    bStarted = false;
+    bool    bRunEnd = false;
+    bool    bFailed = false;
+    bool    bRecordsMatch = true;
+    bool    bOrderOK = true;
+    int     numEvents = 0;
+    QString Error;
+};
+
+static bool isCannedEvent(int eventId, const QVector<AEnergyDepositionCell*> & cells)
+{
+    if (cells.size() != cannedNumCells(eventId)) return false;
+    for (int i = 0; i < cells.size(); i++)
+    {
+        const AEnergyDepositionCell * c = cells.at(i);
+        const ACannedCell e = cannedCell(eventId, i);
+        if (c->ParticleId != e.particleId || c->MaterialId != e.matId || c->eventId != eventId) return false;
+        if (c->dE != e.dE || c->time != e.time) return false;
+        for (int j = 0; j < 3; j++)
+            if (c->r[j] != e.r[j]) return false;
+    }
+    return true;
+}
+
+static AStubRunResult runStub(const QString & stubPath, const QString & mode, int firstEvent, int numEvents)
+{
+    AStubRunResult res;
+
+    AG4StreamChannel channel(QString("g4streamcheck-%1-%2").arg(mode).arg(QCoreApplication::applicationPid()));
+    if (!channel.listen())
+    {
+        res.Error = channel.ErrorString;
+        return res;
+    }
+
+    QProcess stub;
+    stub.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    stub.start(stubPath, QStringList() << channel.getFullServerName() << mode);
+    if (!channel.waitForConnection(10000))
+    {
+        res.Error = "Stub has not connected: " + stub.errorString();
+        stub.kill();
+        stub.waitForFinished(1000);
+        return res;
+    }
+    res.bStarted = true;
+
+    QByteArray primaries;
+    AParticleRecord particle;
+    particle.Id = 0;
+    particle.energy = 100.0;
+    particle.r[0] = particle.r[1] = particle.r[2] = 0;
+    particle.v[0] = particle.v[1] = 0; particle.v[2] = 1.0;
+    const QVector<AParticleRecord*> particles{&particle};
+    for (int iEvent = firstEvent; iEvent < firstEvent + numEvents; iEvent++)
+        AG4StreamChannel::appendPrimaries(primaries, iEvent, particles);
+    channel.sendFrames(primaries);
+    channel.sendFrame(AG4StreamChannel::PrimariesEnd, QByteArray());
+    channel.flush(5000);
+
+    QElapsedTimer timer;
+    timer.start();
+    int expectedEvent = firstEvent;
+    while (true)
+    {
+        const AG4StreamChannel::ReadResult r = channel.readFrame(100);
+        if (r == AG4StreamChannel::NoData)
+        {
+            if (timer.elapsed() > 20000)
+            {
+                res.Error = "Timeout";
+                res.bFailed = true;
+                break;
+            }
+            continue;
+        }
+        if (r == AG4StreamChannel::Failed)
+        {
+            res.Error = channel.ErrorString;
+            res.bFailed = true;
+            break;
+        }
+        if (channel.getFrameType() == AG4StreamChannel::RunEnd)
+        {
+            res.bRunEnd = true;
+            break;
+        }
+
+        int eventId;
+        QVector<AEnergyDepositionCell*> cells;
+        if (!channel.readDeposition(eventId, cells))
+        {
+            res.Error = channel.ErrorString;
+            res.bFailed = true;
+            break;
+        }
+        if (eventId != expectedEvent) res.bOrderOK = false;
+        if (!isCannedEvent(eventId, cells)) res.bRecordsMatch = false;
+        for (AEnergyDepositionCell * c : cells) delete c;
+        expectedEvent++;
+        res.numEvents++;
+    }
+
+    if (!stub.waitForFinished(5000)) stub.kill();
+    return res;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QString stubPath = (argc > 1 ? QString(argv[1]) : QCoreApplication::applicationDirPath() + "/../stub/g4streamstub");
+    if (!QFileInfo(stubPath).exists() && QFileInfo(stubPath + ".exe").exists()) stubPath += ".exe";
+
+    const int firstEvent = 100;
+    const int numEvents  = 7;
+
+    for (const QString & mode : QStringList{"normal", "split"})
+    {
+        qDebug() << "Mode" << mode;
+        const AStubRunResult res = runStub(stubPath, mode, firstEvent, numEvents);
+        check(res.bStarted, "stub connected " + res.Error);
+        check(!res.bFailed && res.bRunEnd, "stream completed with RunEnd " + res.Error);
+        check(res.numEvents == numEvents, QString("all events received (%1)").arg(res.numEvents));
+        check(res.bOrderOK, "events in the order of primaries");
+        check(res.bRecordsMatch, "records are equal to the canned ones");
+    }
+
+    qDebug() << "Mode truncated";
+    {
+        const AStubRunResult res = runStub(stubPath, "truncated", firstEvent, numEvents);
+        check(res.bStarted, "stub connected " + res.Error);
+        check(res.bFailed && !res.bRunEnd, "partial last frame and exit reported as failure: " + res.Error);
+        check(res.numEvents == numEvents - 1, QString("complete frames delivered (%1)").arg(res.numEvents));
+        check(res.bRecordsMatch, "records are equal to the canned ones");
+    }
+
+    qDebug() << "Mode early";
+    {
+        const AStubRunResult res = runStub(stubPath, "early", firstEvent, numEvents);
+        check(res.bStarted, "stub connected " + res.Error);
+        check(res.bFailed && !res.bRunEnd, "exit without RunEnd reported as failure: " + res.Error);
+        check(res.numEvents == 1, QString("only the first event delivered (%1)").arg(res.numEvents));
+        check(res.bRecordsMatch, "records are equal to the canned ones");
+    }
+
+    qDebug() << "Mode corrupt";
+    {
+        const AStubRunResult res = runStub(stubPath, "corrupt", firstEvent, numEvents);
+        check(res.bStarted, "stub connected " + res.Error);
+        check(res.bFailed && res.Error.startsWith("Corrupted"), "oversized frame header reported as stream error: " + res.Error);
+        check(res.numEvents == 1, QString("only the first event delivered (%1)").arg(res.numEvents));
+        check(res.bRecordsMatch, "records are equal to the canned ones");
+    }
+
+    qDebug() << (Failures == 0 ? "All checks passed" : QString("%1 check(s) failed").arg(Failures));
+    return Failures;
+}
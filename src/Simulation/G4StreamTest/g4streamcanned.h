@@ -0,0 +1,64 @@
+#ifndef G4STREAMCANNED_H
+#define G4STREAMCANNED_H
+
+#include "ag4streamchannel.h"
+
+#include <QByteArray>
+
+#include <cstring>
+
+// Deposition records sent by g4streamstub: event eventId has (eventId % 3) cells, so empty events are also present
+
+struct ACannedCell
+{
+    int    particleId;
+    int    matId;
+    double dE;
+    double r[3];
+    double time;
+};
+
+inline int cannedNumCells(int eventId)
+{
+    return eventId % 3;
+}
+
+inline ACannedCell cannedCell(int eventId, int iCell)
+{
+    ACannedCell c;
+    c.particleId = iCell;
+    c.matId      = eventId % 5;
+    c.dE         = 0.125 * (iCell + 1) + eventId;
+    c.r[0]       = eventId;
+    c.r[1]       = -0.5 * iCell;
+    c.r[2]       = 1.0e-3 * eventId * (iCell + 1);
+    c.time       = 10.0 * eventId + iCell;
+    return c;
+}
+
+// complete Deposition frame in the format of AG4StreamChannel
+inline QByteArray cannedDepositionFrame(int eventId)
+{
+    const int numCells = cannedNumCells(eventId);
+    QByteArray payload;
+    payload.append(reinterpret_cast<const char*>(&eventId),  sizeof(int));
+    payload.append(reinterpret_cast<const char*>(&numCells), sizeof(int));
+    for (int i = 0; i < numCells; i++)
+    {
+        const ACannedCell c = cannedCell(eventId, i);
+        payload.append(reinterpret_cast<const char*>(&c.particleId), sizeof(int));
+        payload.append(reinterpret_cast<const char*>(&c.matId),      sizeof(int));
+        payload.append(reinterpret_cast<const char*>(&c.dE),         sizeof(double));
+        payload.append(reinterpret_cast<const char*>(c.r),           3*sizeof(double));
+        payload.append(reinterpret_cast<const char*>(&c.time),       sizeof(double));
+    }
+
+    QByteArray frame;
+    frame.append((char)AG4StreamChannel::Deposition);
+    const quint32 size = payload.size();
+    frame.append(reinterpret_cast<const char*>(&size), sizeof(quint32));
+    frame.append(payload);
+    return frame;
+}
+
+#endif // G4STREAMCANNED_H
@@ -0,0 +1,129 @@
+// Stand-in for G4ants in the streaming mode: connects to the local server, reads the primaries
+// up to PrimariesEnd and answers every Primaries frame with a canned deposition frame (g4streamcanned.h)
+//
+// Usage: g4streamstub <serverName> <mode>
+//   normal    - all events, then RunEnd
+//   split     - as normal, but every frame is written in small pieces with pauses -> the reader sees partial frames
+//   truncated - the frame of the last event is cut in the middle, then the process exits
+//   early     - the process exits after the first event, without RunEnd
+//   corrupt   - after the first event a frame header with an impossible payload size is sent
+
+#include "g4streamcanned.h"
+
+#include <QCoreApplication>
+#include <QLocalSocket>
+#include <QThread>
+#include <QVector>
+#include <QTextStream>
+
+#include <cstring>
+
+static void writeAll(QLocalSocket & socket, const QByteArray & data)
+{
+    socket.write(data);
+    while (socket.bytesToWrite() > 0)
+        if (!socket.waitForBytesWritten(5000)) return;
+}
+
+static void writeInPieces(QLocalSocket & socket, const QByteArray & data)
+{
+    const int piece = 3; // smaller than the frame header
+    for (int i = 0; i < data.size(); i += piece)
+    {
+        writeAll(socket, data.mid(i, piece));
+        QThread::msleep(2);
+    }
+}
+
+static int finish(QLocalSocket & socket, int code)
+{
+    socket.flush();
+    socket.disconnectFromServer();
+    if (socket.state() != QLocalSocket::UnconnectedState) socket.waitForDisconnected(1000);
+    return code;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+    if (argc < 3)
+    {
+        err << "Usage: g4streamstub <serverName> <normal|split|truncated|early|corrupt>\n";
+        return 1;
+    }
+    const QString mode = argv[2];
+
+    QLocalSocket socket;
+    socket.connectToServer(argv[1]);
+    if (!socket.waitForConnected(5000))
+    {
+        err << "Cannot connect: " << socket.errorString() << "\n";
+        return 2;
+    }
+
+    // primaries: only the event ids are used
+    QVector<int> events;
+    QByteArray in;
+    bool bPrimariesEnd = false;
+    while (!bPrimariesEnd)
+    {
+        if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(5000))
+        {
+            err << "Primaries were not received\n";
+            return 3;
+        }
+        in.append(socket.readAll());
+
+        while (in.size() >= 5)
+        {
+            quint32 size;
+            memcpy(&size, in.constData() + 1, sizeof(quint32));
+            if ((quint32)in.size() < 5 + size) break;
+
+            const unsigned char type = in.at(0);
+            if (type == AG4StreamChannel::PrimariesEnd) bPrimariesEnd = true;
+            else if (type == AG4StreamChannel::Primaries && size >= sizeof(int))
+            {
+                int eventId;
+                memcpy(&eventId, in.constData() + 5, sizeof(int));
+                events << eventId;
+            }
+            in.remove(0, 5 + size);
+        }
+    }
+
+    for (int i = 0; i < events.size(); i++)
+    {
+        const QByteArray frame = cannedDepositionFrame(events.at(i));
+
+        if (mode == "truncated" && i == events.size() - 1)
+        {
+            writeAll(socket, frame.left(frame.size() / 2));
+            return finish(socket, 0);
+        }
+
+        if (mode == "split") writeInPieces(socket, frame);
+        else                 writeAll(socket, frame);
+
+        if (mode == "early") return finish(socket, 0);
+
+        if (mode == "corrupt")
+        {
+            QByteArray header(5, 0);
+            header[0] = (char)AG4StreamChannel::Deposition;
+            const quint32 size = 0xFFFFFFF0u; // negative if taken as int
+            memcpy(header.data() + 1, &size, sizeof(quint32));
+            writeAll(socket, header);
+            QThread::msleep(500); // keep the connection: the reader has to reject the header itself
+            return finish(socket, 0);
+        }
+    }
+
+    QByteArray runEnd(5, 0);
+    runEnd[0] = (char)AG4StreamChannel::RunEnd;
+    if (mode == "split") writeInPieces(socket, runEnd);
+    else                 writeAll(socket, runEnd);
+
+    return finish(socket, 0);
+}
@@ -0,0 +1,12 @@
+QT       -= gui
+QT       += network
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TARGET = g4streamstub
+TEMPLATE = app
+
+INCLUDEPATH += .. ../..
+
+SOURCES += g4streamstub.cpp
+HEADERS += ../g4streamcanned.h
@@ -0,0 +1,86 @@
+#include "aeventscheduler.h"
+
+#include <algorithm>
+
+static inline uint64_t packFrontBack(uint32_t front, uint32_t back) {return ( (uint64_t)front << 32 ) | back;}
+
+AEventScheduler::AEventScheduler(int totalEvents, int numThreads, int chunkSize) :
+    TotalEvents(totalEvents), ChunkSize(std::max(1, chunkSize)), Shares(std::max(1, numThreads))
+{
+    NumChunks = (TotalEvents + ChunkSize - 1) / ChunkSize;
+
+    const int numShares = Shares.size();
+    const int chunksPerShare = NumChunks / numShares;
+    const int remainingChunks = NumChunks % numShares;
+    int front = 0;
+    for (int iShare = 0; iShare < numShares; iShare++)
+    {
+        const int back = front + chunksPerShare + (iShare < remainingChunks ? 1 : 0);
+        Shares[iShare].FrontBack.store(packFrontBack(front, back));
+        front = back;
+    }
+}
+
+bool AEventScheduler::getChunk(int threadIndex, int & eventFrom, int & eventTo)
+{
+    const int numShares = Shares.size();
+    int iChunk = -1;
+    bool bGotChunk = takeFront(threadIndex % numShares, iChunk);
+
+    //stealing: starting from the next thread to spread the thieves over the victims
+    for (int i = 1; !bGotChunk && i < numShares; i++)
+        bGotChunk = takeBack( (threadIndex + i) % numShares, iChunk );
+
+    if (!bGotChunk) return false;
+
+    eventFrom = iChunk * ChunkSize;
+    eventTo   = std::min(TotalEvents, eventFrom + ChunkSize);
+    return true;
+}
+
+bool AEventScheduler::takeFront(int iShare, int & iChunk)
+{
+    std::atomic<uint64_t> & fb = Shares[iShare].FrontBack;
+    uint64_t old = fb.load();
+    while (true)
+    {
+        const uint32_t front = old >> 32;
+        const uint32_t back  = old & 0xFFFFFFFF;
+        if (front >= back) return false;
+        if (fb.compare_exchange_weak(old, packFrontBack(front + 1, back)))
+        {
+            iChunk = front;
+            return true;
+        }
+    }
+}
+
+bool AEventScheduler::takeBack(int iShare, int & iChunk)
+{
+    std::atomic<uint64_t> & fb = Shares[iShare].FrontBack;
+    uint64_t old = fb.load();
+    while (true)
+    {
+        const uint32_t front = old >> 32;
+        const uint32_t back  = old & 0xFFFFFFFF;
+        if (front >= back) return false;
+        if (fb.compare_exchange_weak(old, packFrontBack(front, back - 1)))
+        {
+            iChunk = back - 1;
+            return true;
+        }
+    }
+}
+
+uint32_t AEventScheduler::makeEventSeed(uint32_t runSeed, int iEvent, int attempt)
+{
+    //splitmix64 finalizer applied to the combined key
+    uint64_t z = ( (uint64_t)runSeed << 32 ) ^ ( (uint64_t)(uint32_t)iEvent ) ^ ( (uint64_t)attempt << 48 );
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= (z >> 31);
+
+    const uint32_t seed = (uint32_t)(z ^ (z >> 32));
+    return (seed == 0 ? 1 : seed); // 0 would make ROOT generators to use time-based seed
+}
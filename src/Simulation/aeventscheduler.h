@@ -0,0 +1,41 @@
+#ifndef AEVENTSCHEDULER_H
+#define AEVENTSCHEDULER_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+// Dynamic distribution of events between simulation threads
+// Events are grouped in chunks; initially every thread owns an even share of the chunks and takes them from the front,
+// a thread which has no chunks left steals them from the back of the share of another thread
+// Lock-free: the front and back of each share are packed in one atomic word and modified only by compare-exchange
+class AEventScheduler
+{
+public:
+    AEventScheduler(int totalEvents, int numThreads, int chunkSize);
+
+    bool getChunk(int threadIndex, int & eventFrom, int & eventTo); // false -> all events are already distributed
+
+    int countChunks() const {return NumChunks;}
+
+    // seed of the random generator for the given event: depends only on the run seed and the event index,
+    // attempt is increased when the event is discarded (e.g. no deposition) and has to be re-generated
+    static uint32_t makeEventSeed(uint32_t runSeed, int iEvent, int attempt = 0);
+
+private:
+    struct AShare
+    {
+        std::atomic<uint64_t> FrontBack; // front chunk index in the upper 32 bits, back (exclusive) in the lower
+        char Padding[64 - sizeof(std::atomic<uint64_t>)]; // one share per cache line
+    };
+
+    int TotalEvents;
+    int ChunkSize;
+    int NumChunks;
+    std::vector<AShare> Shares;
+
+    bool takeFront(int iShare, int & iChunk);
+    bool takeBack(int iShare, int & iChunk);
+};
+
+#endif // AEVENTSCHEDULER_H
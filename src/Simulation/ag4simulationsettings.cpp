@@ -8,6 +8,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDebug>
+#include <QCoreApplication>
 
 AG4SimulationSettings::AG4SimulationSettings()
 {
@@ -45,6 +46,7 @@ void AG4SimulationSettings::writeToJson(QJsonObject &json) const
 
     json["BinaryOutput"]  = BinaryOutput;
     json["Precision"]     = Precision;
+    json["StreamDeposition"] = StreamDeposition;
 
     json["UseTSphys"]     = UseTSphys;
 }
@@ -83,6 +85,7 @@ void AG4SimulationSettings::readFromJson(const QJsonObject &json)
 
     parseJson(json, "BinaryOutput", BinaryOutput);
     parseJson(json, "Precision",    Precision);
+    parseJson(json, "StreamDeposition", StreamDeposition);
 
     parseJson(json, "UseTSphys", UseTSphys);
 }
@@ -127,6 +130,17 @@ const QString AG4SimulationSettings::getGdmlFileName() const
     return getPath() + "Detector.gdml";
 }
 
+const QString AG4SimulationSettings::getStreamName(int iThreadNum) const
+{
+    // has to be unique if several ANTS2 instances run on the same machine
+    const QString name = QString("ants2-g4-%1-%2").arg(QCoreApplication::applicationPid()).arg(iThreadNum);
+#ifdef Q_OS_WIN
+    return "\\\\.\\pipe\\" + name;
+#else
+    return QDir::tempPath() + "/" + name;
+#endif
+}
+
 bool AG4SimulationSettings::checkPathValid() const
 {
     const QString & path = AGlobalSettings::getInstance().G4ExchangeFolder;
@@ -20,6 +20,7 @@ public:
     QMap<QString, double> StepLimits;
     bool                  BinaryOutput = false;
     int                   Precision = 6;
+    bool                  StreamDeposition = false; // primaries and deposition go over a local socket instead of files
 
     bool                  UseTSphys = false;
 
@@ -34,6 +35,7 @@ public:
     const QString getMonitorDataFileName(int iThreadNum) const;
     const QString getExitParticleFileName(int iThreadNum) const;
     const QString getGdmlFileName() const;
+    const QString getStreamName(int iThreadNum) const; // full name of the local socket (named pipe on Windows)
 
     bool  checkPathValid() const;
     bool  checkExecutableExists() const;
@@ -0,0 +1,191 @@
+#include "ag4streamchannel.h"
+#include "aparticlerecord.h"
+#include "aenergydepositioncell.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDebug>
+
+#include <cstring>
+
+AG4StreamChannel::AG4StreamChannel(const QString & name) : Name(name) {}
+
+AG4StreamChannel::~AG4StreamChannel()
+{
+    if (Socket) Socket->abort();
+    delete Socket;
+    delete Server;
+}
+
+bool AG4StreamChannel::listen()
+{
+    QLocalServer::removeServer(Name); // leftover of a crashed run
+    Server = new QLocalServer();
+    if (!Server->listen(Name))
+    {
+        ErrorString = "Cannot start local server for G4ants streaming: " + Server->errorString();
+        return false;
+    }
+    return true;
+}
+
+const QString AG4StreamChannel::getFullServerName() const
+{
+    return (Server ? Server->fullServerName() : Name);
+}
+
+bool AG4StreamChannel::waitForConnection(int msecs)
+{
+    if (!Server) return false;
+    if (!Server->waitForNewConnection(msecs)) return false;
+
+    Socket = Server->nextPendingConnection();
+    if (!Socket) return false;
+    Socket->setParent(nullptr);  // lifetime is controlled here
+    Server->close();             // only one peer is expected
+    return true;
+}
+
+bool AG4StreamChannel::isConnected() const
+{
+    return Socket && Socket->state() == QLocalSocket::ConnectedState;
+}
+
+void AG4StreamChannel::sendFrame(FrameType type, const QByteArray & payload)
+{
+    if (!Socket) return;
+    char header[HeaderSize];
+    header[0] = type;
+    const quint32 size = payload.size();
+    memcpy(header + 1, &size, sizeof(quint32));
+    Socket->write(header, HeaderSize);
+    if (size > 0) Socket->write(payload);
+}
+
+void AG4StreamChannel::sendFrames(const QByteArray & frames)
+{
+    if (Socket && !frames.isEmpty()) Socket->write(frames);
+}
+
+bool AG4StreamChannel::flush(int msecs)
+{
+    if (!Socket) return false;
+    while (Socket->bytesToWrite() > 0)
+        if (!Socket->waitForBytesWritten(msecs)) return false;
+    return true;
+}
+
+AG4StreamChannel::ReadResult AG4StreamChannel::readFrame(int msecs)
+{
+    if (!Socket)
+    {
+        ErrorString = "G4ants stream is not connected";
+        return Failed;
+    }
+
+    // drop the previous frame; compact the buffer only when the consumed part dominates
+    if (InPos > 0 && InPos * 2 > InBuffer.size())
+    {
+        InBuffer.remove(0, InPos);
+        InPos = 0;
+    }
+    Payload = nullptr;
+
+    bool bWaited = false;
+    while (true)
+    {
+        const int available = InBuffer.size() - InPos;
+        if (available >= HeaderSize)
+        {
+            const char * p = InBuffer.constData() + InPos;
+            quint32 size;
+            memcpy(&size, p + 1, sizeof(quint32));
+            if (size > MaxPayloadSize)
+            {
+                ErrorString = QString("Corrupted G4ants stream: frame size of %1 bytes").arg(size);
+                return Failed;
+            }
+            if ((quint64)available >= (quint64)HeaderSize + size)
+            {
+                FrameTypeRead = static_cast<FrameType>((unsigned char)p[0]);
+                Payload = p + HeaderSize;
+                PayloadSize = size;
+                InPos += HeaderSize + size;
+                return FrameReady;
+            }
+        }
+
+        if (Socket->bytesAvailable() > 0)
+        {
+            InBuffer.append(Socket->readAll());
+            continue;
+        }
+
+        if (bWaited) return NoData;
+        if (Socket->state() != QLocalSocket::ConnectedState)
+        {
+            ErrorString = "G4ants has closed the stream before the end of the run";
+            return Failed;
+        }
+        Socket->waitForReadyRead(msecs);
+        bWaited = true;
+    }
+}
+
+bool AG4StreamChannel::readDeposition(int & eventId, QVector<AEnergyDepositionCell*> & cells)
+{
+    const size_t cellSize = 2 * sizeof(int) + 5 * sizeof(double);
+    if (!Payload || FrameTypeRead != Deposition || PayloadSize < 2 * sizeof(int))
+    {
+        ErrorString = "Unexpected frame in G4ants deposition stream";
+        return false;
+    }
+
+    const char * p = Payload;
+    int numCells;
+    memcpy(&eventId,  p, sizeof(int)); p += sizeof(int);
+    memcpy(&numCells, p, sizeof(int)); p += sizeof(int);
+    if (numCells < 0 || PayloadSize != 2 * sizeof(int) + numCells * cellSize)
+    {
+        ErrorString = QString("Corrupted deposition frame in G4ants stream (event %1)").arg(eventId);
+        return false;
+    }
+
+    cells.reserve(cells.size() + numCells);
+    for (int i = 0; i < numCells; i++)
+    {
+        AEnergyDepositionCell * cell = new AEnergyDepositionCell();
+        memcpy(&cell->ParticleId, p, sizeof(int));    p += sizeof(int);
+        memcpy(&cell->MaterialId, p, sizeof(int));    p += sizeof(int);
+        memcpy(&cell->dE,         p, sizeof(double)); p += sizeof(double);
+        memcpy(cell->r,           p, 3*sizeof(double)); p += 3*sizeof(double);
+        memcpy(&cell->time,       p, sizeof(double)); p += sizeof(double);
+        cell->index   = 0;
+        cell->eventId = eventId;
+        cells << cell;
+    }
+    return true;
+}
+
+void AG4StreamChannel::appendPrimaries(QByteArray & buffer, int eventId, const QVector<AParticleRecord *> & particles)
+{
+    const int numParticles = particles.size();
+    const quint32 size = 2 * sizeof(int) + numParticles * (sizeof(int) + 8 * sizeof(double));
+
+    const int start = buffer.size();
+    buffer.resize(start + HeaderSize + size);
+    char * p = buffer.data() + start;
+
+    *p++ = Primaries;
+    memcpy(p, &size,         sizeof(quint32)); p += sizeof(quint32);
+    memcpy(p, &eventId,      sizeof(int));     p += sizeof(int);
+    memcpy(p, &numParticles, sizeof(int));     p += sizeof(int);
+    for (const AParticleRecord * pr : particles)
+    {
+        memcpy(p, &pr->Id,     sizeof(int));      p += sizeof(int);
+        memcpy(p, &pr->energy, sizeof(double));   p += sizeof(double);
+        memcpy(p, pr->r,       3*sizeof(double)); p += 3*sizeof(double);
+        memcpy(p, pr->v,       3*sizeof(double)); p += 3*sizeof(double);
+        memcpy(p, &pr->time,   sizeof(double));   p += sizeof(double);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef AG4STREAMCHANNEL_H
+#define AG4STREAMCHANNEL_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+class QLocalServer;
+class QLocalSocket;
+class AParticleRecord;
+struct AEnergyDepositionCell;
+
+// Streaming transport between a simulation thread and its G4ants process
+// (local socket: Unix domain socket on Linux/Mac, named pipe on Windows)
+//
+// Frame: type (uint8), payload length (uint32), payload; native byte order, the peer runs on the same machine
+//   Primaries   ANTS2 -> G4ants  eventId(int32) numParticles(int32) {particleId(int32) energy x y z vx vy vz time (double)}
+//   PrimariesEnd ANTS2 -> G4ants  no payload
+//   Deposition  G4ants -> ANTS2  eventId(int32) numCells(int32) {particleId(int32) matId(int32) dE x y z time (double)}
+//   RunEnd      G4ants -> ANTS2  no payload; the receipt, tracks and monitor files are complete at this point
+// G4ants reads all primaries (up to PrimariesEnd) before it starts to send deposition
+// Every event of the range gets a Deposition frame (numCells can be 0), events come in increasing order
+//
+// All methods are blocking and can be used in a worker thread without an event loop
+
+class AG4StreamChannel
+{
+public:
+    enum FrameType : unsigned char {Primaries = 0x01, PrimariesEnd = 0x02, Deposition = 0x11, RunEnd = 0x1f};
+    enum ReadResult {FrameReady, NoData, Failed};
+
+    AG4StreamChannel(const QString & name);
+    ~AG4StreamChannel();
+
+    bool listen();
+    const QString getFullServerName() const;   // to be given to G4ants
+    bool waitForConnection(int msecs);         // false on timeout
+    bool isConnected() const;
+
+    void sendFrame(FrameType type, const QByteArray & payload);
+    void sendFrames(const QByteArray & frames);  // already composed, e.g. with appendPrimaries()
+    bool flush(int msecs);
+
+    ReadResult readFrame(int msecs);           // NoData if the frame is not complete after msecs
+    FrameType  getFrameType() const {return FrameTypeRead;}
+
+    // valid after readFrame() returned FrameReady with Deposition type; cells are appended, ownership is transferred
+    bool readDeposition(int & eventId, QVector<AEnergyDepositionCell*> & cells);
+
+    static void appendPrimaries(QByteArray & buffer, int eventId, const QVector<AParticleRecord*> & particles); // complete frame
+
+    QString ErrorString;
+
+private:
+    QString        Name;
+    QLocalServer * Server = nullptr;
+    QLocalSocket * Socket = nullptr;
+
+    QByteArray     InBuffer;
+    int            InPos = 0;           // start of the unprocessed data in InBuffer
+    FrameType      FrameTypeRead = RunEnd;
+    const char *   Payload = nullptr;   // points into InBuffer, valid until the next readFrame()
+    quint32        PayloadSize = 0;
+
+    static const int HeaderSize = 5;
+    static const quint32 MaxPayloadSize = 256u << 20;  // larger frame size in a header means a corrupted stream
+};
+
+#endif // AG4STREAMCHANNEL_H
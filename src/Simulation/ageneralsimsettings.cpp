@@ -64,6 +64,10 @@ bool AGeneralSimSettings::readFromJson(const QJsonObject & Json)
   QJsonObject acjson = json["AcceleratorConfig"].toObject();
   MaxNumTrans = acjson["MaxNumTransitions"].toInt();
   fQEaccelerator = acjson["CheckBeforeTrack"].toBool();  
+  PhotonPacketSize = acjson["PhotonPacketSize"].toInt(0);
+  bDynamicEventDistribution = acjson["DynamicEventDistribution"].toBool(true);
+  EventChunkSize = acjson["EventChunkSize"].toInt(10);
+  bCounterBasedRandom = acjson["CounterBasedRandom"].toBool(false);
 
   DetStatNumBins = json["DetStatNumBins"].toInt(100);
 
@@ -160,6 +164,10 @@ bool AGeneralSimSettings::writeToJson(QJsonObject & Json) const
         QJsonObject js;
             js["MaxNumTransitions"] = MaxNumTrans;
             js["CheckBeforeTrack"]  = fQEaccelerator;
+            js["PhotonPacketSize"]  = PhotonPacketSize;
+            js["DynamicEventDistribution"] = bDynamicEventDistribution;
+            js["EventChunkSize"]    = EventChunkSize;
+            js["CounterBasedRandom"] = bCounterBasedRandom;
         json["AcceleratorConfig"] = js;
     }
 
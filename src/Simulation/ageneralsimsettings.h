@@ -39,6 +39,10 @@ public:
 
   int    MaxNumTrans         = 500;
   bool   fQEaccelerator      = false;
+  int    PhotonPacketSize    = 0;     //0 - photons are traced one by one, otherwise max number of photons traced as one packet
+  bool   bDynamicEventDistribution = true; //particle sources: threads take events in chunks, random seed is derived from event index
+  int    EventChunkSize      = 10;
+  bool   bCounterBasedRandom = false; //random sequence is a function of (run seed, event, sub-stream) -> independent of threads
   bool   bDoPhotonHistoryLog = false; //detailed photon history, activated by "photon" script!
 
   int    DetStatNumBins      = 100;        //number of bins in detection statistics
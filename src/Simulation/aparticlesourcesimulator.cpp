@@ -18,10 +18,13 @@
 #include "aenergydepositioncell.h"
 #include "ajsontools.h"
 #include "aexternalprocesshandler.h"
+#include "aeventscheduler.h"
+#include "ag4streamchannel.h"
 
 #include <memory>
 #include <algorithm>
 #include <fstream>
+#include <limits>
 
 #include <QDebug>
 #include <QJsonObject>
@@ -149,6 +152,15 @@ void AParticleSourceSimulator::simulate()
     fStopRequested = false;
     fHardAbortWasTriggered = false;
 
+    if (Scheduler)
+    {
+        bool bOK = simulateDynamic();
+        ParticleTracker->releaseResources();
+        if (ParticleGun) ParticleGun->ReleaseResources();
+        fSuccess = bOK && !fHardAbortWasTriggered;
+        return;
+    }
+
     std::unique_ptr<QFile> pFile;
     std::unique_ptr<QTextStream> pStream;
     if (GenSimSettings.G4SimSet.bTrackParticles)
@@ -176,24 +188,37 @@ void AParticleSourceSimulator::simulate()
             return;
         }
 
-        const QString name = GenSimSettings.G4SimSet.getPrimariesFileName(ThreadIndex);//   FilePath + QString("primaries-%1.txt").arg(ID);
-        pFile.reset(new QFile(name));
-        if(!pFile->open(QIODevice::WriteOnly | QFile::Text))
+        PrimariesStream.clear();
+        if (!GenSimSettings.G4SimSet.StreamDeposition)
         {
-            ErrorString = QString("Cannot open file: %1").arg(name);
-            fSuccess = false;
-            return;
+            const QString name = GenSimSettings.G4SimSet.getPrimariesFileName(ThreadIndex);//   FilePath + QString("primaries-%1.txt").arg(ID);
+            pFile.reset(new QFile(name));
+            if(!pFile->open(QIODevice::WriteOnly | QFile::Text))
+            {
+                ErrorString = QString("Cannot open file: %1").arg(name);
+                fSuccess = false;
+                return;
+            }
+            pStream.reset(new QTextStream(&(*pFile)));
         }
-        pStream.reset(new QTextStream(&(*pFile)));
     }
 
     // -- Main simulation cycle --
     updateFactor = 100.0 / ( eventEnd - eventBegin );
+    int lastKeyedEvent = -1;
+    int attempt = 0;
     for (eventCurrent = eventBegin; eventCurrent < eventEnd; eventCurrent++)
     {
         if (fStopRequested) break;
         if (!EnergyVector.isEmpty()) clearEnergyVector();
 
+        if (CounterRandGen)
+        {
+            attempt = (eventCurrent == lastKeyedEvent ? attempt + 1 : 0); // the same event index is repeated if the event was discarded
+            lastKeyedEvent = eventCurrent;
+            setRandomEventKey(eventCurrent, attempt);
+        }
+
         int numPrimaries = chooseNumberOfParticlesThisEvent();
             //qDebug() << "---- primary particles in this event: " << numPrimaries;
         bool bGenerationSuccessful = choosePrimariesForThisEvent(numPrimaries, eventCurrent);
@@ -206,20 +231,24 @@ void AParticleSourceSimulator::simulate()
             ParticleTracker->TrackParticlesOnStack(eventCurrent);
         else
         {
-            //prepare file with primaries for export to Geant4 particle tracker
-            *pStream << QString("#%1\n").arg(eventCurrent);
-            for (const AParticleRecord* p : ParticleStack)
+            //prepare file (or stream frames) with primaries for export to Geant4 particle tracker
+            if (!pStream)
+                AG4StreamChannel::appendPrimaries(PrimariesStream, eventCurrent, ParticleStack);
+            else
             {
-                QString t = QString::number(p->Id);
-                t += QString(" %1").arg(p->energy);
-                t += QString(" %1 %2 %3").arg(p->r[0]).arg(p->r[1]).arg(p->r[2]);
-                t += QString(" %1 %2 %3").arg(p->v[0]).arg(p->v[1]).arg(p->v[2]);
-                t += QString(" %1").arg(p->time);
-                t += "\n";
-                *pStream << t;
-                delete p;
+                *pStream << QString("#%1\n").arg(eventCurrent);
+                for (const AParticleRecord* p : ParticleStack)
+                {
+                    QString t = QString::number(p->Id);
+                    t += QString(" %1").arg(p->energy);
+                    t += QString(" %1 %2 %3").arg(p->r[0]).arg(p->r[1]).arg(p->r[2]);
+                    t += QString(" %1 %2 %3").arg(p->v[0]).arg(p->v[1]).arg(p->v[2]);
+                    t += QString(" %1").arg(p->time);
+                    t += "\n";
+                    *pStream << t;
+                }
             }
-            ParticleStack.clear();
+            clearParticleStack();
 
             if (bOnlySavePrimariesToFile) progress = (eventCurrent - eventBegin + 1) * updateFactor;  // *!* obsolete?
 
@@ -248,19 +277,14 @@ void AParticleSourceSimulator::simulate()
             continue;
         }
 
-        if (!GenSimSettings.fLRFsim) OneEvent->HitsToSignal();
-
-        dataHub->Events.append(OneEvent->PMsignals);
-        if (timeRange != 0) dataHub->TimedEvents.append(OneEvent->TimedPMsignals);
-
-        EnergyVectorToScan(); //prepare true position data using deposition data
+        storeEvent(eventCurrent);
 
         progress = (eventCurrent - eventBegin + 1) * updateFactor;
     }
 
     ParticleTracker->releaseResources();
     if (ParticleGun) ParticleGun->ReleaseResources();
-    if (GenSimSettings.G4SimSet.bTrackParticles)
+    if (pStream)
     {
         pStream->flush();
         pFile->close();
@@ -281,6 +305,83 @@ void AParticleSourceSimulator::simulate()
     //  qDebug() << "done!"<<ID << "events collected:"<<dataHub->countEvents();
 }
 
+bool AParticleSourceSimulator::isDynamicDistributionSupported() const
+{
+    //file generator reads events sequentially, Geant4 tracks the whole event range of the thread at once
+    return !GenSimSettings.G4SimSet.bTrackParticles && PartSimSet.GenerationMode != AParticleSimSettings::File;
+}
+
+bool AParticleSourceSimulator::simulateDynamic()
+{
+    // events are taken from the scheduler in chunks; random generator is re-seeded for every event,
+    // so the result does not depend on the number of threads and on which thread has simulated the event
+    updateFactor = 100.0 / std::max(1, getEventCount()); // runner averages the progress over the threads
+    int eventsDone = 0;
+    eventCurrent = eventBegin;
+
+    int eventFrom, eventTo;
+    while (!fStopRequested && Scheduler->getChunk(ThreadIndex, eventFrom, eventTo))
+    {
+        for (int iEvent = eventFrom; iEvent < eventTo; iEvent++)
+        {
+            int attempt = 0;
+            while (true)
+            {
+                if (fStopRequested) return true;
+                setRandomEventKey(iEvent, attempt);
+                if (!EnergyVector.isEmpty()) clearEnergyVector();
+
+                const int numPrimaries = chooseNumberOfParticlesThisEvent();
+                if (!choosePrimariesForThisEvent(numPrimaries, iEvent))
+                {
+                    ErrorString = ParticleGun->GetErrorString();
+                    return false;
+                }
+
+                ParticleTracker->TrackParticlesOnStack(iEvent);
+
+                if ( PartSimSet.bIgnoreNoDepo && EnergyVector.isEmpty() ) //if there is no deposition -> re-generate this event
+                {
+                    attempt++;
+                    continue;
+                }
+
+                if ( !generateAndTrackPhotons() ) return false;
+
+                if ( PartSimSet.bIgnoreNoHits && OneEvent->isHitsEmpty() ) // if there were no PM hits -> re-generate this event
+                {
+                    attempt++;
+                    continue;
+                }
+                break;
+            }
+
+            storeEvent(iEvent);
+
+            eventsDone++;
+            eventCurrent = eventBegin + eventsDone;
+            progress = eventsDone * updateFactor;
+        }
+    }
+    return true;
+}
+
+void AParticleSourceSimulator::storeEvent(int iEvent)
+{
+    if (!GenSimSettings.fLRFsim) OneEvent->HitsToSignal();
+
+    dataHub->Events.append(OneEvent->PMsignals);
+    if (timeRange != 0) dataHub->TimedEvents.append(OneEvent->TimedPMsignals);
+
+    EnergyVectorToScan(); //prepare true position data using deposition data
+
+    if (Scheduler)
+    {
+        EventIndexes.append(iEvent);
+        HistoryEventIndexes.resize(TrackingHistory.size(), iEvent); //also the records of the rejected attempts
+    }
+}
+
 void AParticleSourceSimulator::appendToDataHub(EventsDataClass *dataHub)
 {
     //qDebug() << "Thread #"<<ID << " PartSim ---> appending data";
@@ -289,7 +390,7 @@ void AParticleSourceSimulator::appendToDataHub(EventsDataClass *dataHub)
     dataHub->ScanNumberOfRuns = 1;
 }
 
-void AParticleSourceSimulator::mergeData(QSet<QString> & SeenNonReg, double & DepoNotReg, double & DepoReg, std::vector<AEventTrackingRecord *> & TrHistory)
+void AParticleSourceSimulator::mergeData(QSet<QString> & SeenNonReg, double & DepoNotReg, double & DepoReg, std::vector<AEventTrackingRecord *> & TrHistory, std::vector<int> & TrHistoryEventIndexes)
 {
     SeenNonReg += SeenNonRegisteredParticles;
     SeenNonRegisteredParticles.clear();
@@ -300,12 +401,16 @@ void AParticleSourceSimulator::mergeData(QSet<QString> & SeenNonReg, double & De
     DepoReg += DepoByRegistered;
     DepoByRegistered = 0;
 
+    if (Scheduler) HistoryEventIndexes.resize(TrackingHistory.size(), std::numeric_limits<int>::max()); //unfinished event on abort -> last
     TrHistory.insert(
           TrHistory.end(),
           std::make_move_iterator(TrackingHistory.begin()),
           std::make_move_iterator(TrackingHistory.end())
         );
     TrackingHistory.clear();
+
+    TrHistoryEventIndexes.insert(TrHistoryEventIndexes.end(), HistoryEventIndexes.begin(), HistoryEventIndexes.end());
+    HistoryEventIndexes.clear();
 }
 
 void AParticleSourceSimulator::hardAbort()
@@ -512,8 +617,12 @@ bool AParticleSourceSimulator::generateAndTrackPhotons()
 #include "amonitor.h"
 bool AParticleSourceSimulator::geant4TrackAndProcess()
 {
-    bool bOK = runGeant4Handler();
+    // in streaming mode photon simulation runs while G4ants is tracking, otherwise deposition is read from file afterwards
+    const bool bStreaming = GenSimSettings.G4SimSet.StreamDeposition;
+    bool bOK = (bStreaming ? runGeant4Streaming() : runGeant4Handler());
+    PrimariesStream.clear();
     if (!bOK) return false;
+    if (bStreaming && fStopRequested) return true; // G4ants was stopped, its output is incomplete
 
     // read receipt file, stop if not OK
     QString receipeFileName = GenSimSettings.G4SimSet.getReceitFileName(ThreadIndex); // FilePath + QString("receipt-%1.txt").arg(ID);
@@ -549,9 +658,12 @@ bool AParticleSourceSimulator::geant4TrackAndProcess()
         SeenNonRegisteredParticles.insert(arNP.at(i).toString());
 
     //read and process depo data
-    bOK = processG4DepositionData();
-    releaseInputResources();
-    if (!bOK) return false;
+    if (!bStreaming)
+    {
+        bOK = processG4DepositionData();
+        releaseInputResources();
+        if (!bOK) return false;
+    }
 
     //read history/tracks
     if (GenSimSettings.TrackBuildOptions.bBuildParticleTracks || GenSimSettings.LogsStatOptions.bParticleTransportLog)
@@ -604,7 +716,7 @@ bool AParticleSourceSimulator::geant4TrackAndProcess()
     return true;
 }
 
-bool AParticleSourceSimulator::runGeant4Handler()
+void AParticleSourceSimulator::createGeant4Handler()
 {
     const QString exe = AGlobalSettings::getInstance().G4antsExec;
     const QString confFile = GenSimSettings.G4SimSet.getConfigFileName(ThreadIndex); // FilePath + QString("aga-%1.json").arg(ID);
@@ -615,6 +727,11 @@ bool AParticleSourceSimulator::runGeant4Handler()
     G4handler = new AExternalProcessHandler(exe, ar);
     //G4handler->setVerbose();
     G4handler->setProgressVariable(&progressG4);
+}
+
+bool AParticleSourceSimulator::runGeant4Handler()
+{
+    createGeant4Handler();
 
     bG4isRunning = true;
     G4handler->startAndWait();
@@ -634,6 +751,112 @@ bool AParticleSourceSimulator::runGeant4Handler()
     return true;
 }
 
+bool AParticleSourceSimulator::runGeant4Streaming()
+{
+    AG4StreamChannel channel(GenSimSettings.G4SimSet.getStreamName(ThreadIndex));
+    if (!channel.listen())
+    {
+        ErrorString = channel.ErrorString;
+        return false;
+    }
+
+    createGeant4Handler();
+    bG4isRunning = true;
+    G4handler->start();
+
+    while (!channel.waitForConnection(100))
+    {
+        G4handler->pollOutput();
+        if (fHardAbortWasTriggered || !G4handler->isRunning())
+        {
+            G4handler->waitForFinished();
+            bG4isRunning = false;
+            if (fHardAbortWasTriggered) return false;
+            ErrorString = "G4ants has not connected to the deposition stream";
+            if (!G4handler->ErrorString.isEmpty()) ErrorString += "\n" + G4handler->ErrorString;
+            return false;
+        }
+    }
+
+    if (!PrimariesStream.isEmpty()) // empty if primaries are given to G4ants in a file
+    {
+        channel.sendFrames(PrimariesStream);
+        channel.sendFrame(AG4StreamChannel::PrimariesEnd, QByteArray());
+    }
+    channel.flush(-1);
+
+    updateFactor = 100.0 / std::max(1, getEventCount());
+    eventCurrent = eventBegin;
+    bool bOK = true;
+    while (bOK)
+    {
+        const AG4StreamChannel::ReadResult res = channel.readFrame(100);
+        G4handler->pollOutput();
+        if (fHardAbortWasTriggered || fStopRequested) break;
+        if (res == AG4StreamChannel::NoData) continue;
+        if (res == AG4StreamChannel::Failed)
+        {
+            ErrorString = channel.ErrorString;
+            bOK = false;
+            break;
+        }
+
+        if (channel.getFrameType() == AG4StreamChannel::RunEnd) break;
+
+        if (!EnergyVector.isEmpty()) clearEnergyVector();
+        int eventId;
+        bOK = channel.readDeposition(eventId, EnergyVector);
+        if (!bOK)
+        {
+            ErrorString = channel.ErrorString;
+            break;
+        }
+        if (eventId != eventCurrent || eventCurrent >= eventEnd)
+        {
+            ErrorString = QString("Bad event number in G4ants deposition stream: expected %1 and got %2").arg(eventCurrent).arg(eventId);
+            bOK = false;
+            break;
+        }
+
+        bOK = processG4Event();
+        eventCurrent++;
+    }
+
+    if (!bOK || fStopRequested || fHardAbortWasTriggered) G4handler->abort();
+    else
+    {
+        G4handler->waitForFinished();
+        if (!G4handler->ErrorString.isEmpty())
+        {
+            ErrorString = "G4ants run failed\n" + G4handler->ErrorString;
+            bOK = false;
+        }
+        else if (!fHardAbortWasTriggered && eventCurrent != eventEnd)
+        {
+            ErrorString = QString("G4ants deposition stream has ended after %1 events, expected %2").arg(eventCurrent - eventBegin).arg(getEventCount());
+            bOK = false;
+        }
+    }
+    bG4isRunning = false;
+
+    if (!bOK || fHardAbortWasTriggered) return false;
+
+    progressG4 = 100.0;
+    return true;
+}
+
+bool AParticleSourceSimulator::processG4Event()
+{
+    if (CounterRandGen) setRandomEventKey(eventCurrent, PhotonPhaseSubStream);
+
+    if (!generateAndTrackPhotons()) return false;
+
+    storeEvent(eventCurrent);
+
+    progress = (eventCurrent - eventBegin + 1) * updateFactor;
+    return true;
+}
+
 bool AParticleSourceSimulator::processG4DepositionData()
 {
     const QString DepoFileName = GenSimSettings.G4SimSet.getDepositionFileName(ThreadIndex);
@@ -675,17 +898,8 @@ bool AParticleSourceSimulator::processG4DepositionData()
         if (!bOK) return false;
         //  qDebug() << "Energy vector contains" << EnergyVector.size() << "cells";
 
-        bOK = generateAndTrackPhotons();
+        bOK = processG4Event();
         if (!bOK) return false;
-
-        if (!GenSimSettings.fLRFsim) OneEvent->HitsToSignal();
-
-        dataHub->Events.append(OneEvent->PMsignals);
-        if (timeRange != 0) dataHub->TimedEvents.append(OneEvent->TimedPMsignals);
-
-        EnergyVectorToScan();
-
-        progress = (eventCurrent - eventBegin + 1) * updateFactor;
     }
     return true;
 }
@@ -883,6 +1097,11 @@ void AParticleSourceSimulator::generateG4antsConfigCommon(QJsonObject & json)
     json["Primaries_G4ants"] = bG4Primaries;
     json["Primaries_Binary"] = bBinaryPrimaries;
 
+    // see AG4StreamChannel for the protocol
+    json["Deposition_Stream"] = G4SimSet.StreamDeposition;
+    json["Primaries_Stream"]  = G4SimSet.StreamDeposition && !bG4Primaries;
+    if (G4SimSet.StreamDeposition) json["Stream_Name"] = G4SimSet.getStreamName(ThreadIndex);
+
     QString primFN = G4SimSet.getPrimariesFileName(ThreadIndex);
     json["File_Primaries"] = primFN;
     removeOldFile(primFN, "primaries");
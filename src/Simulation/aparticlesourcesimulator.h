@@ -36,11 +36,12 @@ public:
     void updateGeoManager() override;
 
     void simulate() override;
+    bool isDynamicDistributionSupported() const override;
 
     void appendToDataHub(EventsDataClass * dataHub) override;
     void hardAbort() override;
 
-    void mergeData(QSet<QString> & SeenNonReg, double & DepoNotReg, double & DepoReg, std::vector<AEventTrackingRecord *> & TrHistory);
+    void mergeData(QSet<QString> & SeenNonReg, double & DepoNotReg, double & DepoReg, std::vector<AEventTrackingRecord *> & TrHistory, std::vector<int> & TrHistoryEventIndexes);
 
     const QVector<AEnergyDepositionCell*> & getEnergyVector() const { return EnergyVector; }  // !*! to change
     void ClearEnergyVectorButKeepObjects() {EnergyVector.resize(0);} //to avoid clear of objects stored in the vector  // !*! to change
@@ -58,8 +59,13 @@ private:
     int  chooseNumberOfParticlesThisEvent() const;
     bool choosePrimariesForThisEvent(int numPrimaries, int iEvent);
     bool generateAndTrackPhotons();
+    bool simulateDynamic();
+    void storeEvent(int iEvent);
     bool geant4TrackAndProcess();
+    void createGeant4Handler();
     bool runGeant4Handler();
+    bool runGeant4Streaming();
+    bool processG4Event();
 
     bool processG4DepositionData();
     bool readG4DepoEventFromTextFile();
@@ -88,6 +94,8 @@ private:
     //resources for binary input
     std::ifstream * inStream      = nullptr;
     int             G4NextEventId = -1;
+    //primaries for the streaming mode
+    QByteArray      PrimariesStream;
 
     //local use - container which particle generator fills for each event; the particles are deleted by the tracker
     QVector<AParticleRecord*> GeneratedParticles;
@@ -104,7 +112,9 @@ private:
     double DepoByNotRegistered = 0;
     double DepoByRegistered = 0;
     std::vector<AEventTrackingRecord *> TrackingHistory;
+    std::vector<int> HistoryEventIndexes; //dynamic event distribution: event index for every record in TrackingHistory
     int StartSeed;
+    static constexpr int PhotonPhaseSubStream = 0x7fffffff; //random sub-stream for the optical phase of events tracked by Geant4
 };
 
 #endif // APARTICLESOURCESIMULATOR_H
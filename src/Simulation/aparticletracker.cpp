@@ -90,8 +90,7 @@ bool AParticleTracker::TrackParticlesOnStack(int eventId)
         {
             if (SimSet->LogsStatOptions.bParticleTransportLog)
             {
-                ATrackingStepData * step = new ATrackingStepData(p->r, p->time, p->energy, 0, "O");
-                thisParticleRecord->addStep(step);
+                thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, p->energy, 0, "O") );
             }
             delete p; p = nullptr;
             continue;
@@ -119,8 +118,7 @@ bool AParticleTracker::TrackParticlesOnStack(int eventId)
                 //qDebug()<<"Found medium where tracking is not allowed!";
                 if (SimSet->LogsStatOptions.bParticleTransportLog)
                 {
-                    ATrackingStepData * step = new ATrackingStepData(p->r, p->time, p->energy, 0, "S");
-                    thisParticleRecord->addStep(step);
+                    thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, p->energy, 0, "S") );
                 }
                 break;
             }
@@ -153,8 +151,7 @@ bool AParticleTracker::TrackParticlesOnStack(int eventId)
                 {
                     if (SimSet->LogsStatOptions.bParticleTransportLog)
                     {
-                        ATrackingStepData * step = new ATrackingStepData(p->r, p->time, p->energy, 0, "ExitStop");
-                        thisParticleRecord->addStep(step);
+                        thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, p->energy, 0, "ExitStop") );
                     }
                     break;
                 }
@@ -164,8 +161,7 @@ bool AParticleTracker::TrackParticlesOnStack(int eventId)
             {
                 if (SimSet->LogsStatOptions.bParticleTransportLog)
                 {
-                    ATrackingStepData * step = new ATrackingStepData(p->r, p->time, p->energy, 0, "O");
-                    thisParticleRecord->addStep(step);
+                    thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, p->energy, 0, "O") );
                 }
                 break;
             }
@@ -173,9 +169,9 @@ bool AParticleTracker::TrackParticlesOnStack(int eventId)
             {
                 if (SimSet->LogsStatOptions.bParticleTransportLog)
                 {
-                    ATransportationStepData * step = new ATransportationStepData(p->r, p->time, p->energy, 0, "T");
+                    ATrackingStepData step(p->r, p->time, p->energy, 0, "T");
                     TGeoNode * node = navigator->GetCurrentNode();
-                    step->setVolumeInfo(node->GetVolume()->GetName(), node->GetNumber(), node->GetVolume()->GetMaterial()->GetIndex());
+                    step.setVolumeInfo(node->GetVolume()->GetName(), node->GetNumber(), node->GetVolume()->GetMaterial()->GetIndex());
                     thisParticleRecord->addStep(step);
                 }
             }
@@ -256,9 +252,9 @@ void AParticleTracker::initLog()
         EventRecord->addPrimaryRecord(thisParticleRecord);
     }
 
-    ATransportationStepData * step = new ATransportationStepData(p->r, p->time, p->energy, 0, "C");
+    ATrackingStepData step(p->r, p->time, p->energy, 0, "C");
     TGeoNode * node = navigator->GetCurrentNode();
-    step->setVolumeInfo(node->GetVolume()->GetName(), node->GetNumber(), node->GetVolume()->GetMaterial()->GetIndex());
+    step.setVolumeInfo(node->GetVolume()->GetName(), node->GetNumber(), node->GetVolume()->GetMaterial()->GetIndex());
     thisParticleRecord->addStep(step);
 }
 
@@ -317,8 +313,7 @@ bool AParticleTracker::checkMonitors_isKilled()
             {
                 if (SimSet->LogsStatOptions.bParticleTransportLog)
                 {
-                    ATrackingStepData * step = new ATrackingStepData(p->r, p->time, p->energy, 0, "MonitorStop");
-                    thisParticleRecord->addStep(step);
+                    thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, p->energy, 0, "MonitorStop") );
                 }
                 return true; // particle is stopped
             }
@@ -338,10 +333,7 @@ bool AParticleTracker::trackCharged_isKilled()
     {
         //    qDebug() << "-->On step start energy:"<<energy;
         //dE/dx [keV/mm] = Density[g/cm3] * [cm2/g*keV] * 0.1  //0.1 since local units are mm, not cm
-        const double dEdX = 0.1 * thisMaterial->density * GetInterpolatedValue(p->energy,
-                                                                               &thisMatParticle->InteractionDataX,
-                                                                               &thisMatParticle->InteractionDataF,
-                                                                               MpCollection.fLogLogInterpolation);
+        const double dEdX = 0.1 * thisMaterial->density * thisMatParticle->InteractionTable.getValue(p->energy);
 
         //recommended step: (RecFraction - suggested decrease of energy per step)
         double Step = (dEdX < 1.0e-25 ? 1.0e25 : SimSet->dE * p->energy/dEdX);
@@ -390,8 +382,7 @@ bool AParticleTracker::trackCharged_isKilled()
 
         if (SimSet->LogsStatOptions.bParticleTransportLog)
         {
-            ATrackingStepData * step = new ATrackingStepData(p->r, p->time, p->energy, dE, "hIoni");
-            thisParticleRecord->addStep(step);
+            thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, p->energy, dE, "hIoni") );
         }
 
         distanceHistory += Step;
@@ -448,10 +439,7 @@ bool AParticleTracker::trackNeutral_isKilled()
 
             double InteractionCoefficient;
             if (!bUseNCrystal)
-                InteractionCoefficient = GetInterpolatedValue(p->energy,
-                                                              &Terminators[iProcess].PartialCrossSectionEnergy,
-                                                              &Terminators[iProcess].PartialCrossSection,
-                                                              MpCollection.fLogLogInterpolation);
+                InteractionCoefficient = Terminators[iProcess].PartialCrossSectionTable.getValue(p->energy);
             else
                 InteractionCoefficient = Terminators[iProcess].getNCrystalCrossSectionBarns(p->energy, ThreadIndex) * 1.0e-24; //in cm2
 
@@ -540,8 +528,7 @@ bool AParticleTracker::processPhotoelectric_isKilled()
 
     if (SimSet->LogsStatOptions.bParticleTransportLog)
     {
-        ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, p->energy, "phot");
-        thisParticleRecord->addStep(step);
+        thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, p->energy, "phot") );
     }
     return true;
 }
@@ -573,16 +560,13 @@ bool AParticleTracker::processCompton_isKilled()
     if (SimSet->LogsStatOptions.bParticleTransportLog)
     {
         /*
-        ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, G0.energy - G1.energy, "compt");
-        thisParticleRecord->addStep(step);
+        thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, G0.energy - G1.energy, "compt") );
         AParticleTrackingRecord * secTR = AParticleTrackingRecord::create( "gamma" );
         tmp->ParticleRecord = secTR;
         thisParticleRecord->addSecondary(secTR);
-        step->Secondaries.push_back( thisParticleRecord->countSecondaries()-1 );
         */
 
-        ATrackingStepData * step = new ATrackingStepData(p->r, p->time, G1.energy, G0.energy - G1.energy, "compt");
-        thisParticleRecord->addStep(step);
+        thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, G1.energy, G0.energy - G1.energy, "compt") );
     }
 
     if (bBuildThisTrack) track->Nodes.append(TrackNodeStruct(p->r, p->time));
@@ -607,20 +591,12 @@ bool AParticleTracker::processNeutronAbsorption_isKilled(const NeutralTerminator
         {
             double rnd = RandGen.Rndm();
 
-            QVector<double> mfcs(elements.size(), 0);
-            double trueSum = 0;
-            for (int i=0; i<elements.size(); i++)
-            {
-                if (!elements.at(i).Energy.isEmpty())
-                {
-                    mfcs[i] = elements.at(i).MolarFraction * GetInterpolatedValue(p->energy, &elements.at(i).Energy, &elements.at(i).CrossSection, MpCollection.fLogLogInterpolation);
-                    trueSum += mfcs.at(i);
-                }
-            }
+            IsotopeCrossSections.resize(elements.size());
+            const double trueSum = term.IsotopeCrossSectionTables.getWeightedValues(p->energy, IsotopeCrossSections.data());
             const int max = elements.size()-1;  //if before-last failed, the last is selected automatically
             for (; iselected<max; iselected++)
             {
-                const double thisOne = mfcs.at(iselected) / trueSum; // fraction of this element in the total effective cross section
+                const double thisOne = IsotopeCrossSections[iselected] / trueSum; // fraction of this element in the total effective cross section
                 if (rnd <= thisOne) break;
                 rnd -= thisOne;
             }
@@ -634,8 +610,7 @@ bool AParticleTracker::processNeutronAbsorption_isKilled(const NeutralTerminator
             // qDebug() << "No decay scenarios following neutron capture are defined";
             if (SimSet->LogsStatOptions.bParticleTransportLog)
             {
-                ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, 0, "nCapture");
-                thisParticleRecord->addStep(step);
+                thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, 0, "nCapture") );
             }
         }
         else
@@ -662,8 +637,7 @@ bool AParticleTracker::processNeutronAbsorption_isKilled(const NeutralTerminator
                 //  qDebug() << "In this scenario there is no emission of secondary particles";
                 if (SimSet->LogsStatOptions.bParticleTransportLog)
                 {
-                    ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, 0, "nCapture");
-                    thisParticleRecord->addStep(step);
+                    thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, 0, "nCapture") );
                 }
               }
                 break;
@@ -700,8 +674,7 @@ bool AParticleTracker::processNeutronAbsorption_isKilled(const NeutralTerminator
 
                 if (SimSet->LogsStatOptions.bParticleTransportLog)
                 {
-                    ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, depoE, "nDirect");
-                    thisParticleRecord->addStep(step);
+                    thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, depoE, "nDirect") );
                 }
               }
                 break;
@@ -709,12 +682,8 @@ bool AParticleTracker::processNeutronAbsorption_isKilled(const NeutralTerminator
             case ADecayScenario::FissionFragments:
               {
                 //  qDebug() << "Fission";
-                ATrackingStepData * step;
                 if (SimSet->LogsStatOptions.bParticleTransportLog && !reaction.GeneratedParticles.empty())
-                {
-                    step = new ATrackingStepData(p->r, p->time, 0, 0, "neutronInelastic");
-                    thisParticleRecord->addStep(step);
-                }
+                    thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, 0, "neutronInelastic") ); // the generated particles are registered as its secondaries
 
                 double vv[3]; //generated direction of the particle
                 for (int igp = 0; igp < reaction.GeneratedParticles.size(); igp++)
@@ -740,7 +709,6 @@ bool AParticleTracker::processNeutronAbsorption_isKilled(const NeutralTerminator
                         AParticleTrackingRecord * secTR = AParticleTrackingRecord::create( MpCollection.getParticleName(ParticleId) );
                         pp->ParticleRecord = secTR;
                         thisParticleRecord->addSecondary(secTR);
-                        step->Secondaries.push_back( thisParticleRecord->countSecondaries()-1 );
                     }
                 }
               }
@@ -752,8 +720,7 @@ bool AParticleTracker::processNeutronAbsorption_isKilled(const NeutralTerminator
         qWarning() << "||| Warning: No isotopes are defined for" << thisMaterial->name;
         if (SimSet->LogsStatOptions.bParticleTransportLog)
         {
-            ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, 0, "nCapture");
-            thisParticleRecord->addStep(step);
+            thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, 0, "nCapture") );
         }
     }
     return true;
@@ -776,18 +743,15 @@ bool AParticleTracker::processPairProduction_isKilled()
 
     if (SimSet->LogsStatOptions.bParticleTransportLog)
     {
-        ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, depo, "pair");
-        thisParticleRecord->addStep(step);
+        thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, depo, "pair") );
 
         AParticleTrackingRecord * secTR = AParticleTrackingRecord::create( "gamma" );
         tmp1->ParticleRecord = secTR;
         thisParticleRecord->addSecondary(secTR);
-        step->Secondaries.push_back( thisParticleRecord->countSecondaries()-1 );
 
         secTR = AParticleTrackingRecord::create( "gamma" );
         tmp2->ParticleRecord = secTR;
         thisParticleRecord->addSecondary(secTR);
-        step->Secondaries.push_back( thisParticleRecord->countSecondaries()-1 );
     }
     return true;
 }
@@ -812,20 +776,12 @@ bool AParticleTracker::processNeutronElastic_isKilled(const NeutralTerminatorStr
         if (elements.size() > 1)
         {
             double rnd = RandGen.Rndm();
-            QVector<double> mfcs(elements.size(), 0);
-            double trueSum = 0;
-            for (int i=0; i<elements.size(); i++)
-            {
-                if (!elements.at(i).Energy.isEmpty())
-                {
-                    mfcs[i] = elements.at(i).MolarFraction * GetInterpolatedValue(p->energy, &elements.at(i).Energy, &elements.at(i).CrossSection, MpCollection.fLogLogInterpolation);
-                    trueSum += mfcs[i];
-                }
-            }
+            IsotopeCrossSections.resize(elements.size());
+            const double trueSum = term.IsotopeCrossSectionTables.getWeightedValues(p->energy, IsotopeCrossSections.data());
             const int max = elements.size()-1;  //if before-last failed, the last is selected automatically
             for (; iselected<max; iselected++)
             {
-                const double thisOne = mfcs.at(iselected) / trueSum; // fraction of this element in the total effective cross section
+                const double thisOne = IsotopeCrossSections[iselected] / trueSum; // fraction of this element in the total effective cross section
                 if (rnd <= thisOne) break;
                 rnd -= thisOne;
             }
@@ -929,15 +885,13 @@ bool AParticleTracker::processNeutronElastic_isKilled(const NeutralTerminatorStr
 
     if (SimSet->fLogsStat)
     {
-        ATrackingStepData * step = new ATrackingStepData(p->r, p->time, 0, depE, (bCoherent ? "nElasticCoherent" : "nElastic") );
-        thisParticleRecord->addStep(step);
+        thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, 0, depE, (bCoherent ? "nElasticCoherent" : "nElastic") ) );
 
         if (tmp)
         {
             AParticleTrackingRecord * secTR = AParticleTrackingRecord::create( "neutron" );
             tmp->ParticleRecord = secTR;
             thisParticleRecord->addSecondary(secTR);
-            step->Secondaries.push_back( thisParticleRecord->countSecondaries()-1 );
         }
     }
     return true;
@@ -969,8 +923,7 @@ bool AParticleTracker::processNeutronElastic_isKilled(const NeutralTerminatorStr
 
     if (SimSet->LogsStatOptions.bParticleTransportLog)
     {
-        ATrackingStepData * step = new ATrackingStepData(p->r, p->time, newEnergy, depE, (bCoherent ? "nElasticCoherent" : "nElastic") );
-        thisParticleRecord->addStep(step);
+        thisParticleRecord->addStep( ATrackingStepData(p->r, p->time, newEnergy, depE, (bCoherent ? "nElasticCoherent" : "nElastic") ) );
     }
 
     return bKilled;
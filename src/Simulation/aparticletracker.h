@@ -82,6 +82,8 @@ private:
 
     bool bBuildThisTrack = false;
 
+    std::vector<double> IsotopeCrossSections; // buffer for the isotope selection in neutron interactions
+
     std::ofstream * outStreamExit = nullptr;
 
     void generateRandomDirection(double* vv);
@@ -0,0 +1,30 @@
+#include "aphotonpacket.h"
+
+void APhotonPacket::clear()
+{
+    x.clear();  y.clear();  z.clear();
+    vx.clear(); vy.clear(); vz.clear();
+    time.clear();
+    waveIndex.clear();
+}
+
+void APhotonPacket::reserve(int size)
+{
+    x.reserve(size);  y.reserve(size);  z.reserve(size);
+    vx.reserve(size); vy.reserve(size); vz.reserve(size);
+    time.reserve(size);
+    waveIndex.reserve(size);
+}
+
+void APhotonPacket::append(const double * r, const double * v, int iWave, double Time)
+{
+    x.push_back(r[0]);  y.push_back(r[1]);  z.push_back(r[2]);
+    vx.push_back(v[0]); vy.push_back(v[1]); vz.push_back(v[2]);
+    time.push_back(Time);
+    waveIndex.push_back(iWave);
+}
+
+bool APhotonPacket::isSameOrigin(int iPhoton, int iOther) const
+{
+    return (x[iPhoton] == x[iOther] && y[iPhoton] == y[iOther] && z[iPhoton] == z[iOther]);
+}
@@ -0,0 +1,30 @@
+#ifndef APHOTONPACKET_H
+#define APHOTONPACKET_H
+
+#include <vector>
+
+class ASimulationStatistics;
+
+// Structure-of-arrays container for a group of photons which are traced together by APhotonTracer::TracePacket
+// All photons of the packet share the scintillation type and the statistics container
+class APhotonPacket
+{
+public:
+    std::vector<double> x, y, z;     //positions
+    std::vector<double> vx, vy, vz;  //directions (unit vectors!)
+    std::vector<double> time;        //time stamps
+    std::vector<int>    waveIndex;   //wave indexes (-1 = not wave-resolved)
+
+    int scint_type = 0;              //1 - primary //2 - secondary // 0 - undefined
+    ASimulationStatistics * SimStat = nullptr;
+
+    void clear();
+    void reserve(int size);
+    void append(const double * r, const double * v, int iWave, double Time);
+
+    int  size() const {return (int)x.size();}
+    bool isEmpty() const {return x.empty();}
+    bool isSameOrigin(int iPhoton, int iOther) const;
+};
+
+#endif // APHOTONPACKET_H
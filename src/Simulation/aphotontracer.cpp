@@ -10,9 +10,13 @@
 #include "atrackrecords.h"
 #include "amonitor.h"
 #include "atracerstateful.h"
+#include "aphotonpacket.h"
+#include "aopticalpropertytable.h"
+#include "acommonfunctions.h"
 
 //Qt
 #include <QDebug>
+#include <QElapsedTimer>
 
 //ROOT
 #include "TGeoManager.h"
@@ -29,6 +33,7 @@ APhotonTracer::APhotonTracer(TGeoManager *geoManager, TRandom2 *RandomGenerator,
     MaterialCollection = materialCollection;
     PMs = Pms;
     grids = Grids;
+    OptTable = &MaterialCollection->getOpticalTable();
     fGridShiftOn = false;
     fBuildTracks = false;
     p = new APhoton();
@@ -40,6 +45,7 @@ APhotonTracer::APhotonTracer(TGeoManager *geoManager, TRandom2 *RandomGenerator,
 
 APhotonTracer::~APhotonTracer()
 {
+    ResourcesForOverrides->flushScriptOverrideTiming();
     delete ResourcesForOverrides;
     delete p;
 }
@@ -59,54 +65,146 @@ void APhotonTracer::TracePhoton(const APhoton* Photon)
   if (bAbort) return;
   //qDebug() << "----accel is on?"<<SimSet->fQEaccelerator<< "Build tracks?"<<fBuildTracks;
   //accelerators
-  if (SimSet->fQEaccelerator)
-    {
-      rnd = RandGen->Rndm();
-      if (SimSet->fWaveResolved && Photon->waveIndex != -1)
-        {
-          if (rnd > PMs->getMaxQEvsWave(Photon->waveIndex))
-            {
-              OneEvent->SimStat->TracingSkipped++;
-              return; //no need to trace this photon
-            }
-        }
-      else
-        {
-           if (rnd > PMs->getMaxQE())
-             {
-               OneEvent->SimStat->TracingSkipped++;
-               return; //no need to trace this photon
-             }
-        }
-    }
+  if (SimSet->fQEaccelerator && IsRejectedByQEaccelerator(Photon->waveIndex)) return; //no need to trace this photon
 
    //=====inits=====
-   navigator = GeoManager->GetCurrentNavigator();
-   if (!navigator)
-   {
-       qDebug() << "Photon tracer: current navigator does not exist, creating new";
-       navigator = GeoManager->AddNavigator();
-   }
+   InitNavigator();
    navigator->SetCurrentPoint(Photon->r);
    navigator->SetCurrentDirection(Photon->v);
    navigator->FindNode();
    fGridShiftOn = false;
+   p->CopyFrom(Photon);
 
    if (navigator->IsOutside())
      {
-//     qDebug()<<"Generated outside geometry!";
-       OneEvent->SimStat->GeneratedOutsideGeometry++;
-       PhLog.clear();
-       PhLog.append( APhotonHistoryLog(p->r, "", p->time, p->waveIndex, APhotonHistoryLog::GeneratedOutsideGeometry) );
+       RegisterGeneratedOutside();
        return;
      }
 
-   p->CopyFrom(Photon);
    //qDebug()<<"Photon starts from:";
    //qDebug()<<navigator->GetPath();
    //qDebug()<<"material name: "<<navigator->GetCurrentVolume()->GetMaterial()->GetName();
    //qDebug()<<"material index: "<<navigator->GetCurrentVolume()->GetMaterial()->GetIndex();
 
+   TraceFromCurrentLocation();
+}
+
+void APhotonTracer::TracePacket(const APhotonPacket & Packet)
+{
+   if (bAbort) return;
+   const int numPhotons = Packet.size();
+   if (numPhotons == 0) return;
+
+   QElapsedTimer timer;
+   timer.start();
+
+   //QE accelerator: the whole packet is tested before any navigation is performed
+   PacketSelected.clear();
+   PacketRnd.clear();
+   if (SimSet->fQEaccelerator)
+     {
+       for (int i = 0; i < numPhotons; i++)
+         {
+           if (IsRejectedByQEaccelerator(Packet.waveIndex[i])) continue;
+           PacketSelected.push_back(i);
+           PacketRnd.push_back(rnd);
+         }
+     }
+   else
+     {
+       PacketSelected.resize(numPhotons);
+       for (int i = 0; i < numPhotons; i++) PacketSelected[i] = i;
+     }
+
+   InitNavigator();
+   p->scint_type = Packet.scint_type;
+   p->SimStat = Packet.SimStat;
+
+   //photons emitted from the same point share the navigator state found for the first of them:
+   //it is kept on the navigator stack and restored instead of calling FindNode for every photon
+   int  iOriginState = 0;  // index of the saved state on the navigator stack, 0 - nothing is saved
+   bool bOriginOutside = false;
+   int  iPrevious = -1;
+   for (size_t iSel = 0; iSel < PacketSelected.size(); iSel++)
+     {
+       if (bAbort) break;
+       const int i = PacketSelected[iSel];
+
+       p->r[0] = Packet.x[i];  p->r[1] = Packet.y[i];  p->r[2] = Packet.z[i];
+       p->v[0] = Packet.vx[i]; p->v[1] = Packet.vy[i]; p->v[2] = Packet.vz[i];
+       p->time = Packet.time[i];
+       p->waveIndex = Packet.waveIndex[i];
+       if (SimSet->fQEaccelerator) rnd = PacketRnd[iSel];
+
+       if (iPrevious != -1 && Packet.isSameOrigin(i, iPrevious))
+         {
+           if (!bOriginOutside)
+             {
+               navigator->PopPoint(iOriginState);
+               iOriginState = navigator->PushPoint();
+               navigator->SetOutside(kFALSE);
+             }
+         }
+       else
+         {
+           if (iOriginState) navigator->PopDummy(iOriginState);
+           iOriginState = 0;
+           navigator->SetCurrentPoint(p->r);
+           navigator->FindNode();
+           bOriginOutside = navigator->IsOutside();
+           if (!bOriginOutside) iOriginState = navigator->PushPoint();
+         }
+       iPrevious = i;
+       fGridShiftOn = false;
+
+       if (bOriginOutside)
+         {
+           RegisterGeneratedOutside();
+           continue;
+         }
+
+       navigator->SetCurrentDirection(p->v);
+       TraceFromCurrentLocation();
+     }
+   if (iOriginState) navigator->PopDummy(iOriginState); //clean up the stack
+
+   OneEvent->SimStat->TracedPackets++;
+   OneEvent->SimStat->PacketPhotons += numPhotons;
+   OneEvent->SimStat->PacketTracingTime += 1.0e-6 * timer.nsecsElapsed();
+}
+
+bool APhotonTracer::IsRejectedByQEaccelerator(int waveIndex)
+{
+    rnd = RandGen->Rndm();
+    const double maxQE = ( (SimSet->fWaveResolved && waveIndex != -1) ? PMs->getMaxQEvsWave(waveIndex) : PMs->getMaxQE() );
+    if (rnd > maxQE)
+      {
+        OneEvent->SimStat->TracingSkipped++;
+        return true;
+      }
+    return false;
+}
+
+void APhotonTracer::InitNavigator()
+{
+    navigator = GeoManager->GetCurrentNavigator();
+    if (!navigator)
+    {
+        qDebug() << "Photon tracer: current navigator does not exist, creating new";
+        navigator = GeoManager->AddNavigator();
+    }
+}
+
+void APhotonTracer::RegisterGeneratedOutside()
+{
+    //qDebug()<<"Generated outside geometry!";
+    OneEvent->SimStat->GeneratedOutsideGeometry++;
+    PhLog.clear();
+    PhLog.append( APhotonHistoryLog(p->r, "", p->time, p->waveIndex, APhotonHistoryLog::GeneratedOutsideGeometry) );
+}
+
+void APhotonTracer::TraceFromCurrentLocation()
+{
    if (fBuildTracks)
      {
        if (PhotonTracksAdded < MaxTracks)
@@ -133,7 +231,7 @@ void APhotonTracer::TracePhoton(const APhoton* Photon)
    {
      Counter++;
 
-     MaterialFrom = (*MaterialCollection)[MatIndexFrom]; //this is the material where the photon is currently in
+     PropFrom = &OptTable->get(MatIndexFrom, p->waveIndex); //optical properties of the material where the photon is currently in
      if (SimSet->bDoPhotonHistoryLog) nameFrom = navigator->GetCurrentVolume()->GetName();
 
      navigator->FindNextBoundary();
@@ -190,8 +288,7 @@ void APhotonTracer::TracePhoton(const APhoton* Photon)
      navigator->PushPoint(); //DO NOT FORGET TO CLEAN IT IF NOT USED!!!
 
      //can make the track now - the photon made it to the other border in any case
-     double refIndex = MaterialFrom->getRefractiveIndex(p->waveIndex);
-     p->time += Step/c_in_vac*refIndex;
+     p->time += Step/c_in_vac*PropFrom->n;
      if (fBuildTracks && Step>0.001)
      {
          if (fGridShiftOn)
@@ -226,7 +323,6 @@ void APhotonTracer::TracePhoton(const APhoton* Photon)
      TGeoVolume* ThisVolume = NodeAfterInterface->GetVolume();
      if (SimSet->bDoPhotonHistoryLog) nameTo = navigator->GetCurrentVolume()->GetName();
      MatIndexTo = ThisVolume->GetMaterial()->GetIndex();
-     MaterialTo = (*MaterialCollection)[MatIndexTo];
      fHaveNormal = false;
 
      //qDebug()<<"Found border with another volume: "<<ThisVolume->GetName();
@@ -234,7 +330,7 @@ void APhotonTracer::TracePhoton(const APhoton* Photon)
      //qDebug()<<"coordinates: "<<navigator->GetCurrentPoint()[0]<<navigator->GetCurrentPoint()[1]<<navigator->GetCurrentPoint()[2];
 
      //-----Checking overrides-----     
-     AOpticalOverride* ov = MaterialFrom->OpticalOverrides[MatIndexTo];
+     AOpticalOverride* ov = OptTable->getOverride(MatIndexFrom, MatIndexTo);
      if (ov)
        {
          //qDebug() << "Overrides defined! Model = "<<ov->getType();
@@ -558,7 +654,7 @@ APhotonTracer::AbsRayEnum APhotonTracer::AbsorptionAndRayleigh()
     bool DoAbsorption;
     double AbsPath;
 
-    const double AbsCoeff = (*MaterialCollection)[MatIndexFrom]->getAbsorptionCoefficient(p->waveIndex);
+    const double AbsCoeff = PropFrom->abs;
     if (AbsCoeff > 0)
       {
         AbsPath = -log(RandGen->Rndm())/AbsCoeff;
@@ -570,14 +666,10 @@ APhotonTracer::AbsRayEnum APhotonTracer::AbsorptionAndRayleigh()
      //prepare Rayleigh
     bool DoRayleigh;
     double RayleighPath;
-    if (MaterialFrom->rayleighMFP == 0) DoRayleigh = false;      // == 0 - means undefined
+    if (PropFrom->rayleighMFP == 0) DoRayleigh = false;      // == 0 - means undefined
     else
       {
-        double RayleighMFP;
-        if (p->waveIndex == -1) RayleighMFP = MaterialFrom->rayleighMFP;
-        else RayleighMFP = MaterialFrom->rayleighBinned[p->waveIndex];
-
-        RayleighPath = -RayleighMFP * log(RandGen->Rndm());
+        RayleighPath = -PropFrom->rayleighMFP * log(RandGen->Rndm());
         if (RayleighPath < Step) DoRayleigh = true;
         else DoRayleigh = false;
       }
@@ -596,8 +688,7 @@ APhotonTracer::AbsRayEnum APhotonTracer::AbsorptionAndRayleigh()
         if (DoAbsorption)
           {
             //qDebug()<<"Absorption was triggered!";
-            double refIndex = MaterialFrom->getRefractiveIndex(p->waveIndex);
-            p->time += AbsPath/c_in_vac*refIndex;
+            p->time += AbsPath/c_in_vac*PropFrom->n;
             OneEvent->SimStat->Absorbed++;
             OneEvent->SimStat->BulkAbsorption++;
 
@@ -613,7 +704,7 @@ APhotonTracer::AbsRayEnum APhotonTracer::AbsorptionAndRayleigh()
                }
 
             //check if this material is waveshifter
-            const double reemissionProb = (*MaterialCollection)[MatIndexFrom]->getReemissionProbability(p->waveIndex);
+            const double reemissionProb = PropFrom->reemissionProb;
             if ( reemissionProb > 0 )
               {
                 if (RandGen->Rndm() < reemissionProb)
@@ -628,7 +719,7 @@ APhotonTracer::AbsRayEnum APhotonTracer::AbsorptionAndRayleigh()
                         {
                             attempts++;
                             if (attempts > 9) return AbsTriggered;  // ***!!! absolute number
-                            wavelength = (*MaterialCollection)[MatIndexFrom]->PrimarySpectrumHist->GetRandom();
+                            wavelength = (*MaterialCollection)[MatIndexFrom]->GeneratePrimaryWavelength(RandGen);
                             //qDebug() << "   "<<wavelength << " MatIndexFrom:"<< MatIndexFrom;
                             waveIndex = round( (wavelength - SimSet->WaveFrom)/SimSet->WaveStep );
                         }
@@ -686,8 +777,7 @@ APhotonTracer::AbsRayEnum APhotonTracer::AbsorptionAndRayleigh()
             while ( (dotProduct*dotProduct + 1.0) < RandGen->Rndm(2.0));
             navigator->SetCurrentDirection(p->v);            
 
-            double refIndex = MaterialFrom->getRefractiveIndex(p->waveIndex);
-            p->time += RayleighPath/c_in_vac*refIndex;
+            p->time += RayleighPath/c_in_vac*PropFrom->n;
             OneEvent->SimStat->Rayleigh++;
 
             //updating track if needed
@@ -709,8 +799,8 @@ double APhotonTracer::CalculateReflectionCoefficient()
     const double cos1 = fabs(NK);
     //qDebug() << "Cos of incidence:"<<cos1;
 
-    RefrIndexFrom = MaterialFrom->getRefractiveIndex(p->waveIndex);
-    RefrIndexTo   = MaterialTo->getRefractiveIndex(p->waveIndex);
+    RefrIndexFrom = PropFrom->n;
+    RefrIndexTo   = OptTable->getRefractiveIndex(MatIndexTo, p->waveIndex);
 
     //qDebug()<<"Photon wavelength"<<p->wavelength<<"WaveIndex:"<<p->WaveIndex<<"n1 and n2 are: "<<RefrIndexFrom<<RefrIndexTo;
     const double sin1 = sqrt(1.0 - NK*NK);
@@ -9,8 +9,10 @@
 #include "TMathBase.h"
 
 class APhoton;
+class APhotonPacket;
 class TGeoManager;
-class AMaterial;
+class AOpticalPropertyTable;
+struct AOpticalPropertyRecord;
 class APmHub;
 class AMaterialParticleCollection;
 class AOneEvent;
@@ -36,6 +38,7 @@ public:
     void configure(const AGeneralSimSettings *simSet, AOneEvent* oneEvent, bool fBuildTracks, std::vector<TrackHolderClass *> * tracks);
 
     void TracePhoton(const APhoton* Photon);
+    void TracePacket(const APhotonPacket & Packet); //QE accelerator test and geometry search are amortized over the packet
 
     AOneEvent* getEvent() {return OneEvent;}  //only used in LRF-based sim
 
@@ -68,8 +71,8 @@ private:
     bool fMissPM;
     int MatIndexFrom; //material index of the current medium or medium before the interface
     int MatIndexTo;   //material index of the medium after interface
-    AMaterial* MaterialFrom; //material before the interface
-    AMaterial* MaterialTo;   //material after the interface
+    const AOpticalPropertyTable* OptTable; //shared by all threads, built by material collection before simulation
+    const AOpticalPropertyRecord* PropFrom; //optical properties of the material before the interface
     double RefrIndexFrom, RefrIndexTo; //refractive indexes n1 and n2
     bool fDoFresnel; //flag - to perform or not the fresnel calculation on the interface
     bool fBuildTracks;
@@ -84,7 +87,15 @@ private:
 
     bool bAbort = false;
 
+    //packet mode
+    std::vector<int> PacketSelected;  //indexes of the packet photons which passed QE accelerator
+    std::vector<double> PacketRnd;    //pre-generated random numbers for accelerated mode
+
     enum AbsRayEnum {AbsRayNotTriggered=0, AbsTriggered, RayTriggered, WaveShifted};
+    void TraceFromCurrentLocation(); //p and navigator have to be already set
+    inline bool IsRejectedByQEaccelerator(int waveIndex);
+    inline void InitNavigator();
+    inline void RegisterGeneratedOutside();
     inline AbsRayEnum AbsorptionAndRayleigh();
     inline double CalculateReflectionCoefficient();
     inline void PMwasHit(int PMnumber);
@@ -193,6 +193,7 @@ bool APointSourceSimulator::simulateSingle()
     eventCurrent = 0;
     for (int irun = 0; irun < eventsToDo; ++irun)
     {
+        if (CounterRandGen) setRandomEventKey(eventBegin + irun);
         simulateOneNode(*node);
         eventCurrent = irun;
         progress = irun * updateFactor;
@@ -263,6 +264,7 @@ bool APointSourceSimulator::simulateRegularGrid()
                 }
 
                 //running this node
+                if (CounterRandGen) setRandomEventKey(currentNode);
                 for (int irun = 0; irun < NumRuns; irun++)
                 {
                     simulateOneNode(*node);
@@ -321,10 +323,19 @@ bool APointSourceSimulator::simulateFlood()
     eventCurrent = 0;
     int WatchdogThreshold = 100000;
     double updateFactor = 100.0 / (NumRuns*nodeCount);
+    int lastKeyedNode = -1;
+    int attempt = 0;
     for (int inode = 0; inode < nodeCount; inode++)
     {
         if(fStopRequested) return false;
 
+        if (CounterRandGen)
+        {
+            attempt = (inode == lastKeyedNode ? attempt + 1 : 0); // the same node index is repeated if the position was rejected
+            lastKeyedNode = inode;
+            setRandomEventKey(eventBegin + inode, attempt);
+        }
+
         //choosing node coordinates
         node->R[0] = Xfrom + (Xto - Xfrom) * RandGen->Rndm();
         node->R[1] = Yfrom + (Yto - Yfrom) * RandGen->Rndm();
@@ -379,6 +390,7 @@ bool APointSourceSimulator::simulateCustomNodes()
     for (int inode = 0; inode < nodeCount; inode++)
     {
         ANodeRecord * thisNode = Nodes.at(currentNode);
+        if (CounterRandGen) setRandomEventKey(currentNode);
 
         for (int irun = 0; irun<NumRuns; irun++)
         {
@@ -410,6 +422,7 @@ bool APointSourceSimulator::simulatePhotonsFromFile()
 
     for (int iEvent = -1; iEvent < eventEnd; iEvent++)
     {
+        if (CounterRandGen && iEvent >= eventBegin) setRandomEventKey(iEvent);
         while (!in.atEnd())
         {
             if (fStopRequested)
@@ -485,7 +498,7 @@ int APointSourceSimulator::getNumPhotToRun()
         num = std::round( RandGen->Gaus(PhotSimSettings.PerNodeSettings.Mean, PhotSimSettings.PerNodeSettings.Sigma) );
         break;
     case APhotonSim_PerNodeSettings::Custom :
-        num = CustomHist->GetRandom();
+        num = GetRandomFromHist(CustomHist, RandGen);
         break;
     case APhotonSim_PerNodeSettings::Poisson :
         num = RandGen->Poisson(PhotSimSettings.PerNodeSettings.PoisMean);
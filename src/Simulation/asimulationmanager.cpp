@@ -22,6 +22,7 @@
 #include <QStringList>
 #include <QFile>
 #include <QTextStream>
+#include <algorithm>
 
 #include "TRandom2.h"
 
@@ -69,6 +70,8 @@ void ASimulationManager::StartSimulation(QJsonObject& json, int threads, bool fF
 {
     fFinished = false;
     fSuccess = false;
+    WarningString.clear();
+    NumRejectedTrackingNames = ATrackingNameTable::getInstance().countRejected();
     bDoGuiUpdate = fFromGui;
     threads = std::max(threads, 1);
     if (MaxThreads > 0 && threads > MaxThreads)
@@ -317,6 +320,11 @@ void ASimulationManager::onSimulationFinished()
 
     copyDataFromWorkers();
 
+    const int numRejected = ATrackingNameTable::getInstance().countRejected() - NumRejectedTrackingNames;
+    if (numRejected > 0)
+        WarningString += QString("Tracking history: the limit of %1 different process and volume names was reached,\n"
+                                 "%2 process/volume entries of the steps are shown as '?'\n").arg(ATrackingNameTable::getMaxNames()).arg(numRejected);
+
     if (fHardAborted)
         EventsDataHub.clear(); //data are not valid!
     else
@@ -366,12 +374,15 @@ void ASimulationManager::copyDataFromWorkers()
 
     clearG4data();
     clearTracks();
+    const bool bDynamic = Runner->isEventDistributionDynamic();
+    if (bDynamic) ASimulator::sortEventsByIndex(workers);
+    std::vector<int> HistoryEventIndexes;
     for (int i = 0; i < workers.count(); i++)
     {
         workers[i]->appendToDataHub(&EventsDataHub); //EventsDataHub should be already cleared in setup
 
         AParticleSourceSimulator * pss = dynamic_cast<AParticleSourceSimulator *>(workers[i]);
-        if (pss) pss->mergeData(SeenNonRegisteredParticles, DepoByNotRegistered, DepoByRegistered, TrackingHistory);
+        if (pss) pss->mergeData(SeenNonRegisteredParticles, DepoByNotRegistered, DepoByRegistered, TrackingHistory, HistoryEventIndexes);
 
         QString err = workers.at(i)->getErrorString();
         if (!err.isEmpty()) ErrorString += QString("Thread %1 reported error: %2\n").arg(i).arg(err);
@@ -382,6 +393,9 @@ void ASimulationManager::copyDataFromWorkers()
         workers[i]->tracks.clear();  //to avoid delete objects on simulator delete
     }
 
+    if (bDynamic && HistoryEventIndexes.size() == TrackingHistory.size())
+        sortTrackingHistory(HistoryEventIndexes);
+
     SiPMpixels.clear();
     clearEnergyVector();
     if (!workers.isEmpty() && !fHardAborted)
@@ -402,6 +416,19 @@ void ASimulationManager::copyDataFromWorkers()
     }
 }
 
+void ASimulationManager::sortTrackingHistory(const std::vector<int> & eventIndexes)
+{
+    //same order as events (see ASimulator::sortEventsByIndex); records of one event keep their order
+    std::vector<std::pair<int, AEventTrackingRecord*>> records;
+    records.reserve(TrackingHistory.size());
+    for (size_t i = 0; i < TrackingHistory.size(); i++)
+        records.push_back( {eventIndexes.at(i), TrackingHistory.at(i)} );
+    std::stable_sort(records.begin(), records.end(),
+                     [](const std::pair<int, AEventTrackingRecord*> & a, const std::pair<int, AEventTrackingRecord*> & b){return a.first < b.first;});
+    for (size_t i = 0; i < records.size(); i++)
+        TrackingHistory[i] = records.at(i).second;
+}
+
 void ASimulationManager::clearTracks()
 {
     for (auto * tr : Tracks) delete tr;
@@ -6,6 +6,7 @@
 #include "alogsandstatisticsoptions.h"
 #include "asimsettings.h"
 #include "aphotonnodedistributor.h"
+#include "asipmmicrocells.h"
 
 #include <vector>
 
@@ -43,6 +44,7 @@ public:
     bool isSimulationAborted() const;
 
     const QString & getErrorString() {return ErrorString;}
+    const QString & getWarningString() const {return WarningString;}  //problems which do not invalidate the run
     void setErrorString(const QString & err) {ErrorString = err;}
 
     void clearTracks();
@@ -67,7 +69,7 @@ public:
     std::vector<AEventTrackingRecord *> TrackingHistory;
 
     //last event info
-    QVector<QBitArray> SiPMpixels;
+    QVector<ASiPMMicrocells> SiPMpixels;
     QVector<AEnergyDepositionCell *> EnergyVector;
 
     // Next three: Simulator workers use their own local copies of Generators!
@@ -97,6 +99,8 @@ private:
     QTimer simTimerGuiUpdate;
 
     QString ErrorString;
+    QString WarningString;
+    int  NumRejectedTrackingNames = 0;  //in the name table before this run
 
     int  MaxThreads = -1;
     bool bDoGuiUpdate = false;
@@ -124,6 +128,7 @@ signals:
 private:
     void clearG4data();
     void copyDataFromWorkers();
+    void sortTrackingHistory(const std::vector<int> & eventIndexes); //dynamic event distribution: tracking history in the order of event index
     QString makeLogDir() const;
     void saveParticleLog(const QString & dir) const;
     void saveG4ParticleLog(const QString & dir) const;
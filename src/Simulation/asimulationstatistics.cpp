@@ -1,7 +1,7 @@
 #include "asimulationstatistics.h"
 #include "ageoobject.h"
 #include "amonitor.h"
-#include "aroothistappenders.h"
+#include "ahistogram.h"
 
 #include <QDebug>
 
@@ -36,33 +36,46 @@ void ASimulationStatistics::clearAll()
     AngularDistr = 0;
     if (TransitionSpectrum) delete TransitionSpectrum;
     TransitionSpectrum = 0;
+
+    delete WaveAcc; WaveAcc = 0;
+    delete TimeAcc; TimeAcc = 0;
+    delete AngularAcc; AngularAcc = 0;
+    delete TransitionAcc; TransitionAcc = 0;
+    bHistsOutdated = false;
+
     clearMonitors();
 }
 
+void ASimulationStatistics::init1D(AHistogram1D *& acc, ATH1D *& hist, const TString & name, const char * title, int bins, double from, double to)
+{
+    delete acc;
+    delete hist;
+    acc = new AHistogram1D(bins, from, to); // to <= from: range is defined by the data
+    if (to <= from) to = from + 1.0;
+    hist = new ATH1D(name, title, bins, from, to);
+}
+
 void ASimulationStatistics::initialize(QVector<const AGeoObject*> monitorRecords, int nBins, int waveNodes)
 {    
     if (nBins != 0) numBins = nBins;
     if (waveNodes != 0) WaveNodes = waveNodes;
 
-    if (WaveSpectrum) delete WaveSpectrum;
     if (WaveNodes != 0)
-       WaveSpectrum = new TH1D("iWaveSpectrum"+NameID,"WaveIndex spectrum", WaveNodes, 0, WaveNodes);
+       init1D(WaveAcc, WaveSpectrum, "iWaveSpectrum"+NameID, "WaveIndex spectrum", WaveNodes, 0, WaveNodes);
     else
-       WaveSpectrum = new TH1D("iWaveSpectrum"+NameID,"WaveIndex spectrum",numBins,0,-1);
+       init1D(WaveAcc, WaveSpectrum, "iWaveSpectrum"+NameID, "WaveIndex spectrum", numBins, 0, -1);
 
-    if (TimeSpectrum) delete TimeSpectrum;
-    TimeSpectrum = new TH1D("TimeSpectrum"+NameID, "Time spectrum",numBins,0,-1);
-
-    if (AngularDistr) delete AngularDistr;
-    AngularDistr = new TH1D("AngularDistr"+NameID, "cosAngle spectrum", numBins, 0, 90.0);
-
-    if (TransitionSpectrum) delete TransitionSpectrum;
-    TransitionSpectrum = new TH1D("TransitionsSpectrum"+NameID, "Transitions", numBins, 0,-1);
+    init1D(TimeAcc, TimeSpectrum, "TimeSpectrum"+NameID, "Time spectrum", numBins, 0, -1);
+    init1D(AngularAcc, AngularDistr, "AngularDistr"+NameID, "cosAngle spectrum", numBins, 0, 90.0);
+    init1D(TransitionAcc, TransitionSpectrum, "TransitionsSpectrum"+NameID, "Transitions", numBins, 0, -1);
+    bHistsOutdated = false;
 
     Absorbed = OverrideLoss = HitPM = HitDummy = Escaped = LossOnGrid = TracingSkipped = MaxCyclesReached = GeneratedOutsideGeometry = KilledByMonitor = 0;
 
     FresnelTransmitted = FresnelReflected = BulkAbsorption = Rayleigh = Reemission = 0;
     OverrideForward = OverrideBack = 0;
+    TracedPackets = PacketPhotons = 0;
+    PacketTracingTime = 0;
 
     PhotonHistoryLog.clear();
     PhotonHistoryLog.squeeze();
@@ -82,22 +95,62 @@ bool ASimulationStatistics::isEmpty()
 
 void ASimulationStatistics::registerWave(int iWave)
 {
-    WaveSpectrum->Fill(iWave);
+    bHistsOutdated = true;
+    WaveAcc->Fill(iWave, 1.0);
 }
 
 void ASimulationStatistics::registerTime(double Time)
 {
-    TimeSpectrum->Fill(Time);
+    bHistsOutdated = true;
+    TimeAcc->Fill(Time, 1.0);
 }
 
 void ASimulationStatistics::registerAngle(double angle)
 {
-    AngularDistr->Fill(angle);
+    bHistsOutdated = true;
+    AngularAcc->Fill(angle, 1.0);
 }
 
 void ASimulationStatistics::registerNumTrans(int NumTransitions)
 {
-  TransitionSpectrum->Fill(NumTransitions);
+    bHistsOutdated = true;
+    TransitionAcc->Fill(NumTransitions, 1.0);
+}
+
+TH1D *ASimulationStatistics::getWaveSpectrum()
+{
+    updateHists();
+    return WaveSpectrum;
+}
+
+TH1D *ASimulationStatistics::getTimeSpectrum()
+{
+    updateHists();
+    return TimeSpectrum;
+}
+
+TH1D *ASimulationStatistics::getAngularDistr()
+{
+    updateHists();
+    return AngularDistr;
+}
+
+TH1D *ASimulationStatistics::getTransitionSpectrum()
+{
+    updateHists();
+    return TransitionSpectrum;
+}
+
+void ASimulationStatistics::updateHists()
+{
+    if (!bHistsOutdated) return;
+
+    if (WaveAcc && WaveSpectrum)             WaveSpectrum->Import(*WaveAcc);
+    if (TimeAcc && TimeSpectrum)             TimeSpectrum->Import(*TimeAcc);
+    if (AngularAcc && AngularDistr)          AngularDistr->Import(*AngularAcc);
+    if (TransitionAcc && TransitionSpectrum) TransitionSpectrum->Import(*TransitionAcc);
+
+    bHistsOutdated = false;
 }
 
 //static void addTH1(TH1 *first, const TH1 *second)
@@ -110,10 +163,11 @@ void ASimulationStatistics::registerNumTrans(int NumTransitions)
 
 void ASimulationStatistics::AppendSimulationStatistics(ASimulationStatistics* from)
 {
-    appendTH1D(AngularDistr, from->getAngularDistr());
-    appendTH1D(TimeSpectrum, from->getTimeSpectrum());
-    appendTH1D(WaveSpectrum, from->getWaveSpectrum());
-    appendTH1D(TransitionSpectrum, from->getTransitionSpectrum());
+    if (AngularAcc && from->AngularAcc)       AngularAcc->append(*from->AngularAcc);
+    if (TimeAcc && from->TimeAcc)             TimeAcc->append(*from->TimeAcc);
+    if (WaveAcc && from->WaveAcc)             WaveAcc->append(*from->WaveAcc);
+    if (TransitionAcc && from->TransitionAcc) TransitionAcc->append(*from->TransitionAcc);
+    bHistsOutdated = true;
 
     Absorbed += from->Absorbed;
     OverrideLoss += from->OverrideLoss;
@@ -135,6 +189,10 @@ void ASimulationStatistics::AppendSimulationStatistics(ASimulationStatistics* fr
     OverrideBack += from->OverrideBack;
     OverrideForward += from->OverrideForward;
 
+    TracedPackets += from->TracedPackets;
+    PacketPhotons += from->PacketPhotons;
+    PacketTracingTime += from->PacketTracingTime;
+
     if (Monitors.size() != from->Monitors.size())
     {
         qWarning() << "Cannot append monitor data - size mismatch:\n" <<
@@ -10,6 +10,8 @@
 
 class TH1I;
 class TH1D;
+class ATH1D;
+class AHistogram1D;
 class AMonitor;
 class AGeoObject;
 
@@ -33,11 +35,11 @@ public:
     //since every thread has its own statistics container:
     void AppendSimulationStatistics(ASimulationStatistics *from);
 
-    //read-outs
-    TH1D* getWaveSpectrum() {return WaveSpectrum;}
-    TH1D* getTimeSpectrum() {return TimeSpectrum;}
-    TH1D* getAngularDistr() {return AngularDistr;}
-    TH1D* getTransitionSpectrum() {return TransitionSpectrum;}
+    //read-outs: ROOT histograms are updated from the accumulators on request
+    TH1D* getWaveSpectrum();
+    TH1D* getTimeSpectrum();
+    TH1D* getAngularDistr();
+    TH1D* getTransitionSpectrum();
 
     //photon loss statistics
     long Absorbed, OverrideLoss, HitPM, HitDummy, Escaped, LossOnGrid, TracingSkipped, MaxCyclesReached, GeneratedOutsideGeometry, KilledByMonitor;
@@ -46,6 +48,10 @@ public:
     long FresnelTransmitted, FresnelReflected, BulkAbsorption, Rayleigh, Reemission; //general bulk
     long OverrideBack, OverrideForward; //general override. Note that OverrideLoss is already defined
 
+    //packet tracing throughput
+    long TracedPackets, PacketPhotons;
+    double PacketTracingTime; //in ms, summed over threads
+
     //only affects script unit "photon" tracing!
     QVector< QVector <APhotonHistoryLog> > PhotonHistoryLog;    
     QSet<int> MustNotInclude_Processes;   //v.fast
@@ -60,10 +66,16 @@ public:
     QVector<AMonitor*> Monitors;
 
 private:
-    TH1D* WaveSpectrum;
-    TH1D* TimeSpectrum;
-    TH1D* AngularDistr;
-    TH1D* TransitionSpectrum;
+    AHistogram1D* WaveAcc = 0;
+    AHistogram1D* TimeAcc = 0;
+    AHistogram1D* AngularAcc = 0;
+    AHistogram1D* TransitionAcc = 0;
+
+    ATH1D* WaveSpectrum;
+    ATH1D* TimeSpectrum;
+    ATH1D* AngularDistr;
+    ATH1D* TransitionSpectrum;
+    bool bHistsOutdated = false;
 
     int numBins;
     TString NameID;
@@ -74,6 +86,8 @@ private:
 
     long countPhotons();
     void clearMonitors();
+    void init1D(AHistogram1D *& acc, ATH1D *& hist, const TString & name, const char * title, int bins, double from, double to);
+    void updateHists();
 };
 
 #endif // ASIMULATIONSTATISTICS_H
@@ -9,10 +9,15 @@
 #include "photon_generator.h"
 #include "aphotontracer.h"
 #include "asandwich.h"
+#include "aeventscheduler.h"
+#include "apmhub.h"
+#include "arandomphilox.h"
 
 #include <QDebug>
 #include <QJsonObject>
 
+#include <algorithm>
+
 #include "TRandom2.h"
 #include "TGeoManager.h" //to move?
 
@@ -21,7 +26,12 @@ ASimulator::ASimulator(const ASimSettings & simSet, const DetectorClass & detect
     detector(detector),
     ThreadIndex(threadIndex)
 {
-    RandGen = new TRandom2();    
+    if (GenSimSettings.bCounterBasedRandom)
+    {
+        CounterRandGen = new ARandomPhilox();
+        RandGen = CounterRandGen;
+    }
+    else RandGen = new TRandom2();
     RandGen->SetSeed(startSeed);
 
     dataHub = new EventsDataClass(threadIndex);
@@ -90,9 +100,68 @@ void ASimulator::divideThreadWork(int threadId, int threadCount)
     //  qDebug() << maxPhotonTracks << maxParticleTracks;
 }
 
+void ASimulator::sortEventsByIndex(QVector<ASimulator *> & workers)
+{
+    if (workers.isEmpty()) return;
+
+    struct AEventRef
+    {
+        int iEvent, iWorker, iEntry;
+        bool operator<(const AEventRef & other) const {return iEvent < other.iEvent;}
+    };
+
+    std::vector<AEventRef> refs;
+    for (int iWorker = 0; iWorker < workers.size(); iWorker++)
+    {
+        const QVector<int> & indexes = workers[iWorker]->EventIndexes;
+        for (int iEntry = 0; iEntry < indexes.size(); iEntry++)
+            refs.push_back( {indexes.at(iEntry), iWorker, iEntry} );
+    }
+    std::sort(refs.begin(), refs.end());
+
+    //dimensions are taken from the settings: a worker can end up without events if there are fewer events than threads
+    const ASimulator * firstWorker = workers.first();
+    const AGeneralSimSettings & genSet = firstWorker->GenSimSettings;
+    const bool bTimed = genSet.fTimeResolved;
+    const int numPMs = firstWorker->detector.PMs->count();
+    AEventStore Events;
+    AEventStore TimedEvents;
+    QVector<AScanRecord*> Scan;
+    Events.setDimensions(numPMs);
+    Events.reserve(refs.size());
+    if (bTimed)
+    {
+        TimedEvents.setDimensions(numPMs, genSet.TimeBins);
+        TimedEvents.reserve(refs.size());
+    }
+    Scan.reserve(refs.size());
+
+    for (const AEventRef & r : refs)
+    {
+        const EventsDataClass * hub = workers.at(r.iWorker)->dataHub;
+        Events.append(hub->Events.at(r.iEntry));
+        if (bTimed && r.iEntry < hub->TimedEvents.size()) TimedEvents.append(hub->TimedEvents.at(r.iEntry));
+        if (r.iEntry < hub->Scan.size()) Scan << hub->Scan.at(r.iEntry);
+    }
+
+    for (ASimulator * w : workers)
+    {
+        w->dataHub->Events.clear();
+        w->dataHub->TimedEvents.clear();
+        w->dataHub->Scan.clear(); //records are transferred, not deleted
+        w->EventIndexes.clear();
+    }
+
+    EventsDataClass * first = workers.first()->dataHub;
+    first->Events      = std::move(Events);
+    first->TimedEvents = std::move(TimedEvents);
+    first->Scan        = Scan;
+}
+
 bool ASimulator::setup()
 {
     dataHub->clear();
+    EventIndexes.clear();
 
     OneEvent->configure(&GenSimSettings);
     photonGenerator->configure(&GenSimSettings, OneEvent->SimStat);
@@ -102,8 +171,8 @@ bool ASimulator::setup()
 
 void ASimulator::appendToDataHub(EventsDataClass *dataHub)
 {
-    dataHub->Events << this->dataHub->Events; //static
-    dataHub->TimedEvents << this->dataHub->TimedEvents; //static
+    dataHub->Events.append(this->dataHub->Events); //static
+    dataHub->TimedEvents.append(this->dataHub->TimedEvents); //static
     dataHub->Scan << this->dataHub->Scan; //dynamic!
     this->dataHub->Scan.clear();
 
@@ -117,8 +186,9 @@ void ASimulator::hardAbort()
 
 void ASimulator::ReserveSpace(int expectedNumEvents)
 {
-    dataHub->Events.reserve(expectedNumEvents);
-    if (GenSimSettings.fTimeResolved) dataHub->TimedEvents.reserve(expectedNumEvents);
+    //event stores grow by blocks without reallocation, so only the dimensions are defined here
+    dataHub->Events.setDimensions(detector.PMs->count());
+    if (GenSimSettings.fTimeResolved) dataHub->TimedEvents.setDimensions(detector.PMs->count(), GenSimSettings.TimeBins);
     dataHub->Scan.reserve(expectedNumEvents);
 }
 
@@ -127,6 +197,12 @@ void ASimulator::updateMaxTracks(int maxPhotonTracks, int /*maxParticleTracks*/)
     photonTracker->setMaxTracks(maxPhotonTracks);
 }
 
+void ASimulator::setRandomEventKey(int iEvent, int subStream)
+{
+    if (CounterRandGen) CounterRandGen->setKey(RunSeed, iEvent, subStream);
+    else RandGen->SetSeed( AEventScheduler::makeEventSeed(RunSeed, iEvent, subStream) );
+}
+
 void ASimulator::assureNavigatorPresent()
 {
     // it is normal to be triggered once per tread on sim start!
@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QSet>
+#include <QVector>
 #include <vector>
 
 class ASimSettings;
@@ -14,6 +15,8 @@ class EventsDataClass;
 class Photon_Generator;
 class APhotonTracer;
 class TRandom2;
+class AEventScheduler;
+class ARandomPhilox;
 
 // tread worker for simulation - base class
 class ASimulator
@@ -44,6 +47,12 @@ public:
 
     void divideThreadWork(int threadId, int threadCount);
 
+    //dynamic event distribution
+    virtual bool isDynamicDistributionSupported() const {return false;}
+    void setScheduler(AEventScheduler * scheduler) {Scheduler = scheduler;}
+    void setRunSeed(unsigned int runSeed) {RunSeed = runSeed;}
+    static void sortEventsByIndex(QVector<ASimulator *> & workers); //moves all events to the first worker in the order of event index
+
     int progress   = 0;   // progress in percents
     int progressG4 = 0; // progress of G4ants sim in percents
 
@@ -62,6 +71,7 @@ protected:
 
     // local resources
     TRandom2         * RandGen  = nullptr;
+    ARandomPhilox    * CounterRandGen = nullptr; //the same object as RandGen if counter-based mode is selected, otherwise nullptr
     AOneEvent        * OneEvent = nullptr; //PM hit data for one event is stored here
     EventsDataClass  * dataHub = nullptr;
     Photon_Generator * photonGenerator = nullptr;
@@ -69,6 +79,11 @@ protected:
 
     QString ErrorString; //last error
 
+    //dynamic event distribution
+    AEventScheduler  * Scheduler = nullptr; //not owned
+    unsigned int       RunSeed = 0;
+    QVector<int>       EventIndexes; //event index for every event stored in dataHub
+
     //state control
     int eventBegin = 0;
     int eventCurrent; //to be updated by implementor, or override getEventsDone()
@@ -84,6 +99,7 @@ protected:
 
 protected:
     void assureNavigatorPresent();
+    void setRandomEventKey(int iEvent, int subStream = 0); //re-seeds RandGen using only the run seed, event index and sub-stream
 
 };
 
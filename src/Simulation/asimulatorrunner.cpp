@@ -8,6 +8,8 @@
 #include "apmhub.h"
 #include "apointsourcesimulator.h"
 #include "aparticlesourcesimulator.h"
+#include "aeventscheduler.h"
+#include "asimsettings.h"
 
 #include <QDebug>
 #include <QJsonObject>  //move?
@@ -80,10 +82,15 @@ bool ASimulatorRunner::setup(int threadCount, bool bPhotonSourceSim)
         return false;
     }
 
+    //for dynamic event distribution and counter-based random generator: derived from the seed of the first worker,
+    //so the global generator is advanced exactly as before and the static distribution gives the same results
+    unsigned int runSeed = 0;
+
     for (int iWorker = 0; iWorker < threadCount; iWorker++)
     {
         ASimulator *worker;
         int seed = detector.RandGen->Rndm() * 10000000;
+        if (iWorker == 0) runSeed = AEventScheduler::makeEventSeed(seed, -1);
         if (bPhotonSourceSim) worker = new APointSourceSimulator(simMan.Settings, detector, simMan.Nodes, simMan.InNodeDistributor, iWorker, seed);
         else                  worker = new AParticleSourceSimulator(simMan.Settings, detector, iWorker, seed);
 
@@ -118,6 +125,15 @@ bool ASimulatorRunner::setup(int threadCount, bool bPhotonSourceSim)
         workers.append(worker);
     }
 
+    for (ASimulator * worker : workers) worker->setRunSeed(runSeed);
+
+    const AGeneralSimSettings & GenSimSet = simMan.Settings.genSimSet;
+    if (GenSimSet.bDynamicEventDistribution && !workers.isEmpty() && workers.first()->isDynamicDistributionSupported())
+    {
+        Scheduler = new AEventScheduler(workers.first()->getTotalEventCount(), workers.size(), GenSimSet.EventChunkSize);
+        for (ASimulator * worker : workers) worker->setScheduler(Scheduler);
+    }
+
     if (threadCount > 1)
     {
         backgroundWorker = nullptr;
@@ -185,6 +201,8 @@ void ASimulatorRunner::clearWorkers()
     for(int i = 0; i < workers.count(); i++)
         delete workers[i];
     workers.clear();
+
+    delete Scheduler; Scheduler = nullptr;
 }
 
 void ASimulatorRunner::simulate()
@@ -12,6 +12,7 @@ class DetectorClass;
 class EventsDataClass;
 class ASimulationManager;
 class ASimulator;
+class AEventScheduler;
 
 #if ROOT_VERSION_CODE < ROOT_VERSION(6,11,1)
     class TThread;
@@ -38,6 +39,7 @@ public:
     QVector<ASimulator *> & getWorkers() {return workers;}
     State getSimState() const {return simState;}
     void clearWorkers();
+    bool isEventDistributionDynamic() const {return Scheduler;}
 
 private:
     DetectorClass      & detector;
@@ -55,6 +57,7 @@ private:
     QVector<std::thread *> threads;
 #endif
     ASimulator * backgroundWorker = nullptr;
+    AEventScheduler * Scheduler = nullptr;
 
     //Time
     QTime startTime;
@@ -248,12 +248,12 @@ AParticleTrackingRecord * ATrackingDataImporter::createAndInitParticleTrackingRe
     {
         r = AParticleTrackingRecord::create(BparticleName.data());
 
-        ATransportationStepData * step = new ATransportationStepData(Bpos,          // pos
-                                                                     Btime,         // time
-                                                                     BkinEnergy,    // E
-                                                                     0,             // depoE
-                                                                     "C");          // process = 'C' which is "Creation"
-        step->setVolumeInfo(BnextVolName.data(), BnextVolIndex, BnextMat);
+        ATrackingStepData step(Bpos,          // pos
+                               Btime,         // time
+                               BkinEnergy,    // E
+                               0,             // depoE
+                               "C");          // process = 'C' which is "Creation"
+        step.setVolumeInfo(BnextVolName.data(), BnextVolIndex, BnextMat);
         r->addStep(step);
     }
     else
@@ -262,14 +262,14 @@ AParticleTrackingRecord * ATrackingDataImporter::createAndInitParticleTrackingRe
         //   0           1           2         3 4 5   6  7   8     9       10
         r = AParticleTrackingRecord::create(inputSL.at(2));
 
-        ATransportationStepData * step = new ATransportationStepData(inputSL.at(3).toFloat(), // X
-                                                                     inputSL.at(4).toFloat(), // Y
-                                                                     inputSL.at(5).toFloat(), // Z
-                                                                     inputSL.at(6).toFloat(), // time
-                                                                     inputSL.at(7).toFloat(), // E
-                                                                     0,                       // depoE
-                                                                     "C");                    // process = 'C' which is "Creation"
-        step->setVolumeInfo(inputSL.at(9), inputSL.at(10).toInt(), inputSL.at(8).toInt());
+        ATrackingStepData step(inputSL.at(3).toFloat(), // X
+                               inputSL.at(4).toFloat(), // Y
+                               inputSL.at(5).toFloat(), // Z
+                               inputSL.at(6).toFloat(), // time
+                               inputSL.at(7).toFloat(), // E
+                               0,                       // depoE
+                               "C");                    // process = 'C' which is "Creation"
+        step.setVolumeInfo(inputSL.at(9), inputSL.at(10).toInt(), inputSL.at(8).toInt());
         r->addStep(step);
     }
 
@@ -401,9 +401,8 @@ void ATrackingDataImporter::addTrackStep()
 
 void ATrackingDataImporter::addHistoryStep()
 {
-    ATrackingStepData * step = ( isTransportationStep() ? createHistoryTransportationStep()
-                                                        : createHistoryStep() );
-    CurrentParticleRecord->addStep(step);
+    CurrentParticleRecord->addStep( isTransportationStep() ? createHistoryTransportationStep()
+                                                           : createHistoryStep() );
 
     readSecondaries();
     for (const int & index : BsecVec)
@@ -414,76 +413,69 @@ void ATrackingDataImporter::addHistoryStep()
             return;
         }
         AParticleTrackingRecord * sr = AParticleTrackingRecord::create(); //empty!
-        step->Secondaries.push_back(CurrentParticleRecord->countSecondaries());
-        CurrentParticleRecord->addSecondary(sr);
+        CurrentParticleRecord->addSecondary(sr); // registered as created in the step added above
         PromisedSecondaries.insert(index, sr);
     }
 }
 
-ATrackingStepData *ATrackingDataImporter::createHistoryTransportationStep() const
+ATrackingStepData ATrackingDataImporter::createHistoryTransportationStep() const
 {
-    ATransportationStepData * step;
-
     if (bBinaryInput)
     {
-        step = new ATransportationStepData(Bpos[0],         // X
-                                           Bpos[1],         // Y
-                                           Bpos[2],         // Z
-                                           Btime,           // time
-                                           BkinEnergy,      // energy
-                                           BdepoEnergy,     // depoE
-                                           BprocessName.data());   // pr
+        ATrackingStepData step(Bpos[0],         // X
+                               Bpos[1],         // Y
+                               Bpos[2],         // Z
+                               Btime,           // time
+                               BkinEnergy,      // energy
+                               BdepoEnergy,     // depoE
+                               BprocessName.data());   // pr
 
-        step->setVolumeInfo(BnextVolName.data(), BnextVolIndex, BnextMat);
+        step.setVolumeInfo(BnextVolName.data(), BnextVolIndex, BnextMat);
+        return step;
     }
     else
     {
         // ProcName X Y Z Time KinE DirectDepoE iMatTo VolNameTo VolIndexTo [secondaries]
         //     0    1 2 3   4    5      6          7       8           9         ...
 
-        step = new ATransportationStepData(inputSL.at(1).toFloat(), // X
-                                           inputSL.at(2).toFloat(), // Y
-                                           inputSL.at(3).toFloat(), // Z
-                                           inputSL.at(4).toFloat(), // time
-                                           inputSL.at(5).toFloat(), // energy
-                                           inputSL.at(6).toFloat(), // depoE
-                                           inputSL.at(0));          // pr
+        ATrackingStepData step(inputSL.at(1).toFloat(), // X
+                               inputSL.at(2).toFloat(), // Y
+                               inputSL.at(3).toFloat(), // Z
+                               inputSL.at(4).toFloat(), // time
+                               inputSL.at(5).toFloat(), // energy
+                               inputSL.at(6).toFloat(), // depoE
+                               inputSL.at(0));          // pr
 
-        step->setVolumeInfo(inputSL.at(8), inputSL.at(9).toInt(), inputSL.at(7).toInt());
+        step.setVolumeInfo(inputSL.at(8), inputSL.at(9).toInt(), inputSL.at(7).toInt());
+        return step;
     }
-
-    return step;
 }
 
-ATrackingStepData * ATrackingDataImporter::createHistoryStep() const
+ATrackingStepData ATrackingDataImporter::createHistoryStep() const
 {
-    ATrackingStepData * step;
-
     if (bBinaryInput)
     {
-        step = new ATrackingStepData(Bpos[0],         // X
-                                     Bpos[1],         // Y
-                                     Bpos[2],         // Z
-                                     Btime,           // time
-                                     BkinEnergy,      // energy
-                                     BdepoEnergy,     // depoE
-                                     BprocessName.data());   // pr
+        return ATrackingStepData(Bpos[0],         // X
+                                 Bpos[1],         // Y
+                                 Bpos[2],         // Z
+                                 Btime,           // time
+                                 BkinEnergy,      // energy
+                                 BdepoEnergy,     // depoE
+                                 BprocessName.data());   // pr
     }
     else
     {
         // ProcName X Y Z Time KinE DirectDepoE [secondaries]
         //     0    1 2 3   4    5      6           ...
 
-        step = new ATrackingStepData(inputSL.at(1).toFloat(), // X
-                                     inputSL.at(2).toFloat(), // Y
-                                     inputSL.at(3).toFloat(), // Z
-                                     inputSL.at(4).toFloat(), // time
-                                     inputSL.at(5).toFloat(), // energy
-                                     inputSL.at(6).toFloat(), // depoE
-                                     inputSL.at(0));          // pr
+        return ATrackingStepData(inputSL.at(1).toFloat(), // X
+                                 inputSL.at(2).toFloat(), // Y
+                                 inputSL.at(3).toFloat(), // Z
+                                 inputSL.at(4).toFloat(), // time
+                                 inputSL.at(5).toFloat(), // energy
+                                 inputSL.at(6).toFloat(), // depoE
+                                 inputSL.at(0));          // pr
     }
-
-    return step;
 }
 
 void ATrackingDataImporter::readSecondaries()
@@ -97,8 +97,8 @@ private:
     void addTrackStep();
     void addHistoryStep();
     bool isTransportationStep() const;
-    ATrackingStepData * createHistoryTransportationStep() const;
-    ATrackingStepData * createHistoryStep() const;
+    ATrackingStepData createHistoryTransportationStep() const;
+    ATrackingStepData createHistoryStep() const;
     void readSecondaries();
     void readString(std::string & str) const;
 
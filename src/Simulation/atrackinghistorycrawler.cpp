@@ -16,6 +16,18 @@ void ATrackingHistoryCrawler::find(const AFindRecordSelector & criteria, AHistor
 {
     processor.beforeSearch();
 
+    // volume names are compared by their interned ids; a name never seen in the history cannot match
+    ATrackingNameTable & names = ATrackingNameTable::getInstance();
+    auto resolve = [&names](const TString & name)
+    {
+        const int id = names.findId(name.Data());
+        return (id == -1 ? -2 : id);
+    };
+    ANameIds ids;
+    ids.FromVolume = resolve(criteria.FromVolume);
+    ids.ToVolume   = resolve(criteria.ToVolume);
+    ids.Volume     = resolve(criteria.Volume);
+
     //int iEv = 0;
     for (const AEventTrackingRecord * e : History)
     {
@@ -24,7 +36,7 @@ void ATrackingHistoryCrawler::find(const AFindRecordSelector & criteria, AHistor
 
         const std::vector<AParticleTrackingRecord *> & prim = e->getPrimaryParticleRecords();
         for (const AParticleTrackingRecord * p : prim)
-            findRecursive(*p, criteria, processor);
+            findRecursive(*p, criteria, ids, processor);
 
         processor.onEventEnd();
     }
@@ -32,7 +44,7 @@ void ATrackingHistoryCrawler::find(const AFindRecordSelector & criteria, AHistor
     processor.afterSearch();
 }
 
-void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr, const AFindRecordSelector & opt, AHistorySearchProcessor & processor) const
+void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr, const AFindRecordSelector & opt, const ANameIds & ids, AHistorySearchProcessor & processor) const
 {
     bool bDoTrack = true;
 
@@ -52,31 +64,30 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
         bool bMaster = processor.onNewTrack(pr);
         bInlineTrackingOfSecondaries = processor.isInlineSecondaryProcessing(); // give a possibility to change the mode
 
-        QString curVolume;
+        int     curVolume = ATrackingNameTable::Empty;
         int     curVolIndex;
         int     curMat;
 
-        const std::vector<ATrackingStepData *> & steps = pr.getSteps();
+        const std::vector<ATrackingStepData> & steps = pr.getSteps();
         for (size_t iStep = 0; iStep < steps.size(); iStep++)
         {
-            const ATrackingStepData * thisStep = steps[iStep];
+            const ATrackingStepData * thisStep = &steps[iStep];
 
             // different handling of Transportation ("T", "O") and all other processes
             // Creation ("C") is checked as both "Transportation" and all other type process
 
             ProcessType ProcType;
-            if      (thisStep->Process == "C")
+            if      (thisStep->ProcessId == ATrackingNameTable::Creation)
             {
                 ProcType = Creation;
 
-                const ATransportationStepData * trStep = static_cast<const ATransportationStepData*>(thisStep);
-                curVolume = trStep->VolName;
-                curVolIndex = trStep->VolIndex;
-                curMat = trStep->iMaterial;
+                curVolume = thisStep->VolNameId;
+                curVolIndex = thisStep->VolIndex;
+                curMat = thisStep->iMaterial;
             }
-            else if (thisStep->Process == "T") ProcType = NormalTransportation;
-            else if (thisStep->Process == "O") ProcType = ExitingWorld;
-            else                               ProcType = Local;
+            else if (thisStep->ProcessId == ATrackingNameTable::Transportation) ProcType = NormalTransportation;
+            else if (thisStep->ProcessId == ATrackingNameTable::Out)            ProcType = ExitingWorld;
+            else                                                                ProcType = Local;
 
             if (ProcType == Creation || ProcType == NormalTransportation || ProcType == ExitingWorld)
             {
@@ -92,7 +103,7 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                     if (bCheckingExit)
                     {
                         const bool bRejectedByMaterial = (opt.bFromMat      && opt.FromMat      != curMat);
-                        const bool bRejectedByVolName  = (opt.bFromVolume   && opt.FromVolume   != curVolume);
+                        const bool bRejectedByVolName  = (opt.bFromVolume   && ids.FromVolume   != curVolume);
                         const bool bRejectedByVolIndex = (opt.bFromVolIndex && opt.FromVolIndex != curVolIndex);
                         bExitValidated = !(bRejectedByMaterial || bRejectedByVolName || bRejectedByVolIndex);
                     }
@@ -101,17 +112,16 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
 
                 bool bEntranceValidated;
                 const bool bCheckingEnter = (opt.bToMat || opt.bToVolume || opt.bToVolIndex);
-                if (thisStep->Process == "O")
+                if (ProcType == ExitingWorld)
                 {
                     bEntranceValidated = !bCheckingEnter; // if any check selected -> entrance is not valid
                 }
                 else if (bCheckingEnter)
                 {
-                    const ATransportationStepData * trStep = static_cast<const ATransportationStepData*>(thisStep); // "O" should not see this line!
                     {
-                        const bool bRejectedByMaterial = (opt.bToMat      && opt.ToMat      != trStep->iMaterial);
-                        const bool bRejectedByVolName  = (opt.bToVolume   && opt.ToVolume   != trStep->VolName);
-                        const bool bRejectedByVolIndex = (opt.bToVolIndex && opt.ToVolIndex != trStep->VolIndex);
+                        const bool bRejectedByMaterial = (opt.bToMat      && opt.ToMat      != thisStep->iMaterial);
+                        const bool bRejectedByVolName  = (opt.bToVolume   && ids.ToVolume   != thisStep->VolNameId);
+                        const bool bRejectedByVolIndex = (opt.bToVolIndex && opt.ToVolIndex != thisStep->VolIndex);
                         bEntranceValidated = !(bRejectedByMaterial || bRejectedByVolName || bRejectedByVolIndex);
                     }
                 }
@@ -121,7 +131,7 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                 if (opt.bCreated  && ProcType != Creation)     bEntranceValidated = false;
 
                 // if transition validated, calling onTransition (+paranoic test on existence of the prevStep - for Creation exit is always not validated
-                const ATrackingStepData * prevStep = (iStep == 0 ? nullptr : steps[iStep-1]);
+                const ATrackingStepData * prevStep = (iStep == 0 ? nullptr : &steps[iStep-1]);
                 if (bExitValidated && bEntranceValidated && prevStep)
                     processor.onTransition(*prevStep, *thisStep); // not the "next" step here! this is just to extract direction information
 
@@ -131,7 +141,7 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                     {
                         ATrackingStepData prevStep = *thisStep;
                         for (int i=0; i<3; i++)
-                            prevStep.Position[i] = 2.0 * thisStep->Position[i] - steps[1]->Position[i];
+                            prevStep.Position[i] = 2.0 * thisStep->Position[i] - steps[1].Position[i];
                         processor.onTransition(prevStep, *thisStep);
                     }
                 }
@@ -144,7 +154,7 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                     if (bCheckingExit)
                     {
                         const bool bRejectedByMaterial = (opt.bMaterial    && opt.Material    != curMat);
-                        const bool bRejectedByVolName  = (opt.bVolume      && opt.Volume      != curVolume);
+                        const bool bRejectedByVolName  = (opt.bVolume      && ids.Volume      != curVolume);
                         const bool bRejectedByVolIndex = (opt.bVolumeIndex && opt.VolumeIndex != curVolIndex);
                         bExitValidated = !(bRejectedByMaterial || bRejectedByVolName || bRejectedByVolIndex);
                     }
@@ -159,10 +169,9 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                     const bool bCheckingEnter = (opt.bMaterial || opt.bVolume || opt.bVolumeIndex);
                     if (bCheckingEnter)
                     {
-                        const ATransportationStepData * trStep = static_cast<const ATransportationStepData*>(thisStep); // "O" should not see this line!
-                        const bool bRejectedByMaterial = (opt.bMaterial    && opt.Material    != trStep->iMaterial);
-                        const bool bRejectedByVolName  = (opt.bVolume      && opt.Volume      != trStep->VolName);
-                        const bool bRejectedByVolIndex = (opt.bVolumeIndex && opt.VolumeIndex != trStep->VolIndex);
+                        const bool bRejectedByMaterial = (opt.bMaterial    && opt.Material    != thisStep->iMaterial);
+                        const bool bRejectedByVolName  = (opt.bVolume      && ids.Volume      != thisStep->VolNameId);
+                        const bool bRejectedByVolIndex = (opt.bVolumeIndex && opt.VolumeIndex != thisStep->VolIndex);
                         bEntranceValidated = !(bRejectedByMaterial || bRejectedByVolName || bRejectedByVolIndex);
                     }
                     else bEntranceValidated = true;
@@ -171,12 +180,11 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                 }
 
                 //now can update current volume info for transition step
-                if (thisStep->Process == "T")
+                if (ProcType == NormalTransportation)
                 {
-                    const ATransportationStepData * trStep = static_cast<const ATransportationStepData*>(thisStep);
-                    curVolume = trStep->VolName;
-                    curVolIndex = trStep->VolIndex;
-                    curMat = trStep->iMaterial;
+                    curVolume = thisStep->VolNameId;
+                    curVolIndex = thisStep->VolIndex;
+                    curMat = thisStep->iMaterial;
                 }
             }
 
@@ -188,14 +196,14 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                 {
                          if (opt.bMaterial    && opt.Material    != curMat) bSkipThisStep = true;
                     else if (opt.bVolumeIndex && opt.VolumeIndex != curVolIndex) bSkipThisStep = true;
-                    else if (opt.bVolume      && opt.Volume      != curVolume) bSkipThisStep = true;
+                    else if (opt.bVolume      && ids.Volume      != curVolume) bSkipThisStep = true;
                 }
                 if (!bSkipThisStep) processor.onLocalStep(*thisStep);
 
                 if (bInlineTrackingOfSecondaries)
                 {
-                    for (int iSec : thisStep->Secondaries)
-                        findRecursive(*pr.getSecondaries().at(iSec), opt, processor);
+                    for (int iSec = thisStep->FirstSecondary; iSec < thisStep->FirstSecondary + thisStep->NumSecondaries; iSec++)
+                        findRecursive(*pr.getSecondaries().at(iSec), opt, ids, processor);
 
                     if (!pr.getSecondaryOf() && opt.bLimitToFirstInteractionOfPrimary && ProcType != Creation)
                         break;
@@ -204,8 +212,8 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
                 {
                     if (!pr.getSecondaryOf() && opt.bLimitToFirstInteractionOfPrimary && ProcType != Creation)
                     {
-                        if (thisStep->Secondaries.empty()) bSkipTrackingOfSecondaries = true;
-                        else lastSecondaryToTrack = pr.getSecondaries().at( thisStep->Secondaries.back() );
+                        if (thisStep->NumSecondaries == 0) bSkipTrackingOfSecondaries = true;
+                        else lastSecondaryToTrack = pr.getSecondaries().at( thisStep->FirstSecondary + thisStep->NumSecondaries - 1 );
                         break;
                     }
                 }
@@ -223,7 +231,7 @@ void ATrackingHistoryCrawler::findRecursive(const AParticleTrackingRecord & pr,
             const std::vector<AParticleTrackingRecord *> & secondaries = pr.getSecondaries();
             for (AParticleTrackingRecord * sec : secondaries)
             {
-                findRecursive(*sec, opt, processor);
+                findRecursive(*sec, opt, ids, processor);
                 if (sec == lastSecondaryToTrack) break;
             }
         }
@@ -454,7 +462,7 @@ void AHistorySearchProcessor_findProcesses::onLocalStep(const ATrackingStepData
 {
     if (validateStep(tr))
     {
-        const QString & Proc = tr.Process;
+        const QString & Proc = tr.getProcess();
         QMap<QString, int>::iterator it = FoundProcesses.find(Proc);
         if (it == FoundProcesses.end())
             FoundProcesses.insert(Proc, 1);
@@ -490,7 +498,7 @@ bool AHistorySearchProcessor_findProcesses::validateStep(const ATrackingStepData
     {
     case All :                  return true;
     case WithEnergyDeposition : return (tr.DepositedEnergy != 0);
-    case TrackEnd :             return (tr.Energy == 0 || tr.Process == "O");
+    case TrackEnd :             return (tr.Energy == 0 || tr.ProcessId == ATrackingNameTable::Out);
     }
     return false; // just to avoid warning
 }
@@ -276,7 +276,9 @@ private:
 
     enum ProcessType {Creation, Local, NormalTransportation, ExitingWorld};
 
-    void findRecursive(const AParticleTrackingRecord & pr, const AFindRecordSelector &opt, AHistorySearchProcessor & processor) const;
+    struct ANameIds {int FromVolume; int ToVolume; int Volume;}; // selector volume names resolved in ATrackingNameTable
+
+    void findRecursive(const AParticleTrackingRecord & pr, const AFindRecordSelector &opt, const ANameIds & ids, AHistorySearchProcessor & processor) const;
 };
 
 #endif // ATRACKINGHISTORYCRAWLER_H
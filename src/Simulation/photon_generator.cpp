@@ -3,9 +3,11 @@
 #include "amaterialparticlecolection.h"
 #include "ageneralsimsettings.h"
 #include "aphoton.h"
+#include "aphotonpacket.h"
 #include "aoneevent.h"
 #include "apmhub.h"
 #include "alrfmoduleselector.h"
+#include "acommonfunctions.h"
 
 #include <QDebug>
 
@@ -42,7 +44,7 @@ void Photon_Generator::GenerateWave(APhoton *Photon, int materialId) const
     {
         if (SimSet->fWaveResolved && Material->PrimarySpectrumHist)
         {
-            double wavelength = Material->PrimarySpectrumHist->GetRandom();
+            double wavelength = Material->GeneratePrimaryWavelength(&RandGen);
             Photon->waveIndex = (wavelength - SimSet->WaveFrom)/SimSet->WaveStep;
             //  qDebug()<<"prim! lambda "<<wavelength<<" index:"<<Photon->waveIndex;
         }
@@ -52,7 +54,7 @@ void Photon_Generator::GenerateWave(APhoton *Photon, int materialId) const
     {
         if (SimSet->fWaveResolved && Material->SecondarySpectrumHist)
         {
-            double wavelength = Material->SecondarySpectrumHist->GetRandom();
+            double wavelength = Material->GenerateSecondaryWavelength(&RandGen);
             Photon->waveIndex = (wavelength - SimSet->WaveFrom)/SimSet->WaveStep;
             //  qDebug()<<"sec! lambda "<<wavelength<<" index:"<<Photon->waveIndex;
         }
@@ -74,6 +76,36 @@ void Photon_Generator::GenerateTime(APhoton *Photon, int materialId) const
     //  qDebug()<<"Final time"<<Photon->time;
 }
 
+void Photon_Generator::GeneratePacket(APhotonPacket & Packet, const double * r, double time, int numPhotons, int materialId) const
+{
+    APhoton Photon;
+    Photon.r[0] = r[0];
+    Photon.r[1] = r[1];
+    Photon.r[2] = r[2];
+    Photon.scint_type = Packet.scint_type;
+
+    //wavelengths of the whole packet are sampled in one batch
+    const AMaterial* Material = (*Detector.MpCollection)[materialId];
+    const TH1D* spectrum = (Packet.scint_type == 1 ? Material->PrimarySpectrumHist : Packet.scint_type == 2 ? Material->SecondarySpectrumHist : nullptr);
+    QVector<double> wavelengths;
+    if (SimSet->fWaveResolved && spectrum)
+    {
+        wavelengths.resize(numPhotons);
+        Material->GenerateWavelengths(Packet.scint_type, &RandGen, numPhotons, wavelengths.data());
+    }
+
+    Packet.reserve(Packet.size() + numPhotons);
+    for (int i = 0; i < numPhotons; i++)
+    {
+        Photon.time = time;
+        GenerateDirection(&Photon);
+        if (wavelengths.isEmpty()) GenerateWave(&Photon, materialId);
+        else Photon.waveIndex = (wavelengths.at(i) - SimSet->WaveFrom)/SimSet->WaveStep;
+        GenerateTime(&Photon, materialId);
+        Packet.append(Photon.r, Photon.v, Photon.waveIndex, Photon.time);
+    }
+}
+
 void Photon_Generator::GenerateSignalsForLrfMode(int NumPhotons, double* r, AOneEvent* OneEvent)
 {
     double energy = 1.0 * NumPhotons / SimSet->NumPhotsForLrfUnity; // NumPhotsForLRFunity corresponds to the total number of photons per event for unitary LRF
@@ -3,6 +3,7 @@
 
 class DetectorClass;
 class APhoton;
+class APhotonPacket;
 class AGeneralSimSettings;
 class ASimulationStatistics;
 class AOneEvent;
@@ -16,6 +17,7 @@ public:
     void GenerateDirection(APhoton *Photon) const;
     void GenerateWave(APhoton *Photon, int materialId) const;
     void GenerateTime(APhoton *Photon, int materialId) const;
+    void GeneratePacket(APhotonPacket & Packet, const double * r, double time, int numPhotons, int materialId) const; //isotropic photons from one point, appended to the packet
 
     void configure(const AGeneralSimSettings *simSet, ASimulationStatistics* detStat) {SimSet = simSet; DetStat = detStat;}
 
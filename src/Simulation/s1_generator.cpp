@@ -9,6 +9,8 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 #include "TRandom2.h"
 
 S1_Generator::S1_Generator(Photon_Generator *photonGenerator, APhotonTracer *photonTracker, AMaterialParticleCollection *materialCollection, QVector<AEnergyDepositionCell *> *energyVector, QVector<GeneratedPhotonsHistoryStructure> *PhotonsHistory, TRandom2* RandomGenerator)
@@ -75,6 +77,18 @@ bool S1_Generator::Generate() //uses MW->EnergyVector as the input parameter
 
         if (PhotonGenerator->SimSet->fLRFsim)
             PhotonGenerator->GenerateSignalsForLrfMode(NumPhotons, (*EnergyVector)[iEv]->r, PhotonTracker->getEvent());
+        else if (PhotonGenerator->SimSet->PhotonPacketSize > 0)
+        {
+            Packet.scint_type = 1;
+            Packet.SimStat = PhotonGenerator->DetStat;
+            const int PacketSize = PhotonGenerator->SimSet->PhotonPacketSize;
+            for (int iFrom = 0; iFrom < NumPhotons; iFrom += PacketSize)
+            {
+                Packet.clear();
+                PhotonGenerator->GeneratePacket(Packet, (*EnergyVector)[iEv]->r, (*EnergyVector)[iEv]->time, std::min(PacketSize, NumPhotons - iFrom), MatId);
+                PhotonTracker->TracePacket(Packet);
+            }
+        }
         else
         {
             //generate photons
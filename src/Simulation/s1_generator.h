@@ -2,6 +2,7 @@
 #define S1_GENERATOR_H
 
 #include "ahistoryrecords.h"
+#include "aphotonpacket.h"
 
 #include <QVector>
 
@@ -34,6 +35,7 @@ private:
     QVector<GeneratedPhotonsHistoryStructure>* GeneratedPhotonsHistory = nullptr;
 
     bool DoTextLog = false;
+    APhotonPacket Packet; //reused to avoid re-allocations
 };
 
 #endif // S1_GENERATOR_H
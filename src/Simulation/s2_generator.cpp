@@ -215,6 +215,14 @@ void S2_Generator::generateAndTracePhotons(double * Position, double Time, int N
     Photon.SimStat = PhotonGenerator->DetStat;
 
     const double DriftVelocity = MaterialCollection->getDriftSpeed(MatIndexSecScint);
+    const int PacketSize = PhotonGenerator->SimSet->PhotonPacketSize;
+    if (PacketSize > 0)
+    {
+        Packet.clear();
+        Packet.scint_type = 2;
+        Packet.SimStat = Photon.SimStat;
+    }
+
     for (int iPhoton = 0; iPhoton < NumPhotonsToGenerate; iPhoton++)
     {
         //random z inside secondary scintillator
@@ -225,8 +233,20 @@ void S2_Generator::generateAndTracePhotons(double * Position, double Time, int N
         PhotonGenerator->GenerateDirection(&Photon);
         PhotonGenerator->GenerateWave(&Photon, MatIndexSecScint);
         PhotonGenerator->GenerateTime(&Photon, MatIndexSecScint);
-        PhotonTracker->TracePhoton(&Photon);
+
+        if (PacketSize > 0)
+        {
+            Packet.append(Photon.r, Photon.v, Photon.waveIndex, Photon.time);
+            if (Packet.size() == PacketSize)
+            {
+                PhotonTracker->TracePacket(Packet);
+                Packet.clear();
+            }
+        }
+        else PhotonTracker->TracePhoton(&Photon);
     }
+
+    if (PacketSize > 0) PhotonTracker->TracePacket(Packet);
 }
 
 bool S2_Generator::initLogger()
@@ -2,6 +2,7 @@
 #define S2_GENERATOR_H
 
 #include "ahistoryrecords.h"
+#include "aphotonpacket.h"
 
 #include <QVector>
 
@@ -53,6 +54,8 @@ private:
     bool DoTextLog = false;
     bool OnlySecondary;
 
+    APhotonPacket Packet; //reused to avoid re-allocations
+
     int RecordNumber = 0; //tracer for photon log index, not used if OnlySecondary is true
 
     int ThisId;
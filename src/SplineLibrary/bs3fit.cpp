@@ -2,8 +2,11 @@
 #include "bspline3.h"
 #include <Eigen/Dense>
 #include "eiquadprog.hpp"
+#include "normaleq.h"
 #include <TProfile.h>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 //#include <vector>
 
@@ -80,51 +83,89 @@ bool BS3fit::Fit()
     return Fit(vw.size(), &vx[0], &vy[0], &vw[0]);
 }
 
+// index of the first basis function which can be non-zero at x; at most 4 are non-zero
+static int FirstBasis(const Bspline3 *bs, double x)
+{
+    return (int)floor((x-bs->GetXmin())/(bs->GetXmax()-bs->GetXmin())*bs->GetNint());
+}
+
 bool BS3fit::Fit(int npts, double const *datax, double const *datay, double const *dataw)
 {
 // linear least squares
-// we've got npts equations with nbas unknowns
-    MatrixXd A(npts, nbas);
+// we've got npts equations with nbas unknowns, but at most 4 non-zero coefficients per equation:
+// the normal equations A'A x = A'y are accumulated directly, A'A is banded (bandwidth 3)
+    NormalEq ne(nbas, 3);
     VectorXd y(npts);
     VectorXd x;
 
+// coefficients of the equation for point i; returns the number of non-zero ones
+    auto fillRow = [&](int i, int *idx, double *a) {
+        const int k0 = FirstBasis(bs, datax[i]);
+        int nnz = 0;
+        for (int k=std::max(0, k0); k<std::min(nbas, k0+4); k++) {
+            if (dataw == 0)             // for not weighted data
+                a[nnz] = bs->Basis(datax[i], k);
+            else if (dataw[i] > 0.5)    // normal point (W >= 1)
+                a[nnz] = bs->Basis(datax[i], k) * dataw[i];
+            else                        // missing point (W == 0) - make it smooth by setting 2nd derivative to zero
+                a[nnz] = bs->BasisDrv2(datax[i], k);
+            idx[nnz] = k;
+            nnz++;
+        }
+        return nnz;
+    };
+
 // fill the equations
-    if (dataw == 0) {   // for not weighted data
-        for (int i=0; i<npts; i++) {
+    int idx[4];
+    double a[4];
+    for (int i=0; i<npts; i++) {
+        const int nnz = fillRow(i, idx, a);
+        if (dataw == 0)
             y(i) = datay[i];
-            for (int k=0; k<nbas; k++)
-                A(i, k) = bs->Basis(datax[i], k);
-        }
-    } else {            // for weighted data
-        for (int i=0; i<npts; i++) {
-            if (dataw[i] > 0.5) { // normal point (W >= 1)
-                y(i) = datay[i] * dataw[i];
-                for (int k=0; k<nbas; k++)
-                    A(i, k) = bs->Basis(datax[i], k) * dataw[i];
-            } else {            // missing point (W == 0) - make it smooth by setting 2nd derivative to zero
-                y(i) = 0.;
-                for (int k=0; k<nbas; k++)
-                    A(i, k) = bs->BasisDrv2(datax[i], k);
-            }
-        }
+        else
+            y(i) = dataw[i] > 0.5 ? datay[i] * dataw[i] : 0.;
+        ne.AddRow(nnz, idx, a, y(i));
     }
 
+    std::vector <double> coef;
     if (!non_negative && !non_increasing && !even) { // unconstrained fit
-    // solve the system using SVD
-        JacobiSVD <MatrixXd> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
-          //std::cout << "Singular values: " << svd.singularValues();
-        x = svd.solve(y);
+    // solve the normal equations with band Cholesky decomposition
+        if (ne.Solve(coef)) {
+            x = Eigen::Map<VectorXd>(coef.data(), nbas);
+            residual = sqrt(ne.SquaredResidual(coef));
+        } else {
+    // singular system: solve it using SVD (minimum norm solution); the full matrix is only built here
+            MatrixXd A = MatrixXd::Zero(npts, nbas);
+            for (int i=0; i<npts; i++) {
+                const int nnz = fillRow(i, idx, a);
+                for (int k=0; k<nnz; k++)
+                    A(i, idx[k]) = a[k];
+            }
+            JacobiSVD <MatrixXd> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+              //std::cout << "Singular values: " << svd.singularValues();
+            x = svd.solve(y);
+
+            VectorXd r = A*x - y;
+            residual = sqrt(r.squaredNorm());
+        }
 
-        VectorXd r = A*x - y;
-        residual = sqrt(r.squaredNorm());
+    } else if (non_negative && !non_increasing && !even && ne.SolveNonNegative(coef)) {
+    // only the bounds x >= 0: active set method on the banded reduced systems
+        x = Eigen::Map<VectorXd>(coef.data(), nbas);
+        residual = 0.5*(ne.SquaredResidual(coef) - ne.GetYY()); // the same as the quadprog minimum below
 
     } else { // constrained fit
 
     // solve the system using quadratic programming, i.e.
     // minimize 1/2 * x G x + g0 x subject to some inequality and equality constraints,
     // where G = A'A and g0 = -y'A (' denotes transposition)
-        MatrixXd G = A.transpose()*A;
-        VectorXd g0 = (y.transpose()*A)*(-1.);
+        MatrixXd G(nbas, nbas);
+        VectorXd g0(nbas);
+        for (int i=0; i<nbas; i++) {
+            g0(i) = -ne.Getg(i);
+            for (int j=0; j<nbas; j++)
+                G(i, j) = ne.GetG(i, j);
+        }
 
     // ineqaulity constraints:
         MatrixXd CI;
@@ -157,12 +198,6 @@ bool BS3fit::Fit(int npts, double const *datax, double const *datay, double cons
         }
 
     /*
-        std::cout << "A:" << std::endl;
-        std::cout << A << std::endl;
-
-        std::cout << "y:" << std::endl;
-        std::cout << y << std::endl;
-
         std::cout << "G:" << std::endl;
         std::cout << G << std::endl;
 
@@ -23,6 +23,12 @@
 
 #include "bspline3.h"
 
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 Bspline3::Bspline3() : xl(0), xr(0), dx(0), nint(0), nbas(0) { }
 
 Bspline3::Bspline3(double xmin, double xmax, int n_int) : xl(xmin), xr(xmax), nint(n_int)
@@ -210,6 +216,59 @@ Bspline3::value_type Bspline3::Eval(value_type x) const
 	return pi[0] + xf*(pi[1] + xf*(pi[2] + xf*pi[3]));
 }
 
+// same result as Eval() for every point: the interval index is clamped to the last interval (x == xr),
+// points outside of the range and NaNs give 0
+void Bspline3::EvalBatch(int n, const value_type *x, value_type *out) const
+{
+	if (poly.empty()) {
+		for (int i=0; i<n; i++) out[i] = 0.;
+		return;
+	}
+	int i = 0;
+#ifdef __AVX2__
+	const double *pp = poly[0].p;
+	const __m256d vxl = _mm256_set1_pd(xl);
+	const __m256d vxr = _mm256_set1_pd(xr);
+	const __m256d vdx = _mm256_set1_pd(dx);
+	const __m256d vnint = _mm256_set1_pd(nint);
+	const __m256d vlast = _mm256_set1_pd(nint-1);
+	for (; i+4<=n; i+=4) {
+		__m256d vx = _mm256_loadu_pd(x+i);
+		const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(vx, vxl, _CMP_GE_OQ), _mm256_cmp_pd(vx, vxr, _CMP_LE_OQ));
+		vx = _mm256_blendv_pd(vxl, vx, inside);
+		const __m256d xi = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(vx, vxl), vdx), vnint);
+		const __m256d fi = _mm256_min_pd(_mm256_floor_pd(xi), vlast);
+		const __m256d xf = _mm256_sub_pd(xi, fi);
+		const __m128i idx = _mm_slli_epi32(_mm256_cvttpd_epi32(fi), 2); // 4 coefficients per interval
+
+		__m256d sum = _mm256_i32gather_pd(pp+3, idx, 8);
+		sum = _mm256_add_pd(_mm256_i32gather_pd(pp+2, idx, 8), _mm256_mul_pd(xf, sum));
+		sum = _mm256_add_pd(_mm256_i32gather_pd(pp+1, idx, 8), _mm256_mul_pd(xf, sum));
+		sum = _mm256_add_pd(_mm256_i32gather_pd(pp,   idx, 8), _mm256_mul_pd(xf, sum));
+		_mm256_storeu_pd(out+i, _mm256_and_pd(sum, inside));
+	}
+#endif
+	for (; i<n; i++)
+		out[i] = Eval(x[i]);
+}
+
+void Bspline3::EvalDrvBatch(int n, const value_type *x, value_type *val, value_type *drv) const
+{
+	const double scale = nint/dx;
+	for (int i=0; i<n; i++) {
+		if (poly.empty() || !(x[i]>=xl && x[i]<=xr)) {
+			val[i] = drv[i] = 0.;
+			continue;
+		}
+		double xi = (x[i]-xl)/dx*nint;
+		int ix = std::min((int)xi, nint-1);
+		double xf = xi - ix;
+		const value_type *pi = poly[ix].p;
+		val[i] = pi[0] + xf*(pi[1] + xf*(pi[2] + xf*pi[3]));
+		drv[i] = (pi[1] + xf*(2.*pi[2] + xf*3.*pi[3]))*scale;
+	}
+}
+
 double Bspline3::Eval(double *x, double* /*p*/)	// insertable into ROOT function
 {
 	return Eval(x[0]);
@@ -74,6 +74,8 @@ public:
 	value_type Eval_greedy(value_type x);
 	value_type Eval_x_phobic(value_type x);
 	value_type Eval(value_type x) const;
+	void EvalBatch(int n, const value_type *x, value_type *out) const; // out[i] = Eval(x[i]), vectorized if AVX2 is available
+	void EvalDrvBatch(int n, const value_type *x, value_type *val, value_type *drv) const; // value and d/dx (EvalDrv() gives derivative per interval)
 	double Eval(double *x, double *p);	// insertable into a ROOT function
 	Bspline3::value_type EvalDrv(value_type x);
 	double EvalDrv(double *x, double *p);	// insertable into a ROOT function
@@ -0,0 +1,159 @@
+#include "normaleq.h"
+
+#include <algorithm>
+#include <cmath>
+
+NormalEq::NormalEq(int n, int bw) : n(n), bw(bw)
+{
+    G.assign(n*(bw+1), 0.);
+    g.assign(n, 0.);
+}
+
+void NormalEq::AddRow(int nnz, const int *idx, const double *a, double y)
+{
+    const int w = bw + 1;
+    for (int k=0; k<nnz; k++) {
+        const int i = idx[k];
+        g[i] += a[k]*y;
+        for (int l=0; l<nnz; l++) {
+            const int j = idx[l];
+            if (j <= i)
+                G[i*w + i-j] += a[k]*a[l];
+        }
+    }
+    yy += y*y;
+}
+
+double NormalEq::GetG(int i, int j) const
+{
+    if (j > i) std::swap(i, j);
+    if (i-j > bw) return 0.;
+    return G[i*(bw+1) + i-j];
+}
+
+bool NormalEq::Solve(std::vector<double> &x) const
+{
+    std::vector<int> vars(n);
+    for (int i=0; i<n; i++)
+        vars[i] = i;
+    return solveSubset(vars, x);
+}
+
+bool NormalEq::solveSubset(const std::vector<int> &vars, std::vector<double> &x) const
+{
+    x.assign(n, 0.);
+    const int m = vars.size();
+    if (m == 0) return true;
+
+// reduced system: dropping unknowns does not widen the band
+    const int w = bw + 1;
+    std::vector<double> L(m*w, 0.);
+    std::vector<double> b(m);
+    for (int ri=0; ri<m; ri++) {
+        const int i = vars[ri];
+        b[ri] = g[i];
+        for (int rj=ri; rj>=0 && i-vars[rj]<=bw; rj--)
+            L[ri*w + ri-rj] = G[i*w + i-vars[rj]];
+    }
+
+// band Cholesky G = L L'
+    for (int i=0; i<m; i++) {
+        const int j0 = std::max(0, i-bw);
+        for (int j=j0; j<=i; j++) {
+            double s = L[i*w + i-j];
+            for (int k=std::max(j0, j-bw); k<j; k++)
+                s -= L[i*w + i-k]*L[j*w + j-k];
+            if (i == j) {
+                const double diag = L[i*w];
+                if (!(diag > 0.) || !(s > diag*1e-14))
+                    return false; // singular or not positive definite
+                L[i*w] = sqrt(s);
+            } else
+                L[i*w + i-j] = s/L[j*w];
+        }
+    }
+
+// L z = b, then L' x = z
+    for (int i=0; i<m; i++) {
+        double s = b[i];
+        for (int k=std::max(0, i-bw); k<i; k++)
+            s -= L[i*w + i-k]*b[k];
+        b[i] = s/L[i*w];
+    }
+    for (int i=m-1; i>=0; i--) {
+        double s = b[i];
+        for (int k=i+1; k<=std::min(m-1, i+bw); k++)
+            s -= L[k*w + k-i]*b[k];
+        b[i] = s/L[i*w];
+    }
+
+    for (int ri=0; ri<m; ri++)
+        x[vars[ri]] = b[ri];
+    return true;
+}
+
+bool NormalEq::SolveNonNegative(std::vector<double> &x, int maxIter) const
+{
+    if (maxIter < 1) maxIter = 5*n + 50;
+
+    double gmax = 0;
+    for (int i=0; i<n; i++)
+        gmax = std::max(gmax, fabs(g[i]));
+    const double gtol = gmax*1e-12;
+
+// block principal pivoting (Kim & Park): start with all unknowns free, at every step all infeasible
+// unknowns change the set at once; if it stops reducing the number of infeasibilities, one at a time
+    std::vector<char> isFree(n, 1);
+    std::vector<int> vars, infeasible;
+    int ninf = n+1;
+    int tries = 3;
+    for (int iter=0; iter<maxIter; iter++) {
+        vars.clear();
+        for (int i=0; i<n; i++)
+            if (isFree[i]) vars.push_back(i);
+        if (!solveSubset(vars, x))
+            return false;
+
+        infeasible.clear();
+        for (int i=0; i<n; i++) {
+            if (isFree[i]) {
+                if (x[i] < 0.) infeasible.push_back(i);
+            } else {
+            // gradient of 1/2 x'Gx - g'x must be non-negative for the unknowns fixed at 0
+                double grad = -g[i];
+                for (int j=std::max(0, i-bw); j<=std::min(n-1, i+bw); j++)
+                    grad += GetG(i, j)*x[j];
+                if (grad < -gtol) infeasible.push_back(i);
+            }
+        }
+
+        if (infeasible.empty())
+            return true;
+
+        if ((int)infeasible.size() < ninf) {
+            ninf = infeasible.size();
+            tries = 3;
+        } else if (tries > 0)
+            tries--;
+        else
+            infeasible.erase(infeasible.begin(), infeasible.end()-1);
+
+        for (int i : infeasible)
+            isFree[i] = !isFree[i];
+    }
+    return false;
+}
+
+double NormalEq::SquaredResidual(const std::vector<double> &x) const
+{
+// |Ax-y|^2 = x'Gx - 2g'x + y'y
+    const int w = bw + 1;
+    double sum = yy;
+    for (int i=0; i<n; i++) {
+        sum -= 2.*g[i]*x[i];
+        sum += G[i*w]*x[i]*x[i];
+        for (int j=std::max(0, i-bw); j<i; j++)
+            sum += 2.*G[i*w + i-j]*x[i]*x[j];
+    }
+    return std::max(0., sum);
+}
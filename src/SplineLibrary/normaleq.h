@@ -0,0 +1,42 @@
+#ifndef NORMALEQ_H
+#define NORMALEQ_H
+
+#include <vector>
+
+// Normal equations G x = g (G = A'A, g = A'y) of a linear least squares problem A x = y,
+// accumulated row by row from the non-zero elements of A only.
+// For spline bases G is banded: G(i,j) = 0 for |i-j| > bw, only the lower band is stored.
+// The solvers use the band Cholesky decomposition: O(n*bw^2) operations, O(n*bw) memory
+class NormalEq
+{
+public:
+    NormalEq(int n, int bw);
+
+    // adds equation sum_k a[k]*x[idx[k]] = y; all idx of one row should be within bw of each other
+    void AddRow(int nnz, const int *idx, const double *a, double y);
+
+    int GetN() const {return n;}
+    double GetG(int i, int j) const; // 0 outside of the band
+    double Getg(int i) const {return g[i];}
+    double GetYY() const {return yy;}   // y'y
+
+    // false if G is not (numerically) positive definite
+    bool Solve(std::vector<double> &x) const;
+    // min |Ax-y| subject to x >= 0: active set (block principal pivoting) on the reduced systems
+    // false if the reduced system can not be solved or no convergence in maxIter iterations
+    bool SolveNonNegative(std::vector<double> &x, int maxIter = 0) const;
+
+    double SquaredResidual(const std::vector<double> &x) const; // |Ax-y|^2
+
+private:
+    int n;
+    int bw;
+    std::vector<double> G; // G(i,j), j = i-bw..i, is at [i*(bw+1) + i-j]
+    std::vector<double> g;
+    double yy = 0;
+
+    // solves the subsystem for the listed unknowns (sorted); the others are fixed at 0
+    bool solveSubset(const std::vector<int> &vars, std::vector<double> &x) const;
+};
+
+#endif // NORMALEQ_H
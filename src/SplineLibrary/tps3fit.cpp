@@ -9,11 +9,12 @@
 #include <Eigen/SparseQR>
 #include <Eigen/OrderingMethods>
 #include "eiquadprog.hpp"
+#include "normaleq.h"
 #include <TProfile2D.h>
 #include <iostream>
+#include <algorithm>
 
 #include <QDebug>
-#include <QTime>
 
 
 //#include <vector>
@@ -104,97 +105,97 @@ bool TPS3fit::Fit()
 }
 
 
-bool TPS3fit::Fit(int npts, double const *datax, double const *datay, double const *dataz, double const *dataw)
+// index of the first basis function which can be non-zero at x; at most 4 are non-zero
+static int FirstBasis(const Bspline3 &bs, double x)
 {
-    QTime myTimer;
-
-// for the case of weighted data with missing points,
-// we need to make a provision for additional 2nd derivative equations
-    int missing = 0;
-    int missing_ptr = npts; // put the additional equations in the end
-
-    if (dataw != 0) {
-        for (int i=0; i<npts; i++)
-            if (dataw[i] < 0.5) // missing point
-                missing++;
-    }
+    return (int)floor((x-bs.GetXmin())/(bs.GetXmax()-bs.GetXmin())*bs.GetNint());
+}
 
+bool TPS3fit::Fit(int npts, double const *datax, double const *datay, double const *dataz, double const *dataw)
+{
 // linear least squares
 // we've got nbas unknowns to determine from npts equations
-// (plus additional 2 equations per each missing point because of partial derivatives)
-    MatrixXd A(npts+missing*2, nbas);
-    VectorXd y(npts+missing*2);
+// (plus additional 2 equations per each missing point because of partial derivatives),
+// but at most 4x4 non-zero coefficients per equation: the normal equations A'A x = A'y are
+// accumulated directly. With k = ix + iy*nbasx, A'A is banded (bandwidth 3*nbasx + 3)
+    const int nbasx = bs->GetBSX().GetNbas();
+    const int nbasy = bs->GetBSY().GetNbas();
+    NormalEq ne(nbas, 3*nbasx + 3);
     VectorXd x;
 
-// fill the equations
-    if (dataw == 0) {   // for not weighted data
-        for (int i=0; i<npts; i++) {
-            y(i) = dataz[i]; // yeah, that's not a typo :)
-            for (int k=0; k<nbas; k++)
-                A(i, k) = bs->Basis(datax[i], datay[i], k);
-        }
-    } else {            // for weighted data
-        for (int i=0; i<npts; i++) {
-            if (dataw[i] > 0.5) { // normal point (W >= 1)
-                y(i) = dataz[i] * dataw[i];
-                for (int k=0; k<nbas; k++)
-                    A(i, k) = bs->Basis(datax[i], datay[i], k) * dataw[i];
-            } else {            // missing point (W == 0) - make it smooth by setting 2nd derivatives to zero
-// in 2D case it will be d2/dxdy, d2/dx2 and d2/dy2
-// the first goes in place the of the original equation
-// and the other two to the additional rows reserved in the end
-                y(i) = 0.;
-                for (int k=0; k<nbas; k++)
-                    A(i, k) = bs->BasisDrv2XY(datax[i], datay[i], k);
-
-                y(missing_ptr) = 0.;
-                for (int k=0; k<nbas; k++)
-                    A(missing_ptr, k) = bs->BasisDrv2XX(datax[i], datay[i], k);
-                missing_ptr++;
-
-                y(missing_ptr) = 0.;
-                for (int k=0; k<nbas; k++)
-                    A(missing_ptr, k) = bs->BasisDrv2YY(datax[i], datay[i], k);
-                missing_ptr++;
+    int idx[16];
+    double a[16];
+    double axx[16], ayy[16];
+// coefficients of the equations for point i (axx, ayy only for a missing point); returns the number of non-zero ones
+    auto fillPoint = [&](int i, bool missing) {
+        const int kx0 = FirstBasis(bs->GetBSX(), datax[i]);
+        const int ky0 = FirstBasis(bs->GetBSY(), datay[i]);
+        int nnz = 0;
+        for (int ky=std::max(0, ky0); ky<std::min(nbasy, ky0+4); ky++)
+            for (int kx=std::max(0, kx0); kx<std::min(nbasx, kx0+4); kx++) {
+                const int k = kx + ky*nbasx;
+                idx[nnz] = k;
+                if (dataw == 0)         // for not weighted data
+                    a[nnz] = bs->Basis(datax[i], datay[i], k);
+                else if (!missing)      // normal point (W >= 1)
+                    a[nnz] = bs->Basis(datax[i], datay[i], k) * dataw[i];
+                else {                  // missing point (W == 0) - make it smooth by setting 2nd derivatives to zero
+                    a[nnz] = bs->BasisDrv2XY(datax[i], datay[i], k);
+                    axx[nnz] = bs->BasisDrv2XX(datax[i], datay[i], k);
+                    ayy[nnz] = bs->BasisDrv2YY(datax[i], datay[i], k);
+                }
+                nnz++;
             }
+        return nnz;
+    };
+
+// fill the equations; the equations for the 2nd derivatives are extra rows
+    int nrows = 0;
+    for (int i=0; i<npts; i++) {
+        const bool missing = dataw != 0 && dataw[i] < 0.5;
+        const int nnz = fillPoint(i, missing);
+        if (!missing) {
+            ne.AddRow(nnz, idx, a, dataw == 0 ? dataz[i] : dataz[i] * dataw[i]); // yeah, that's not a typo :)
+            nrows++;
+        } else {
+// in 2D case it will be d2/dxdy, d2/dx2 and d2/dy2
+            ne.AddRow(nnz, idx, a, 0.);
+            ne.AddRow(nnz, idx, axx, 0.);
+            ne.AddRow(nnz, idx, ayy, 0.);
+            nrows += 3;
         }
     }
 
+    std::vector <double> coef;
     if (!non_negative && !non_increasing_x && !slope_y && !flat_top_x && !top_down) { // unconstrained fit
-    // solve the system using QR decomposition (SVD is too slow)
-        sparse = true;
-        if (!sparse) {
-            myTimer.start();
-            x = A.colPivHouseholderQr().solve(y);
-            qDebug() << "Solve: " << myTimer.elapsed();
-            VectorXd r = A*x - y;
-            residual = sqrt(r.squaredNorm());
-        } else { // sparse version - EXPERIMENTAL
-            int nz_elem = 0;
-            for (int i=0; i<A.rows(); i++)
-                for (int j=0; j<A.cols(); j++)
-                    if (A(i,j) != 0.)
-                        nz_elem++;
-
-            qDebug() << "Non-zero elements: " << nz_elem;
-
-            qDebug() << "Make triplet list";
-            myTimer.start();
-            std::vector <Eigen::Triplet<double> > tripletList;
-            tripletList.reserve(nz_elem);
-            for (int i=0; i<A.rows(); i++)
-                for (int j=0; j<A.cols(); j++)
-                    if (A(i,j) != 0.)
-                        tripletList.push_back(Eigen::Triplet<double>(i,j,A(i,j)));
-            qDebug() << "Done: " << myTimer.elapsed();
-            qDebug() << "Fill sparse matrix";
-            myTimer.start();
-            SparseMatrix <double> A_sp(A.rows(),A.cols());
-            A_sp.setFromTriplets(tripletList.begin(), tripletList.end());
-            qDebug() << "Done: " << myTimer.elapsed();
-
-            qDebug() << "Solving Sparse system";
-            myTimer.start();
+    // solve the normal equations with band Cholesky decomposition
+        if (ne.Solve(coef)) {
+            x = Eigen::Map<VectorXd>(coef.data(), nbas);
+            residual = sqrt(ne.SquaredResidual(coef));
+        } else {
+    // singular system: sparse QR decomposition of the full system, only built here
+            std::vector <Triplet<double> > triplets;
+            triplets.reserve((size_t)nrows*16);
+            VectorXd yv(nrows);
+            int irow = 0;
+            auto addRow = [&](int nnz, const double *coef, double val) {
+                for (int k=0; k<nnz; k++)
+                    triplets.push_back(Triplet<double>(irow, idx[k], coef[k]));
+                yv(irow++) = val;
+            };
+            for (int i=0; i<npts; i++) {
+                const bool missing = dataw != 0 && dataw[i] < 0.5;
+                const int nnz = fillPoint(i, missing);
+                if (!missing)
+                    addRow(nnz, a, dataw == 0 ? dataz[i] : dataz[i] * dataw[i]);
+                else {
+                    addRow(nnz, a, 0.);
+                    addRow(nnz, axx, 0.);
+                    addRow(nnz, ayy, 0.);
+                }
+            }
+            SparseMatrix <double> A_sp(nrows, nbas);
+            A_sp.setFromTriplets(triplets.begin(), triplets.end());
 
             SparseQR <SparseMatrix<double>, Eigen::COLAMDOrdering<int> > solver;
             solver.compute(A_sp);
@@ -202,24 +203,32 @@ bool TPS3fit::Fit(int npts, double const *datax, double const *datay, double con
               std::cout << "decomposition failed\n";
               return false;
             }
-            qDebug() << "Compute QR: " << myTimer.elapsed();
-            x = solver.solve(y);
+            x = solver.solve(yv);
             if(solver.info()!=Eigen::Success) {
               std::cout << "solving failed\n";
               return false;
             }
-            qDebug() << "Solve: " << myTimer.elapsed();
-            VectorXd r = A_sp*x - y;
+            VectorXd r = A_sp*x - yv;
             residual = sqrt(r.squaredNorm());
         }
 
+    } else if (non_negative && !non_increasing_x && !slope_y && !flat_top_x && !top_down && ne.SolveNonNegative(coef)) {
+    // only the bounds x >= 0: active set method on the banded reduced systems
+        x = Eigen::Map<VectorXd>(coef.data(), nbas);
+        residual = 0.5*(ne.SquaredResidual(coef) - ne.GetYY()); // the same as the quadprog minimum below
+
     } else { // constrained fit
 
     // solve the system using quadratic programming, i.e.
     // minimize 1/2 * x G x + g0 x subject to some inequality and equality constraints,
     // where G = A'A and g0 = -y'A (' denotes transposition)
-        MatrixXd G = A.transpose()*A;
-        VectorXd g0 = (y.transpose()*A)*(-1.);
+        MatrixXd G(nbas, nbas);
+        VectorXd g0(nbas);
+        for (int i=0; i<nbas; i++) {
+            g0(i) = -ne.Getg(i);
+            for (int j=0; j<nbas; j++)
+                G(i, j) = ne.GetG(i, j);
+        }
 
     // ineqaulity constraints:
         MatrixXd CI;
@@ -229,8 +238,6 @@ bool TPS3fit::Fit(int npts, double const *datax, double const *datay, double con
         VectorXd ce0;
 
     //  set ineqaulity constraints:
-        int nbasx = bs->GetBSX().GetNbas();
-        int nbasy = bs->GetBSY().GetNbas();
         // components of inequality constraints
         MatrixXd CI_a, CI_b;
         VectorXd ci0_a, ci0_b;
@@ -348,12 +355,6 @@ bool TPS3fit::Fit(int npts, double const *datax, double const *datay, double con
         }
 
     /*
-        std::cout << "A:" << std::endl;
-        std::cout << A << std::endl;
-
-        std::cout << "y:" << std::endl;
-        std::cout << y << std::endl;
-
         std::cout << "G:" << std::endl;
         std::cout << G << std::endl;
 
@@ -36,7 +36,6 @@ private:
     int slope_y;     // force d/dy positive (1) or negative (2) at x = 0
     double x0, y0;   // coordinates of the "top" point
     bool top_down;   // force upproximately non-increasing behavior with distance from (x0,y0)
-    bool sparse;     // use sparse QR for unconstrained fit - EXPERIMENTAL
     double residual;
     bool status;
     TProfile2D *h1;
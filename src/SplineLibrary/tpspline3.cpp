@@ -23,6 +23,12 @@
 
 #include "tpspline3.h"
 
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 TPspline3::TPspline3(double xmin, double xmax, int n_intx, double ymin, double ymax, int n_inty) :
                     bsx(xmin, xmax, n_intx), bsy(ymin, ymax, n_inty),
                     xl(xmin), yl(ymin),
@@ -166,6 +172,95 @@ double TPspline3::Eval(double x, double y) const
 	return sum + yf*yf*yf*(pi[12] + xf*(pi[13] + xf*(pi[14] + xf*pi[15])));
 }
 
+// value and derivatives over xf and yf of the polynomial of one cell: p[i + 4*j] is the coefficient of xf^i * yf^j
+static inline void evalCellDrv(const double *p, double xf, double yf, double &val, double &dxf, double &dyf)
+{
+	val = dxf = dyf = 0.;
+	double ypow = 1., dypow = 0.;
+	for (int j=0; j<4; j++) {
+		const double *pj = p + 4*j;
+		const double row  = pj[0] + xf*(pj[1] + xf*(pj[2] + xf*pj[3]));
+		const double drow = pj[1] + xf*(2.*pj[2] + xf*3.*pj[3]);
+		val += ypow*row;
+		dxf += ypow*drow;
+		dyf += dypow*row;
+		dypow = (j+1)*ypow;
+		ypow *= yf;
+	}
+}
+
+// same result as Eval() for every point, except that at the upper edges the last interval is used with xf (yf) = 1
+// instead of shifting the point inside by 1e-7; points outside of the domain give 0
+void TPspline3::EvalBatch(int n, const double *x, const double *y, double *out) const
+{
+	if (poly.empty()) {
+		for (int i=0; i<n; i++) out[i] = 0.;
+		return;
+	}
+	int i = 0;
+#ifdef __AVX2__
+	const double *pp = poly[0].p;
+	const __m256d vxl = _mm256_set1_pd(xl), vxr = _mm256_set1_pd(xr), vdx = _mm256_set1_pd(dx), vnx = _mm256_set1_pd(nintx);
+	const __m256d vyl = _mm256_set1_pd(yl), vyr = _mm256_set1_pd(yr), vdy = _mm256_set1_pd(dy), vny = _mm256_set1_pd(ninty);
+	const __m256d vlastx = _mm256_set1_pd(nintx-1), vlasty = _mm256_set1_pd(ninty-1);
+	const __m128i vnintx = _mm_set1_epi32(nintx);
+	for (; i+4<=n; i+=4) {
+		__m256d vx = _mm256_loadu_pd(x+i);
+		__m256d vy = _mm256_loadu_pd(y+i);
+		const __m256d inside = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(vx, vxl, _CMP_GE_OQ), _mm256_cmp_pd(vx, vxr, _CMP_LE_OQ)),
+		                                     _mm256_and_pd(_mm256_cmp_pd(vy, vyl, _CMP_GE_OQ), _mm256_cmp_pd(vy, vyr, _CMP_LE_OQ)));
+		vx = _mm256_blendv_pd(vxl, vx, inside);
+		vy = _mm256_blendv_pd(vyl, vy, inside);
+		const __m256d xi = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(vx, vxl), vdx), vnx);
+		const __m256d yi = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(vy, vyl), vdy), vny);
+		const __m256d fx = _mm256_min_pd(_mm256_floor_pd(xi), vlastx);
+		const __m256d fy = _mm256_min_pd(_mm256_floor_pd(yi), vlasty);
+		const __m256d xf = _mm256_sub_pd(xi, fx);
+		const __m256d yf = _mm256_sub_pd(yi, fy);
+		const __m128i rect = _mm_add_epi32(_mm256_cvttpd_epi32(fx), _mm_mullo_epi32(_mm256_cvttpd_epi32(fy), vnintx));
+		const __m128i idx = _mm_slli_epi32(rect, 4); // 16 coefficients per rectangle
+
+		const __m256d yf2 = _mm256_mul_pd(yf, yf);
+		__m256d sum = _mm256_setzero_pd();
+		__m256d ypow = _mm256_set1_pd(1.);
+		for (int k=0; k<4; k++) {
+			const double *pk = pp + 4*k;
+			__m256d row = _mm256_i32gather_pd(pk+3, idx, 8);
+			row = _mm256_add_pd(_mm256_i32gather_pd(pk+2, idx, 8), _mm256_mul_pd(xf, row));
+			row = _mm256_add_pd(_mm256_i32gather_pd(pk+1, idx, 8), _mm256_mul_pd(xf, row));
+			row = _mm256_add_pd(_mm256_i32gather_pd(pk,   idx, 8), _mm256_mul_pd(xf, row));
+			sum = _mm256_add_pd(sum, _mm256_mul_pd(ypow, row));
+			ypow = (k == 0 ? yf : (k == 1 ? yf2 : _mm256_mul_pd(yf2, yf)));
+		}
+		_mm256_storeu_pd(out+i, _mm256_and_pd(sum, inside));
+	}
+#endif
+	for (; i<n; i++)
+		out[i] = Eval(x[i], y[i]);
+}
+
+// unlike EvalDrvX/Y(), derivatives are in units of x and y, not per interval
+void TPspline3::EvalDrvBatch(int n, const double *x, const double *y, double *val, double *drvx, double *drvy) const
+{
+	const double sx = nintx/dx;
+	const double sy = ninty/dy;
+	for (int i=0; i<n; i++) {
+		if (poly.empty() || !(x[i]>=xl && x[i]<=xr && y[i]>=yl && y[i]<=yr)) {
+			val[i] = drvx[i] = drvy[i] = 0.;
+			continue;
+		}
+		double xi = (x[i]-xl)/dx*nintx;
+		int ix = std::min((int)xi, nintx-1);
+		double yi = (y[i]-yl)/dy*ninty;
+		int iy = std::min((int)yi, ninty-1);
+
+		double dxf, dyf;
+		evalCellDrv(poly[ix + iy*nintx].p, xi-ix, yi-iy, val[i], dxf, dyf);
+		drvx[i] = dxf*sx;
+		drvy[i] = dyf*sy;
+	}
+}
+
 // this eval tries to get best speed with reduced shared memory usage
 double TPspline3::Eval_greedy(double x, double y)
 {
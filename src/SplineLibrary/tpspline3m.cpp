@@ -23,6 +23,10 @@
 
 #include "tpspline3m.h"
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 TPspline3::TPspline3(double xmin, double xmax, int n_intx, double ymin, double ymax, int n_inty) :
                     xl(xmin), yl(ymin), xr(xmax), yr(ymax), nintx(n_intx), ninty(n_inty),
                     bsx(xmin, xmax, n_intx), bsy(ymin, ymax, n_inty)
@@ -143,7 +147,7 @@ bool TPspline3::Locate(double x, double y, int *ix, int *iy, double *xf, double
     if (*ix < 0 || *ix >= nintx)
         return false;
     double yi = (y-yl)/dy*ninty; *iy = (int)yi;
-    if (*iy < 0 || *iy >= nintx)
+    if (*iy < 0 || *iy >= ninty)
         return false;
 
     *xf = xi - *ix;
@@ -162,6 +166,90 @@ double TPspline3::Eval(double x, double y) const
     return PowerVec(xf).transpose()*P[ix + iy*nintx]*PowerVec(yf);
 }
 
+// value and derivatives over xf and yf of the polynomial of one cell: p[i + 4*j] is the coefficient of xf^i * yf^j
+static inline void evalCellDrv(const double *p, double xf, double yf, double &val, double &dxf, double &dyf)
+{
+	val = dxf = dyf = 0.;
+	double ypow = 1., dypow = 0.;
+	for (int j=0; j<4; j++) {
+		const double *pj = p + 4*j;
+		const double row  = pj[0] + xf*(pj[1] + xf*(pj[2] + xf*pj[3]));
+		const double drow = pj[1] + xf*(2.*pj[2] + xf*3.*pj[3]);
+		val += ypow*row;
+		dxf += ypow*drow;
+		dyf += dypow*row;
+		dypow = (j+1)*ypow;
+		ypow *= yf;
+	}
+}
+
+// same result as Eval() for every point (same cell location as in Locate())
+// P matrices are column-major, so P[i](ix,iy) is at data()[ix + 4*iy] - the same layout as "poly" of the non-matrix version
+void TPspline3::EvalBatch(int n, const double *x, const double *y, double *out) const
+{
+	if (P.empty()) {
+		for (int i=0; i<n; i++) out[i] = 0.;
+		return;
+	}
+	int i = 0;
+#ifdef __AVX2__
+	const double *pp = P[0].data();
+	const __m256d vxl = _mm256_set1_pd(xl), vdx = _mm256_set1_pd(dx), vnx = _mm256_set1_pd(nintx);
+	const __m256d vyl = _mm256_set1_pd(yl), vdy = _mm256_set1_pd(dy), vny = _mm256_set1_pd(ninty);
+	const __m256d vzero = _mm256_setzero_pd();
+	const __m128i vnintx = _mm_set1_epi32(nintx);
+	for (; i+4<=n; i+=4) {
+		const __m256d xi = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(x+i), vxl), vdx), vnx);
+		const __m256d yi = _mm256_mul_pd(_mm256_div_pd(_mm256_sub_pd(_mm256_loadu_pd(y+i), vyl), vdy), vny);
+		__m256d fx = _mm256_round_pd(xi, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+		__m256d fy = _mm256_round_pd(yi, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+		const __m256d inside = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(fx, vzero, _CMP_GE_OQ), _mm256_cmp_pd(fx, vnx, _CMP_LT_OQ)),
+		                                     _mm256_and_pd(_mm256_cmp_pd(fy, vzero, _CMP_GE_OQ), _mm256_cmp_pd(fy, vny, _CMP_LT_OQ)));
+		fx = _mm256_blendv_pd(vzero, fx, inside);
+		fy = _mm256_blendv_pd(vzero, fy, inside);
+		const __m256d xf = _mm256_blendv_pd(vzero, _mm256_sub_pd(xi, fx), inside);
+		const __m256d yf = _mm256_blendv_pd(vzero, _mm256_sub_pd(yi, fy), inside);
+		const __m128i rect = _mm_add_epi32(_mm256_cvttpd_epi32(fx), _mm_mullo_epi32(_mm256_cvttpd_epi32(fy), vnintx));
+		const __m128i idx = _mm_slli_epi32(rect, 4); // 16 coefficients per matrix
+
+		const __m256d yf2 = _mm256_mul_pd(yf, yf);
+		__m256d sum = _mm256_setzero_pd();
+		__m256d ypow = _mm256_set1_pd(1.);
+		for (int k=0; k<4; k++) {
+			const double *pk = pp + 4*k;
+			__m256d row = _mm256_i32gather_pd(pk+3, idx, 8);
+			row = _mm256_add_pd(_mm256_i32gather_pd(pk+2, idx, 8), _mm256_mul_pd(xf, row));
+			row = _mm256_add_pd(_mm256_i32gather_pd(pk+1, idx, 8), _mm256_mul_pd(xf, row));
+			row = _mm256_add_pd(_mm256_i32gather_pd(pk,   idx, 8), _mm256_mul_pd(xf, row));
+			sum = _mm256_add_pd(sum, _mm256_mul_pd(ypow, row));
+			ypow = (k == 0 ? yf : (k == 1 ? yf2 : _mm256_mul_pd(yf2, yf)));
+		}
+		_mm256_storeu_pd(out+i, _mm256_and_pd(sum, inside));
+	}
+#endif
+	for (; i<n; i++)
+		out[i] = Eval(x[i], y[i]);
+}
+
+// unlike EvalDrvX/Y(), derivatives are in units of x and y, not per interval
+void TPspline3::EvalDrvBatch(int n, const double *x, const double *y, double *val, double *drvx, double *drvy) const
+{
+	const double sx = nintx/dx;
+	const double sy = ninty/dy;
+	for (int i=0; i<n; i++) {
+		int ix, iy;
+		double xf, yf;
+		if (P.empty() || !Locate(x[i], y[i], &ix, &iy, &xf, &yf)) {
+			val[i] = drvx[i] = drvy[i] = 0.;
+			continue;
+		}
+		double dxf, dyf;
+		evalCellDrv(P[ix + iy*nintx].data(), xf, yf, val[i], dxf, dyf);
+		drvx[i] = dxf*sx;
+		drvy[i] = dyf*sy;
+	}
+}
+
 // this eval tries to get best speed with reduced shared memory usage
 double TPspline3::Eval_greedy(double x, double y) const
 {
@@ -58,6 +58,8 @@ class TPspline3
 		double Basis(double *x, double *p);  // insertable into ROOT function
 		double Eval_slow(double x, double y);
         double Eval(double x, double y) const;
+        void EvalBatch(int n, const double *x, const double *y, double *out) const; // out[i] = Eval(x[i], y[i]), vectorized if AVX2 is available
+        void EvalDrvBatch(int n, const double *x, const double *y, double *val, double *drvx, double *drvy) const; // value, d/dx and d/dy
         double Eval_greedy(double x, double y) const;
         double EvalDrvX(double x, double y);
         double EvalDrvY(double x, double y);
@@ -50,10 +50,12 @@ ants2_eigen3 {
 
      SOURCES += SplineLibrary/bs3fit.cpp \
                 SplineLibrary/tps3fit.cpp \
+                SplineLibrary/normaleq.cpp \
                 SplineLibrary/curvefit.cpp
 
      HEADERS += SplineLibrary/bs3fit.h \
                 SplineLibrary/tps3fit.h \
+                SplineLibrary/normaleq.h \
                 SplineLibrary/curvefit.h
 }
 ants2_matrix { # use matrix algebra for TP splines
@@ -292,6 +294,9 @@ SOURCES += main.cpp \
     OpticalOverrides/aopticaloverride.cpp \
     modules/detectorclass.cpp \
     modules/eventsdataclass.cpp \
+    modules/aeventstore.cpp \
+    modules/aeventfile.cpp \
+    modules/aeventframe.cpp \
     modules/dynamicpassiveshandler.cpp \
     modules/flatfield.cpp \
     modules/sensorlrfs.cpp \
@@ -333,6 +338,7 @@ SOURCES += main.cpp \
     common/ascriptvaluecopier.cpp \
     common/acustomrandomsampling.cpp \
     common/amaterial.cpp \
+    common/aopticalpropertytable.cpp \
     common/aparticle.cpp \
     modules/amaterialparticlecolection.cpp\
     common/ascriptvalueconverter.cpp \
@@ -345,6 +351,7 @@ SOURCES += main.cpp \
     common/apeakfinder.cpp \
     common/amaterialcomposition.cpp \
     common/aneutroninteractionelement.cpp \
+    common/ainterpolationtable.cpp \
     scriptmode/localscriptinterfaces.cpp \
     scriptmode/histgraphinterfaces.cpp \
     scriptmode/arootgraphrecord.cpp \
@@ -359,12 +366,16 @@ SOURCES += main.cpp \
     modules/apmhub.cpp \
     common/apmtype.cpp \
     modules/aoneevent.cpp \
+    modules/asipmmicrocells.cpp \
     common/aroottreerecord.cpp \
     Net/awebsocketsessionserver.cpp \
     Net/awebsocketstandalonemessanger.cpp \
     Net/awebsocketsession.cpp \
     common/agammarandomgenerator.cpp \
+    common/arandomphilox.cpp \
     Net/agridrunner.cpp \
+    Net/agridscheduler.cpp \
+    Net/agridsessionpool.cpp \
     Net/aremoteserverrecord.cpp \
     common/atrackbuildoptions.cpp \
     OpticalOverrides/aopticaloverridescriptinterface.cpp \
@@ -407,7 +418,9 @@ SOURCES += main.cpp \
     common/aexternalprocesshandler.cpp \
     Simulation/alogsandstatisticsoptions.cpp \
     Reconstruction/areconstructionworker.cpp \
+    Reconstruction/asimdgridmanager.cpp \
     common/ahistogram.cpp \
+    common/aparalleltasks.cpp \
     modules/apmdummystructure.cpp \
     SplineLibrary/Spline123/profileHist.cpp \
     SplineLibrary/Spline123/json11.cpp \
@@ -430,6 +443,7 @@ HEADERS  += common/CorrelationFilters.h \
     common/reconstructionsettings.h \
     common/tmpobjhubclass.h \
     common/agammarandomgenerator.h \
+    common/arandomphilox.h \
     common/apositionenergyrecords.h \
     common/ajsontools.h \
     common/afiletools.h \
@@ -447,6 +461,9 @@ HEADERS  += common/CorrelationFilters.h \
     modules/flatfield.h \
     modules/sensorlrfs.h \
     modules/eventsdataclass.h \
+    modules/aeventstore.h \
+    modules/aeventfile.h \
+    modules/aeventframe.h \
     modules/dynamicpassiveshandler.h \
     modules/manifesthandling.h \
     modules/apmgroupsmanager.h \
@@ -497,6 +514,7 @@ HEADERS  += common/CorrelationFilters.h \
     common/ascriptvaluecopier.h \
     common/acustomrandomsampling.h \
     common/amaterial.h \
+    common/aopticalpropertytable.h \
     common/aparticle.h \
     modules/amaterialparticlecolection.h\
     common/ascriptvalueconverter.h \
@@ -510,6 +528,7 @@ HEADERS  += common/CorrelationFilters.h \
     common/apeakfinder.h \
     common/amaterialcomposition.h \
     common/aneutroninteractionelement.h \
+    common/ainterpolationtable.h \
     scriptmode/localscriptinterfaces.h \
     scriptmode/histgraphinterfaces.h \
     common/amessageoutput.h \
@@ -526,11 +545,14 @@ HEADERS  += common/CorrelationFilters.h \
     modules/apmhub.h \
     common/apmtype.h \
     modules/aoneevent.h \
+    modules/asipmmicrocells.h \
     common/aroottreerecord.h \
     Net/awebsocketsessionserver.h \
     Net/awebsocketstandalonemessanger.h \
     Net/awebsocketsession.h \
     Net/agridrunner.h \
+    Net/agridscheduler.h \
+    Net/agridsessionpool.h \
     Net/aremoteserverrecord.h \
     common/atrackbuildoptions.h \
     OpticalOverrides/aopticaloverridescriptinterface.h \
@@ -575,7 +597,9 @@ HEADERS  += common/CorrelationFilters.h \
     Simulation/alogsandstatisticsoptions.h \
     Reconstruction/afunctorbase.h \
     Reconstruction/areconstructionworker.h \
+    Reconstruction/asimdgridmanager.h \
     common/ahistogram.h \
+    common/aparalleltasks.h \
     modules/apmanddummy.h \
     modules/apmdummystructure.h \
     SplineLibrary/Spline123/profileHist.h \
@@ -600,6 +624,8 @@ ants2_SIM {
     DEFINES += SIM
 
     SOURCES += Simulation/aphoton.cpp \
+    Simulation/aphotonpacket.cpp \
+    Simulation/aeventscheduler.cpp \
     Simulation/asimulationstatistics.cpp \
     Simulation/s1_generator.cpp \
     Simulation/photon_generator.cpp \
@@ -617,6 +643,7 @@ ants2_SIM {
     Simulation/apointsourcesimulator.cpp \
     Simulation/amaterialloader.cpp \
     Simulation/aparticlesourcesimulator.cpp \
+    Simulation/ag4streamchannel.cpp \
     Simulation/asaveparticlestofilesettings.cpp \
     Simulation/aphotonsimsettings.cpp \
     Simulation/ageneralsimsettings.cpp \
@@ -626,6 +653,8 @@ ants2_SIM {
     Simulation/a3dposprob.cpp
 
     HEADERS  += Simulation/aphoton.h \
+    Simulation/aphotonpacket.h \
+    Simulation/aeventscheduler.h \
     Simulation/asimulationstatistics.h \
     Simulation/agridelementrecord.h \
     Simulation/ageomarkerclass.h \
@@ -649,6 +678,7 @@ ants2_SIM {
     Simulation/apointsourcesimulator.h \
     Simulation/amaterialloader.h \
     Simulation/aparticlesourcesimulator.h \
+    Simulation/ag4streamchannel.h \
     Simulation/asaveparticlestofilesettings.h \
     Simulation/aphotonsimsettings.h \
     Simulation/ageneralsimsettings.h \
@@ -914,6 +944,7 @@ ants2_GUI {
 # couldn't get of widgets yet due to funny compile erors - VS
 QT += widgets
 QT += websockets
+QT += network #local socket streaming to G4ants
 QT += script #scripts support
 win32:QT += winextras  #used in windownavigator only
 
@@ -125,6 +125,7 @@ CorrelationFilterStructure *CorrelationFilterStructure::createFromJson(QJsonObje
     QList<double> Data;
     for (int id=0; id<ar.size(); id++) Data.append(ar[id].toDouble());
     cut->Data = Data;
+    cut->prepare();
 
     //creating filter
     CorrelationFilterStructure* tmp = new CorrelationFilterStructure(X, Y, cut);
@@ -160,10 +161,10 @@ CorrelationUnitGenericClass* CorrelationFilterStructure::CorrUnitCreator(QString
 
 const TString CU_SingleChannel::getAxisTitle() { TString tmp = "Ch"; tmp += Channels[0]; return tmp;}
 
-double CU_SingleChannel::getValue(int iev)
+double CU_SingleChannel::getValue(int iev) const
 {
     //return EventsDataHub->Events.at(iev)[Channels[0]] * Detector->PMs->getGain(Channels[0]);
-  return EventsDataHub->Events.at(iev)[Channels[0]] * PMgroups->Groups.at(ThisPMgroup)->PMS.at(Channels[0]).gain;
+  return EventsDataHub->Events.at(iev)[Channels.at(0)] * PMgroups->Groups.at(ThisPMgroup)->PMS.at(Channels.at(0)).gain;
 }
 
 CU_SingleChannel *CU_SingleChannel::getClone()
@@ -172,12 +173,12 @@ CU_SingleChannel *CU_SingleChannel::getClone()
   return copy;
 }
 
-double CU_SumAllChannels::getValue(int iev)
+double CU_SumAllChannels::getValue(int iev) const
 {
   double sum = 0;
   for (int i=0; i<Channels.size(); i++)
     {
-      int thisPM = Channels[i];
+      int thisPM = Channels.at(i);
       //sum += EventsDataHub->Events.at(iev)[thisPM] * Detector->PMs->getGain(thisPM);
       sum += EventsDataHub->Events.at(iev)[thisPM] * PMgroups->Groups.at(ThisPMgroup)->PMS.at(thisPM).gain;
     }
@@ -203,12 +204,12 @@ const TString CU_SumChannels::getAxisTitle()
     return tmp;
 }
 
-double CU_SumChannels::getValue(int iev)
+double CU_SumChannels::getValue(int iev) const
 {
     double sum = 0;
     for (int i=0; i<Channels.size(); i++)
     {
-        int thisPM = Channels[i];
+        int thisPM = Channels.at(i);
         //sum += EventsDataHub->Events.at(iev)[thisPM] * Detector->PMs->getGain(thisPM);
         sum += EventsDataHub->Events.at(iev)[thisPM] * PMgroups->Groups.at(ThisPMgroup)->PMS.at(thisPM).gain;
     }
@@ -221,7 +222,7 @@ CU_SumChannels *CU_SumChannels::getClone()
   return copy;
 }
 
-double CU_TrueOrLoadedEnergy::getValue(int iev)
+double CU_TrueOrLoadedEnergy::getValue(int iev) const
 {
     //return EventsDataHub->Events.at(iev).last();
 
@@ -235,7 +236,7 @@ CU_TrueOrLoadedEnergy *CU_TrueOrLoadedEnergy::getClone()
   return copy;
 }
 
-double CU_RecE::getValue(int iev)
+double CU_RecE::getValue(int iev) const
 {
     return EventsDataHub->ReconstructionData.at(ThisPMgroup).at(iev)->Points[0].energy;
 }
@@ -246,7 +247,7 @@ CU_RecE *CU_RecE::getClone()
   return copy;
 }
 
-double CU_Chi2::getValue(int iev)
+double CU_Chi2::getValue(int iev) const
 {
     return EventsDataHub->ReconstructionData.at(ThisPMgroup).at(iev)->chi2;
 }
@@ -257,7 +258,7 @@ CU_Chi2 *CU_Chi2::getClone()
   return copy;
 }
 
-double CU_RecX::getValue(int iev)
+double CU_RecX::getValue(int iev) const
 {
     return EventsDataHub->ReconstructionData.at(ThisPMgroup).at(iev)->Points[0].r[0];
 }
@@ -268,7 +269,7 @@ CU_RecX *CU_RecX::getClone()
   return copy;
 }
 
-double CU_RecY::getValue(int iev)
+double CU_RecY::getValue(int iev) const
 {
     return EventsDataHub->ReconstructionData.at(ThisPMgroup).at(iev)->Points[0].r[1];
 }
@@ -279,7 +280,7 @@ CU_RecY *CU_RecY::getClone()
   return copy;
 }
 
-double CU_RecZ::getValue(int iev)
+double CU_RecZ::getValue(int iev) const
 {
     return EventsDataHub->ReconstructionData.at(ThisPMgroup).at(iev)->Points[0].r[2];
 }
@@ -291,16 +292,16 @@ CU_RecZ *CU_RecZ::getClone()
 }
 
 
-bool Cut_Line::filter(double val1, double val2)
+bool Cut_Line::filter(double val1, double val2) const
 {
   if (CutOption == 1)
     {
-      if ( (Data[0]*val1 + Data[1]*val2) > Data[2] ) return false; //cuts above
+      if ( (Data.at(0)*val1 + Data.at(1)*val2) > Data.at(2) ) return false; //cuts above
       else return true;
     }
   else
     {
-      if ( (Data[0]*val1 + Data[1]*val2) > Data[2] ) return true; //cuts below
+      if ( (Data.at(0)*val1 + Data.at(1)*val2) > Data.at(2) ) return true; //cuts below
       else return false;
     }
 }
@@ -313,21 +314,28 @@ Cut_Line *Cut_Line::getClone()
 }
 
 
-bool Cut_Ellipse::filter(double val1, double val2)
+void Cut_Ellipse::prepare()
+{
+  if (Data.size() < 5) return;
+  SinA = sin(-Data.at(4)*0.017453292519);
+  CosA = cos(-Data.at(4)*0.017453292519);
+}
+
+bool Cut_Ellipse::filter(double val1, double val2) const
 {
   // 0-x 1-y 2-r1 3-r2 4-(-angle)
   bool outside = false;
-  if ( (Data[2]<1.0e-10 && Data[2]>-1.0e-10) || (Data[3]<1.0e-10 && Data[3]>-1.0e-10) ) outside = true;
+  const double & r1 = Data.at(2);
+  const double & r2 = Data.at(3);
+  if ( (r1<1.0e-10 && r1>-1.0e-10) || (r2<1.0e-10 && r2>-1.0e-10) ) outside = true;
   else
     {
-      double sinA = sin(-Data[4]*0.017453292519);
-      double cosA = cos(-Data[4]*0.017453292519);
-      double dx = val1 - Data[0];
-      double dy = val2 - Data[1];
+      double dx = val1 - Data.at(0);
+      double dy = val2 - Data.at(1);
 
-      double tmp1 = cosA*dx - sinA*dy;
-      double tmp2 = sinA*dx + cosA*dy;
-      double rad = tmp1*tmp1/Data[2]/Data[2] + tmp2*tmp2/Data[3]/Data[3];
+      double tmp1 = CosA*dx - SinA*dy;
+      double tmp2 = SinA*dx + CosA*dy;
+      double rad = tmp1*tmp1/r1/r1 + tmp2*tmp2/r2/r2;
 
       if (rad > 1) outside = true;
     }
@@ -340,17 +348,20 @@ Cut_Ellipse *Cut_Ellipse::getClone()
 {
   Cut_Ellipse* copy = new Cut_Ellipse();
   copy->CutOption = CutOption; copy->Data = Data;
+  copy->prepare();
   return copy;
 }
 
 
-bool Cut_Polygon::filter(double val1, double val2)
+void Cut_Polygon::prepare()
 {
-  QVector<QPointF> tmp(0);
-  for (int i=0; i<Data.size()/2; i++) tmp.append(QPointF(Data[i*2], Data[i*2+1]));
-  QPolygonF poly(tmp);
+  Polygon.clear();
+  for (int i=0; i<Data.size()/2; i++) Polygon.append(QPointF(Data.at(i*2), Data.at(i*2+1)));
+}
 
-  bool inside = poly.containsPoint(QPointF(val1, val2), Qt::OddEvenFill);
+bool Cut_Polygon::filter(double val1, double val2) const
+{
+  bool inside = Polygon.containsPoint(QPointF(val1, val2), Qt::OddEvenFill);
 
   if (CutOption == 0) return inside;
   else return !inside;
@@ -360,6 +371,7 @@ Cut_Polygon *Cut_Polygon::getClone()
 {
   Cut_Polygon* copy = new Cut_Polygon();
   copy->CutOption = CutOption; copy->Data = Data;
+  copy->prepare();
   return copy;
 }
 
@@ -29,7 +29,7 @@ class CorrelationUnitGenericClass
     APmGroupsManager * PMgroups = nullptr;
     int ThisPMgroup = 0;
 
-    virtual double getValue(int) {return 0;} //gives value for the event number
+    virtual double getValue(int) const {return 0;} //gives value for the event number; const - used concurrently by the event filter threads
     virtual bool isRequireReconstruction() {return true;} //does require recon data to present?
 
     virtual CorrelationUnitGenericClass* getClone()=0;//never used not overloaded
@@ -48,7 +48,8 @@ class CorrelationCutGenericClass
     int CutOption = 0; //e.g. "left_above" for line or "inside" for ellipse
     QList<double> Data; //e.g. A B C for line or ellipse data or X Y for polygon nodes
 
-    virtual bool filter(double , double ) {return false;} //true - passes
+    virtual bool filter(double , double ) const {return false;} //true - passes; const - used concurrently by the event filter threads
+    virtual void prepare() {} //precalculates the data used by filter(), has to be called after Data are changed
 
     virtual CorrelationCutGenericClass* getClone()=0;//never used not overloaded
 
@@ -109,7 +110,7 @@ class CU_SingleChannel : public CorrelationUnitGenericClass
     int getCOBindex() const {return 0;}
     virtual const TString getAxisTitle();
 
-    double getValue(int iev);
+    double getValue(int iev) const;
     bool isRequireReconstruction() {return false;}
 
     CU_SingleChannel* getClone();
@@ -125,7 +126,7 @@ class CU_SumAllChannels : public CorrelationUnitGenericClass
     int getCOBindex() const {return 1;}
     virtual const TString getAxisTitle() { return "Sum all ch";}
 
-    double getValue(int iev);
+    double getValue(int iev) const;
     bool isRequireReconstruction() {return false;}
 
     CU_SumAllChannels* getClone();
@@ -141,7 +142,7 @@ class CU_SumChannels : public CorrelationUnitGenericClass
     int getCOBindex() const {return 2;}
     virtual const TString getAxisTitle();
 
-    double getValue(int iev);
+    double getValue(int iev) const;
     bool isRequireReconstruction() {return false;}
 
     CU_SumChannels* getClone();
@@ -157,7 +158,7 @@ class CU_TrueOrLoadedEnergy : public CorrelationUnitGenericClass
     int getCOBindex() const {return 3;}
     virtual const TString getAxisTitle() { return "True or loaded energy";}
 
-    double getValue(int iev);
+    double getValue(int iev) const;
     bool isRequireReconstruction() {return false;}
 
     CU_TrueOrLoadedEnergy* getClone();
@@ -172,7 +173,7 @@ class CU_RecE : public CorrelationUnitGenericClass
      const QString getType() { return "RecE";}
      int getCOBindex() const {return 4;}
      virtual const TString getAxisTitle() { return "Rec energy";}
-     double getValue(int iev);
+     double getValue(int iev) const;
      CU_RecE* getClone();
 };
 
@@ -185,7 +186,7 @@ class CU_Chi2 : public CorrelationUnitGenericClass
      const QString getType() { return "Chi2";}
      int getCOBindex() const {return 5;}
      virtual const TString getAxisTitle() { return "Chi2";}
-     double getValue(int iev);
+     double getValue(int iev) const;
      CU_Chi2* getClone();
 };
 
@@ -198,7 +199,7 @@ class CU_RecX : public CorrelationUnitGenericClass
      const QString getType() { return "RecX";}
      int getCOBindex() const {return 6;}
      virtual const TString getAxisTitle() { return "Rec X";}
-     double getValue(int iev);
+     double getValue(int iev) const;
      CU_RecX* getClone();
 };
 class CU_RecY : public CorrelationUnitGenericClass
@@ -210,7 +211,7 @@ class CU_RecY : public CorrelationUnitGenericClass
      const QString getType() { return "RecY";}
      int getCOBindex() const {return 7;}
      virtual const TString getAxisTitle() { return "Rec Y";}
-     double getValue(int iev);
+     double getValue(int iev) const;
      CU_RecY* getClone();
 };
 class CU_RecZ : public CorrelationUnitGenericClass
@@ -222,7 +223,7 @@ class CU_RecZ : public CorrelationUnitGenericClass
      const QString getType() { return "RecZ";}
      int getCOBindex() const {return 8;}
      virtual const TString getAxisTitle() { return "Rec Z";}
-     double getValue(int iev);
+     double getValue(int iev) const;
      CU_RecZ* getClone();
 };
 
@@ -234,7 +235,7 @@ class Cut_Line : public CorrelationCutGenericClass
     const QString getType() {return "line";}
     int getCOBindex() const {return 0;}
 
-    bool filter(double val1, double val2);
+    bool filter(double val1, double val2) const;
     Cut_Line* getClone();
 };
 
@@ -244,8 +245,12 @@ class Cut_Ellipse : public CorrelationCutGenericClass
     const QString getType() {return "ellipse";}
     int getCOBindex() const {return 1;}
 
-    bool filter(double val1, double val2);
+    bool filter(double val1, double val2) const;
+    void prepare();
     Cut_Ellipse* getClone();
+
+  private:
+    double SinA = 0, CosA = 1;
 };
 
 class Cut_Polygon : public CorrelationCutGenericClass
@@ -254,8 +259,12 @@ class Cut_Polygon : public CorrelationCutGenericClass
     const QString getType() {return "polygon";}
     int getCOBindex() const {return 2;}
 
-    bool filter(double val1, double val2);
+    bool filter(double val1, double val2) const;
+    void prepare();
     Cut_Polygon* getClone();
+
+  private:
+    QPolygonF Polygon;
 };
 
 
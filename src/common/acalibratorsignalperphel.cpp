@@ -317,7 +317,7 @@ bool ACalibratorSignalPerPhEl_Peaks::PrepareData()
                 qApp->processEvents();
             }
 
-            h->Fill(EventsDataHub.getEvent(iev)->at(ipm));
+            h->Fill(EventsDataHub.getEvent(iev).at(ipm));
         }
         DataHists << h;
     }
@@ -101,7 +101,7 @@ double GetInterpolatedValue(double val, const QVector<double>* X, const QVector<
     QVector<double>::const_iterator it;
     //it = qLowerBound(X->begin(), X->end(), energy);
     it = std::lower_bound(X->begin(), X->end(), val);
-    int index = X->indexOf(*it);
+    int index = it - X->begin();
     //      qDebug()<<"energy:"<<energy<<"index"<<index;//<<*it;
     if (index < 1)
       {
@@ -2,18 +2,28 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 #include "TRandom2.h"
 
 ACustomRandomSampling::ACustomRandomSampling(const QVector<double>* Probabilities)
-  : Probs(Probabilities)
 {
-  fUndefined = true;
-  if (Probs->isEmpty() || Probs->size() == 1) return;
+  configure(*Probabilities);
+}
 
+void ACustomRandomSampling::configure(const QVector<double> & Probabilities)
+{
+  fUndefined = true;
   Sum = 0;
-  for (int i=0; i<Probs->size(); i++)
+  Size = 0;
+  Threshold.clear();
+  Alias.clear();
+  Cumulative.clear();
+  if (Probabilities.isEmpty() || Probabilities.size() == 1) return;
+
+  for (int i=0; i<Probabilities.size(); i++)
     {
-      double v = Probs->at(i);
+      double v = Probabilities.at(i);
       if (v < 0)
         {
           qWarning() << "ACustomRandomSampler: negative value in the probabilities!";
@@ -26,32 +36,122 @@ ACustomRandomSampling::ACustomRandomSampling(const QVector<double>* Probabilitie
   if (Size==1) return;
   if (Sum == 0) return;
 
+  if (Size > MaxAliasSize)
+    {
+      Cumulative.resize(Size);
+      double cum = 0;
+      for (int i=0; i<Size; i++)
+        {
+          cum += Probabilities.at(i);
+          Cumulative[i] = cum;
+        }
+    }
+  else
+    {
+      //Vose: bins with scaled probability below 1 are topped up from the bins above 1
+      Threshold.resize(Size);
+      Alias.resize(Size);
+      QVector<int> small, large;
+      for (int i=0; i<Size; i++)
+        {
+          Threshold[i] = Probabilities.at(i) * Size / Sum;
+          Alias[i] = i;
+          if (Threshold.at(i) < 1.0) small << i;
+          else large << i;
+        }
+
+      while (!small.isEmpty() && !large.isEmpty())
+        {
+          const int s = small.takeLast();
+          const int l = large.last();
+          Alias[s] = l;
+          Threshold[l] -= 1.0 - Threshold.at(s);
+          if (Threshold.at(l) < 1.0)
+            {
+              large.removeLast();
+              small << l;
+            }
+        }
+      //leftovers are 1 within the rounding errors
+      for (int i : large) Threshold[i] = 1.0;
+      for (int i : small) Threshold[i] = 1.0;
+    }
+
   fUndefined = false;
 }
 
 void ACustomRandomSampling::reportSettings() const
 {
-  qDebug() << "Data:" << *Probs;
   qDebug() << "Undefined flag =" << fUndefined;
   if (!fUndefined)
     {
       qDebug() << "Sum ="<<Sum;
       qDebug() << "True size = "<<Size;
+      qDebug() << "Method:" << (Cumulative.isEmpty() ? "alias table" : "binary search in the cumulative table");
     }
 }
 
+int ACustomRandomSampling::sampleFromRandom(double rnd, double & fraction) const
+{
+  if (Cumulative.isEmpty())
+    {
+      const double u = rnd * Size;
+      int i = (int)u;
+      if (i >= Size) i = Size - 1; //paranoic protection
+      const double f = u - i;
+
+      const double t = Threshold.at(i);
+      if (f < t)
+        {
+          fraction = f / t;
+          return i;
+        }
+      fraction = (f - t) / (1.0 - t);
+      return Alias.at(i);
+    }
+
+  const double x = rnd * Sum;
+  int i = std::upper_bound(Cumulative.begin(), Cumulative.end(), x) - Cumulative.begin();
+  if (i >= Size) i = Size - 1; //paranoic protection
+  const double from = (i == 0 ? 0 : Cumulative.at(i-1));
+  const double width = Cumulative.at(i) - from;
+  fraction = (width > 0 ? (x - from) / width : 0);
+  return i;
+}
+
 int ACustomRandomSampling::sample(TRandom2 *RandGen) const
 {
-   if (fUndefined) return 0;
+  double fraction;
+  return sample(RandGen, fraction);
+}
 
-   double rnd = RandGen->Rndm()*Sum;
+int ACustomRandomSampling::sample(TRandom2 *RandGen, double & fraction) const
+{
+  if (fUndefined)
+    {
+      fraction = RandGen->Rndm();
+      return 0;
+    }
+  return sampleFromRandom(RandGen->Rndm(), fraction);
+}
 
-   double cum = 0;
-   for (int i=0; i<Size; i++)
-     {
-       cum += Probs->at(i);
-       if (rnd < cum) return i;
-     }
+void ACustomRandomSampling::sample(TRandom2 *RandGen, int n, int * indexes, double * fractions) const
+{
+  if (n < 1) return;
 
-   return Size-1; //paranoic protection
+  QVector<double> rnd(n);
+  RandGen->RndmArray(n, rnd.data());
+
+  double fraction;
+  for (int i=0; i<n; i++)
+    {
+      if (fUndefined)
+        {
+          indexes[i] = 0;
+          fraction = rnd.at(i);
+        }
+      else indexes[i] = sampleFromRandom(rnd.at(i), fraction);
+
+      if (fractions) fractions[i] = fraction;
+    }
 }
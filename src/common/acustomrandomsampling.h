@@ -5,21 +5,38 @@
 
 class TRandom2;
 
+// Sampling of an index from a discrete distribution given by non-negative weights
+// Walker/Vose alias method: O(1) per sample, one random number per sample
+// For very large tables (see MaxAliasSize) the binary search in the cumulative table is used instead
 class ACustomRandomSampling
 {
 public:
+  ACustomRandomSampling() {}
   ACustomRandomSampling(const QVector<double> *Probabilities);
 
+  void configure(const QVector<double> & Probabilities);  //tables are copied, the weights do not have to be normalized
+
+  bool isUndefined() const {return fUndefined;}
+
   int sample(TRandom2* RandGen) const;  //always returns 0 if fUndefined
+  int sample(TRandom2* RandGen, double & fraction) const;  //fraction: uniform in [0,1) from the same random number, e.g. for the position inside a histogram bin
+  void sample(TRandom2* RandGen, int n, int * indexes, double * fractions = nullptr) const;  //batch: n random numbers are generated with one RndmArray call
+
   void reportSettings() const;
 
+  static const int MaxAliasSize = 1000000;
+
 private:
-  const QVector<double> *Probs;
+  double Sum = 0;
+  bool fUndefined = true;
+
+  int Size = 0; //Probabilities without trailing zeros
 
-  double Sum;
-  bool fUndefined;
+  QVector<double> Threshold;  //alias method: probability to keep the bin
+  QVector<int>    Alias;
+  QVector<double> Cumulative; //only for Size > MaxAliasSize
 
-  int Size; //Probabilities without trailing zeros
+  inline int sampleFromRandom(double rnd, double & fraction) const;
 };
 
 #endif // ACUSTOMRANDOMSAMPLING_H
@@ -192,6 +192,8 @@ bool AEventFilteringSettings::readFromJson(QJsonObject &js, APmGroupsManager* PM
       }
 
      fKNNfilter = js.contains("kNN");
+     KNNfilterChecks = 0;
+     KNNfilterEps = 0;
      if (fKNNfilter)
        {
          QJsonObject knnjson = js["kNN"].toObject();
@@ -199,6 +201,8 @@ bool AEventFilteringSettings::readFromJson(QJsonObject &js, APmGroupsManager* PM
          parseJson(knnjson, "Min", KNNfilterMin);
          parseJson(knnjson, "Max", KNNfilterMax);
          parseJson(knnjson, "AverageOver", KNNfilterAverageOver);
+         parseJson(knnjson, "Checks", KNNfilterChecks);
+         parseJson(knnjson, "Eps", KNNfilterEps);
        }
      return true;
 }
@@ -60,14 +60,16 @@ public:
     double SpF_halfSizeX, SpF_halfSizeY, SpF_radius2; // calculated in this module
     QPolygonF SpF_polygon; // calculated in this module
 
-    //filters - after thread data merge
-      //correlationFilter
-    bool fCorrelationFilters;
-    QVector <CorrelationFilterStructure* > CorrelationFilters; //link to filters configured at ReconstructionWindow
-      //kNN filter
+      //kNN filter: the neighbour search is done before the threaded pass
     bool fKNNfilter;
     double KNNfilterMin, KNNfilterMax;
     int KNNfilterAverageOver;
+    int KNNfilterChecks;   //see AKnnSearchSettings
+    double KNNfilterEps;
+
+      //correlationFilter
+    bool fCorrelationFilters;
+    QVector <CorrelationFilterStructure* > CorrelationFilters; //link to filters configured at ReconstructionWindow
 
     //misc
     QString ErrorString;
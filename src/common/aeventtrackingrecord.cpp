@@ -7,79 +7,119 @@
 #include "TGeoManager.h"
 #include "TGeoNode.h"
 
+// ============= Names ==============
+
+ATrackingNameTable & ATrackingNameTable::getInstance()
+{
+    static ATrackingNameTable instance;
+    return instance;
+}
+
+ATrackingNameTable::ATrackingNameTable() :
+    Names(new QString[MaxNames]), NumNames(0), NumRejected(0)
+{
+    for (const QString & name : {QString(""), QString("C"), QString("T"), QString("O"), QString("?")})
+        getId(name);
+}
+
+ATrackingNameTable::~ATrackingNameTable()
+{
+    delete [] Names;
+}
+
+int ATrackingNameTable::getId(const QString & name)
+{
+    {
+        QReadLocker locker(&Lock);
+        QHash<QString,int>::const_iterator it = Ids.constFind(name);
+        if (it != Ids.constEnd()) return it.value();
+    }
+
+    QWriteLocker locker(&Lock);
+    QHash<QString,int>::const_iterator it = Ids.constFind(name);
+    if (it != Ids.constEnd()) return it.value(); // registered by another thread meanwhile
+
+    const int id = NumNames.loadAcquire();
+    if (id == MaxNames)
+    {
+        if (NumRejected.fetchAndAddOrdered(1) == 0)
+            qWarning() << "Tracking history: too many different process/volume names, this and further new names are shown as '?':" << name;
+        return Unregistered;
+    }
+    Names[id] = name;
+    Ids.insert(name, id);
+    NumNames.storeRelease(id + 1);
+    return id;
+}
+
+int ATrackingNameTable::findId(const QString & name) const
+{
+    QReadLocker locker(&Lock);
+    return Ids.value(name, -1);
+}
+
+const QString & ATrackingNameTable::getName(int id) const
+{
+    if (id < 0 || id >= NumNames.loadAcquire()) return Names[Empty];
+    return Names[id];
+}
+
 // ============= Step ==============
 
-ATrackingStepData::ATrackingStepData(float *position, float time, float energy, float depositedEnergy, const QString & process) :
-    Time(time), Energy(energy), DepositedEnergy(depositedEnergy), Process(process)
+ATrackingStepData::ATrackingStepData(const float *position, float time, float energy, float depositedEnergy, const QString & process) :
+    Time(time), Energy(energy), DepositedEnergy(depositedEnergy), ProcessId(ATrackingNameTable::getInstance().getId(process))
 {
     for (int i=0; i<3; i++) Position[i] = position[i];
 }
 
 ATrackingStepData::ATrackingStepData(const double *position, double time, double energy, double depositedEnergy, const QString &process) :
-    Time(time), Energy(energy), DepositedEnergy(depositedEnergy), Process(process)
+    Time(time), Energy(energy), DepositedEnergy(depositedEnergy), ProcessId(ATrackingNameTable::getInstance().getId(process))
 {
     for (int i=0; i<3; i++) Position[i] = position[i];
 }
 
 ATrackingStepData::ATrackingStepData(float x, float y, float z, float time, float energy, float depositedEnergy, const QString &process) :
-    Time(time), Energy(energy), DepositedEnergy(depositedEnergy), Process(process)
+    Time(time), Energy(energy), DepositedEnergy(depositedEnergy), ProcessId(ATrackingNameTable::getInstance().getId(process))
 {
     Position[0] = x;
     Position[1] = y;
     Position[2] = z;
 }
 
-ATrackingStepData::~ATrackingStepData(){}
-
-void ATrackingStepData::logToString(QString & str, int offset) const
-{
-    str += QString(' ').repeated(offset);
-    str += QString("%2 at [%4, %5, %6]mm t=%7ns depo=%3keV E=%1keV").arg(Energy).arg(Process).arg(DepositedEnergy).arg(Position[0]).arg(Position[1]).arg(Position[2]).arg(Time);
-    if (Secondaries.size() > 0)
-        str += QString("  #sec:%1").arg(Secondaries.size());
-    str += '\n';
-}
-
-ATransportationStepData::ATransportationStepData(float x, float y, float z, float time, float energy, float depositedEnergy, const QString &process) :
-    ATrackingStepData(x,y,z, time, energy, depositedEnergy, process) {}
-
-ATransportationStepData::ATransportationStepData(const double *position, double time, double energy, double depositedEnergy, const QString &process) :
-    ATrackingStepData(position, time, energy, depositedEnergy, process) {}
-
-void ATransportationStepData::setVolumeInfo(const QString & volName, int volIndex, int matIndex)
+void ATrackingStepData::setVolumeInfo(const QString & volName, int volIndex, int matIndex)
 {
-    VolName  = volName;
-    VolIndex = volIndex;
+    VolNameId = ATrackingNameTable::getInstance().getId(volName);
+    VolIndex  = volIndex;
     iMaterial = matIndex;
 }
 
-void ATransportationStepData::logToString(QString &str, int offset) const
+void ATrackingStepData::logToString(QString & str, int offset) const
 {
-    if (Process == "C")
+    str += QString(' ').repeated(offset);
+    if (isTransportation() && ProcessId == ATrackingNameTable::Creation)
     {
-        str += QString(' ').repeated(offset);
-        str += QString("C at %1 %2 (mat %3)").arg(VolName).arg(VolIndex).arg(iMaterial);
+        str += QString("C at %1 %2 (mat %3)").arg(getVolName()).arg(VolIndex).arg(iMaterial);
         str += QString(" [%1, %2, %3]mm t=%4ns E=%5keV").arg(Position[0]).arg(Position[1]).arg(Position[2]).arg(Time).arg(Energy);
         str += '\n';
+        return;
     }
-    else if (Process == "T")
+
+    if (isTransportation() && ProcessId == ATrackingNameTable::Transportation)
     {
-        str += QString(' ').repeated(offset);
-        str += QString("T to %1 %2 (mat %3)").arg(VolName).arg(VolIndex).arg(iMaterial);
+        str += QString("T to %1 %2 (mat %3)").arg(getVolName()).arg(VolIndex).arg(iMaterial);
         str += QString(" [%1, %2, %3]mm t=%4ns depo=%5keV E=%6keV").arg(Position[0]).arg(Position[1]).arg(Position[2]).arg(Time).arg(DepositedEnergy).arg(Energy);
-        if (Secondaries.size() > 0)  str += QString("  #sec:%1").arg(Secondaries.size());
-        str += '\n';
     }
-    else ATrackingStepData::logToString(str, offset);
+    else
+        str += QString("%2 at [%4, %5, %6]mm t=%7ns depo=%3keV E=%1keV").arg(Energy).arg(getProcess()).arg(DepositedEnergy).arg(Position[0]).arg(Position[1]).arg(Position[2]).arg(Time);
+    if (NumSecondaries > 0)
+        str += QString("  #sec:%1").arg(NumSecondaries);
+    str += '\n';
 }
 
 // ============= Track ==============
 
 AParticleTrackingRecord::~AParticleTrackingRecord()
 {
-    for (ATrackingStepData * step : Steps) delete step;
-    Steps.clear();
-
     for (AParticleTrackingRecord * sec  : Secondaries) delete sec;
     Secondaries.clear();
 }
@@ -97,12 +137,12 @@ AParticleTrackingRecord *AParticleTrackingRecord::create()
 void AParticleTrackingRecord::updatePromisedSecondary(const QString & particle, float startEnergy, float startX, float startY, float startZ, float startTime, const QString& volName, int volIndex, int matIndex)
 {
     ParticleName = particle;
-    ATransportationStepData * st = new ATransportationStepData(startX, startY, startZ, startTime, startEnergy, 0, "C");
-    st->setVolumeInfo(volName, volIndex, matIndex);
+    ATrackingStepData st(startX, startY, startZ, startTime, startEnergy, 0, "C");
+    st.setVolumeInfo(volName, volIndex, matIndex);
     Steps.push_back(st);
 }
 
-void AParticleTrackingRecord::addStep(ATrackingStepData * step)
+void AParticleTrackingRecord::addStep(const ATrackingStepData & step)
 {
     Steps.push_back( step );
 }
@@ -110,6 +150,13 @@ void AParticleTrackingRecord::addStep(ATrackingStepData * step)
 void AParticleTrackingRecord::addSecondary(AParticleTrackingRecord *sec)
 {
     sec->SecondaryOf = this;
+
+    if (!Steps.empty())
+    {
+        ATrackingStepData & step = Steps.back();
+        if (step.NumSecondaries == 0) step.FirstSecondary = static_cast<int>(Secondaries.size());
+        step.NumSecondaries++;
+    }
     Secondaries.push_back(sec);
 }
 
@@ -120,14 +167,28 @@ int AParticleTrackingRecord::countSecondaries() const
 
 bool AParticleTrackingRecord::isHaveProcesses(const QStringList & Proc, bool bOnlyPrimary)
 {
-    for (ATrackingStepData * s : Steps)
-        for (const QString & p : Proc)
-            if (p == s->Process) return true;
+    std::vector<int> ids;
+    ATrackingNameTable & names = ATrackingNameTable::getInstance();
+    for (const QString & p : Proc)
+    {
+        const int id = names.findId(p);
+        if (id != -1) ids.push_back(id);
+    }
+    if (ids.empty()) return false;
+
+    return isHaveProcessIds(ids, bOnlyPrimary);
+}
+
+bool AParticleTrackingRecord::isHaveProcessIds(const std::vector<int> & ProcIds, bool bOnlyPrimary) const
+{
+    for (const ATrackingStepData & s : Steps)
+        for (int id : ProcIds)
+            if (id == s.ProcessId) return true;
 
     if (!bOnlyPrimary)
     {
         for (AParticleTrackingRecord * sec : Secondaries)
-            if (sec->isHaveProcesses(Proc, bOnlyPrimary))
+            if (sec->isHaveProcessIds(ProcIds, bOnlyPrimary))
                 return true;
     }
 
@@ -136,12 +197,11 @@ bool AParticleTrackingRecord::isHaveProcesses(const QStringList & Proc, bool bOn
 
 bool AParticleTrackingRecord::isTouchedVolumes(const QStringList & Vols, const QStringList & VolsStartsWith) const
 {
-    for (ATrackingStepData * s : Steps)
+    for (const ATrackingStepData & s : Steps)
     {
-        ATransportationStepData * tr = dynamic_cast<ATransportationStepData*>(s);
-        if (tr)
+        if (s.isTransportation())
         {
-            const QString & volName = tr->VolName;
+            const QString & volName = s.getVolName();
 
             if (Vols.contains(volName)) return true;
             for (const QString & s : VolsStartsWith)
@@ -181,12 +241,12 @@ void AParticleTrackingRecord::logToString(QString & str, int offset, bool bExpan
     //str += (ParticleId > -1 && ParticleId < ParticleNames.size() ? ParticleNames.at(ParticleId) : "unknown");
     str += ParticleName + "\n";
 
-    for (auto* st : Steps)
+    for (const ATrackingStepData & st : Steps)
     {
-        st->logToString(str, offset);
+        st.logToString(str, offset);
         if (bExpandSecondaries)
         {
-            for (int & iSec : st->Secondaries)
+            for (int iSec = st.FirstSecondary; iSec < st.FirstSecondary + st.NumSecondaries; iSec++)
                 Secondaries.at(iSec)->logToString(str, offset + 4, bExpandSecondaries);
         }
     }
@@ -199,10 +259,10 @@ void AParticleTrackingRecord::makeTrack(std::vector<TrackHolderClass *> & Tracks
     TrackBuildOptions.applyToParticleTrack(tr, ParticleNames.indexOf(ParticleName));
     Tracks.push_back(tr);
 
-    for (ATrackingStepData * step : Steps)
+    for (const ATrackingStepData & step : Steps)
     {
-        if (step->Process != "T")
-            tr->Nodes.append( TrackNodeStruct(step->Position[0], step->Position[1], step->Position[2], step->Time) );
+        if (step.ProcessId != ATrackingNameTable::Transportation)
+            tr->Nodes.append( TrackNodeStruct(step.Position[0], step.Position[1], step.Position[2], step.Time) );
     }
 
     if (bWithSecondaries)
@@ -210,7 +270,7 @@ void AParticleTrackingRecord::makeTrack(std::vector<TrackHolderClass *> & Tracks
             sec->makeTrack(Tracks, ParticleNames, TrackBuildOptions, bWithSecondaries);
 }
 
-void AParticleTrackingRecord::fillELDD(ATrackingStepData *IdByStep, std::vector<float> &dist, std::vector<float> &ELDD) const
+void AParticleTrackingRecord::fillELDD(const ATrackingStepData *IdByStep, std::vector<float> &dist, std::vector<float> &ELDD) const
 {
     dist.clear();
     ELDD.clear();
@@ -220,10 +280,10 @@ void AParticleTrackingRecord::fillELDD(ATrackingStepData *IdByStep, std::vector<
     bool bFound = false;
     for (; iStep<Steps.size(); iStep++)
     {
-        QString Proc = Steps.at(iStep)->Process;
-        if (Proc == "C" || Proc == "T") iMatStart = iStep;
+        const int Proc = Steps[iStep].ProcessId;
+        if (Proc == ATrackingNameTable::Creation || Proc == ATrackingNameTable::Transportation) iMatStart = iStep;
 
-        if (Steps.at(iStep) == IdByStep)
+        if (&Steps[iStep] == IdByStep)
         {
             bFound = true;
             break;
@@ -235,11 +295,11 @@ void AParticleTrackingRecord::fillELDD(ATrackingStepData *IdByStep, std::vector<
     iStep = iMatStart;
     do
     {
-        ATrackingStepData * ps = Steps.at(iStep);
+        const ATrackingStepData * ps = &Steps[iStep];
         iStep++;
         if (iStep >= (int)Steps.size()) break;
-        ATrackingStepData * ts = Steps.at(iStep);
-        if (ts->Process == "T" || ts->Process == "O") break;
+        const ATrackingStepData * ts = &Steps[iStep];
+        if (ts->ProcessId == ATrackingNameTable::Transportation || ts->ProcessId == ATrackingNameTable::Out) break;
 
         float Delta = 0;
         for (int i=0; i<3; i++)
@@ -3,6 +3,9 @@
 
 #include <QString>
 #include <QStringList>
+#include <QHash>
+#include <QAtomicInt>
+#include <QReadWriteLock>
 #include <vector>
 
 class AParticleTrackingRecord;
@@ -11,41 +14,71 @@ class ATrackBuildOptions;
 class TGeoNode;
 class TrackHolderClass;
 
+// Process and volume names are interned: a step keeps only small integer ids
+// The table is shared by all threads; a registered name never changes, so getName() does not lock
+class ATrackingNameTable
+{
+public:
+    enum {Empty = 0, Creation, Transportation, Out, Unregistered}; // "", "C", "T", "O" and "?" are always registered
+
+    static ATrackingNameTable & getInstance();
+
+    int  getId(const QString & name);          // registers the name if it is new
+    int  findId(const QString & name) const;   // returns -1 if the name was never registered
+    const QString & getName(int id) const;
+    int  countNames() const {return NumNames.loadAcquire();}
+    int  countRejected() const {return NumRejected.loadAcquire();}  // names which did not fit into the table -> "?"
+    static int getMaxNames() {return MaxNames;}
+
+private:
+    ATrackingNameTable();
+    ~ATrackingNameTable();
+
+    ATrackingNameTable(const ATrackingNameTable &) = delete;
+    ATrackingNameTable & operator=(const ATrackingNameTable &) = delete;
+
+    static const int MaxNames = 16384;
+
+    QString *          Names;     // fixed capacity - never reallocated
+    QAtomicInt         NumNames;
+    QAtomicInt         NumRejected;
+    QHash<QString,int> Ids;
+    mutable QReadWriteLock Lock;
+};
+
+// Flat step record: steps of a particle are stored by value in one contiguous block
 class ATrackingStepData
 {
 public:
-    ATrackingStepData(float * position, float time, float energy, float depositedEnergy, const QString & process);
+    ATrackingStepData(const float * position, float time, float energy, float depositedEnergy, const QString & process);
     ATrackingStepData(const double * position, double time, double energy, double depositedEnergy, const QString & process);
     ATrackingStepData(float x, float y, float z, float time, float energy, float depositedEnergy, const QString & process);
 
-    virtual ~ATrackingStepData();
+    void setVolumeInfo(const QString & volName, int volIndex, int matIndex);
 
-    virtual void logToString(QString & str, int offset) const;
+    const QString & getProcess() const {return ATrackingNameTable::getInstance().getName(ProcessId);}
+    const QString & getVolName() const {return ATrackingNameTable::getInstance().getName(VolNameId);}
+
+    bool isTransportation() const {return VolNameId != -1;} // "C" and "T" steps carry volume info
+    bool isSecondaryOfThisStep(int iSec) const {return iSec >= FirstSecondary && iSec < FirstSecondary + NumSecondaries;}
+
+    void logToString(QString & str, int offset) const;
 
 public:
     float   Position[3];
     float   Time;
     float   Energy;
     float   DepositedEnergy;
-    QString Process;              //step defining process
-    std::vector<int> Secondaries; //secondaries created in this step - indexes in the parent record
-};
-
-class ATransportationStepData : public ATrackingStepData
-{
-public:
-    ATransportationStepData(float x, float y, float z, float time, float energy, float depositedEnergy, const QString & process);
-    ATransportationStepData(const double * position, double time, double energy, double depositedEnergy, const QString & process);
+    int     ProcessId;            //step defining process - id in ATrackingNameTable
 
-    void setVolumeInfo(const QString & volName, int volIndex, int matIndex);
-
-public:
     // for "T" step it is for the next volume, for "C" step it is for the current
-    QString VolName;
-    int VolIndex;
-    int iMaterial;
+    int     VolNameId  = -1;      //id in ATrackingNameTable, -1 if there is no volume info
+    int     VolIndex   = -1;
+    int     iMaterial  = -1;
 
-    virtual void logToString(QString & str, int offset) const override;
+    //secondaries created in this step - index range in the parent record
+    int     FirstSecondary = 0;
+    int     NumSecondaries = 0;
 };
 
 class AParticleTrackingRecord
@@ -55,14 +88,14 @@ public:
     static AParticleTrackingRecord* create(); // try to avoid this
 
     void updatePromisedSecondary(const QString & particle, float startEnergy, float startX, float startY, float startZ, float startTime, const QString& volName, int volIndex, int matIndex);
-    void addStep(ATrackingStepData * step);
+    void addStep(const ATrackingStepData & step);
 
-    void addSecondary(AParticleTrackingRecord * sec);
+    void addSecondary(AParticleTrackingRecord * sec); // registered as created in the last added step
     int  countSecondaries() const;
 
     bool isPrimary() const {return !SecondaryOf;}
     bool isSecondary() const {return (bool)SecondaryOf;}
-    const std::vector<ATrackingStepData *> & getSteps() const {return Steps;}
+    const std::vector<ATrackingStepData> & getSteps() const {return Steps;}
     const AParticleTrackingRecord * getSecondaryOf() const {return SecondaryOf;}
     const std::vector<AParticleTrackingRecord *> & getSecondaries() const {return Secondaries;}
 
@@ -72,10 +105,13 @@ public:
 
     void logToString(QString & str, int offset, bool bExpandSecondaries) const;
     void makeTrack(std::vector<TrackHolderClass *> & Tracks, const QStringList & ParticleNames, const ATrackBuildOptions & TrackBuildOptions, bool bWithSecondaries) const;
-    void fillELDD(ATrackingStepData * IdByStep, std::vector<float> & dist, std::vector<float> & ELDD) const;
+    void fillELDD(const ATrackingStepData * IdByStep, std::vector<float> & dist, std::vector<float> & ELDD) const;
 
     virtual ~AParticleTrackingRecord();
 
+private:
+    bool isHaveProcessIds(const std::vector<int> & ProcIds, bool bOnlyPrimary) const;
+
     // prevent creation on the stack and copy/move
 private:
     AParticleTrackingRecord(const QString & particle) : ParticleName(particle) {}
@@ -90,7 +126,7 @@ public:
     QString ParticleName;
 
 private:
-    std::vector<ATrackingStepData *> Steps;   // tracking steps
+    std::vector<ATrackingStepData> Steps;     // tracking steps
     AParticleTrackingRecord * SecondaryOf = nullptr;    // 0 means primary
     std::vector<AParticleTrackingRecord *> Secondaries; // vector of secondaries
 
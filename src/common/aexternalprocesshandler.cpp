@@ -12,6 +12,12 @@ AExternalProcessHandler::~AExternalProcessHandler()
 }
 
 bool AExternalProcessHandler::startAndWait()
+{
+    if (!start()) return false;
+    return waitForFinished();
+}
+
+bool AExternalProcessHandler::start()
 {
     if (Process)
     {
@@ -28,7 +34,28 @@ bool AExternalProcessHandler::startAndWait()
     QObject::connect(Process, SIGNAL(readyReadStandardOutput()), this, SLOT(onReadReady()));
 
     Process->start(Program, Args);
-    bool bStartedOK = Process->waitForStarted(1000);
+    bStartedOK = Process->waitForStarted(1000);
+    return true;
+}
+
+bool AExternalProcessHandler::isRunning() const
+{
+    return Process && Process->state() != QProcess::NotRunning;
+}
+
+void AExternalProcessHandler::pollOutput()
+{
+    if (isRunning()) Process->waitForReadyRead(0); // emits readyReadStandardOutput if there is something
+}
+
+bool AExternalProcessHandler::waitForFinished()
+{
+    if (!Process)
+    {
+        ErrorString = "Not started";
+        return false;
+    }
+
     if (bStartedOK) Process->waitForFinished(-1);
 
     QProcess::ExitStatus exitStat = Process->exitStatus();
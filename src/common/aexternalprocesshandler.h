@@ -18,6 +18,12 @@ public:
     bool startAndWait();
     void abort();
 
+    // for the case the caller has to communicate with the process while it is running
+    bool start();
+    bool isRunning() const;
+    void pollOutput();          // processes pending output (progress reports) without blocking
+    bool waitForFinished();
+
     void setVerbose() {bVerbose = true;}
     void setProgressVariable(int * progressPercent) {ExeProgress = progressPercent;}
     const QString & getOutput() {return output;}
@@ -34,6 +40,7 @@ private:
     QProcess * Process = nullptr;
     QString output;
     bool bVerbose = false;
+    bool bStartedOK = false;
     int * ExeProgress;
 };
 
@@ -1,8 +1,26 @@
 #include "ahistogram.h"
 
 #include <limits>
+#include <cmath>
+#include <algorithm>
 #include <QDebug>
 
+static void widenDegenerateRange(double & from, double & to)
+{
+    if (from != to) return;
+    const double delta = ( from == 0 ? 1.0 : 0.005 * fabs(from) );
+    from -= delta;
+    to   += delta;
+}
+
+// bin center, or +-infinity for underflow / overflow
+static double binPosition(int ibin, int bins, double from, double deltaBin)
+{
+    if (ibin == 0)    return -std::numeric_limits<double>::infinity();
+    if (ibin > bins)  return  std::numeric_limits<double>::infinity();
+    return from + (ibin - 0.5) * deltaBin;
+}
+
 AHistogram1D::AHistogram1D(int Bins, double From, double To) :
     bins(Bins), from(From), to(To)
 {
@@ -16,6 +34,7 @@ AHistogram1D::AHistogram1D(int Bins, double From, double To) :
     else
     {
         bFixedRange = false;
+        bExtendable = true;
         buffer.reserve(bufferSize);
     }
 }
@@ -34,27 +53,83 @@ void AHistogram1D::Fill(double x, double val)
     }
 }
 
+void AHistogram1D::append(const AHistogram1D & other)
+{
+    if (!other.bFixedRange)
+    {
+        for (const auto & p : other.buffer)
+            Fill(p.first, p.second);
+        return;
+    }
+
+    if (!bFixedRange)
+    {
+        if (buffer.empty())
+        {
+            const size_t size = bufferSize;
+            *this = other;
+            bufferSize = size;
+            return;
+        }
+        processBuffer();
+    }
+
+    if (other.bins == bins && other.from == from && other.to == to)
+    {
+        for (int i=0; i<bins+2; i++)
+            data[i] += other.data[i];
+    }
+    else
+    {
+        for (int i=0; i<other.bins+2; i++)
+            if (other.data[i] != 0)
+                fillBin(binPosition(i, other.bins, other.from, other.deltaBin), other.data[i]);
+    }
+
+    entries  += other.entries;
+    sumVal   += other.sumVal;
+    sumVal2  += other.sumVal2;
+    sumValX  += other.sumValX;
+    sumValX2 += other.sumValX2;
+}
+
+bool AHistogram1D::Import(double From, double To, const std::vector<double> & binContent, const std::vector<double> & stats)
+{
+    if (binContent.size() < 3 || From >= To || stats.size() != 5) return false;
+
+    bins = binContent.size() - 2;
+    from = From;
+    to = To;
+    deltaBin = (to - from) / bins;
+    data = binContent;
+
+    sumVal   = stats[0];
+    sumVal2  = stats[1];
+    sumValX  = stats[2];
+    sumValX2 = stats[3];
+    entries  = stats[4];
+
+    bFixedRange = true;
+    bExtendable = false;
+    buffer.clear();
+    return true;
+}
+
 const std::vector<double> &AHistogram1D::getContent()
 {
     if (!bFixedRange) processBuffer();
     return data;
 }
 
-const std::vector<double> AHistogram1D::getStat()
+const std::vector<double> AHistogram1D::getStat() const
 {
     return {sumVal, sumVal2, sumValX, sumValX2, entries};
 }
 
 void AHistogram1D::fillFixed(double x, double val)
 {
-    if (x < from)
-        data[0] += val;
-    else if (x > to)
-        data[bins+1] += val;
-    else
+    if (fillBin(x, val))
     {
-        data[ 1 + (x - from)/deltaBin ] += val;
-
         sumVal   += val;
         sumVal2  += val*val;
         sumValX  += val*x;
@@ -62,6 +137,57 @@ void AHistogram1D::fillFixed(double x, double val)
     }
 }
 
+bool AHistogram1D::fillBin(double x, double val)
+{
+    if (bExtendable && (x < from || x > to))
+        extendRange(x);
+
+    if (x < from)
+    {
+        data[0] += val;
+        return false;
+    }
+    if (x > to)
+    {
+        data[bins+1] += val;
+        return false;
+    }
+
+    int ibin = 1 + (x - from)/deltaBin;
+    if (ibin > bins) ibin = bins; // x == to
+    data[ibin] += val;
+    return true;
+}
+
+void AHistogram1D::extendRange(double x)
+{
+    if (!std::isfinite(x)) return;
+
+    // the range is doubled towards x: every old bin is fully inside one of the new bins
+    std::vector<double> old;
+    while (x < from || x > to)
+    {
+        const double range = to - from;
+        int offset;
+        if (x < from)
+        {
+            from -= range;
+            offset = bins;
+        }
+        else
+        {
+            to += range;
+            offset = 0;
+        }
+        deltaBin *= 2.0;
+
+        old = data;
+        std::fill(data.begin() + 1, data.end() - 1, 0);
+        for (int i=0; i<bins; i++)
+            data[1 + (offset + i)/2] += old[1 + i];
+    }
+}
+
 void AHistogram1D::processBuffer()
 {
     if (buffer.empty()) return;
@@ -73,14 +199,10 @@ void AHistogram1D::processBuffer()
         if      (x < from) from = x;
         else if (x > to)   to   = x;
     }
-
-    if (from == to)
-    {
-        from *= 0.995;
-        to   *= 1.005;
-    }
+    widenDegenerateRange(from, to);
 
     deltaBin = (to - from) / bins + std::numeric_limits<double>::epsilon();
+    bFixedRange = true;
 
     for (size_t i=0; i<buffer.size(); i++)
     {
@@ -88,8 +210,7 @@ void AHistogram1D::processBuffer()
         const double & val = buffer[i].second;
         fillFixed(x, val);
     }
-
-    bFixedRange = true;
+    buffer.clear();
 }
 
 AHistogram2D::AHistogram2D(int XBins, double XFrom, double XTo, int YBins, double YFrom, double YTo) :
@@ -127,18 +248,113 @@ void AHistogram2D::Fill(double x, double y, double val)
     }
 }
 
+void AHistogram2D::append(const AHistogram2D & other)
+{
+    if (!other.bFixedRange)
+    {
+        for (const auto & t : other.buffer)
+            Fill(std::get<0>(t), std::get<1>(t), std::get<2>(t));
+        return;
+    }
+
+    if (!bFixedRange)
+    {
+        if (buffer.empty())
+        {
+            const size_t size = bufferSize;
+            *this = other;
+            bufferSize = size;
+            return;
+        }
+        processBuffer();
+    }
+
+    if (other.xbins == xbins && other.xfrom == xfrom && other.xto == xto &&
+        other.ybins == ybins && other.yfrom == yfrom && other.yto == yto)
+    {
+        for (int iy=0; iy<ybins+2; iy++)
+        {
+            std::vector<double> & row = data[iy];
+            const std::vector<double> & otherRow = other.data[iy];
+            for (int ix=0; ix<xbins+2; ix++)
+                row[ix] += otherRow[ix];
+        }
+    }
+    else
+    {
+        for (int iy=0; iy<other.ybins+2; iy++)
+        {
+            const double y = binPosition(iy, other.ybins, other.yfrom, other.ydeltaBin);
+            for (int ix=0; ix<other.xbins+2; ix++)
+                if (other.data[iy][ix] != 0)
+                    fillBin(binPosition(ix, other.xbins, other.xfrom, other.xdeltaBin), y, other.data[iy][ix]);
+        }
+    }
+
+    entries  += other.entries;
+    sumVal   += other.sumVal;
+    sumVal2  += other.sumVal2;
+    sumValX  += other.sumValX;
+    sumValX2 += other.sumValX2;
+    sumValY  += other.sumValY;
+    sumValY2 += other.sumValY2;
+}
+
+bool AHistogram2D::Import(double Xfrom, double Xto, double Yfrom, double Yto, const std::vector<std::vector<double> > & binContent, const std::vector<double> & stats)
+{
+    if (binContent.size() < 3 || binContent[0].size() < 3) return false;
+    for (const auto & row : binContent)
+        if (row.size() != binContent[0].size()) return false;
+    if (Xfrom >= Xto || Yfrom >= Yto || stats.size() != 7) return false;
+
+    ybins = binContent.size() - 2;
+    xbins = binContent[0].size() - 2;
+    xfrom = Xfrom;
+    xto   = Xto;
+    yfrom = Yfrom;
+    yto   = Yto;
+    xdeltaBin = (xto - xfrom) / xbins;
+    ydeltaBin = (yto - yfrom) / ybins;
+    data = binContent;
+
+    sumVal   = stats[0];
+    sumVal2  = stats[1];
+    sumValX  = stats[2];
+    sumValX2 = stats[3];
+    sumValY  = stats[4];
+    sumValY2 = stats[5];
+    entries  = stats[6];
+
+    bFixedRange = true;
+    buffer.clear();
+    return true;
+}
+
 const std::vector<std::vector<double> > & AHistogram2D::getContent()
 {
     if (!bFixedRange) processBuffer();
     return data;
 }
 
-const std::vector<double> AHistogram2D::getStat()
+const std::vector<double> AHistogram2D::getStat() const
 {
     return {sumVal, sumVal2, sumValX, sumValX2, sumValY, sumValY2, entries};
 }
 
 void AHistogram2D::fillFixed(double x, double y, double val)
+{
+    if (fillBin(x, y, val))
+    {
+        sumVal   += val;
+        sumVal2  += val*val;
+        sumValX  += val*x;
+        sumValX2 += val*x*x;
+        sumValY  += val*y;
+        sumValY2 += val*y*y;
+    }
+}
+
+bool AHistogram2D::fillBin(double x, double y, double val)
 {
     int ixbin, iybin;
     bool bGood = true;
@@ -154,7 +370,10 @@ void AHistogram2D::fillFixed(double x, double y, double val)
         bGood = false;
     }
     else
+    {
         ixbin = 1 + (x - xfrom)/xdeltaBin;
+        if (ixbin > xbins) ixbin = xbins;
+    }
 
     if      (y < yfrom)
     {
@@ -167,19 +386,13 @@ void AHistogram2D::fillFixed(double x, double y, double val)
         bGood = false;
     }
     else
+    {
         iybin = 1 + (y - yfrom)/ydeltaBin;
+        if (iybin > ybins) iybin = ybins;
+    }
 
     data[iybin][ixbin] += val;
-
-    if (bGood)
-    {
-        sumVal   += val;
-        sumVal2  += val*val;
-        sumValX  += val*x;
-        sumValX2 += val*x*x;
-        sumValY  += val*y;
-        sumValY2 += val*y*y;
-    }
+    return bGood;
 }
 
 void AHistogram2D::processBuffer()
@@ -197,9 +410,12 @@ void AHistogram2D::processBuffer()
         if      (y < yfrom) yfrom = y;
         else if (y > yto)   yto   = y;
     }
+    widenDegenerateRange(xfrom, xto);
+    widenDegenerateRange(yfrom, yto);
 
     xdeltaBin = (xto - xfrom) / xbins + std::numeric_limits<double>::epsilon();
     ydeltaBin = (yto - yfrom) / ybins + std::numeric_limits<double>::epsilon();
+    bFixedRange = true;
 
     for (size_t i=0; i<buffer.size(); i++)
     {
@@ -208,8 +424,7 @@ void AHistogram2D::processBuffer()
         const double & val = std::get<2>(buffer[i]);
         fillFixed(x, y, val);
     }
-
-    bFixedRange = true;
+    buffer.clear();
 }
 
 // --------------------------------------------------------------------------------------
@@ -235,6 +450,15 @@ const QString ATH1D::Import(double from, double to, const std::vector<double> &
     return "";
 }
 
+void ATH1D::Import(AHistogram1D & hist)
+{
+    const std::vector<double> & content = hist.getContent(); // can define the range, so before getLimits
+    double from, to;
+    hist.getLimits(from, to);
+    if (from < to) Import(from, to, content, hist.getStat());
+    else Reset();
+}
+
 void ATH1D::setStats(double *statsArray)
 {
     fTsumw   = statsArray[0];
@@ -274,6 +498,15 @@ const QString ATH2D::Import(double xfrom, double xto, double yfrom, double yto,
     return "";
 }
 
+void ATH2D::Import(AHistogram2D & hist)
+{
+    const std::vector< std::vector<double> > & content = hist.getContent();
+    double xfrom, xto, yfrom, yto;
+    hist.getLimits(xfrom, xto, yfrom, yto);
+    if (xfrom < xto && yfrom < yto) Import(xfrom, xto, yfrom, yto, content, hist.getStat());
+    else Reset();
+}
+
 void ATH2D::SetStatistic(const std::vector<double> &stats)
 {
     fTsumw   = stats[0];
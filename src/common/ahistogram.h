@@ -8,14 +8,19 @@
 class AHistogram1D
 {
 public:
-    AHistogram1D(int Bins, double From, double To);
+    AHistogram1D(int Bins, double From, double To); // To <= From: range is defined by the buffered entries, then extended (doubled) on demand
     void setBufferSize(size_t size) {bufferSize = size;}
 
     void Fill(double x, double val);
 
+    void append(const AHistogram1D & other); // e.g. to merge the data from several threads; bins are rebinned if the ranges are different
+    bool Import(double From, double To, const std::vector<double> & binContent, const std::vector<double> & stats); // same formats as in getContent/getStat
+
+    int  getBins() const {return bins;}
+    double getEntries() const {return entries;}
     void getLimits(double & From, double & To) const {From = from; To = to;}
     const std::vector<double> & getContent(); // [0] - underflow, [1] - bin#0, ..., [bins] - bin#(bins-1), [bins+1] - overflow
-    const std::vector<double> getStat();    // [0] - sumVals, [1] - sumVals2, [2] - sumValX, [3] - sumValX2, [4] - # entries
+    const std::vector<double> getStat() const;    // [0] - sumVals, [1] - sumVals2, [2] - sumValX, [3] - sumValX2, [4] - # entries
 
 private:
     int    bins;
@@ -30,6 +35,7 @@ private:
     double sumValX2 = 0;
 
     bool   bFixedRange = true;
+    bool   bExtendable = false;
     size_t bufferSize = 1000;
 
     std::vector<double> data; // [0] - underflow, [bins+1] - overflow
@@ -37,6 +43,8 @@ private:
 
 private:
     void fillFixed(double x, double val);
+    bool fillBin(double x, double val); // false for under/overflow; no stat update
+    void extendRange(double x);
     void processBuffer();
 
 };
@@ -49,9 +57,13 @@ public:
 
     void Fill(double x, double y, double val);
 
+    void append(const AHistogram2D & other); // bins are rebinned if the ranges are different
+    bool Import(double Xfrom, double Xto, double Yfrom, double Yto, const std::vector< std::vector<double> > & binContent, const std::vector<double> & stats);
+
+    double getEntries() const {return entries;}
     void getLimits(double & Xfrom, double & Xto, double & Yfrom, double & Yto) const {Xfrom = xfrom; Xto = xto; Yfrom = yfrom; Yto = yto;}
     const std::vector< std::vector<double> > & getContent(); //[y][x]; in each X: [0] - underflow, [1] - bin#0, ..., [bins] - bin#(bins-1), [bins+1] - overflow
-    const std::vector<double> getStat();    // [0] - sumVals, [1] - sumVals2, [2] - sumValX, [3] - sumValX2, [4] - sumValY, [5] - sumValY2, [6] - # entries
+    const std::vector<double> getStat() const;    // [0] - sumVals, [1] - sumVals2, [2] - sumValX, [3] - sumValX2, [4] - sumValY, [5] - sumValY2, [6] - # entries
 
 private:
     int    xbins;
@@ -80,6 +92,7 @@ private:
 
 private:
     void fillFixed(double x, double y, double val);
+    bool fillBin(double x, double y, double val); // false for under/overflow; no stat update
     void processBuffer();
 
 };
@@ -95,6 +108,7 @@ public:
     ATH1D(const TH1D & other);
 
     const QString Import(double from, double to, const std::vector<double> & binContent, const std::vector<double> & stats); // empty srtring if no error
+    void Import(AHistogram1D & hist); // histogram is reset if the range of hist is not yet defined
 
     void setStats(double * statsArray);
 
@@ -108,6 +122,7 @@ public:
     ATH2D(const char *name, const char *title, int xbins, double xfrom, double xto, int ybins, double yfrom, double yto);
 
     const QString Import(double xfrom, double xto, double yfrom, double yto, const std::vector<std::vector<double> > &binContent, const std::vector<double> & stats); // empty srtring if no error
+    void Import(AHistogram2D & hist);
 
 private:
     void SetStatistic(const std::vector<double> & stats);
@@ -0,0 +1,140 @@
+#include "ainterpolationtable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+AInterpolationArgument::AInterpolationArgument(double x) :
+    X(x), LogX(x > 0 ? log(x) : -std::numeric_limits<double>::infinity()) {}
+
+void AInterpolationTable::configure(const QVector<double> & X, const QVector<double> & F, bool bLogLog)
+{
+    clear();
+    const int size = std::min(X.size(), F.size());
+    if (size == 0) return;
+
+    FirstF = F.first();
+    LastF  = F.at(size-1);
+
+    Nodes.resize(size);
+    for (int i=0; i<size; i++)
+    {
+        ANode & n = Nodes[i];
+        n.X    = X.at(i);
+        n.LogX = (n.X > 0 ? log(n.X) : -std::numeric_limits<double>::infinity());
+
+        if (i == size-1)
+        {
+            n.A = F.at(i); n.B = 0; n.bLog = false;
+            continue;
+        }
+
+        const double & Less = F.at(i);
+        const double & More = F.at(i+1);
+        const double & EnergyLess = X.at(i);
+        const double & EnergyMore = X.at(i+1);
+
+        if (EnergyLess == EnergyMore)
+        {
+            n.A = More; n.B = 0; n.bLog = false;
+        }
+        else if (bLogLog && Less > 0 && More > 0 && EnergyLess > 0)
+        {
+            n.A = log(Less);
+            n.B = (log(More) - n.A) / (log(EnergyMore) - n.LogX);
+            n.bLog = true;
+        }
+        else
+        {
+            n.A = Less;
+            n.B = (More - Less) / (EnergyMore - EnergyLess);
+            n.bLog = false;
+        }
+    }
+
+    if (size < 3 || Nodes.front().X <= 0) return;
+
+    LogXmin = Nodes.front().LogX;
+    const double range = Nodes.back().LogX - LogXmin;
+    if (!(range > 0)) return;
+
+    const int numBuckets = 2 * size;
+    InvBucketWidth = numBuckets / range;
+    BucketStart.resize(numBuckets + 1);
+    int iNode = 0;
+    for (int iBucket = 0; iBucket <= numBuckets; iBucket++)
+    {
+        // last node with X strictly below the lower edge of the bucket
+        const double edge = exp(LogXmin + iBucket / InvBucketWidth);
+        while (iNode+1 < size && Nodes[iNode+1].X < edge) iNode++;
+        BucketStart[iBucket] = (iBucket == 0 ? 0 : iNode);
+    }
+}
+
+void AInterpolationTable::clear()
+{
+    Nodes.clear();
+    BucketStart.clear();
+    FirstF = LastF = 0;
+    LogXmin = InvBucketWidth = 0;
+}
+
+int AInterpolationTable::findInterval(const AInterpolationArgument & arg) const
+{
+    // returns i so that X[i] < x <= X[i+1]
+    int i;
+    if (InvBucketWidth > 0)
+    {
+        int iBucket = (arg.LogX - LogXmin) * InvBucketWidth;
+        if (iBucket < 0) iBucket = 0;
+        else if (iBucket >= (int)BucketStart.size()) iBucket = BucketStart.size() - 1;
+        i = BucketStart[iBucket];
+        // bucket edges are rounded: step back if needed
+        while (i > 0 && Nodes[i].X >= arg.X) i--;
+    }
+    else
+    {
+        auto it = std::lower_bound(Nodes.begin(), Nodes.end(), arg.X, [](const ANode & n, double x){return n.X < x;});
+        return (it - Nodes.begin()) - 1;
+    }
+
+    const int last = (int)Nodes.size() - 1;
+    while (i+1 < last && Nodes[i+1].X < arg.X) i++;
+    return i;
+}
+
+double AInterpolationTable::getValue(const AInterpolationArgument & arg) const
+{
+    if (Nodes.empty()) return 0;
+    if (!(arg.X > Nodes.front().X)) return FirstF; // also for NaN
+    if (arg.X >  Nodes.back().X)  return LastF;
+
+    const ANode & n = Nodes[findInterval(arg)];
+    if (n.bLog) return exp(n.A + n.B * (arg.LogX - n.LogX));
+    return n.A + n.B * (arg.X - n.X);
+}
+
+void AInterpolationTableSet::clear()
+{
+    Tables.clear();
+    Weights.clear();
+}
+
+void AInterpolationTableSet::addTable(const QVector<double> & X, const QVector<double> & F, double weight, bool bLogLog)
+{
+    Tables.push_back(AInterpolationTable());
+    Tables.back().configure(X, F, bLogLog);
+    Weights.push_back(weight);
+}
+
+double AInterpolationTableSet::getWeightedValues(double x, double * out) const
+{
+    const AInterpolationArgument arg(x);
+    double sum = 0;
+    for (size_t i=0; i<Tables.size(); i++)
+    {
+        out[i] = (Tables[i].isEmpty() ? 0 : Weights[i] * Tables[i].getValue(arg));
+        sum += out[i];
+    }
+    return sum;
+}
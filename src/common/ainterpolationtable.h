@@ -0,0 +1,70 @@
+#ifndef AINTERPOLATIONTABLE_H
+#define AINTERPOLATIONTABLE_H
+
+#include <QVector>
+#include <vector>
+
+// Energy argument shared by several tables: the logarithm is computed only once
+struct AInterpolationArgument
+{
+    explicit AInterpolationArgument(double x);
+
+    double X;
+    double LogX;
+};
+
+// Read-only lin-lin or log-log interpolation table (cross-sections, stopping powers), built once in updateRuntimeProperties
+// Same results as GetInterpolatedValue(): constant extrapolation outside the data range
+// The interval is found in O(1) on average using a uniform index in log(x); grids and slopes are precalculated
+class AInterpolationTable
+{
+public:
+    void configure(const QVector<double> & X, const QVector<double> & F, bool bLogLog);
+    void clear();
+
+    bool isEmpty() const {return Nodes.empty();}
+
+    double getValue(double x) const {return getValue(AInterpolationArgument(x));}
+    double getValue(const AInterpolationArgument & arg) const;
+
+private:
+    struct ANode
+    {
+        double X;
+        double LogX;
+        double A;    // value (lin) or log of value (log) at this node
+        double B;    // slope towards the next node in the same representation
+        bool   bLog; // false also for log-log intervals with non-positive values
+    };
+
+    std::vector<ANode> Nodes;
+    double FirstF = 0;
+    double LastF  = 0;
+
+    // index acceleration
+    std::vector<int> BucketStart; // index of the node to start the search from
+    double LogXmin     = 0;
+    double InvBucketWidth = 0;    // 0 -> no acceleration (non-positive x in the grid), binary search is used
+
+    int findInterval(const AInterpolationArgument & arg) const;
+};
+
+// Tables of all isotopes/elements of a mixture evaluated for one energy in a single pass
+class AInterpolationTableSet
+{
+public:
+    void clear();
+    void addTable(const QVector<double> & X, const QVector<double> & F, double weight, bool bLogLog); // empty X -> always 0
+
+    int  size() const {return static_cast<int>(Tables.size());}
+    const AInterpolationTable & getTable(int index) const {return Tables[index];}
+
+    // out has to have size() elements; returns the sum
+    double getWeightedValues(double x, double * out) const;
+
+private:
+    std::vector<AInterpolationTable> Tables;
+    std::vector<double> Weights;
+};
+
+#endif // AINTERPOLATIONTABLE_H
@@ -88,17 +88,8 @@ double AMaterial::GeneratePrimScintTime(TRandom2 * RandGen) const
     else
     {
         //selecting decay time component
-        const double generatedStatWeight = _PrimScintSumStatWeight_Decay * RandGen->Rndm();
-        double cumulativeStatWeight = 0;
-        for (int i=0; i<PriScint_Decay.size(); i++)
-        {
-            cumulativeStatWeight += PriScint_Decay.at(i).statWeight;
-            if (generatedStatWeight < cumulativeStatWeight)
-            {
-                DecayTime = PriScint_Decay.at(i).value;
-                break;
-            }
-        }
+        if (_PrimScintSumStatWeight_Decay > 0)
+            DecayTime = PriScint_Decay.at(_PrimScintDecaySampler.sample(RandGen)).value;
     }
 
     if (DecayTime == 0)
@@ -111,17 +102,8 @@ double AMaterial::GeneratePrimScintTime(TRandom2 * RandGen) const
     else
     {
         //selecting raise time component
-        const double generatedStatWeight = _PrimScintSumStatWeight__Raise * RandGen->Rndm();
-        double cumulativeStatWeight = 0;
-        for (int i=0; i<PriScint_Raise.size(); i++)
-        {
-            cumulativeStatWeight += PriScint_Raise.at(i).statWeight;
-            if (generatedStatWeight < cumulativeStatWeight)
-            {
-                RiseTime = PriScint_Raise.at(i).value;
-                break;
-            }
-        }
+        if (_PrimScintSumStatWeight__Raise > 0)
+            RiseTime = PriScint_Raise.at(_PrimScintRaiseSampler.sample(RandGen)).value;
     }
 
     if (RiseTime == 0)
@@ -189,6 +171,8 @@ void AMaterial::updateRuntimeProperties(bool bLogLogInterpolation, TRandom2* Ran
 {
     for (int iP=0; iP<MatParticle.size(); iP++)
     {
+       MatParticle[iP].InteractionTable.configure(MatParticle[iP].InteractionDataX, MatParticle[iP].InteractionDataF, bLogLogInterpolation);
+
        for (int iTerm=0; iTerm<MatParticle[iP].Terminators.size(); iTerm++)
        {
            //qDebug() << "-----"<<name << iP << iTerm;
@@ -203,6 +187,61 @@ void AMaterial::updateRuntimeProperties(bool bLogLogInterpolation, TRandom2* Ran
         _PrimScintSumStatWeight_Decay += pair.statWeight;
     for (const APair_ValueAndWeight& pair : PriScint_Raise)
         _PrimScintSumStatWeight__Raise += pair.statWeight;
+
+    QVector<double> weights;
+    for (const APair_ValueAndWeight& pair : PriScint_Decay) weights << pair.statWeight;
+    _PrimScintDecaySampler.configure(weights);
+    weights.clear();
+    for (const APair_ValueAndWeight& pair : PriScint_Raise) weights << pair.statWeight;
+    _PrimScintRaiseSampler.configure(weights);
+
+    //emission spectra: histograms are already rebuilt for the current wavelength binning
+    configureSpectrumSampler(PrimarySpectrumHist,   PrimarySpectrumSampler);
+    configureSpectrumSampler(SecondarySpectrumHist, SecondarySpectrumSampler);
+}
+
+void AMaterial::configureSpectrumSampler(const TH1D * hist, ACustomRandomSampling & sampler)
+{
+    QVector<double> weights;
+    if (hist)
+    {
+        const int nbins = hist->GetNbinsX();
+        weights.reserve(nbins);
+        for (int i = 1; i <= nbins; i++) weights << hist->GetBinContent(i);
+    }
+    sampler.configure(weights);
+}
+
+double AMaterial::generateFromSpectrum(const TH1D * hist, const ACustomRandomSampling & sampler, TRandom2 * RandGen)
+{
+    //same distribution as GetRandomFromHist: uniform inside the selected bin
+    double fraction;
+    const int ibin = sampler.sample(RandGen, fraction) + 1;
+    return hist->GetBinLowEdge(ibin) + fraction * hist->GetBinWidth(ibin);
+}
+
+void AMaterial::GenerateWavelengths(int scintType, TRandom2 * RandGen, int n, double * wavelengths) const
+{
+    const TH1D * hist = (scintType == 1 ? PrimarySpectrumHist : SecondarySpectrumHist);
+    const ACustomRandomSampling & sampler = (scintType == 1 ? PrimarySpectrumSampler : SecondarySpectrumSampler);
+
+    QVector<int> bins(n);
+    sampler.sample(RandGen, n, bins.data(), wavelengths); //fractions are converted to wavelengths in place
+    for (int i = 0; i < n; i++)
+    {
+        const int ibin = bins.at(i) + 1;
+        wavelengths[i] = hist->GetBinLowEdge(ibin) + wavelengths[i] * hist->GetBinWidth(ibin);
+    }
+}
+
+double AMaterial::GeneratePrimaryWavelength(TRandom2 * RandGen) const
+{
+    return generateFromSpectrum(PrimarySpectrumHist, PrimarySpectrumSampler, RandGen);
+}
+
+double AMaterial::GenerateSecondaryWavelength(TRandom2 * RandGen) const
+{
+    return generateFromSpectrum(SecondarySpectrumHist, SecondarySpectrumSampler, RandGen);
 }
 
 void AMaterial::UpdateRandGen(int ID, TRandom2 *RandGen)
@@ -771,6 +810,7 @@ void NeutralTerminatorStructure::UpdateRunTimeProperties(bool bUseLogLog, TRando
             //      qDebug() << "Updating neutron cross-section data...";
             PartialCrossSectionEnergy.clear();
             PartialCrossSection.clear();
+            IsotopeCrossSectionTables.clear();
             //      qDebug() << "isotope records defined:"<<IsotopeRecords.size();
             for (int iElement=0; iElement<IsotopeRecords.size(); iElement++)
             {
@@ -779,6 +819,7 @@ void NeutralTerminatorStructure::UpdateRunTimeProperties(bool bUseLogLog, TRando
 
                 //updating neutron absorption runtime properties (can be custom distr of deposited energy)
                 nie.updateRuntimeProperties();
+                IsotopeCrossSectionTables.addTable(nie.Energy, nie.CrossSection, nie.MolarFraction, bUseLogLog);
 
                 //  qDebug() << "size of cross-section dataset"<<nie.Energy.size() << nie.CrossSection.size();
                 if (nie.Energy.isEmpty()) continue;
@@ -793,15 +834,18 @@ void NeutralTerminatorStructure::UpdateRunTimeProperties(bool bUseLogLog, TRando
                 else
                 {
                     //using interpolation to match already defined energy bins
+                    const AInterpolationTable & table = IsotopeCrossSectionTables.getTable(iElement);
                     for (int iEnergy=0; iEnergy<PartialCrossSectionEnergy.size(); iEnergy++)
                     {
                         const double& energy = PartialCrossSectionEnergy.at(iEnergy);
-                        const double cs = GetInterpolatedValue(energy, &nie.Energy, &nie.CrossSection, bUseLogLog);
+                        const double cs = table.getValue(energy);
                         PartialCrossSection[iEnergy] += cs * nie.MolarFraction;
                     }
                 }
             }
         }
+
+    PartialCrossSectionTable.configure(PartialCrossSectionEnergy, PartialCrossSection, bUseLogLog);
     //      qDebug() << "...done!";
 }
 
@@ -818,6 +862,8 @@ void NeutralTerminatorStructure::ClearProperties()
 
     PartialCrossSectionEnergy.clear();
     PartialCrossSection.clear();
+    PartialCrossSectionTable.clear();
+    IsotopeCrossSectionTables.clear();
 
     for (int iElement=0; iElement<IsotopeRecords.size(); iElement++)
     {
@@ -7,6 +7,8 @@
 
 #include "aneutroninteractionelement.h"
 #include "amaterialcomposition.h"
+#include "ainterpolationtable.h"
+#include "acustomrandomsampling.h"
 
 class QJsonObject;
 class AParticle;
@@ -85,6 +87,11 @@ public:
   QVector<double> SecondarySpectrum_lambda;
   QVector<double> SecondarySpectrum;
   TH1D* SecondarySpectrumHist = 0;
+  ACustomRandomSampling PrimarySpectrumSampler;   //run-time, bins of PrimarySpectrumHist
+  ACustomRandomSampling SecondarySpectrumSampler; //run-time, bins of SecondarySpectrumHist
+  double GeneratePrimaryWavelength(TRandom2* RandGen) const;   //PrimarySpectrumHist should exist
+  double GenerateSecondaryWavelength(TRandom2* RandGen) const; //SecondarySpectrumHist should exist
+  void   GenerateWavelengths(int scintType, TRandom2* RandGen, int n, double* wavelengths) const; //batch version, scintType: 1 - primary, 2 - secondary
 
   TGeoMaterial* GeoMat = 0; // handled by TGeoManager
   TGeoMedium* GeoMed = 0;   // handled by TGeoManager
@@ -109,9 +116,13 @@ private:
   //run-time properties
   double _PrimScintSumStatWeight_Decay;
   double _PrimScintSumStatWeight__Raise;
+  ACustomRandomSampling _PrimScintDecaySampler;
+  ACustomRandomSampling _PrimScintRaiseSampler;
 
 private:
   double FT(double td, double tr, double t) const;
+  static double generateFromSpectrum(const TH1D* hist, const ACustomRandomSampling & sampler, TRandom2* RandGen);
+  static void configureSpectrumSampler(const TH1D* hist, ACustomRandomSampling & sampler);
 };
 
 struct NeutralTerminatorStructure //descriptor for the interaction scenarios for neutral particles
@@ -130,6 +141,10 @@ struct NeutralTerminatorStructure //descriptor for the interaction scenarios for
   // exclusive for neutrons
   QVector<ANeutronInteractionElement> IsotopeRecords;
 
+  //run-time properties
+  AInterpolationTable    PartialCrossSectionTable;
+  AInterpolationTableSet IsotopeCrossSectionTables; //same order as IsotopeRecords, weighted with molar fractions
+
   void UpdateRunTimeProperties(bool bUseLogLog,  TRandom2 *RandGen, int numThreads, double temp = 298.0);
   void ClearProperties();
 
@@ -171,6 +186,7 @@ struct MatParticleStructure  //each paticle have this entry in MaterialStructure
 
   QVector<double> InteractionDataX; //energy in keV
   QVector<double> InteractionDataF; //stopping power (for charged) or total interaction cross-section (neutrals)
+  AInterpolationTable InteractionTable; //run-time property
 
   QVector<NeutralTerminatorStructure> Terminators;
 
@@ -1,7 +1,6 @@
 #include "amonitor.h"
 #include "ageoobject.h"
 #include "ageotype.h"
-#include "aroothistappenders.h"
 #include "ahistogram.h"
 
 #include <QDebug>
@@ -10,9 +9,9 @@
 #include "TH2D.h"
 #include "TString.h"
 
-AMonitor::AMonitor() : name("Undefined"), time(0), xy(0), angle(0), wave(0), energy(0) {}
+AMonitor::AMonitor() : name("Undefined") {}
 
-AMonitor::AMonitor(const AGeoObject *MonitorGeoObject) : time(0), xy(0), angle(0), wave(0), energy(0)
+AMonitor::AMonitor(const AGeoObject *MonitorGeoObject)
 {
     readFromGeoObject(MonitorGeoObject);
 }
@@ -29,18 +28,57 @@ void AMonitor::clearData()
     delete angle; angle = 0;
     delete wave; wave = 0;
     delete energy; energy = 0;
+
+    delete timeAcc; timeAcc = 0;
+    delete xyAcc;   xyAcc = 0;
+    delete angleAcc; angleAcc = 0;
+    delete waveAcc; waveAcc = 0;
+    delete energyAcc; energyAcc = 0;
+
+    bHistsOutdated = false;
+}
+
+TH1D *AMonitor::getTime() const
+{
+    updateHists();
+    return time;
+}
+
+TH2D *AMonitor::getXY() const
+{
+    updateHists();
+    return xy;
+}
+
+TH1D *AMonitor::getWave() const
+{
+    updateHists();
+    return wave;
+}
+
+TH1D *AMonitor::getAngle() const
+{
+    updateHists();
+    return angle;
+}
+
+TH1D *AMonitor::getEnergy() const
+{
+    updateHists();
+    return energy;
 }
 
 int AMonitor::getHits() const
 {
-    return xy->GetEntries();
+    return ( xyAcc ? xyAcc->getEntries() : 0 );
 }
 
 void AMonitor::fillForParticle(double x, double y, double Time, double Angle, double Energy)
 {
-    xy->Fill(x,y);
-    time->Fill(Time);
-    angle->Fill(Angle);
+    bHistsOutdated = true;
+    xyAcc->Fill(x, y, 1.0);
+    timeAcc->Fill(Time, 1.0);
+    angleAcc->Fill(Angle, 1.0);
 
     switch (config.energyUnitsInHist)
     {
@@ -49,15 +87,16 @@ void AMonitor::fillForParticle(double x, double y, double Time, double Angle, do
     case 2: break;
     case 3: Energy *= 1.0e-3;break;
     }
-    energy->Fill(Energy);
+    energyAcc->Fill(Energy, 1.0);
 }
 
 void AMonitor::fillForPhoton(double x, double y, double Time, double Angle, int waveIndex)
 {
-    xy->Fill(x,y);
-    time->Fill(Time);
-    angle->Fill(Angle);
-    wave->Fill(waveIndex);
+    bHistsOutdated = true;
+    xyAcc->Fill(x, y, 1.0);
+    timeAcc->Fill(Time, 1.0);
+    angleAcc->Fill(Angle, 1.0);
+    waveAcc->Fill(waveIndex, 1.0);
 }
 
 bool AMonitor::readFromGeoObject(const AGeoObject *MonitorRecord)
@@ -82,14 +121,20 @@ bool AMonitor::readFromGeoObject(const AGeoObject *MonitorRecord)
     return true;
 }
 
+template <class T>
+static void appendAccumulator(T * to, const T * from)
+{
+    if (to && from) to->append(*from);
+}
+
 void AMonitor::appendDataFromAnotherMonitor(AMonitor *from)
 {
-    appendTH1DwithStat(time, from->getTime());
-    appendTH2D(xy, from->getXY());
-    appendTH1DwithStat(angle, from->getAngle());
-    appendTH1DwithStat(wave, from->getWave());
-    //appendTH1D(energy, from->getEnergy());
-    appendTH1DwithStat(energy, from->getEnergy());
+    appendAccumulator(timeAcc,   from->timeAcc);
+    appendAccumulator(xyAcc,     from->xyAcc);
+    appendAccumulator(angleAcc,  from->angleAcc);
+    appendAccumulator(waveAcc,   from->waveAcc);
+    appendAccumulator(energyAcc, from->energyAcc);
+    bHistsOutdated = true;
 }
 
 #include "ahistogram.h"
@@ -97,14 +142,22 @@ void AMonitor::appendDataFromAnotherMonitor(AMonitor *from)
 #include <QJsonArray>
 void AMonitor::overrideDataFromJson(const QJsonObject &json)
 {
+    double multiplier;
+    switch (config.energyUnitsInHist)
+    {
+    case 0:  multiplier = 1.0e6;  break;// keV -> meV
+    case 1:  multiplier = 1.0e3;  break;// keV -> eV
+    default: multiplier = 1.0;    break;// keV -> keV
+    case 3:  multiplier = 1.0e-3; break;// keV -> MeV
+    }
     QJsonObject jEnergy = json["Energy"].toObject();
-    update1D(jEnergy, energy);
+    update1D(jEnergy, energyAcc, multiplier);
 
     QJsonObject jAngle = json["Angle"].toObject();
-    update1D(jAngle, angle);
+    update1D(jAngle, angleAcc);
 
     QJsonObject jTime = json["Time"].toObject();
-    update1D(jTime, time);
+    update1D(jTime, timeAcc);
 
     QJsonObject jSpatial = json["Spatial"].toObject();
     double xfrom = jSpatial["xfrom"].toDouble();
@@ -128,13 +181,15 @@ void AMonitor::overrideDataFromJson(const QJsonObject &json)
     std::vector<double> statVec;
     for (int i=0; i<statAr.size(); i++)
         statVec.push_back(statAr[i].toDouble());
-    ATH2D * hist = new ATH2D("", "", 100, 0, 1.0, 100, 0, 1.0);
-    hist->Import(xfrom, xto, yfrom, yto, dataVec, statVec);
-    delete xy; xy = hist;
+    if (xyAcc) xyAcc->Import(xfrom, xto, yfrom, yto, dataVec, statVec);
+
+    bHistsOutdated = true;
 }
 
-void AMonitor::update1D(const QJsonObject & json, TH1D* & old)
+void AMonitor::update1D(const QJsonObject & json, AHistogram1D * acc, double multiplier)
 {
+    if (!acc) return;
+
     double from = json["from"].toDouble();
     double to =   json["to"].toDouble();
 
@@ -148,58 +203,60 @@ void AMonitor::update1D(const QJsonObject & json, TH1D* & old)
     for (int i=0; i<statAr.size(); i++)
         statVec.push_back(statAr[i].toDouble());
 
-    double multiplier = 1.0;
-    if (old == energy)
-    {
-        switch (config.energyUnitsInHist)
-        {
-        case 0:  multiplier = 1.0e6;  break;// keV -> meV
-        case 1:  multiplier = 1.0e3;  break;// keV -> eV
-        default: multiplier = 1.0;    break;// keV -> keV
-        case 3:  multiplier = 1.0e-3; break;// keV -> MeV
-        }
-    }
+    acc->Import(from * multiplier, to * multiplier, dataVec, statVec);
+}
+
+void AMonitor::updateHists() const
+{
+    if (!bHistsOutdated) return;
+
+    if (timeAcc && time)     time->Import(*timeAcc);
+    if (xyAcc && xy)         xy->Import(*xyAcc);
+    if (angleAcc && angle)   angle->Import(*angleAcc);
+    if (waveAcc && wave)     wave->Import(*waveAcc);
+    if (energyAcc && energy) energy->Import(*energyAcc);
 
-    ATH1D * hist = new ATH1D(*old); //to inherit all properties, including the axis titles
-    hist->Import(from * multiplier, to * multiplier, dataVec, statVec);
-    delete old;
-    old = hist;
+    bHistsOutdated = false;
 }
 
 void AMonitor::initXYHist()
 {
     delete xy;
+    delete xyAcc;
     const double limit2 = ( config.shape == 0 ? config.size2 : config.size1 ); // 0 - rectangular, 1 - round
-    xy = new TH2D("", "", config.xbins, -config.size1, config.size1, config.ybins, -limit2, limit2);
+    xyAcc = new AHistogram2D(config.xbins, -config.size1, config.size1, config.ybins, -limit2, limit2);
+    xy = new ATH2D("", "", config.xbins, -config.size1, config.size1, config.ybins, -limit2, limit2);
     xy->SetXTitle("X, mm");
     xy->SetYTitle("Y, mm");
 }
 
+void AMonitor::init1D(AHistogram1D *& acc, ATH1D *& hist, int bins, double from, double to, const char * xTitle)
+{
+    delete acc;
+    delete hist;
+    acc = new AHistogram1D(bins, from, to);
+    if (to <= from) to = from + 1.0; // range is defined by the accumulator; ROOT's buffer is not needed
+    hist = new ATH1D("", "", bins, from, to);
+    hist->SetXTitle(xTitle);
+}
+
 void AMonitor::initTimeHist()
 {
-    delete time;
-    time = new TH1D("", "", config.timeBins, config.timeFrom, config.timeTo);
-    time->SetXTitle("Time, ns");
+    init1D(timeAcc, time, config.timeBins, config.timeFrom, config.timeTo, "Time, ns");
 }
 
 void AMonitor::initWaveHist()
 {
-    delete wave;
-    wave = new TH1D("", "", config.waveBins, config.waveFrom, config.waveTo);
-    wave->SetXTitle("Wave index");
+    init1D(waveAcc, wave, config.waveBins, config.waveFrom, config.waveTo, "Wave index");
 }
 
 void AMonitor::initAngleHist()
 {
-    delete angle;
-    angle = new TH1D("", "", config.angleBins, config.angleFrom, config.angleTo);
-    angle->SetXTitle("Angle, degrees");
+    init1D(angleAcc, angle, config.angleBins, config.angleFrom, config.angleTo, "Angle, degrees");
 }
 
 void AMonitor::initEnergyHist()
 {
-    delete energy;
-
     double from = config.energyFrom;
     double to = config.energyTo;
     TString title = "";
@@ -211,6 +268,5 @@ void AMonitor::initEnergyHist()
     case 3: title = "Energy, MeV"; break;
     }
 
-    energy = new TH1D("", "", config.energyBins, from, to);
-    energy->SetXTitle(title);
+    init1D(energyAcc, energy, config.energyBins, from, to, title.Data());
 }
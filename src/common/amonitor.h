@@ -9,6 +9,9 @@
 class TH1D;
 class ATH1D;
 class TH2D;
+class ATH2D;
+class AHistogram1D;
+class AHistogram2D;
 class AGeoObject;
 class QJsonObject;
 
@@ -42,11 +45,12 @@ public:
 // stat data handling
   void clearData();
 
-  TH1D* getTime() const    {return time;}
-  TH2D* getXY()   const    {return xy;}
-  TH1D* getWave() const    {return wave;}
-  TH1D* getAngle() const   {return angle;}
-  TH1D* getEnergy() const  {return energy;}
+  // ROOT histograms are updated from the accumulators on request
+  TH1D* getTime() const;
+  TH2D* getXY()   const;
+  TH1D* getWave() const;
+  TH1D* getAngle() const;
+  TH1D* getEnergy() const;
 
   int getHits() const;
   const QString getName() const {return name;}
@@ -58,11 +62,20 @@ public:
 private:
   QString name;
 
-  TH1D* time;
-  TH2D* xy;
-  TH1D* angle;
-  TH1D* wave;
-  TH1D* energy;
+  // filled during the simulation
+  AHistogram1D* timeAcc = 0;
+  AHistogram2D* xyAcc = 0;
+  AHistogram1D* angleAcc = 0;
+  AHistogram1D* waveAcc = 0;
+  AHistogram1D* energyAcc = 0;
+
+  // read-out
+  ATH1D* time = 0;
+  ATH2D* xy = 0;
+  ATH1D* angle = 0;
+  ATH1D* wave = 0;
+  ATH1D* energy = 0;
+  mutable bool bHistsOutdated = false;
 
   AMonitorConfig config;
 
@@ -71,8 +84,11 @@ private:
   void initWaveHist();
   void initAngleHist();
   void initEnergyHist();
+  void init1D(AHistogram1D *& acc, ATH1D *& hist, int bins, double from, double to, const char * xTitle);
 
-  void update1D(const QJsonObject &json, TH1D *& old);
+  void updateHists() const;
+
+  void update1D(const QJsonObject &json, AHistogram1D * acc, double multiplier = 1.0);
 };
 
 #endif // AMONITOR_H
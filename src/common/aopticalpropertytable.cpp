@@ -0,0 +1,40 @@
+#include "aopticalpropertytable.h"
+#include "amaterialparticlecolection.h"
+#include "amaterial.h"
+
+void AOpticalPropertyTable::build(const AMaterialParticleCollection & MpCollection, bool bWaveResolved, int waveNodes)
+{
+    clear();
+
+    NumMaterials = MpCollection.countMaterials();
+    const int numWaves = (bWaveResolved ? waveNodes : 0);
+    Stride = numWaves + 1;
+
+    Records.resize(NumMaterials * Stride);
+    Overrides.resize(NumMaterials * NumMaterials, nullptr);
+
+    for (int iMat = 0; iMat < NumMaterials; iMat++)
+    {
+        const AMaterial * mat = MpCollection[iMat];
+        for (int iWave = -1; iWave < numWaves; iWave++)
+        {
+            AOpticalPropertyRecord & rec = Records[iMat * Stride + iWave + 1];
+            rec.n              = mat->getRefractiveIndex(iWave);
+            rec.abs            = mat->getAbsorptionCoefficient(iWave);
+            rec.reemissionProb = mat->getReemissionProbability(iWave);
+            if (mat->rayleighMFP == 0) rec.rayleighMFP = 0;
+            else rec.rayleighMFP = ( (iWave == -1 || mat->rayleighBinned.isEmpty()) ? mat->rayleighMFP : mat->rayleighBinned.at(iWave) );
+        }
+
+        for (int iTo = 0; iTo < NumMaterials && iTo < mat->OpticalOverrides.size(); iTo++)
+            Overrides[iMat * NumMaterials + iTo] = mat->OpticalOverrides.at(iTo);
+    }
+}
+
+void AOpticalPropertyTable::clear()
+{
+    NumMaterials = 0;
+    Stride = 1;
+    Records.clear();
+    Overrides.clear();
+}
@@ -0,0 +1,39 @@
+#ifndef AOPTICALPROPERTYTABLE_H
+#define AOPTICALPROPERTYTABLE_H
+
+#include <vector>
+
+class AMaterialParticleCollection;
+class AOpticalOverride;
+
+struct AOpticalPropertyRecord
+{
+    double n;              //refractive index
+    double abs;            //absorption coefficient, mm-1
+    double rayleighMFP;    //0 - no Rayleigh scattering
+    double reemissionProb; //for waveshifters
+};
+
+// Read-only flat copy of the optical properties of all materials, built once per run and shared by all simulation threads
+// Records are indexed by material index and wave index (iWave = -1 -> non-resolved values); overrides by material pair
+class AOpticalPropertyTable
+{
+public:
+    void build(const AMaterialParticleCollection & MpCollection, bool bWaveResolved, int waveNodes);
+    void clear();
+
+    bool isEmpty() const {return NumMaterials == 0;}
+
+    const AOpticalPropertyRecord & get(int iMat, int iWave) const {return Records[iMat * Stride + iWave + 1];}
+    double getRefractiveIndex(int iMat, int iWave) const {return get(iMat, iWave).n;}
+    AOpticalOverride * getOverride(int iMatFrom, int iMatTo) const {return Overrides[iMatFrom * NumMaterials + iMatTo];}
+
+private:
+    int NumMaterials = 0;
+    int Stride = 1;        //records per material: wave nodes + 1 (for iWave = -1)
+
+    std::vector<AOpticalPropertyRecord> Records;
+    std::vector<AOpticalOverride*> Overrides;
+};
+
+#endif // AOPTICALPROPERTYTABLE_H
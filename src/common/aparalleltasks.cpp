@@ -0,0 +1,88 @@
+#include "aparalleltasks.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static bool runTask(const std::function<bool(int, int)> & task, int iTask, int iThread)
+{
+    try
+    {
+        return task(iTask, iThread);
+    }
+    catch (...)
+    {
+        qWarning() << "Exception in the parallel task #" << iTask;
+        return false;
+    }
+}
+
+bool runParallelTasks(int numTasks, int numThreads,
+                      const std::function<bool(int, int)> & task,
+                      const std::function<bool(int)> & monitor)
+{
+    if (numTasks < 1) return true;
+    numThreads = std::max(1, std::min(numThreads, numTasks));
+
+    if (numThreads == 1)
+    {
+        for (int iTask = 0; iTask < numTasks; iTask++)
+        {
+            if (!monitor(iTask)) return false;
+            if (!runTask(task, iTask, 0)) return false;
+        }
+        monitor(numTasks);
+        return true;
+    }
+
+    std::atomic<int>  nextTask(0);
+    std::atomic<bool> bStop(false);
+    std::mutex Mutex;
+    std::condition_variable Finished;
+    int numDone = 0;
+
+    auto worker = [&](int iThread)
+    {
+        while (!bStop)
+        {
+            const int iTask = nextTask++;
+            if (iTask >= numTasks) break;
+
+            const bool ok = runTask(task, iTask, iThread);
+            if (!ok) bStop = true;
+
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                numDone++;
+            }
+            Finished.notify_one();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int iThread = 0; iThread < numThreads; iThread++)
+        threads.emplace_back(worker, iThread);
+
+    std::unique_lock<std::mutex> lock(Mutex);
+    while (numDone < numTasks && !bStop)
+    {
+        Finished.wait_for(lock, std::chrono::milliseconds(100));
+        const int done = numDone;
+        lock.unlock();
+        if (!monitor(done)) bStop = true;
+        lock.lock();
+    }
+    lock.unlock();
+
+    for (std::thread & t : threads) t.join();
+
+    if (bStop) return false;
+    monitor(numTasks);
+    return true;
+}
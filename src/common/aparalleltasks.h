@@ -0,0 +1,17 @@
+#ifndef APARALLELTASKS_H
+#define APARALLELTASKS_H
+
+#include <functional>
+
+// Runs task(iTask, iThread) for iTask = 0 .. numTasks-1 on numThreads std::threads
+// Tasks are taken in the index order by the first free thread; iThread (0 .. numThreads-1) allows
+// to keep per-thread working data. The results have to be stored per task index, then they do not
+// depend on which thread has processed the task.
+// The calling thread is not used for the tasks: it calls monitor(numDone) every ~100 ms and after every
+// finished task, so it can report progress and process GUI events. With numThreads = 1 all is done in the calling thread.
+// Returns false if a task or the monitor returned false: the tasks which are not yet started are skipped
+bool runParallelTasks(int numTasks, int numThreads,
+                      const std::function<bool(int iTask, int iThread)> & task,
+                      const std::function<bool(int numDone)> & monitor);
+
+#endif // APARALLELTASKS_H
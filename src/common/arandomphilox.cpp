@@ -0,0 +1,90 @@
+#include "arandomphilox.h"
+
+static const uint32_t PhiloxM0 = 0xD2511F53;
+static const uint32_t PhiloxM1 = 0xCD9E8D57;
+static const uint32_t PhiloxW0 = 0x9E3779B9;
+static const uint32_t PhiloxW1 = 0xBB67AE85;
+
+static inline void mulHiLo(uint32_t a, uint32_t b, uint32_t & hi, uint32_t & lo)
+{
+    const uint64_t product = (uint64_t)a * b;
+    hi = product >> 32;
+    lo = (uint32_t)product;
+}
+
+ARandomPhilox::ARandomPhilox(uint32_t runSeed) : TRandom2()
+{
+    setKey(runSeed, 0, 0);
+}
+
+void ARandomPhilox::setKey(uint32_t runSeed, uint32_t iEvent, uint32_t subStream)
+{
+    Key[0] = runSeed;
+    Key[1] = subStream;
+    Counter[0] = 0;
+    Counter[1] = 0;
+    Counter[2] = iEvent;
+    Counter[3] = 0;
+    iNext = 4;
+}
+
+void ARandomPhilox::generateBlock()
+{
+    uint32_t c[4] = {Counter[0], Counter[1], Counter[2], Counter[3]};
+    uint32_t k[2] = {Key[0], Key[1]};
+
+    for (int iRound = 0; iRound < 10; iRound++)
+    {
+        if (iRound > 0)
+        {
+            k[0] += PhiloxW0;
+            k[1] += PhiloxW1;
+        }
+        uint32_t hi0, lo0, hi1, lo1;
+        mulHiLo(PhiloxM0, c[0], hi0, lo0);
+        mulHiLo(PhiloxM1, c[2], hi1, lo1);
+        const uint32_t c1 = c[1];
+        const uint32_t c3 = c[3];
+        c[0] = hi1 ^ c1 ^ k[0];
+        c[1] = lo1;
+        c[2] = hi0 ^ c3 ^ k[1];
+        c[3] = lo0;
+    }
+
+    for (int i = 0; i < 4; i++) Block[i] = c[i];
+    iNext = 0;
+
+    //next block
+    if (++Counter[0] == 0) ++Counter[1];
+}
+
+uint32_t ARandomPhilox::nextWord()
+{
+    if (iNext > 3) generateBlock();
+    return Block[iNext++];
+}
+
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,8,0)
+Double_t ARandomPhilox::Rndm(Int_t)
+#else
+Double_t ARandomPhilox::Rndm()
+#endif
+{
+    // (0, 1) - zero is excluded as in TRandom2
+    return ( nextWord() + 0.5 ) * 2.3283064365386963e-10; // 1/2^32
+}
+
+void ARandomPhilox::RndmArray(Int_t n, Float_t * array)
+{
+    for (int i = 0; i < n; i++) array[i] = Rndm();
+}
+
+void ARandomPhilox::RndmArray(Int_t n, Double_t * array)
+{
+    for (int i = 0; i < n; i++) array[i] = Rndm();
+}
+
+void ARandomPhilox::SetSeed(ULong_t seed)
+{
+    setKey(seed, 0, 0);
+}
@@ -0,0 +1,40 @@
+#ifndef ARANDOMPHILOX_H
+#define ARANDOMPHILOX_H
+
+#include "TRandom2.h"
+#include "RVersion.h"
+
+#include <cstdint>
+
+// Counter-based random generator (Philox4x32-10, Salmon et al., SC'11)
+// The sequence is a pure function of (run seed, event index, sub-stream) and the position in the stream,
+// so an event is reproduced exactly independently of the thread (or the farm node) which simulates it
+// Derived from TRandom2 to be used everywhere where TRandom2 is expected (Gaus, Poisson, Exp etc. call Rndm)
+class ARandomPhilox : public TRandom2
+{
+public:
+    ARandomPhilox(uint32_t runSeed = 1);
+
+    void setKey(uint32_t runSeed, uint32_t iEvent, uint32_t subStream = 0); // also resets position in the stream
+
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,8,0)
+    Double_t Rndm(Int_t = 0) override;
+#else
+    Double_t Rndm() override;
+#endif
+    void     RndmArray(Int_t n, Float_t * array) override;
+    void     RndmArray(Int_t n, Double_t * array) override;
+    void     SetSeed(ULong_t seed = 0) override; // same as setKey(seed, 0, 0)
+    UInt_t   GetSeed() const override {return Key[0];}
+
+private:
+    uint32_t Key[2];     // run seed, sub-stream
+    uint32_t Counter[4]; // block index (64 bit), event index, reserved
+    uint32_t Block[4];   // output of the last generated block
+    int      iNext = 4;  // next unused word of Block
+
+    void generateBlock();
+    inline uint32_t nextWord();
+};
+
+#endif // ARANDOMPHILOX_H
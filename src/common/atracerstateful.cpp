@@ -2,6 +2,7 @@
 #include "amaterialparticlecolection.h"
 #include "aopticaloverridescriptinterface.h"
 #include "amath_si.h"
+#include "ascriptopticaloverride.h"
 
 #include <QObject>
 #include <QScriptEngine>
@@ -20,9 +21,12 @@ ATracerStateful::~ATracerStateful()
 
 void ATracerStateful::evaluateScript(const QString &Script)
 {
+    QScriptProgram & program = Programs[&Script];
+    if (program.sourceCode() != Script) program = QScriptProgram(Script);   //new or modified script
+
         //qDebug() << "Script:"<<Script;
         //QScriptValue res =
-    ScriptEngine->evaluate(Script);
+    ScriptEngine->evaluate(program);
         //qDebug() << "eval result:" << res.toString();
 }
 
@@ -52,6 +56,13 @@ void ATracerStateful::generateScriptInfrastructure(const AMaterialParticleCollec
     ScriptEngine->globalObject().setProperty(mathInterface->objectName(), val);
 }
 
+void ATracerStateful::flushScriptOverrideTiming()
+{
+    for (auto it = ScriptOverrideTiming.begin(); it != ScriptOverrideTiming.end(); ++it)
+        it.key()->addTiming(it.value());
+    ScriptOverrideTiming.clear();
+}
+
 void ATracerStateful::abort()
 {
     if (ScriptEngine)
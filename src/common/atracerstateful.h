@@ -2,6 +2,8 @@
 #define ATRACERSTATEFUL_H
 
 #include <QString>
+#include <QHash>
+#include <QScriptProgram>
 
 class TRandom2;
 class QScriptEngine;
@@ -9,6 +11,13 @@ class QObject;
 class AMaterialParticleCollection;
 class AOpticalOverrideScriptInterface;
 class AMath_SI;
+class AScriptOpticalOverride;
+
+struct AScriptOverrideTiming
+{
+    long long NumPhotons = 0;
+    long long NumNanoseconds = 0;
+};
 
 //random generator is external
 //script engine is owned by this class, but created only if needed (there are script overrides)
@@ -19,7 +28,7 @@ public:
     ATracerStateful(TRandom2* RandGen);
     ~ATracerStateful();
 
-    void evaluateScript(const QString& Script);
+    void evaluateScript(const QString& Script);  //compiled on the first call, the program is cached per script (address) in this thread
 
     void generateScriptInfrastructureIfNeeded(const AMaterialParticleCollection* MPcollection); //called by PhotonTracer (one per each thread!)
 
@@ -27,10 +36,16 @@ public:
 
     void abort();
 
+    void flushScriptOverrideTiming();  //adds the timing collected in this thread to the overrides; they have to be still alive
+
     TRandom2 * RandGen = 0;                                 //external
     QScriptEngine * ScriptEngine = 0;                       //local
     AOpticalOverrideScriptInterface* overrideInterface = 0; //local
     AMath_SI* mathInterface = 0;                //local
+    QHash<AScriptOpticalOverride*, AScriptOverrideTiming> ScriptOverrideTiming; //per thread, no sharing on the photon path
+
+private:
+    QHash<const QString*, QScriptProgram> Programs;
 };
 
 #endif // ATRACERSTATEFUL_H
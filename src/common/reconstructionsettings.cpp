@@ -148,7 +148,7 @@ bool ReconstructionSettings::readFromJson(QJsonObject &RecJson)
   //kNNreconstruct
   kNNrecSet = ajson["kNNrecSet"].toObject();
 
-  if (ReconstructionAlgorithm == 4)
+  if (ReconstructionAlgorithm == 4 || ReconstructionAlgorithm == 6)
     {     
       //compatibility
       if (CGonCUDAsettings.contains("Passives"))
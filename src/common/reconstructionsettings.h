@@ -50,7 +50,7 @@ public:
 
   //Root minimiser
   int     RMtype;  //0 - LS, 1 - ML, 2 - TFormula
-  int     RMminuitOption;
+  int     RMminuitOption; //0 - Migrad, 1 - Simplex, 2 - Migrad with analytic gradient, 3 - Levenberg-Marquardt (analytic gradient)
   double  RMstepX, RMstepY, RMstepZ, RMstepEnergy;
   int     RMmaxCalls;
   int     RMstartOption; //0 - cog, 1 - PM with max signal
@@ -4,6 +4,7 @@
 #include "amaterialparticlecolection.h"
 #include "apmhub.h"
 #include "eventsdataclass.h"
+#include "aeventfile.h"
 #include "materialinspectorwindow.h"
 #include "reconstructionwindow.h"
 #include "outputwindow.h"
@@ -261,7 +262,11 @@ void MainWindow::updateLoaded(int events, int progress)
 
 int MainWindow::LoadSimulationDataFromTree(QString fileName, int numEvents)
 {    
-  int numEv = EventsDataHub->loadSimulatedEventsFromTree(fileName, *Detector->PMs, numEvents);
+  int numEv;
+  if (AEventFile::isEventFile(fileName))
+      numEv = EventsDataHub->loadEventsFromBinaryFile(fileName, *Detector->PMs, numEvents);
+  else
+      numEv = EventsDataHub->loadSimulatedEventsFromTree(fileName, *Detector->PMs, numEvents);
 
   ui->leoTotalLoadedEvents->setText(QString::number(EventsDataHub->Events.size()));
   if (numEv != -1)
@@ -58,7 +58,7 @@ void ReconstructionWindow::onUpdatePassiveIndication()
     if (!bYellow)
     {
         int iAlg = ui->cobReconstructionAlgorithm->currentIndex();
-        if (iAlg == 1 || iAlg == 2 || iAlg == 4)
+        if (iAlg == 1 || iAlg == 2 || iAlg == 4 || iAlg == 6)
             if (ui->cbDynamicPassiveByDistance->isChecked() || ui->cbDynamicPassiveBySignal->isChecked())
                 bYellow = true;
     }
@@ -30,6 +30,7 @@ AGeant4ConfigDialog::AGeant4ConfigDialog(AG4SimulationSettings & G4SimSet, QWidg
         ui->pteStepLimits->appendPlainText( QString("%1 %2").arg(key).arg(G4SimSet.StepLimits.value(key)) );
 
     ui->cbBinaryOutput->setChecked(G4SimSet.BinaryOutput);
+    ui->cbStreamDeposition->setChecked(G4SimSet.StreamDeposition);
     ui->sbPrecision->setValue(G4SimSet.Precision);
 
     ui->cbUseTSphys->setChecked(G4SimSet.UseTSphys);
@@ -77,6 +78,7 @@ void AGeant4ConfigDialog::on_pbAccept_clicked()
     }
 
     G4SimSet.BinaryOutput = ui->cbBinaryOutput->isChecked();
+    G4SimSet.StreamDeposition = ui->cbStreamDeposition->isChecked();
     G4SimSet.Precision    = ui->sbPrecision->value();
 
     G4SimSet.UseTSphys    = ui->cbUseTSphys->isChecked();
@@ -33,7 +33,7 @@
 
 //=== external vars/functions using by sorting
 static int CurrentIPM; //used in Center algorithm sorting
-static QVector< QVector< float> >* Events;
+static const AEventStore* Events;
 static QVector<AReconRecord*>* RecData;
 static bool DoFiltering;
 bool CentersLessThan(const int &first, const int &second)
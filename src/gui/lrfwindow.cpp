@@ -567,7 +567,7 @@ bool LRFwindow::checkWatchdogs()
     const int minDataSize = 100;
 
     int dataScanRecon = ui->cb_data_selector->currentIndex(); //0 - Scan, 1 - Reconstr data
-    QVector < QVector <float> > *events = &EventsDataHub->Events;
+    const AEventStore *events = &EventsDataHub->Events;
 
     int dataSize = events->size();
     if (dataSize == 0)
@@ -2449,7 +2449,7 @@ void MainWindow::on_pbConfigureAddOns_clicked()
 
 void MainWindow::LoadSimTreeRequested()
 {  
-  QStringList fileNames = QFileDialog::getOpenFileNames(this, "Load/Append simulation data from Root tree", GlobSet.LastOpenDir, "Root files (*.root)");
+  QStringList fileNames = QFileDialog::getOpenFileNames(this, "Load/Append simulation data from Root tree", GlobSet.LastOpenDir, "Root files (*.root);;Binary event files (*.aev)");
   if (fileNames.isEmpty()) return;
   GlobSet.LastOpenDir = QFileInfo(fileNames.first()).absolutePath();
 
@@ -2853,12 +2853,14 @@ void MainWindow::SaveSimulationDataTree()
       message("No data to save!", this);
       return;
     }
-  QString fileName = QFileDialog::getSaveFileName(this, "Save simulation data as Root Tree", GlobSet.LastOpenDir, "Root files (*.root)");
+  QString fileName = QFileDialog::getSaveFileName(this, "Save simulation data as Root Tree", GlobSet.LastOpenDir, "Root files (*.root);;Binary event files (*.aev)");
   if (fileName.isEmpty()) return;
   GlobSet.LastOpenDir = QFileInfo(fileName).absolutePath();
   if(QFileInfo(fileName).suffix().isEmpty()) fileName += ".root";
 
-  bool ok = EventsDataHub->saveSimulationAsTree(fileName);
+  bool ok;
+  if (QFileInfo(fileName).suffix() == "aev") ok = EventsDataHub->saveSimulationAsBinary(fileName);
+  else ok = EventsDataHub->saveSimulationAsTree(fileName);
   if (!ok) message("Error writing to file!", this);
 }
 
@@ -3195,6 +3197,8 @@ void MainWindow::simulationFinished()
             if (!SimulationManager->isSimulationAborted())
                 message(SimulationManager->getErrorString(), this);
         }
+        else if (!SimulationManager->getWarningString().isEmpty())
+            message(SimulationManager->getWarningString(), this);
 
         bool showTracks = false;
         if (SimulationManager->Settings.bOnlyPhotons)
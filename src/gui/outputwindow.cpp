@@ -33,7 +33,6 @@
 #include <QDebug>
 #include <QGraphicsItem>
 #include <QString>
-#include <QBitArray>
 #include <QStandardItemModel>
 #include <QFileDialog>
 #include <QTimer>
@@ -144,7 +143,7 @@ void OutputWindow::on_pbShowPMtime_clicked()
     hist1D->SetBit(TH1::kCanRebin);
 #endif
     for (int i=0; i<bins; i++)
-       hist1D->SetBinContent(i+1, EventsDataHub->TimedEvents[CurrentEvent][i][ipm]);
+       hist1D->SetBinContent(i+1, EventsDataHub->TimedEvents.atTimeBin(CurrentEvent, i)[ipm]);
     hist1D->GetXaxis()->SetTitle("Time, ns");
     hist1D->GetYaxis()->SetTitle("Signal");
     MW->GraphWindow->Draw(hist1D);
@@ -161,7 +160,7 @@ void OutputWindow::RefreshPMhitsTable()
     int columns = MW->PMs->count() + 1; //+sum over all PMs  
     int rows = 0;    
     if (fHaveData && EventsDataHub->isTimed())
-        rows = EventsDataHub->TimedEvents[0].size();
+        rows = EventsDataHub->TimedEvents.getNumTimeBins();
 
     if (modelPMhits)
       {
@@ -228,10 +227,10 @@ void OutputWindow::RefreshPMhitsTable()
                 if (iColumn == 0)
                   {
                     double sum=0;                    
-                    for (int ipm=0; ipm<MW->PMs->count(); ipm++) sum += EventsDataHub->TimedEvents[CurrentEvent][j][ipm];
+                    for (int ipm=0; ipm<MW->PMs->count(); ipm++) sum += EventsDataHub->TimedEvents.atTimeBin(CurrentEvent, j)[ipm];
                     tmpStr.setNum(sum, 'g', 6);
                   }
-                else tmpStr.setNum( EventsDataHub->TimedEvents[CurrentEvent][j][iColumn-1], 'g', 6);
+                else tmpStr.setNum( EventsDataHub->TimedEvents.atTimeBin(CurrentEvent, j)[iColumn-1], 'g', 6);
               }
 
            item = new QStandardItem(tmpStr);
@@ -312,13 +311,16 @@ void OutputWindow::on_pbSiPMpixels_clicked()
     int binsY = MW->PMs->PixelsY(ipm);
 //    qDebug()<<binsX<<binsY;
 
-    auto hist = new TH2C("histOutW","x vs y",binsX,0,binsX, binsY, -binsY,0);
+    const ASiPMMicrocells & cells = SiPMpixels.at(ipm);
+    if (cells.isEmpty() || iTime >= cells.getNumTimeBins()) return;
+
+    const QString title = QString("Fired microcells: %1").arg(cells.countFired(iTime));
+    auto hist = new TH2C("histOutW", title.toLatin1().data(), binsX,0,binsX, binsY, -binsY,0);
 
-    const APmType *typ = MW->PMs->getTypeForPM(ipm);
     for (int iX=0; iX<binsX; iX++)
      for (int iY=0; iY<binsY; iY++)
-      {         
-        if (SiPMpixels[ipm].testBit((iTime*typ->PixelsY + iY)*typ->PixelsX + iX)) hist->Fill(iX, -iY);
+      {
+        if (cells.isFired(iTime, iX, iY)) hist->Fill(iX, -iY);
       }
 
     MW->GraphWindow->Draw(hist, "col");
@@ -328,7 +330,7 @@ void OutputWindow::on_sbTimeBin_valueChanged(int arg1)
 {
    if (SiPMpixels.isEmpty()) return;
    if (EventsDataHub->TimedEvents.isEmpty()) return;
-   if (arg1 > EventsDataHub->TimedEvents[0].size()-1) ui->sbTimeBin->setValue(0);
+   if (arg1 > EventsDataHub->TimedEvents.getNumTimeBins()-1) ui->sbTimeBin->setValue(0);
 
    on_pbSiPMpixels_clicked();
 }
@@ -485,9 +487,10 @@ void OutputWindow::RefreshData()
   //qDebug()<<"MaxSignal="<<MaxSignal<<"  selector="<<selector;
 
   updateSignalLabels(MaxSignal);
-  addPMitems( (fHaveData ? &EventsDataHub->Events.at(CurrentEvent) : 0), MaxSignal, Passives); //add icons with PMs to the scene
+  const QVector<float> event = (fHaveData ? EventsDataHub->Events.at(CurrentEvent).toVector() : QVector<float>());
+  addPMitems( (fHaveData ? &event : 0), MaxSignal, Passives); //add icons with PMs to the scene
   if (ui->cbShowPMsignals->isChecked())
-    addTextitems( (fHaveData ? &EventsDataHub->Events.at(CurrentEvent) : 0), MaxSignal, Passives); //add icons with signal text to the scene
+    addTextitems( (fHaveData ? &event : 0), MaxSignal, Passives); //add icons with signal text to the scene
   updateSignalScale();
 
   //Monitors
@@ -1154,6 +1157,10 @@ void OutputWindow::ShowPhotonLossLog()
       "---------------------\n"+
       "Total: "+QString::number(sum)+"\n"+
       "=====================";
+  if (d->TracedPackets > 0)
+      s += "\nPacket tracing: " + QString::number(d->TracedPackets) + " packets, " +
+           QString::number( (double)d->PacketPhotons / d->TracedPackets, 'g', 4 ) + " photons/packet, " +
+           QString::number( d->PacketTracingTime > 0 ? 1.0e-3 * d->PacketPhotons / d->PacketTracingTime : 0, 'g', 4 ) + " Mphotons/s per thread";
   ui->pteOut->appendPlainText(s);
 }
 
@@ -1866,34 +1873,32 @@ void OutputWindow::fillEvTabViewRecord(QTreeWidgetItem * item, const AParticleTr
 
     for (size_t iStep = 0; iStep < pr->getSteps().size(); iStep++)
     {
-        ATrackingStepData * step = pr->getSteps().at(iStep);
+        const ATrackingStepData * step = &pr->getSteps().at(iStep);
 
-        QString s = step->Process;
+        QString s = step->getProcess();
 
-        if (step->Process == "C")
+        if (step->ProcessId == ATrackingNameTable::Creation)
         {
-            ATransportationStepData * trStep = static_cast<ATransportationStepData*>(step);
-            curVolume = trStep->VolName;
-            curVolIndex = trStep->VolIndex;
-            curMat = trStep->iMaterial;
+            curVolume = step->getVolName();
+            curVolIndex = step->VolIndex;
+            curMat = step->iMaterial;
         }
-        else if (step->Process == "T")
+        else if (step->ProcessId == ATrackingNameTable::Transportation)
         {
-            ATransportationStepData * trStep = dynamic_cast<ATransportationStepData*>(step);
             if (bHideTransp || (bHideTranspPrim && pr->isPrimary()) )
             {
-                curVolume   = trStep->VolName;
-                curVolIndex = trStep->VolIndex;
-                curMat      = trStep->iMaterial;
+                curVolume   = step->getVolName();
+                curVolIndex = step->VolIndex;
+                curMat      = step->iMaterial;
                 continue;
             }
 
             s += QString("  %1 (#%2, %3) -> %4 (#%5, %6)").arg(curVolume)
                                                           .arg(curVolIndex)
                                                           .arg(MW->MpCollection->getMaterialName(curMat))
-                                                          .arg(trStep->VolName)
-                                                          .arg(trStep->VolIndex)
-                                                          .arg(MW->MpCollection->getMaterialName(trStep->iMaterial));
+                                                          .arg(step->getVolName())
+                                                          .arg(step->VolIndex)
+                                                          .arg(MW->MpCollection->getMaterialName(step->iMaterial));
             //cannot set currents yet - the indication should still show the "from" values - remember about energy deposition during "T" step!
         }
 
@@ -1903,7 +1908,7 @@ void OutputWindow::fillEvTabViewRecord(QTreeWidgetItem * item, const AParticleTr
             double delta = 0;
             if (iStep != 0)
             {
-                ATrackingStepData * prev = pr->getSteps().at(iStep-1);
+                const ATrackingStepData * prev = &pr->getSteps().at(iStep-1);
                 for (int i=0; i<3; i++)
                     delta += (step->Position[i] - prev->Position[i]) * (step->Position[i] - prev->Position[i]);
                 delta = sqrt(delta);
@@ -1911,7 +1916,7 @@ void OutputWindow::fillEvTabViewRecord(QTreeWidgetItem * item, const AParticleTr
             s += QString("  %1mm").arg(delta, 0, 'g', precision);
         }
 
-        if (step->Process != "O" && step->Process != "T")
+        if (step->ProcessId != ATrackingNameTable::Out && step->ProcessId != ATrackingNameTable::Transportation)
         {
             if (bVolume) s += QString("  %1").arg(curVolume);
             if (bIndex)  s += QString("  %1").arg(curVolIndex);
@@ -1931,18 +1936,17 @@ void OutputWindow::fillEvTabViewRecord(QTreeWidgetItem * item, const AParticleTr
 
         if (ExpansionLevel > 0) ui->trwEventView->expandItem(it);
 
-        for (int iSec : step->Secondaries)
+        for (int iSec = step->FirstSecondary; iSec < step->FirstSecondary + step->NumSecondaries; iSec++)
         {
             QTreeWidgetItem * subItem = new QTreeWidgetItem(it);
             fillEvTabViewRecord(subItem, pr->getSecondaries().at(iSec), ExpansionLevel-1);
         }
 
-        if (step->Process == "T")
+        if (step->ProcessId == ATrackingNameTable::Transportation)
         {
-            ATransportationStepData * trStep = dynamic_cast<ATransportationStepData*>(step);
-            curVolume = trStep->VolName;
-            curVolIndex = trStep->VolIndex;
-            curMat = trStep->iMaterial;
+            curVolume = step->getVolName();
+            curVolIndex = step->VolIndex;
+            curMat = step->iMaterial;
         }
     }
 }
@@ -1983,7 +1987,7 @@ void OutputWindow::EV_showGeo()
     if (iEv < 0 || iEv >= MW->EventsDataHub->countEvents()) return;
 
     if (ui->cbEVtracks->isChecked()) MW->GeometryWindow->ShowEvent_Particles(iEv, !ui->cbEVsupressSec->isChecked());
-    if (ui->cbEVpmSig->isChecked())  MW->GeometryWindow->ShowPMsignals(MW->EventsDataHub->Events.at(iEv), false);
+    if (ui->cbEVpmSig->isChecked())  MW->GeometryWindow->ShowPMsignals(MW->EventsDataHub->Events.at(iEv).toVector(), false);
 
     MW->GeometryWindow->DrawTracks();
 }
@@ -2207,12 +2211,12 @@ void OutputWindow::on_trwEventView_customContextMenuRequested(const QPoint &pos)
         qlonglong sp = s.toLongLong();
         pr = reinterpret_cast<AParticleTrackingRecord*>(sp);
     }
-    ATrackingStepData * st = nullptr;
+    const ATrackingStepData * st = nullptr;
     s = item->text(2);
     if (!s.isEmpty())
     {
         qlonglong sp = s.toLongLong();
-        st = reinterpret_cast<ATrackingStepData*>(sp);
+        st = reinterpret_cast<const ATrackingStepData*>(sp);
     }
 
     if (!pr) return;
@@ -2,6 +2,8 @@
 #define OUTPUTWINDOW_H
 
 #include "aguiwindow.h"
+#include "asipmmicrocells.h"
+
 #include <QGraphicsScene>
 
 class MainWindow;
@@ -25,7 +27,7 @@ public:
     explicit OutputWindow(QWidget * parent, MainWindow * MW, EventsDataClass * EventsDataHub);
     ~OutputWindow();
 
-    QVector< QBitArray > SiPMpixels; //[PM#] [time] [pixY] [pixX] - to report only!
+    QVector<ASiPMMicrocells> SiPMpixels; //[PM#] [time] [pixY] [pixX] - to report only!
 
     void PMnumChanged();
     void SetCurrentEvent(int iev);
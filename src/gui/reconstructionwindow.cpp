@@ -227,12 +227,13 @@ void ReconstructionWindow::InitWindow()
 
 void ReconstructionWindow::on_cobReconstructionAlgorithm_currentIndexChanged(int index)
 {
-    ui->swReconstructionAlgorithm->setCurrentIndex(index);
+    //vectorized CG on CPU uses the same settings as the GPU version
+    ui->swReconstructionAlgorithm->setCurrentIndex(index == 6 ? 4 : index);
 
     onUpdatePassiveIndication();
     updateRedStatusOfRecOptions();
 
-    ui->fDynPassive->setEnabled(index == 1 || index == 2 || index == 4);
+    ui->fDynPassive->setEnabled(index == 1 || index == 2 || index == 4 || index == 6);
 
     ui->cobMultipleOption->setEnabled(index == 2);
 }
@@ -743,13 +744,13 @@ void ReconstructionWindow::on_pbShowSumSignal_clicked()
     if (EventsDataHub->ReconstructionData.at(current).at(iev)->GoodEvent)
     {
       double sum = 0;
-      const QVector<float>* event = EventsDataHub->getEvent(iev);
+      const AConstEventSpan event = EventsDataHub->getEvent(iev);
       for (int ipm = 0; ipm < MW->PMs->count(); ipm++)
         if (PMgroups->isPmInCurrentGroupFast(ipm))
           //if (!MW->PMs->at(ipm).passive || AccountForPassive)
           if (PMgroups->isActive(ipm) || AccountForPassive)
           {
-            double sig = event->at(ipm);
+            double sig = event.at(ipm);
             if (ui->cbGainsConsideredInFiltering->isChecked()) sig /= PMgroups->Groups.at(current)->PMS.at(ipm).gain;
             sum += sig;
           }
@@ -823,7 +824,7 @@ void ReconstructionWindow::ShowIndividualSpectrum(bool focus)
   for (int iev = 0; iev < totNumEvents; iev++)
     {
       if (!EventsDataHub->ReconstructionData.at(0).at(iev)->GoodEvent) continue;
-      double sig = EventsDataHub->getEvent(iev)->at(thisipm);
+      double sig = EventsDataHub->getEvent(iev).at(thisipm);
       if (min == max || (sig>min && sig<max))
         {
           hist1D->Fill(sig);
@@ -1029,7 +1030,7 @@ void ReconstructionWindow::updateRedStatusOfRecOptions()
   bool showRed = false;
 
   int iAlg = ui->cobReconstructionAlgorithm->currentIndex();
-  if (iAlg == 1 || iAlg == 2 || iAlg == 4) //the other do not need LRFs
+  if (iAlg == 1 || iAlg == 2 || iAlg == 4 || iAlg == 6) //the other do not need LRFs
     if (!Detector->LRFs->isAllLRFsDefined())
         showRed = true;
 
@@ -4917,7 +4918,7 @@ void ReconstructionWindow::updateReconSettings()
 
   //Algotithm
   QJsonObject ajson;
-  int iAlg = ui->cobReconstructionAlgorithm->currentIndex(); //0-CoG, 1-CG cpu, 2-Root, 3-SNN, 4-CUDA
+  int iAlg = ui->cobReconstructionAlgorithm->currentIndex(); //0-CoG, 1-CG cpu, 2-Root, 3-SNN, 4-CUDA, 5-kNN, 6-CG cpu vectorized
   ajson["Algorithm"] = iAlg;
     //cog
   QJsonObject cogjson;
@@ -5204,7 +5205,7 @@ bool ReconstructionWindow::readReconSettingsFromJson(QJsonObject &jsonMaster)
   //compatibility
   if (cudaJson.contains("Threshold"))
     {
-      if (ui->cobReconstructionAlgorithm->currentIndex()==4)
+      if (ui->cobReconstructionAlgorithm->currentIndex()==4 || ui->cobReconstructionAlgorithm->currentIndex()==6)
         {
            //old system and this is the selected algorithm, so dynamic passives configuration has to be extracted
            ui->cbDynamicPassiveBySignal->setChecked(false);
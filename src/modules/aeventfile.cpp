@@ -0,0 +1,214 @@
+#include "aeventfile.h"
+#include "apositionenergyrecords.h"
+
+#include <QDebug>
+
+#include <cstring>
+#include <algorithm>
+
+static const char     EventFileMagic[8] = {'A','N','T','S','E','V','T','1'};
+static const quint32  EventFileVersion  = 1;
+
+AEventFile::~AEventFile()
+{
+    close();
+}
+
+bool AEventFile::isEventFile(const QString & fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    char magic[8];
+    if (f.read(magic, 8) != 8) return false;
+    return std::memcmp(magic, EventFileMagic, 8) == 0;
+}
+
+void AEventFile::initHeader(int numChannels, int numTimeBins, bool bWithScan, int numRuns)
+{
+    Header = AEventFileHeader();
+    std::memcpy(Header.Magic, EventFileMagic, 8);
+    Header.Version     = EventFileVersion;
+    Header.NumChannels = numChannels;
+    Header.NumTimeBins = numTimeBins;
+    Header.Flags       = (bWithScan ? HasScan : 0);
+    Header.NumEvents   = 0;
+    Header.HeaderSize  = sizeof(AEventFileHeader);
+    Header.NumRuns     = numRuns;
+
+    Header.RecordSize  = getScanOffset() + (bWithScan ? sizeof(AEventFileScan) : 0);
+}
+
+int AEventFile::getScanOffset() const
+{
+    const int numFloats = Header.NumChannels * (1 + Header.NumTimeBins);
+    return (numFloats * sizeof(float) + 7) / 8 * 8;
+}
+
+bool AEventFile::readHeader()
+{
+    if (File.read((char*)&Header, sizeof(AEventFileHeader)) != sizeof(AEventFileHeader) ||
+        std::memcmp(Header.Magic, EventFileMagic, 8) != 0)
+    {
+        ErrorString = "Not an ANTS2 binary event file: " + File.fileName();
+        return false;
+    }
+    if (Header.Version > EventFileVersion)
+    {
+        ErrorString = "Unsupported version of the binary event file: " + QString::number(Header.Version);
+        return false;
+    }
+    if (Header.HeaderSize < sizeof(AEventFileHeader) || Header.RecordSize == 0 || Header.RecordSize % sizeof(float) != 0)
+    {
+        ErrorString = "Corrupted header of the binary event file";
+        return false;
+    }
+
+    // events written after the last header update (e.g. interrupted writing) are ignored
+    const qint64 numComplete = (File.size() - Header.HeaderSize) / Header.RecordSize;
+    if ((qint64)Header.NumEvents > numComplete)
+    {
+        qWarning() << "Binary event file is truncated:" << numComplete << "complete events of" << Header.NumEvents;
+        Header.NumEvents = std::max((qint64)0, numComplete);
+    }
+    return true;
+}
+
+bool AEventFile::open(const QString & fileName)
+{
+    close();
+    ErrorString.clear();
+
+    File.setFileName(fileName);
+    if (!File.open(QIODevice::ReadOnly))
+    {
+        ErrorString = "Cannot open file " + fileName;
+        return false;
+    }
+    if (!readHeader())
+    {
+        close();
+        return false;
+    }
+
+    const qint64 size = Header.HeaderSize + (qint64)Header.NumEvents * Header.RecordSize;
+    Map = File.map(0, size, QFileDevice::MapPrivateOption);
+    if (!Map)
+    {
+        ErrorString = "Failed to map file " + fileName + ": " + File.errorString();
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool AEventFile::create(const QString & fileName, int numChannels, int numTimeBins, bool bWithScan, int numRuns, bool bAppend)
+{
+    close();
+    ErrorString.clear();
+
+    File.setFileName(fileName);
+    if (bAppend && File.exists() && File.size() > 0)
+    {
+        if (!File.open(QIODevice::ReadWrite))
+        {
+            ErrorString = "Cannot open file " + fileName;
+            return false;
+        }
+        if (!readHeader())
+        {
+            close();
+            return false;
+        }
+        if ((int)Header.NumChannels != numChannels || (int)Header.NumTimeBins != numTimeBins || hasScan() != bWithScan)
+        {
+            ErrorString = "Cannot append: the file has a different number of channels / time bins / scan data";
+            close();
+            return false;
+        }
+        File.resize(Header.HeaderSize + (qint64)Header.NumEvents * Header.RecordSize);
+        File.seek(File.size());
+    }
+    else
+    {
+        if (!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            ErrorString = "Cannot open file " + fileName;
+            return false;
+        }
+        initHeader(numChannels, numTimeBins, bWithScan, numRuns);
+        File.write((const char*)&Header, sizeof(AEventFileHeader));
+    }
+
+    Record = QByteArray(Header.RecordSize, 0);
+    bWriting = true;
+    return true;
+}
+
+bool AEventFile::append(AConstEventSpan signal, AConstEventSpan timedSignal, const AScanRecord * scan)
+{
+    if (!bWriting) return false;
+
+    Record.fill(0);
+    float * data = (float*)Record.data();
+    std::memcpy(data, signal.data(), sizeof(float) * std::min<int>(signal.size(), Header.NumChannels));
+    if (isTimed())
+        std::memcpy(data + Header.NumChannels, timedSignal.data(),
+                    sizeof(float) * std::min<int>(timedSignal.size(), Header.NumChannels * Header.NumTimeBins));
+
+    if (hasScan() && scan)
+    {
+        AEventFileScan * s = (AEventFileScan*)(Record.data() + getScanOffset());
+        if (scan->Points.size() > 0) // record without points is stored with zero position / energy / time
+        {
+            const APositionEnergyRecord & p = scan->Points.at(0);
+            for (int i = 0; i < 3; i++) s->r[i] = p.r[i];
+            s->energy = p.energy;
+            s->time   = p.time;
+        }
+        s->zStop     = scan->zStop;
+        s->ScintType = scan->ScintType;
+        s->GoodEvent = scan->GoodEvent;
+    }
+
+    if (File.write(Record) != Record.size())
+    {
+        ErrorString = "Write failed: " + File.errorString();
+        return false;
+    }
+    Header.NumEvents++;
+    return true;
+}
+
+bool AEventFile::readScan(int iev, AScanRecord & scan) const
+{
+    if (!Map || !hasScan() || iev < 0 || iev >= (int)Header.NumEvents) return false;
+
+    const AEventFileScan * s = (const AEventFileScan*)(Map + Header.HeaderSize + (qint64)iev * Header.RecordSize + getScanOffset());
+    if (scan.Points.size() < 1) scan.Points.Reinitialize(1);
+    APositionEnergyRecord & p = scan.Points[0];
+    for (int i = 0; i < 3; i++) p.r[i] = s->r[i];
+    p.energy       = s->energy;
+    p.time         = s->time;
+    scan.zStop     = s->zStop;
+    scan.ScintType = s->ScintType;
+    scan.GoodEvent = s->GoodEvent;
+    return true;
+}
+
+void AEventFile::close()
+{
+    if (bWriting)
+    {
+        // the event counter in the header is updated only here
+        File.seek(0);
+        File.write((const char*)&Header, sizeof(AEventFileHeader));
+        bWriting = false;
+        Record.clear();
+    }
+    if (Map)
+    {
+        File.unmap(Map);
+        Map = nullptr;
+    }
+    if (File.isOpen()) File.close();
+}
@@ -0,0 +1,88 @@
+#ifndef AEVENTFILE_H
+#define AEVENTFILE_H
+
+#include "aeventstore.h"
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+
+struct AScanRecord;
+
+// Binary event file: fixed-size header followed by fixed-size records, so the file itself is the index:
+// event i starts at HeaderSize + i * RecordSize
+// Record: [signals: NumChannels floats][timed signals: NumTimeBins x NumChannels floats, only if time-resolved]
+//         [padding to 8 bytes][scan block, only if HasScan flag is set]
+// Data are stored in the native (little-endian) byte order
+struct AEventFileHeader
+{
+    char    Magic[8];      // "ANTSEVT1"
+    quint32 Version;
+    quint32 NumChannels;
+    quint32 NumTimeBins;   // 0 - not time-resolved
+    quint32 Flags;
+    quint64 NumEvents;
+    quint32 RecordSize;    // in bytes
+    quint32 HeaderSize;    // in bytes
+    quint32 NumRuns;       // ScanNumberOfRuns of the simulation
+    char    Reserved[20];
+};
+
+// only the first point of a scan record is stored
+struct AEventFileScan
+{
+    double  r[3];
+    double  energy;
+    double  time;
+    double  zStop;
+    qint32  ScintType;
+    qint32  GoodEvent;
+};
+
+class AEventFile
+{
+public:
+    enum Flags {HasScan = 0x1};
+
+    ~AEventFile();
+
+    static bool isEventFile(const QString & fileName);
+
+    // read access: the whole file is memory-mapped (copy-on-write, the file is never modified)
+    bool open(const QString & fileName);
+
+    // write access: new file or append to an existing one with the same layout
+    bool create(const QString & fileName, int numChannels, int numTimeBins, bool bWithScan, int numRuns = 1, bool bAppend = false);
+    bool append(AConstEventSpan signal, AConstEventSpan timedSignal, const AScanRecord * scan); // timedSignal is ignored if not time-resolved
+
+    void close();                              // finalizes the header if the file was opened for writing
+
+    bool isOpen() const {return File.isOpen();}
+    int  getNumEvents() const {return Header.NumEvents;}
+    int  getNumChannels() const {return Header.NumChannels;}
+    int  getNumTimeBins() const {return Header.NumTimeBins;}
+    int  getNumRuns() const {return Header.NumRuns;}
+    bool isTimed() const {return Header.NumTimeBins > 0;}
+    bool hasScan() const {return Header.Flags & HasScan;}
+
+    // mapped data (read access only); stride between events is in floats
+    float * getSignals() {return Map ? (float*)(Map + Header.HeaderSize) : nullptr;}
+    float * getTimedSignals() {return getSignals() ? getSignals() + Header.NumChannels : nullptr;}
+    int     getStride() const {return Header.RecordSize / sizeof(float);}
+    bool    readScan(int iev, AScanRecord & scan) const;
+
+    QString ErrorString;
+
+private:
+    QFile File;
+    AEventFileHeader Header = AEventFileHeader();
+    uchar * Map = nullptr;
+    bool    bWriting = false;
+    QByteArray Record;                         // write buffer for one record
+
+    void    initHeader(int numChannels, int numTimeBins, bool bWithScan, int numRuns);
+    int     getScanOffset() const;             // in bytes
+    bool    readHeader();
+};
+
+#endif // AEVENTFILE_H
@@ -0,0 +1,306 @@
+#include "aeventframe.h"
+#include "apositionenergyrecords.h"
+
+#include <QDebug>
+
+#include <cstring>
+#include <limits>
+
+static const char EventFrameMagic[4] = {'A','E','V','F'};
+static const int  HeaderSize = sizeof(AEventFrameHeader);
+
+bool AEventFrame::isFrame(const QByteArray & ba)
+{
+    return ba.size() >= HeaderSize && std::memcmp(ba.constData(), EventFrameMagic, 4) == 0;
+}
+
+char * AEventFrame::initFrame(QByteArray & ba, Type type, int firstEvent, int numEvents, int totalEvents, int rawSize)
+{
+    ba.resize(HeaderSize + rawSize);
+
+    AEventFrameHeader * h = (AEventFrameHeader*)ba.data();
+    *h = AEventFrameHeader();
+    std::memcpy(h->Magic, EventFrameMagic, 4);
+    h->Type        = type;
+    h->FirstEvent  = firstEvent;
+    h->NumEvents   = numEvents;
+    h->TotalEvents = totalEvents;
+    h->NumTimeBins = 1;
+    h->PayloadSize = rawSize;
+    h->RawSize     = rawSize;
+
+    return ba.data() + HeaderSize;
+}
+
+void AEventFrame::finalizeFrame(QByteArray & ba, bool bCompress)
+{
+    const int rawSize = ba.size() - HeaderSize;
+    if (!bCompress || rawSize == 0) return;
+
+    // fast compression level: the payload is mostly floats, the gain is in the zero signals of the inactive channels
+    const QByteArray compressed = qCompress((const uchar*)ba.constData() + HeaderSize, rawSize, 1);
+    if (compressed.size() >= rawSize) return;
+
+    ba.resize(HeaderSize);
+    ba.append(compressed);
+    AEventFrameHeader * h = (AEventFrameHeader*)ba.data();
+    h->Flags      |= Compressed;
+    h->PayloadSize = compressed.size();
+}
+
+void AEventFrame::packEvents(const AEventStore & store, bool bTimed, int from, int to, int firstEvent, int totalEvents, bool bCompress, QByteArray & ba)
+{
+    const int numEvents = to - from;
+    const int eventSize = store.getEventSize();
+    char * payload = initFrame(ba, bTimed ? TimedEvents : Events, firstEvent, numEvents, totalEvents, numEvents * eventSize * sizeof(float));
+
+    AEventFrameHeader * h = (AEventFrameHeader*)ba.data();
+    h->NumChannels = store.getNumChannels();
+    h->NumTimeBins = store.getNumTimeBins();
+
+    for (int iev = from; iev < to; iev++)
+    {
+        std::memcpy(payload, store.at(iev).data(), eventSize * sizeof(float));
+        payload += eventSize * sizeof(float);
+    }
+
+    finalizeFrame(ba, bCompress);
+}
+
+static void writePoints(char * & to, const APositionEnergyBuffer & points)
+{
+    for (int i = 0; i < points.size(); i++)
+    {
+        AEventFramePoint p;
+        for (int j = 0; j < 3; j++) p.r[j] = points.at(i).r[j];
+        p.energy = points.at(i).energy;
+        p.time   = points.at(i).time;
+        std::memcpy(to, &p, sizeof(AEventFramePoint));
+        to += sizeof(AEventFramePoint);
+    }
+}
+
+static void readPoints(const char * & from, int numPoints, APositionEnergyBuffer & points)
+{
+    if (points.size() != numPoints) points.Reinitialize(numPoints);
+    for (int i = 0; i < numPoints; i++)
+    {
+        AEventFramePoint p;
+        std::memcpy(&p, from, sizeof(AEventFramePoint));
+        from += sizeof(AEventFramePoint);
+        for (int j = 0; j < 3; j++) points[i].r[j] = p.r[j];
+        points[i].energy = p.energy;
+        points[i].time   = p.time;
+    }
+}
+
+void AEventFrame::packScan(const QVector<AScanRecord *> & scan, int from, int to, int firstEvent, int totalEvents, bool bCompress, QByteArray & ba)
+{
+    const int numEvents = to - from;
+    int numPoints = 0;
+    for (int iev = from; iev < to; iev++) numPoints += scan.at(iev)->Points.size();
+
+    char * records = initFrame(ba, Scan, firstEvent, numEvents, totalEvents, numEvents * sizeof(AEventFrameScan) + numPoints * sizeof(AEventFramePoint));
+    ((AEventFrameHeader*)ba.data())->NumPoints = numPoints;
+
+    char * points = records + numEvents * sizeof(AEventFrameScan);
+    for (int iev = from; iev < to; iev++)
+    {
+        const AScanRecord * s = scan.at(iev);
+        AEventFrameScan r = AEventFrameScan();
+        r.zStop     = s->zStop;
+        r.NumPoints = s->Points.size();
+        r.ScintType = s->ScintType;
+        r.GoodEvent = s->GoodEvent;
+        std::memcpy(records, &r, sizeof(AEventFrameScan));
+        records += sizeof(AEventFrameScan);
+
+        writePoints(points, s->Points);
+    }
+
+    finalizeFrame(ba, bCompress);
+}
+
+void AEventFrame::packReconstruction(const QVector<AReconRecord *> & rec, int from, int to, int firstEvent, int totalEvents, bool bCompress, QByteArray & ba)
+{
+    const int numEvents = to - from;
+    int numPoints = 0;
+    for (int iev = from; iev < to; iev++) numPoints += rec.at(iev)->Points.size();
+
+    char * records = initFrame(ba, Reconstruction, firstEvent, numEvents, totalEvents, numEvents * sizeof(AEventFrameRecon) + numPoints * sizeof(AEventFramePoint));
+    ((AEventFrameHeader*)ba.data())->NumPoints = numPoints;
+
+    char * points = records + numEvents * sizeof(AEventFrameRecon);
+    for (int iev = from; iev < to; iev++)
+    {
+        const AReconRecord * rr = rec.at(iev);
+        AEventFrameRecon r;
+        r.chi2             = rr->chi2;
+        r.NumPoints        = rr->Points.size();
+        r.ReconstructionOK = rr->ReconstructionOK;
+        std::memcpy(records, &r, sizeof(AEventFrameRecon));
+        records += sizeof(AEventFrameRecon);
+
+        writePoints(points, rr->Points);
+    }
+
+    finalizeFrame(ba, bCompress);
+}
+
+bool AEventFrame::read(const QByteArray & ba)
+{
+    ErrorString.clear();
+    Payload = nullptr;
+    Uncompressed.clear();
+
+    if (!isFrame(ba))
+    {
+        ErrorString = "Not an event frame";
+        return false;
+    }
+    std::memcpy(&Header, ba.constData(), HeaderSize);
+
+    if (Header.Type < Events || Header.Type > Reconstruction || Header.PayloadSize != (quint32)(ba.size() - HeaderSize) ||
+        (quint64)Header.FirstEvent + Header.NumEvents > Header.TotalEvents || Header.TotalEvents > (quint32)std::numeric_limits<int>::max())
+    {
+        ErrorString = "Corrupted event frame header";
+        return false;
+    }
+
+    quint64 expected = 0;
+    switch (Header.Type)
+    {
+    case Events:
+    case TimedEvents:
+        expected = (quint64)Header.NumEvents * Header.NumChannels * Header.NumTimeBins * sizeof(float);
+        break;
+    case Scan:
+        expected = (quint64)Header.NumEvents * sizeof(AEventFrameScan) + (quint64)Header.NumPoints * sizeof(AEventFramePoint);
+        break;
+    case Reconstruction:
+        expected = (quint64)Header.NumEvents * sizeof(AEventFrameRecon) + (quint64)Header.NumPoints * sizeof(AEventFramePoint);
+        break;
+    }
+    if (expected != Header.RawSize)
+    {
+        ErrorString = "Event frame payload size does not match the header";
+        return false;
+    }
+
+    if (Header.Flags & Compressed)
+    {
+        Uncompressed = qUncompress((const uchar*)ba.constData() + HeaderSize, Header.PayloadSize);
+        if ((quint32)Uncompressed.size() != Header.RawSize)
+        {
+            ErrorString = "Failed to uncompress event frame";
+            return false;
+        }
+        Payload = Uncompressed.constData();
+    }
+    else
+    {
+        if (Header.PayloadSize != Header.RawSize)
+        {
+            ErrorString = "Corrupted event frame header";
+            return false;
+        }
+        Payload = ba.constData() + HeaderSize;
+    }
+    return true;
+}
+
+bool AEventFrame::appendEvents(AEventStore & store) const
+{
+    if (!Payload || (getType() != Events && getType() != TimedEvents))
+    {
+        qWarning() << "Event frame does not contain events";
+        return false;
+    }
+
+    if (store.isEmpty()) store.setDimensions(Header.NumChannels, Header.NumTimeBins);
+    else if (store.getNumChannels() != (int)Header.NumChannels || store.getNumTimeBins() != (int)Header.NumTimeBins)
+    {
+        qWarning() << "Event frame has different dimensions than the event store";
+        return false;
+    }
+
+    const int eventSize = Header.NumChannels * Header.NumTimeBins;
+    const float * data = (const float*)Payload;
+    store.reserve(store.size() + Header.NumEvents);
+    for (quint32 iev = 0; iev < Header.NumEvents; iev++)
+        store.append(AConstEventSpan(data + (size_t)iev * eventSize, eventSize));
+
+    return true;
+}
+
+bool AEventFrame::appendScan(QVector<AScanRecord *> & scan) const
+{
+    if (!Payload || getType() != Scan)
+    {
+        qWarning() << "Event frame does not contain scan data";
+        return false;
+    }
+
+    const char * records = Payload;
+    quint64 numPoints = 0;
+    for (quint32 iev = 0; iev < Header.NumEvents; iev++)
+    {
+        AEventFrameScan r;
+        std::memcpy(&r, records + iev * sizeof(AEventFrameScan), sizeof(AEventFrameScan));
+        if (r.NumPoints < 0) return false;
+        numPoints += r.NumPoints;
+    }
+    if (numPoints != Header.NumPoints) return false;
+
+    const char * points = Payload + Header.NumEvents * sizeof(AEventFrameScan);
+    scan.reserve(scan.size() + Header.NumEvents);
+    for (quint32 iev = 0; iev < Header.NumEvents; iev++)
+    {
+        AEventFrameScan r;
+        std::memcpy(&r, records, sizeof(AEventFrameScan));
+        records += sizeof(AEventFrameScan);
+
+        AScanRecord * s = new AScanRecord();
+        readPoints(points, r.NumPoints, s->Points);
+        s->zStop     = r.zStop;
+        s->ScintType = r.ScintType;
+        s->GoodEvent = r.GoodEvent;
+        scan.append(s);
+    }
+    return true;
+}
+
+bool AEventFrame::setReconstruction(QVector<AReconRecord *> & rec, int offset) const
+{
+    if (!Payload || getType() != Reconstruction)
+    {
+        qWarning() << "Event frame does not contain reconstruction data";
+        return false;
+    }
+    if (offset < 0 || offset + Header.FirstEvent + Header.NumEvents > (quint32)rec.size()) return false;
+
+    const char * records = Payload;
+    quint64 numPoints = 0;
+    for (quint32 iev = 0; iev < Header.NumEvents; iev++)
+    {
+        AEventFrameRecon r;
+        std::memcpy(&r, records + iev * sizeof(AEventFrameRecon), sizeof(AEventFrameRecon));
+        if (r.NumPoints < 0) return false;
+        numPoints += r.NumPoints;
+    }
+    if (numPoints != Header.NumPoints) return false;
+
+    const char * points = Payload + Header.NumEvents * sizeof(AEventFrameRecon);
+    for (quint32 iev = 0; iev < Header.NumEvents; iev++)
+    {
+        AEventFrameRecon r;
+        std::memcpy(&r, records, sizeof(AEventFrameRecon));
+        records += sizeof(AEventFrameRecon);
+
+        AReconRecord * rr = rec[offset + Header.FirstEvent + iev];
+        readPoints(points, r.NumPoints, rr->Points);
+        rr->chi2             = r.chi2;
+        rr->ReconstructionOK = r.ReconstructionOK;
+    }
+    return true;
+}
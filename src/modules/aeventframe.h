@@ -0,0 +1,102 @@
+#ifndef AEVENTFRAME_H
+#define AEVENTFRAME_H
+
+#include "aeventstore.h"
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QtGlobal>
+
+struct AScanRecord;
+struct AReconRecord;
+
+// Binary frame for the transfer of events / reconstruction results between the grid client and ANTS2 servers
+// One frame is one binary websocket message: fixed-size header followed by a contiguous payload
+//   Events, TimedEvents: NumEvents x NumTimeBins x NumChannels floats (same layout as an event in AEventStore)
+//   Scan, Reconstruction: NumEvents fixed-size records, followed by the points of all events of the frame
+// A transfer of TotalEvents events is split into frames of consecutive events, FirstEvent is the index in the transfer
+// Payload can be compressed with qCompress; data are in the native (little-endian) byte order
+struct AEventFrameHeader
+{
+    char    Magic[4];      // "AEVF"
+    quint32 Type;
+    quint32 Flags;
+    quint32 FirstEvent;
+    quint32 NumEvents;
+    quint32 TotalEvents;
+    quint32 NumChannels;   // events only
+    quint32 NumTimeBins;   // events only, 1 if not time-resolved
+    quint32 NumPoints;     // scan / reconstruction: sum of the points of all events in the frame
+    quint32 PayloadSize;   // in bytes, as transferred
+    quint32 RawSize;       // in bytes, uncompressed
+    quint32 Reserved;
+};
+
+struct AEventFramePoint
+{
+    double  r[3];
+    double  energy;
+    double  time;
+};
+
+struct AEventFrameScan
+{
+    double  zStop;
+    qint32  NumPoints;
+    qint32  ScintType;
+    qint32  GoodEvent;
+    qint32  Reserved;
+};
+
+struct AEventFrameRecon
+{
+    double  chi2;
+    qint32  NumPoints;
+    qint32  ReconstructionOK;
+};
+
+class AEventFrame
+{
+public:
+    enum Type  {Events = 1, TimedEvents, Scan, Reconstruction};
+    enum Flags {Compressed = 0x1};
+
+    static bool isFrame(const QByteArray & ba);
+
+    // the frame is written directly to ba; events [from, to) of the source become events [firstEvent, ...) of the transfer
+    static void packEvents(const AEventStore & store, bool bTimed, int from, int to, int firstEvent, int totalEvents, bool bCompress, QByteArray & ba);
+    static void packScan(const QVector<AScanRecord*> & scan, int from, int to, int firstEvent, int totalEvents, bool bCompress, QByteArray & ba);
+    static void packReconstruction(const QVector<AReconRecord*> & rec, int from, int to, int firstEvent, int totalEvents, bool bCompress, QByteArray & ba);
+
+    // validates the header; payload of an uncompressed frame is used in place -> ba has to outlive the frame
+    bool read(const QByteArray & ba);
+
+    Type getType() const {return (Type)Header.Type;}
+    int  getFirstEvent() const {return Header.FirstEvent;}
+    int  getNumEvents() const {return Header.NumEvents;}
+    int  getTotalEvents() const {return Header.TotalEvents;}
+    int  getNumChannels() const {return Header.NumChannels;}
+    int  getNumTimeBins() const {return Header.NumTimeBins;}
+    bool isFirst() const {return Header.FirstEvent == 0;}
+    bool isLast() const {return Header.FirstEvent + Header.NumEvents >= Header.TotalEvents;}
+
+    // store dimensions are set from the frame if the store is empty
+    bool appendEvents(AEventStore & store) const;
+    // new records are appended, ownership goes to the container
+    bool appendScan(QVector<AScanRecord*> & scan) const;
+    // overwrites the existing records [offset + FirstEvent, offset + FirstEvent + NumEvents)
+    bool setReconstruction(QVector<AReconRecord*> & rec, int offset) const;
+
+    QString ErrorString;
+
+private:
+    AEventFrameHeader Header = AEventFrameHeader();
+    const char *      Payload = nullptr;
+    QByteArray        Uncompressed;
+
+    static char * initFrame(QByteArray & ba, Type type, int firstEvent, int numEvents, int totalEvents, int rawSize);
+    static void   finalizeFrame(QByteArray & ba, bool bCompress);
+};
+
+#endif // AEVENTFRAME_H
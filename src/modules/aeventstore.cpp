@@ -0,0 +1,210 @@
+#include "aeventstore.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+AEventStore::AEventStore(size_t chunkBytes) :
+    ChunkBytes(chunkBytes)
+{
+    updateChunkEvents();
+}
+
+AEventStore::AEventStore(const AEventStore & other)
+{
+    *this = other;
+}
+
+AEventStore & AEventStore::operator=(const AEventStore & other)
+{
+    if (this == &other) return *this;
+
+    ChunkBytes    = other.ChunkBytes;
+    ChunkEvents   = other.ChunkEvents;
+    NumChannels   = other.NumChannels;
+    NumTimeBins   = other.NumTimeBins;
+    NumEvents     = other.NumEvents;
+    Stride        = other.Stride;
+    Blocks        = other.Blocks;
+    ExternalOwner = other.ExternalOwner;
+    if (ExternalOwner)
+    {
+        // a copy does not share the external memory: it would depend on the mapping kept by the other store
+        Chunks = other.Chunks;
+        detachExternal();
+    }
+    else
+    {
+        Chunks.clear();
+        for (std::vector<float> & b : Blocks) Chunks.push_back(b.data());
+    }
+    return *this;
+}
+
+void AEventStore::setDimensions(int numChannels, int numTimeBins)
+{
+    if (numTimeBins < 1) numTimeBins = 1;
+    if (numChannels == NumChannels && numTimeBins == NumTimeBins) return;
+
+    clear();
+    NumChannels = numChannels;
+    NumTimeBins = numTimeBins;
+    Stride      = getEventSize();
+    updateChunkEvents();
+}
+
+void AEventStore::updateChunkEvents()
+{
+    const size_t eventBytes = sizeof(float) * std::max(1, getEventSize());
+    ChunkEvents = (int)std::max<size_t>(1, std::min<size_t>(ChunkBytes / eventBytes, 1 << 20));
+}
+
+void AEventStore::assureCapacity(int numEvents)
+{
+    if (ExternalOwner) detachExternal();
+
+    const size_t blockSize = (size_t)ChunkEvents * getEventSize();
+    while ((int)Chunks.size() * ChunkEvents < numEvents)
+    {
+        Blocks.push_back(std::vector<float>(blockSize, 0));
+        Chunks.push_back(Blocks.back().data());
+    }
+}
+
+void AEventStore::setExternal(float * data, int numEvents, int stride, int numChannels, int numTimeBins, std::shared_ptr<void> owner)
+{
+    clear();
+    NumChannels = numChannels;
+    NumTimeBins = std::max(1, numTimeBins);
+    NumEvents   = numEvents;
+    Stride      = stride;
+    ExternalOwner = owner;
+    updateChunkEvents();
+
+    for (int iev = 0; iev < numEvents; iev += ChunkEvents)
+        Chunks.push_back(data + (size_t)iev * stride);
+}
+
+void AEventStore::detachExternal()
+{
+    std::shared_ptr<void> owner = ExternalOwner; // keeps the memory alive until the copy is done
+    std::vector<float*> extChunks;
+    extChunks.swap(Chunks);
+    const int extStride = Stride;
+    const int numEvents = NumEvents;
+
+    ExternalOwner.reset();
+    Stride = getEventSize();
+    NumEvents = 0;
+    assureCapacity(numEvents);
+    for (int iev = 0; iev < numEvents; iev++)
+    {
+        const float * from = extChunks[iev / ChunkEvents] + (iev % ChunkEvents) * extStride;
+        std::memcpy(eventData(iev), from, sizeof(float) * getEventSize());
+    }
+    NumEvents = numEvents;
+}
+
+AEventSpan AEventStore::appendEmpty()
+{
+    assureCapacity(NumEvents + 1);
+    NumEvents++;
+    AEventSpan ev = last();
+    std::fill(ev.begin(), ev.end(), 0);
+    return ev;
+}
+
+void AEventStore::append(AConstEventSpan event)
+{
+    if (NumEvents == 0 && NumChannels == 0) setDimensions(event.size());
+
+    const int size = getEventSize();
+    if (event.size() != size)
+        qWarning() << "Event store: appended event has" << event.size() << "values instead of" << size;
+
+    AEventSpan ev = appendEmpty();
+    std::memcpy(ev.data(), event.data(), sizeof(float) * std::min(size, event.size()));
+}
+
+void AEventStore::append(const QVector<float> & event)
+{
+    append(AConstEventSpan(event.data(), event.size()));
+}
+
+void AEventStore::append(const QVector<QVector<float> > & timedEvent)
+{
+    if (NumEvents == 0 && NumChannels == 0)
+        setDimensions(timedEvent.isEmpty() ? 0 : timedEvent.first().size(), timedEvent.size());
+
+    AEventSpan ev = appendEmpty();
+    const int numBins = std::min(NumTimeBins, timedEvent.size());
+    for (int iBin = 0; iBin < numBins; iBin++)
+    {
+        const QVector<float> & bin = timedEvent.at(iBin);
+        std::memcpy(ev.data() + iBin * NumChannels, bin.data(), sizeof(float) * std::min(NumChannels, bin.size()));
+    }
+}
+
+void AEventStore::append(const AEventStore & other)
+{
+    if (other.isEmpty()) return;
+    if (NumEvents == 0) setDimensions(other.NumChannels, other.NumTimeBins);
+
+    reserve(NumEvents + other.NumEvents);
+    for (int iev = 0; iev < other.NumEvents; iev++)
+        append(other.at(iev));
+}
+
+void AEventStore::copyEvent(int from, int to)
+{
+    if (from == to) return;
+    std::memcpy(eventData(to), eventData(from), sizeof(float) * getEventSize());
+}
+
+void AEventStore::resize(int numEvents)
+{
+    if (numEvents < 0) numEvents = 0;
+    if (numEvents > NumEvents)
+    {
+        assureCapacity(numEvents);
+        for (int iev = NumEvents; iev < numEvents; iev++)
+        {
+            float * d = eventData(iev);
+            std::fill(d, d + getEventSize(), 0);
+        }
+    }
+    NumEvents = numEvents;
+}
+
+void AEventStore::reserve(int numEvents)
+{
+    if (getEventSize() == 0) return; // dimensions are not yet known
+    if (ExternalOwner && numEvents <= NumEvents) return;
+    assureCapacity(numEvents);
+}
+
+void AEventStore::squeeze()
+{
+    if (ExternalOwner) return;
+
+    const size_t usedChunks = (NumEvents + ChunkEvents - 1) / ChunkEvents;
+    Blocks.resize(usedChunks);
+    Blocks.shrink_to_fit();
+    Chunks.resize(usedChunks);
+    Chunks.shrink_to_fit();
+}
+
+void AEventStore::clear()
+{
+    Blocks.clear();
+    Blocks.shrink_to_fit();
+    Chunks.clear();
+    Chunks.shrink_to_fit();
+    ExternalOwner.reset();
+    NumEvents   = 0;
+    NumChannels = 0;
+    NumTimeBins = 1;
+    Stride      = 0;
+    updateChunkEvents();
+}
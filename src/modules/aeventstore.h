@@ -0,0 +1,113 @@
+#ifndef AEVENTSTORE_H
+#define AEVENTSTORE_H
+
+#include <QVector>
+
+#include <vector>
+#include <memory>
+
+// Non-owning view of the signals of one event (or of one time bin of a time-resolved event)
+// Valid until the store is cleared / resized / squeezed; append does not invalidate views
+template <typename T>
+class AEventSpanBase
+{
+public:
+    AEventSpanBase() {}
+    AEventSpanBase(T * data, int size) : Data(data), Size(size) {}
+    template <typename U>
+    AEventSpanBase(const AEventSpanBase<U> & other) : Data(other.data()), Size(other.size()) {}
+
+    T &     operator[](int i) const {return Data[i];}
+    const T & at(int i) const {return Data[i];}
+    T &     first() const {return Data[0];}
+    T &     last() const {return Data[Size-1];}
+
+    int     size() const {return Size;}
+    int     count() const {return Size;}
+    bool    isEmpty() const {return Size == 0;}
+    T *     data() const {return Data;}
+    T *     begin() const {return Data;}
+    T *     end() const {return Data + Size;}
+
+    QVector<float> toVector() const {QVector<float> v(Size); for (int i = 0; i < Size; i++) v[i] = Data[i]; return v;}
+
+private:
+    T * Data = nullptr;
+    int Size = 0;
+};
+
+typedef AEventSpanBase<float>       AEventSpan;
+typedef AEventSpanBase<const float> AConstEventSpan;
+
+// Chunked columnar storage of PM signals: all events have the same number of time bins and channels
+// and are kept in flat float blocks of ChunkEvents events each -> no heap allocation per event / per time bin
+// ChunkEvents follows from the block size in bytes and the event size, so large time-resolved events give short blocks
+// Event layout in a block: [timeBin][channel]; non-timed stores have one time bin
+// The store can also be a view of external memory (e.g. memory-mapped event file, see AEventFile):
+// then events are located with a fixed stride and the memory is kept alive by the shared owner object.
+// Operations adding events and copies of the store copy the external data to own blocks first
+class AEventStore
+{
+public:
+    AEventStore(size_t chunkBytes = 1 << 20);
+    AEventStore(const AEventStore & other);
+    AEventStore(AEventStore && other) = default;
+    AEventStore & operator=(const AEventStore & other);
+    AEventStore & operator=(AEventStore && other) = default;
+
+    int  size() const {return NumEvents;}
+    int  count() const {return NumEvents;}
+    bool isEmpty() const {return NumEvents == 0;}
+
+    int  getNumChannels() const {return NumChannels;}
+    int  getNumTimeBins() const {return NumTimeBins;}
+    int  getEventSize() const {return NumChannels * NumTimeBins;}
+    void setDimensions(int numChannels, int numTimeBins = 1); // clears the store if the dimensions are changed
+
+    // whole event (all time bins)
+    AEventSpan      operator[](int iev)       {return AEventSpan(eventData(iev), getEventSize());}
+    AConstEventSpan operator[](int iev) const {return at(iev);}
+    AConstEventSpan at(int iev) const         {return AConstEventSpan(eventData(iev), getEventSize());}
+    AEventSpan      first()                   {return (*this)[0];}
+    AEventSpan      last()                    {return (*this)[NumEvents-1];}
+
+    // one time bin of the event
+    AEventSpan      getTimeBin(int iev, int iTimeBin)      {return AEventSpan(eventData(iev) + iTimeBin * NumChannels, NumChannels);}
+    AConstEventSpan atTimeBin(int iev, int iTimeBin) const {return AConstEventSpan(eventData(iev) + iTimeBin * NumChannels, NumChannels);}
+
+    // if the store is empty, the dimensions are taken from the first appended event
+    // events of different size are truncated / padded with zeros
+    void append(const QVector<float> & event);
+    void append(const QVector< QVector<float> > & timedEvent); // [timeBin][channel]
+    void append(AConstEventSpan event);
+    void append(const AEventStore & other);
+    AEventSpan appendEmpty();                                 // zero-filled
+
+    void copyEvent(int from, int to);                         // overwrites event "to" with a copy of event "from"
+    void resize(int numEvents);                               // new events are zero-filled
+    void reserve(int numEvents);
+    void squeeze();                                           // releases the reserved but unused blocks
+    void clear();                                             // also resets the dimensions
+
+    void setExternal(float * data, int numEvents, int stride, int numChannels, int numTimeBins, std::shared_ptr<void> owner); // stride is in floats
+    bool isExternal() const {return (bool)ExternalOwner;}
+
+private:
+    size_t ChunkBytes;
+    int ChunkEvents = 1;
+    int NumChannels = 0;
+    int NumTimeBins = 1;
+    int NumEvents   = 0;
+    int Stride      = 0;                      // distance between events in floats
+    std::vector< std::vector<float> > Blocks; // own data; each block is allocated in full, so it is never reallocated
+    std::vector<float*> Chunks;               // start of each block of ChunkEvents events (own or external)
+    std::shared_ptr<void> ExternalOwner;
+
+    float * eventData(int iev)             {return Chunks[iev / ChunkEvents] + (iev % ChunkEvents) * Stride;}
+    const float * eventData(int iev) const {return Chunks[iev / ChunkEvents] + (iev % ChunkEvents) * Stride;}
+    void    updateChunkEvents();              // only for an empty store
+    void    assureCapacity(int numEvents);
+    void    detachExternal();
+};
+
+#endif // AEVENTSTORE_H
@@ -94,6 +94,47 @@ double ALrfModuleSelector::getLRFErr(int pmt, double x, double y, double z)
   else return NewModule->getLRFErr(pmt, APoint(x, y, z));
 }
 
+void ALrfModuleSelector::getLRFs(const double *r, std::vector<double> &values)
+{
+  const int numPMs = PMs->count();
+  values.resize(numPMs);
+  if (fOldSelected) OldModule->getLRFs(r, values.data(), numPMs);
+  else
+    for (int ipm = 0; ipm < numPMs; ipm++)
+      values[ipm] = getLRF(ipm, r);
+}
+
+void ALrfModuleSelector::getLRFErrs(const double *r, std::vector<double> &values)
+{
+  const int numPMs = PMs->count();
+  values.resize(numPMs);
+  if (fOldSelected) OldModule->getLRFErrs(r, values.data(), numPMs);
+  else
+    for (int ipm = 0; ipm < numPMs; ipm++)
+      values[ipm] = getLRFErr(ipm, r);
+}
+
+void ALrfModuleSelector::getLRFsAndGradients(const double *r, std::vector<double> &values, std::vector<double> &gradX, std::vector<double> &gradY)
+{
+  const int numPMs = PMs->count();
+  values.resize(numPMs);
+  gradX.resize(numPMs);
+  gradY.resize(numPMs);
+  if (fOldSelected)
+  {
+    OldModule->getLRFsAndGradients(r, values.data(), gradX.data(), gradY.data(), numPMs);
+    return;
+  }
+
+  const double h = 1e-3;
+  for (int ipm = 0; ipm < numPMs; ipm++)
+  {
+    values[ipm] = getLRF(ipm, r[0], r[1], r[2]);
+    gradX[ipm] = (getLRF(ipm, r[0]+h, r[1], r[2]) - getLRF(ipm, r[0]-h, r[1], r[2])) / (2.0*h);
+    gradY[ipm] = (getLRF(ipm, r[0], r[1]+h, r[2]) - getLRF(ipm, r[0], r[1]-h, r[2])) / (2.0*h);
+  }
+}
+
 void ALrfModuleSelector::clear(int numPMs)
 {
   OldModule->clear(numPMs);
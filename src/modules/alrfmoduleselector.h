@@ -14,6 +14,7 @@ namespace LRF {
 
 #include <QJsonObject>
 #include <memory>
+#include <vector>
 
 //WARN: copied instances are only valid until clear() is called.
 //      If copy is used after that, crash!!!
@@ -35,6 +36,13 @@ public:
   double getLRFErr(int pmt, const APoint &pos);
   double getLRFErr(int pmt, double x, double y, double z);
 
+  // one position for all PMs (values are resized to the number of PMs)
+  // the old module evaluates the LRFs with one batched call per sensor group
+  void getLRFs(const double *r, std::vector<double> &values);
+  void getLRFErrs(const double *r, std::vector<double> &values);
+  // gradients over x and y: analytic for the old module, numerical for the new one
+  void getLRFsAndGradients(const double *r, std::vector<double> &values, std::vector<double> &gradX, std::vector<double> &gradY);
+
   void clear(int numPMs); //Warning: don't call unless there are no copies!
 
   void saveActiveLRFs_v2(QJsonObject &LRFjson);
@@ -96,9 +96,12 @@ void AMaterialParticleCollection::UpdateRuntimePropertiesAndWavelengthBinning(AG
   AMaterialParticleCollection::SetWave(SimSet->fWaveResolved, SimSet->WaveFrom, SimSet->WaveTo, SimSet->WaveStep, SimSet->WaveNodes);
   for (int imat = 0; imat < MaterialCollectionData.size(); imat++)
   {
-    UpdateWaveResolvedProperties(imat);
+    UpdateWaveResolvedProperties(imat, false);
     MaterialCollectionData[imat]->updateRuntimeProperties(fLogLogInterpolation, RandGen, numThreads);
   }
+  for (int imat = 0; imat < MaterialCollectionData.size(); imat++)
+    InitializeOverrides(imat);
+  OpticalTable.build(*this, WavelengthResolved, WaveNodes);
 }
 
 const QString AMaterialParticleCollection::CheckOverrides()
@@ -220,6 +223,7 @@ void AMaterialParticleCollection::clearMaterialCollection()
       delete MaterialCollectionData[i];
     }
   MaterialCollectionData.clear();
+  OpticalTable.clear();
 
   AMaterialParticleCollection::ClearTmpMaterial();
 }
@@ -394,7 +398,7 @@ int AMaterialParticleCollection::FindMaterial(const QString & name) const
     return -1;
 }
 
-void AMaterialParticleCollection::UpdateWaveResolvedProperties(int imat)
+void AMaterialParticleCollection::UpdateWaveResolvedProperties(int imat, bool bInitializeOverrides)
 {
   //qDebug()<<"Wavelength-resolved?"<<WavelengthResolved;
   //qDebug()<<"--updating wavelength-resolved properties for material index"<<imat;
@@ -457,10 +461,6 @@ void AMaterialParticleCollection::UpdateWaveResolvedProperties(int imat)
           for (int j = 1; j<WaveNodes+1; j++)  MaterialCollectionData[imat]->SecondarySpectrumHist->SetBinContent(j, y[j-1]);
           MaterialCollectionData[imat]->SecondarySpectrumHist->GetIntegral(); //to make thread safe
         }
-
-      for (int ior=0; ior<MaterialCollectionData[imat]->OpticalOverrides.size(); ior++)
-        if (MaterialCollectionData[imat]->OpticalOverrides[ior])
-            MaterialCollectionData[imat]->OpticalOverrides[ior]->initializeWaveResolved();
   }
   else
   {
@@ -479,11 +479,16 @@ void AMaterialParticleCollection::UpdateWaveResolvedProperties(int imat)
           delete MaterialCollectionData[imat]->SecondarySpectrumHist;
           MaterialCollectionData[imat]->SecondarySpectrumHist = 0;
       }
-
-      for (int ior=0; ior<MaterialCollectionData[imat]->OpticalOverrides.size(); ior++)
-        if (MaterialCollectionData[imat]->OpticalOverrides[ior])
-            MaterialCollectionData[imat]->OpticalOverrides[ior]->initializeWaveResolved();
   }
+
+  if (bInitializeOverrides) InitializeOverrides(imat);
+}
+
+void AMaterialParticleCollection::InitializeOverrides(int imat)
+{
+  for (int ior=0; ior<MaterialCollectionData[imat]->OpticalOverrides.size(); ior++)
+    if (MaterialCollectionData[imat]->OpticalOverrides[ior])
+        MaterialCollectionData[imat]->OpticalOverrides[ior]->initializeWaveResolved();
 }
 
 bool AMaterialParticleCollection::isNCrystalInUse() const
@@ -3,6 +3,7 @@
 
 #include "amaterial.h"
 #include "aparticle.h"
+#include "aopticalpropertytable.h"
 
 #include <QVector>
 #include <QString>
@@ -30,6 +31,7 @@ private:
   double WaveFrom, WaveTo, WaveStep;
   int WaveNodes;
   bool WavelengthResolved;
+  AOpticalPropertyTable OpticalTable; //run-time, rebuilt in UpdateRuntimePropertiesAndWavelengthBinning
 
 public:
   //configuration
@@ -39,6 +41,7 @@ public:
   void UpdateRuntimePropertiesAndWavelengthBinning(AGeneralSimSettings *SimSet, TRandom2 *RandGen, int numThreads = 1);
   const QString CheckOverrides();
   void updateRandomGenForThread(int ID, TRandom2 *RandGen);
+  const AOpticalPropertyTable & getOpticalTable() const {return OpticalTable;}
 
   //for script-based optical override initialization
   bool isScriptOpticalOverrideDefined() const;
@@ -68,7 +71,8 @@ public:
   void AddNewMaterial(QString name, bool fSuppressChangedSignal = false);
   int FindMaterial(const QString &name) const; //if not found, returns -1; if found, returns material index
   bool DeleteMaterial(int imat); //takes care of overrides of materials with index larger than imat!
-  void UpdateWaveResolvedProperties(int imat); //updates wavelength-resolved material properties
+  void UpdateWaveResolvedProperties(int imat, bool bInitializeOverrides = true); //updates wavelength-resolved material properties
+  void InitializeOverrides(int imat); //overrides can use binned properties of both materials -> call after both are updated
   bool isNCrystalInUse() const;
   const QVector<QString> getUndefinedParticles(QJsonObject & matJson);
 
@@ -5,6 +5,7 @@
 #include "ageneralsimsettings.h"
 #include "agammarandomgenerator.h"
 #include "acustomrandomsampling.h"
+#include "acommonfunctions.h"
 
 #include <QDebug>
 
@@ -30,13 +31,11 @@ void AOneEvent::configure(const AGeneralSimSettings *simSet)
     SiPMpixels.resize(numPMs);
     for (int ipm = 0; ipm < numPMs; ipm++)
     {
-        QBitArray sipmPixels;
         const APmType *type = PMs->getTypeForPM(ipm);
-        if(type->SiPM)
-        {
-             sipmPixels = QBitArray((SimSet->fTimeResolved ? SimSet->TimeBins : 1) * type->PixelsX * type->PixelsY);
-             SiPMpixels[ipm] = sipmPixels;
-        }
+        if (type->SiPM)
+            SiPMpixels[ipm].configure((SimSet->fTimeResolved ? SimSet->TimeBins : 1), type->PixelsX, type->PixelsY);
+        else
+            SiPMpixels[ipm] = ASiPMMicrocells();
     }
     AOneEvent::clearHits(); //clears and resizes the hits / signals containers
 }
@@ -76,7 +75,7 @@ void AOneEvent::clearHits()
               TimedPMsignals[itime][ipm] = 0;
           }
 
-      SiPMpixels[ipm].fill(false);
+      SiPMpixels[ipm].clear(); //only the fired cells are reset
   }
 }
 
@@ -89,12 +88,8 @@ bool AOneEvent::CheckPMThit(int ipm, double time, int WaveIndex, double x, doubl
       iTime = AOneEvent::TimeToBin(time);
       if (iTime == -1) return false;
     }
-  //cheking vs photon detection efficiency
-  double DetProbability = PMs->getActualPDE(ipm, WaveIndex);
-  //checking vs angular response
-  DetProbability *= PMs->getActualAngularResponse(ipm, cosAngle);
-  //checking vs area response
-  DetProbability *= PMs->getActualAreaResponse(ipm, x, y);
+  //cheking vs photon detection efficiency, angular and area response
+  const double DetProbability = PMs->getDetectionProbability(ipm, WaveIndex, cosAngle, x, y);
   if (rnd > DetProbability)  //random number is provided by the tracker - done for the accelerator function
       return false;
 
@@ -115,13 +110,8 @@ bool AOneEvent::CheckSiPMhit(int ipm, double time, int WaveIndex, double x, doub
       iTime = AOneEvent::TimeToBin(time);
       if (iTime == -1) return false;
     }
-  //cheking vs photon detection efficiency
-  double DetProbability = 1;
-  DetProbability *= PMs->getActualPDE(ipm, WaveIndex);
-  //checking vs angular response
-  DetProbability *= PMs->getActualAngularResponse(ipm, cosAngle);
-  //checking vs area response
-  DetProbability *= PMs->getActualAreaResponse(ipm, x, y);
+  //cheking vs photon detection efficiency, angular and area response
+  const double DetProbability = PMs->getDetectionProbability(ipm, WaveIndex, cosAngle, x, y);
   //    qDebug()<<"composite detection probability: "<<DetProbability;
   if (rnd > DetProbability) //random number is provided by the tracker - done for the accelerator function
       return false;
@@ -162,32 +152,25 @@ void AOneEvent::registerSiPMhit(int ipm, int iTime, int binX, int binY, float nu
 //numHits != 1 is used 1) for the simplistic model of microcell cross-talk -> then MCmodel = 0
 //                     2) to simulate dark counts in advanced model (MCmodel = 1)
 {
-  const APmType* tp = PMs->getTypeForPM(ipm);
-
-  if (!SimSet->fTimeResolved)
-  {
-      const int iXY = tp->PixelsX*binY + binX;
-      if (SiPMpixels[ipm].testBit(iXY)) return;  //nothing to do - already lit
+  BatchCells.clear();
+  BatchHits.clear();
+  BatchCells.push_back(binY * PMs->getTypeForPM(ipm)->PixelsX + binX);
+  BatchHits.push_back(numHits);
+  registerSiPMbatch(ipm, iTime);
+}
 
-      //registering hit
-      SiPMpixels[ipm].setBit(iXY, true);
-      PMhits[ipm] += numHits;
+void AOneEvent::registerSiPMbatch(int ipm, int iTime)
+{
+  const APmType* tp = PMs->getTypeForPM(ipm);
+  const int pixelsX = tp->PixelsX;
+  const int pixelsY = tp->PixelsY;
+  const bool bCrossTalk = ( PMs->isDoMCcrosstalk()  &&  PMs->at(ipm).MCmodel == 1 );
+  const double trigProb = ( bCrossTalk ? PMs->at(ipm).MCtriggerProb : 0 );
 
-      if (PMs->isDoMCcrosstalk()  &&  PMs->at(ipm).MCmodel == 1)
-      {
-          //checking 4 neighbours
-          const double& trigProb = PMs->at(ipm).MCtriggerProb;
-          if (binX > 0             && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX-1, binY, numHits);//left
-          if (binX+1 < tp->PixelsX && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX+1, binY, numHits);//right
-          if (binY > 0             && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX, binY-1, numHits);//bottom
-          if (binY+1 < tp->PixelsY && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX, binY+1, numHits);//top
-      }
-  }
-  else
+  int iTimeStart = 0;
+  int imax = 1;
+  if (SimSet->fTimeResolved)
   {
-      const int timeBinInterval = tp->PixelsX * tp->PixelsY;
-      const int iTXY = iTime*timeBinInterval + tp->PixelsX*binY + binX;
-
       //have to check status of pixel during the recovery time from iTime and register hit in each "non-lit" time bins
       const int Tbins = SimSet->TimeBins < 1 ? 1 : SimSet->TimeBins; //protection
       int bins = tp->RecoveryTime * Tbins / (SimSet->TimeTo - SimSet->TimeFrom);  //time bins during which the pixel keeps lit status
@@ -195,28 +178,42 @@ void AOneEvent::registerSiPMhit(int ipm, int iTime, int binX, int binY, float nu
 
       //Simplified model is used!
       //"later"-emitted photons can appear before "earlier"-emitted photons - overlaps in fired pixels will be wrong at ~saturation conditions!
+      iTimeStart = iTime;
+      imax = (bins <= SimSet->TimeBins-iTime) ? bins : SimSet->TimeBins-iTime;
+  }
+
+  //cells fired by cross-talk (advanced model) form the next batch with the same start time bin
+  while (!BatchCells.empty())
+  {
+      NextBatchCells.clear();
+      NextBatchHits.clear();
+      BatchFired.resize(BatchCells.size());
 
-      const int imax = (bins <= SimSet->TimeBins-iTime) ? bins : SimSet->TimeBins-iTime;
       for (int itime = 0; itime < imax; itime++)
       {
-          if (!SiPMpixels[ipm].testBit(iTXY+itime*timeBinInterval)) //not yet lit here
+          const int numFired = SiPMpixels[ipm].fire(iTimeStart+itime, BatchCells.data(), BatchCells.size(), BatchFired.data());
+          for (int i = 0; i < numFired; i++)
           {
-              //registering the hit
-              SiPMpixels[ipm].setBit(iTXY+itime*timeBinInterval, true);
+              const int   iCell   = BatchCells[BatchFired[i]];
+              const float numHits = BatchHits[BatchFired[i]];
               PMhits[ipm] += numHits;
-              TimedPMhits[iTime+itime][ipm] += numHits;
+              if (SimSet->fTimeResolved) TimedPMhits[iTimeStart+itime][ipm] += numHits;
 
-              if (PMs->isDoMCcrosstalk()  &&  PMs->at(ipm).MCmodel == 1)
+              if (bCrossTalk)
               {
                   //checking 4 neighbours
-                  const double& trigProb = PMs->at(ipm).MCtriggerProb;
-                  if (binX > 0             && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX-1, binY, numHits);//left
-                  if (binX+1 < tp->PixelsX && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX+1, binY, numHits);//right
-                  if (binY > 0             && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX, binY-1, numHits);//bottom
-                  if (binY+1 < tp->PixelsY && RandGen->Rndm() < trigProb) registerSiPMhit(ipm, iTime, binX, binY+1, numHits);//top
+                  const int binX = iCell % pixelsX;
+                  const int binY = iCell / pixelsX;
+                  if (binX > 0         && RandGen->Rndm() < trigProb) {NextBatchCells.push_back(iCell - 1);       NextBatchHits.push_back(numHits);} //left
+                  if (binX+1 < pixelsX && RandGen->Rndm() < trigProb) {NextBatchCells.push_back(iCell + 1);       NextBatchHits.push_back(numHits);} //right
+                  if (binY > 0         && RandGen->Rndm() < trigProb) {NextBatchCells.push_back(iCell - pixelsX); NextBatchHits.push_back(numHits);} //bottom
+                  if (binY+1 < pixelsY && RandGen->Rndm() < trigProb) {NextBatchCells.push_back(iCell + pixelsX); NextBatchHits.push_back(numHits);} //top
               }
           }
-        }
+      }
+
+      BatchCells.swap(NextBatchCells);
+      BatchHits.swap(NextBatchHits);
   }
 }
 
@@ -281,7 +278,7 @@ void AOneEvent::convertHitsToSignal(const QVector<float> & pmHits, QVector<float
                 if ( pm.SPePHShist )
                 {
                     for (int j = 0; j < pmHits.at(ipm); j++)
-                        pmSignals[ipm] += pm.SPePHShist->GetRandom();
+                        pmSignals[ipm] += GetRandomFromHist(pm.SPePHShist, RandGen);
                 }
               }
             }
@@ -342,6 +339,8 @@ void AOneEvent::AddDarkCounts() //currently applicable only for SiPMs!
                 {
                   int DarkCounts = RandGen->Poisson(averageDarkCounts);
                   //    qDebug() << "Actual dark counts" << DarkCounts;
+                  BatchCells.clear();
+                  BatchHits.clear();
                   for (int iev = 0; iev < DarkCounts; iev++)
                     {
                       int iX = pixelsX * RandGen->Rndm();
@@ -350,21 +349,38 @@ void AOneEvent::AddDarkCounts() //currently applicable only for SiPMs!
                       if (iY >= pixelsY) iY = pixelsY-1;
                       //   qDebug()<<"Pixels:"<<iX<<iY;
 
-                      registerSiPMhit(ipm, iTime, iX, iY, generateDarkHitIncrement(ipm));
+                      BatchCells.push_back(iY * pixelsX + iX);
+                      BatchHits.push_back(generateDarkHitIncrement(ipm));
                     }
+                  registerSiPMbatch(ipm, iTime);
                 }
             }
           else
             {
-              //slow but accurate procedure
+              //accurate procedure: every cell fires with pixelFiringProbability
+              //the distance to the next firing cell is sampled from the geometric distribution, so only the firing cells are visited
+              const int numCells = pixelsX * pixelsY;
+              const double logNoFire = ( pixelFiringProbability < 1.0 ? log(1.0 - pixelFiringProbability) : 0 );
               for (int iTime = 0; iTime<iTimeBins; iTime++)
                 {
-                  for (int iX = 0; iX<pixelsX; iX++)
-                      for (int iY = 0; iY<pixelsY; iY++)
+                  BatchCells.clear();
+                  BatchHits.clear();
+                  int iCell = -1;
+                  while (true)
+                    {
+                      if (logNoFire == 0) iCell++; //all cells fire
+                      else
                         {
-                          if (RandGen->Rndm() < pixelFiringProbability)
-                              registerSiPMhit(ipm, iTime, iX, iY, generateDarkHitIncrement(ipm));
+                          const double skip = log(1.0 - RandGen->Rndm()) / logNoFire;
+                          if (skip >= numCells - iCell) break;
+                          iCell += 1 + (int)skip;
                         }
+                      if (iCell >= numCells) break;
+
+                      BatchCells.push_back(iCell);
+                      BatchHits.push_back(generateDarkHitIncrement(ipm));
+                    }
+                  registerSiPMbatch(ipm, iTime);
                 }
             }
       }
@@ -1,8 +1,11 @@
 #ifndef AONEEVENT_H
 #define AONEEVENT_H
 
+#include "asipmmicrocells.h"
+
 #include <QVector>
-#include <QBitArray>
+
+#include <vector>
 
 class APmHub;
 class TRandom2;
@@ -20,7 +23,7 @@ public:
   QVector<QVector<float> > TimedPMsignals;   // -- convrted to signal  [timeBin][PMnumber]
   QVector<float>           PMhits;           // PM hits [pm]
   QVector<float>           PMsignals;        // -- converted to signal [pm]
-  QVector< QBitArray >     SiPMpixels;       //on/off status of SiPM pixels [PM#] [time] [pixY] [pixX]
+  QVector<ASiPMMicrocells> SiPMpixels;       //on/off status of SiPM pixels [PM#] [time] [pixY] [pixX], empty for PMTs
 
   ASimulationStatistics*   SimStat;
 
@@ -48,7 +51,13 @@ private:
   const AGeneralSimSettings *SimSet;
   int numPMs;
 
+  //SiPM cells to register in one batch: cell index (iY * pixelsX + iX) and the number of hits to add when the cell fires
+  std::vector<int>   BatchCells, NextBatchCells;
+  std::vector<float> BatchHits,  NextBatchHits;
+  std::vector<int>   BatchFired;
+
   void  registerSiPMhit(int ipm, int iTime, int binX, int binY, float numHits = 1.0f); // numHits != 1 for two cases: 1) simplistic model of microcell cross-talk  2) advanced model of dark counts
+  void  registerSiPMbatch(int ipm, int iTime);  // registers and empties BatchCells / BatchHits
   void  AddDarkCounts();
   void  convertHitsToSignal(const QVector<float>& pmHits, QVector<float>& pmSignals);
   float generateDarkHitIncrement(int ipm) const;
@@ -10,6 +10,7 @@
 
 //Qt
 #include <QVector>
+#include <QHash>
 #include <QDebug>
 #include <QFile>
 #include <QTextStream>
@@ -306,6 +307,8 @@ void APmHub::configure(AGeneralSimSettings *SimSet)
     RebinPDEs(); //rebin or clear
     //calculating binned angular
     RecalculateAngular(); //rebin or clear
+    //flat detection tables used by the photon tracer
+    prepareDetectionTables();
     // MaxQE accelerator
     if (SimSet->fQEaccelerator) calculateMaxQEs();
     //if PHS are configured, prepare histograms
@@ -407,6 +410,69 @@ void APmHub::calculateMaxQEs()
      //qDebug()<<"MaxQE ="<< MaxQE;
 }
 
+void APmHub::prepareDetectionTables()
+{
+    const int rowSize = 1 + (WavelengthResolved ? WaveNodes : 0);
+    DetRecords.resize(numPMs);
+    DetPDE.resize(numPMs * rowSize);
+    DetAngular.clear();
+    DetArea.clear();
+
+    //PMs of the same type share the angular table and the area map
+    QHash<const void*, int> angularOffsets;
+    QHash<const void*, int> areaOffsets;
+
+    for (int ipm = 0; ipm < numPMs; ipm++)
+    {
+        const APm & pm = PMs.at(ipm);
+        const APmType * typ = PMtypes.at(pm.type);
+        ADetectionRecord & r = DetRecords[ipm];
+
+        r.PDEoffset = ipm * rowSize;
+        DetPDE[r.PDEoffset] = getActualPDE(ipm, -1);
+        for (int iWave = 0; iWave < rowSize - 1; iWave++)
+            DetPDE[r.PDEoffset + 1 + iWave] = getActualPDE(ipm, iWave);
+
+        r.AngularOffset = -1;
+        if (AngularResolved)
+        {
+            const QVector<double> & ang = ( !pm.AngularSensitivityCosRefracted.isEmpty() ? pm.AngularSensitivityCosRefracted : typ->AngularSensitivityCosRefracted );
+            if (!ang.isEmpty())
+            {
+                auto it = angularOffsets.find(&ang);
+                if (it == angularOffsets.end())
+                {
+                    it = angularOffsets.insert(&ang, DetAngular.size());
+                    DetAngular << ang;
+                }
+                r.AngularOffset = it.value();
+            }
+        }
+
+        r.AreaOffset = -1;
+        if (AreaResolved)
+        {
+            const bool bOverride = !pm.AreaSensitivity.isEmpty();
+            const QVector<QVector<double>> & area = ( bOverride ? pm.AreaSensitivity : typ->AreaSensitivity );
+            if (!area.isEmpty())
+            {
+                r.AreaNumX = area.size();
+                r.AreaNumY = area.at(0).size();
+                r.AreaInvStepX = 1.0 / ( bOverride ? pm.AreaStepX : typ->AreaStepX );
+                r.AreaInvStepY = 1.0 / ( bOverride ? pm.AreaStepY : typ->AreaStepY );
+
+                auto it = areaOffsets.find(&area);
+                if (it == areaOffsets.end())
+                {
+                    it = areaOffsets.insert(&area, DetArea.size());
+                    for (const QVector<double> & column : area) DetArea << column;
+                }
+                r.AreaOffset = it.value();
+            }
+        }
+    }
+}
+
 void APmHub::clear() //does not affect PM types!
 {
     for (APm& pm : PMs) pm.clearSPePHSCustomDist();
@@ -559,7 +625,7 @@ double APmHub::GenerateSignalFromOnePhotoelectron(int ipm)
         break;
     case 3:
         if ( pm.SPePHShist )
-            val = pm.SPePHShist->GetRandom();
+            val = GetRandomFromHist(pm.SPePHShist, RandGen);
         break;
     default:
         qWarning() << "Error: unrecognized type in signal per photoelectron generation";
@@ -55,6 +55,7 @@ public:
     double getActualPDE(int ipm, int WaveIndex) const; //returns partial probability to be detected (wave-resolved PDE)
     double getActualAngularResponse(int ipm, double cosAngle) const; //returns partial probability to be detected (vs angular response - cos of refracted beam)
     double getActualAreaResponse(int ipm, double x, double y); //returns partial probability to be detected (vs area response - x, y in local coordinates of the PM)
+    inline double getDetectionProbability(int ipm, int WaveIndex, double cosAngle, double x, double y) const; //product of the three above, from the tables prepared in configure()
 
     int count() const {return numPMs;} //returns number of PMs
     void clear();
@@ -181,6 +182,44 @@ private:
 
     void writeRelQE_PDE(QJsonObject &json);
     void readRelQE_PDE(QJsonObject &json);
+
+    // detection tables, prepared in configure(): the response is separable in wavelength, angle and area,
+    // so every PM has a PDE row and (shared with the other PMs using the same data) an angular table and an area map
+    struct ADetectionRecord
+    {
+        int    PDEoffset     = 0;  // row in DetPDE: [0] - not wave-resolved, [1 + iWave] - wave-resolved
+        int    AngularOffset = -1; // table in DetAngular (CosBins values), -1 - no angular dependence
+        int    AreaOffset    = -1; // map in DetArea (AreaNumX x AreaNumY values, x-major), -1 - no area dependence
+        int    AreaNumX      = 0;
+        int    AreaNumY      = 0;
+        double AreaInvStepX  = 0;
+        double AreaInvStepY  = 0;
+    };
+    QVector<ADetectionRecord> DetRecords;
+    QVector<double> DetPDE;
+    QVector<double> DetAngular;
+    QVector<double> DetArea;
+    void prepareDetectionTables(); // after rebinning of PDE and angular data
 };
 
+inline double APmHub::getDetectionProbability(int ipm, int WaveIndex, double cosAngle, double x, double y) const
+{
+    const ADetectionRecord & r = DetRecords.at(ipm);
+
+    double prob = DetPDE.at(r.PDEoffset + (WavelengthResolved ? WaveIndex + 1 : 0));
+
+    if (r.AngularOffset != -1)
+        prob *= DetAngular.at(r.AngularOffset + (int)(cosAngle * (CosBins-1)));
+
+    if (r.AreaOffset != -1)
+    {
+        const int iX = x * r.AreaInvStepX + 0.5 * r.AreaNumX;
+        const int iY = y * r.AreaInvStepY + 0.5 * r.AreaNumY;
+        if (iX < 0 || iX >= r.AreaNumX || iY < 0 || iY >= r.AreaNumY) return 0; //outside
+        prob *= DetArea.at(r.AreaOffset + iX * r.AreaNumY + iY);
+    }
+
+    return prob;
+}
+
 #endif // APMHUB_H
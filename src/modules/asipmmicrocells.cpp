@@ -0,0 +1,70 @@
+#include "asipmmicrocells.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+
+void ASiPMMicrocells::configure(int numTimeBins, int pixelsX, int pixelsY)
+{
+    NumTimeBins = std::max(1, numTimeBins);
+    PixelsX = pixelsX;
+    PixelsY = pixelsY;
+    WordsPerTimeBin = (PixelsX * PixelsY + 63) / 64;
+
+    Words.assign(NumTimeBins * WordsPerTimeBin, 0);
+    DirtyWords.clear();
+}
+
+void ASiPMMicrocells::clear()
+{
+    // at high occupancy the plain fill is cheaper than the scattered reset
+    if (DirtyWords.size() > Words.size() / 4)
+        std::fill(Words.begin(), Words.end(), 0);
+    else
+        for (int iWord : DirtyWords) Words[iWord] = 0;
+
+    DirtyWords.clear();
+}
+
+int ASiPMMicrocells::fire(int iTime, const int * cells, int numCells, int * newlyFired)
+{
+    const int firstWord = iTime * WordsPerTimeBin;
+    quint64 * words = Words.data() + firstWord;
+
+    int num = 0;
+    for (int i = 0; i < numCells; i++)
+    {
+        const int iCell = cells[i];
+        quint64 & word = words[iCell >> 6];
+        const quint64 mask = quint64(1) << (iCell & 63);
+        if (word & mask) continue;
+
+        if (word == 0) DirtyWords.push_back(firstWord + (iCell >> 6));
+        word |= mask;
+        newlyFired[num++] = i;
+    }
+    return num;
+}
+
+bool ASiPMMicrocells::isFired(int iTime, int iX, int iY) const
+{
+    const int iCell = iY * PixelsX + iX;
+    return Words[iTime * WordsPerTimeBin + (iCell >> 6)] & (quint64(1) << (iCell & 63));
+}
+
+int ASiPMMicrocells::countFired(int iTime) const
+{
+    int num = 0;
+    const quint64 * word = Words.data() + iTime * WordsPerTimeBin;
+    for (int i = 0; i < WordsPerTimeBin; i++)
+        num += qPopulationCount(word[i]);
+    return num;
+}
+
+int ASiPMMicrocells::countFired() const
+{
+    int num = 0;
+    for (int iWord : DirtyWords)
+        num += qPopulationCount(Words[iWord]);
+    return num;
+}
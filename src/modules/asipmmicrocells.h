@@ -0,0 +1,56 @@
+#ifndef ASIPMMICROCELLS_H
+#define ASIPMMICROCELLS_H
+
+#include <QtGlobal>
+
+#include <vector>
+
+// Fired status of the microcells of one SiPM [time][pixY][pixX], one bit per microcell
+// Every time bin starts at a word boundary. Words modified since the last clear() are tracked,
+// so clear() costs O(fired cells) and not O(cells x time bins)
+class ASiPMMicrocells
+{
+public:
+    void configure(int numTimeBins, int pixelsX, int pixelsY);
+    void clear();
+
+    bool isEmpty() const {return Words.empty();}  // not a SiPM
+    int  getPixelsX() const {return PixelsX;}
+    int  getPixelsY() const {return PixelsY;}
+    int  getNumTimeBins() const {return NumTimeBins;}
+
+    // returns false if the cell is already fired in this time bin
+    inline bool fire(int iTime, int iX, int iY);
+    // batch version, iCell = iY * pixelsX + iX; the positions in cells[] of those which were not yet fired
+    // are written to newlyFired[] (same capacity as cells), returns their number
+    int  fire(int iTime, const int * cells, int numCells, int * newlyFired);
+    bool isFired(int iTime, int iX, int iY) const;
+
+    int  countFired(int iTime) const;
+    int  countFired() const;
+
+private:
+    int PixelsX = 0;
+    int PixelsY = 0;
+    int NumTimeBins = 0;
+    int WordsPerTimeBin = 0;
+
+    std::vector<quint64> Words;
+    std::vector<int>     DirtyWords;  // indexes of the words with fired cells
+};
+
+inline bool ASiPMMicrocells::fire(int iTime, int iX, int iY)
+{
+    const int iCell = iY * PixelsX + iX;
+    const int iWord = iTime * WordsPerTimeBin + (iCell >> 6);
+    const quint64 mask = quint64(1) << (iCell & 63);
+
+    quint64 & word = Words[iWord];
+    if (word & mask) return false;
+
+    if (word == 0) DirtyWords.push_back(iWord);
+    word |= mask;
+    return true;
+}
+
+#endif // ASIPMMICROCELLS_H
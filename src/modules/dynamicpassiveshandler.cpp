@@ -53,6 +53,7 @@ void DynamicPassivesHandler::init(ReconstructionSettings *RecSet, int ThisPmGrou
       fByDistance =  false;
       break;
     case 4:
+    case 6: //CG on CPU with SIMD uses CUDA settings
       {
         QJsonObject json= RecSet->CGonCUDAsettings;
         if (json.contains("Passives")) //old system - compatibility
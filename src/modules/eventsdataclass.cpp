@@ -4,6 +4,8 @@
 #include "apreprocessingsettings.h"
 #include "apmhub.h"
 #include "aeventtrackingrecord.h"
+#include "aeventfile.h"
+#include "aeventframe.h"
 
 //Root
 #include "TTree.h"
@@ -16,6 +18,9 @@
 #include <QFileInfo>
 #include <QtWidgets/QApplication>
 
+#include <algorithm>
+#include <memory>
+
 EventsDataClass::EventsDataClass(const TString nameID) //nameaddon to make unique hist names in multithread
  : QObject()
 {
@@ -146,19 +151,24 @@ void EventsDataClass::purge1e10events()
   if (Scan.size() != Events.size()) return;
   bool fTime = ( TimedEvents.size() == Events.size() );
 
-  int i = 0;
-  while (i < Scan.size())  // reverse order? ***!!!
+  int iposition = 0;
+  for (int i = 0; i < Scan.size(); i++)
   {
       if (Scan.at(i)->Points.size() != 0 && Scan.at(i)->Points[0].r[0] == 1e10 && Scan.at(i)->Points[0].r[1] == 1e10 )
+          continue; //qDebug() << "Found one";
+
+      if (i != iposition)
       {
-          //qDebug() << "Found one";
-          Scan.removeAt(i);
-          Events.removeAt(i);
-          if (fTime) TimedEvents.removeAt(i);
+          Scan[iposition] = Scan[i];
+          Events.copyEvent(i, iposition);
+          if (fTime) TimedEvents.copyEvent(i, iposition);
       }
-      else
-        i++;
+      iposition++;
   }
+
+  Scan.resize(iposition);
+  Events.resize(iposition);
+  if (fTime) TimedEvents.resize(iposition);
 }
 
 bool EventsDataClass::BlurReconstructionData(int type, double sigma, TRandom2* RandGen, int igroup)
@@ -281,8 +291,8 @@ void EventsDataClass::PurgeFilteredEvents(int igroup)
       if (iev != iposition)
         {
           //move
-          Events[iposition] = Events[iev];
-          if (fDoTimed) TimedEvents[iposition] = TimedEvents[iev];
+          Events.copyEvent(iev, iposition);
+          if (fDoTimed) TimedEvents.copyEvent(iev, iposition);
           if (fDoScan)  Scan[iposition] = Scan[iev];
           for (int ig=0; ig<ReconstructionData.size(); ig++)
             ReconstructionData[ig][iposition] = ReconstructionData[ig][iev];
@@ -327,8 +337,8 @@ void EventsDataClass::Purge(int OnePer, int igroup)
       if (iev != iposition)
         {
           //move
-          Events[iposition] = Events[iev];
-          if (fDoTimed) TimedEvents[iposition] = TimedEvents[iev];
+          Events.copyEvent(iev, iposition);
+          if (fDoTimed) TimedEvents.copyEvent(iev, iposition);
           if (fDoScan)  Scan[iposition] = Scan[iev];
           for (int ig=0; ig<ReconstructionData.size(); ig++)
             ReconstructionData[ig][iposition] = ReconstructionData[ig][iev];
@@ -429,23 +439,23 @@ void EventsDataClass::resetReconstructionData(int numGroups)
 int EventsDataClass::getTimeBins() const
 {
   if (TimedEvents.isEmpty()) return 0;
-  return TimedEvents[0].size();
+  return TimedEvents.getNumTimeBins();
 }
 
 int EventsDataClass::getNumPMs() const
 {
     if (Events.isEmpty()) return 0;
-    return Events.first().size();
+    return Events.getNumChannels();
 }
 
-const QVector<float> *EventsDataClass::getEvent(int iev) const
+AConstEventSpan EventsDataClass::getEvent(int iev) const
 {
-  return &Events.at(iev);
+  return Events.at(iev);
 }
 
-const QVector<QVector<float> > *EventsDataClass::getTimedEvent(int iev)
+AConstEventSpan EventsDataClass::getTimedEvent(int iev, int iTimeBin) const
 {
-    return &TimedEvents.at(iev);
+    return TimedEvents.atTimeBin(iev, iTimeBin);
 }
 
 int EventsDataClass::countGoodEvents(int igroup) const //counts events passing all filters
@@ -512,7 +522,12 @@ bool EventsDataClass::packEventsToByteArray(int from, int to, QByteArray& ba) co
     out << to - from;
     out << getNumPMs();
     for (int ievent = from; ievent < to; ievent++)
-        out << Events.at(ievent);
+    {
+        //same stream format as QVector<float>
+        const AConstEventSpan event = Events.at(ievent);
+        out << (quint32)event.size();
+        for (const float & sig : event) out << sig;
+    }
 
     return true;
 }
@@ -532,11 +547,19 @@ bool EventsDataClass::unpackEventsFromByteArray(const QByteArray &ba)
     in >> numPMs;
 
     clear();
+    Events.setDimensions(numPMs);
     Events.resize(events);
     for (int iev=0; iev<events; iev++)
     {
-        Events[iev].resize(numPMs);
-        in >> Events[iev];
+        quint32 size;
+        in >> size;
+        AEventSpan event = Events[iev];
+        for (quint32 i = 0; i < size; i++)
+        {
+            float sig;
+            in >> sig;
+            if ((int)i < numPMs) event[i] = sig;
+        }
     }
 
     createDefaultReconstructionData(0);
@@ -581,6 +604,39 @@ bool EventsDataClass::unpackReconstructedFromByteArray(int from, int to, const Q
     return true;
 }
 
+bool EventsDataClass::appendFromEventFrame(const AEventFrame &frame)
+{
+    bool bOK = false;
+    switch (frame.getType())
+    {
+    case AEventFrame::Events:
+        if (frame.isFirst()) clear();
+        bOK = frame.appendEvents(Events);
+        if (bOK && frame.isLast())
+        {
+            createDefaultReconstructionData(0);
+            emit requestEventsGuiUpdate();        //in the rare case server is with gui
+        }
+        break;
+    case AEventFrame::TimedEvents:
+        if (frame.isFirst()) TimedEvents.clear();
+        bOK = frame.appendEvents(TimedEvents);
+        break;
+    case AEventFrame::Scan:
+        if (frame.isFirst()) clearScan();
+        bOK = frame.appendScan(Scan);
+        break;
+    default:;
+    }
+    return bOK;
+}
+
+bool EventsDataClass::setReconstructedFromEventFrame(int from, const AEventFrame &frame)
+{
+    if (ReconstructionData.isEmpty()) return false;
+    return frame.setReconstruction(ReconstructionData[0], from);
+}
+
 void EventsDataClass::copyTrueToReconstructed(int igroup)
 {
   if (Scan.isEmpty()) return;
@@ -955,11 +1011,11 @@ bool EventsDataClass::saveSimulationAsTree(QString fileName)
   TFile* f = new TFile(c_str,"recreate");
   TTree *tree = new TTree("SimulationTree","Simulation data");
 
-  int numPMs = (Events.size()>0) ? Events[0].size() : 0;
+  int numPMs = Events.getNumChannels();
   int tbins = 1;
   if (isTimed())
     if (Events.size()>0)
-      tbins = TimedEvents[0].size();
+      tbins = TimedEvents.getNumTimeBins();
   //qDebug()<<"time bins:"<<tbins;
   std::vector <double> x;
   std::vector <double> y;
@@ -997,12 +1053,15 @@ bool EventsDataClass::saveSimulationAsTree(QString fileName)
 
   for (iev=0; iev<Events.size(); iev++)
     {
-      for (int ipm=0; ipm<numPMs; ipm++) signal[ipm] = Events[iev][ipm];
+      const AConstEventSpan event = Events.at(iev);
+      std::copy(event.begin(), event.end(), signal);
 
       if (isTimed())
-        for (int ipm=0; ipm<numPMs; ipm++)
-          for (int itime=0; itime<tbins; itime++)
-            signalTimed[itime][ipm] = TimedEvents[iev][itime][ipm];
+        for (int itime=0; itime<tbins; itime++)
+          {
+            const AConstEventSpan bin = TimedEvents.atTimeBin(iev, itime);
+            std::copy(bin.begin(), bin.begin() + std::min(numPMs, bin.size()), signalTimed[itime].begin());
+          }
 
       if (!Scan.isEmpty())
         {
@@ -1053,8 +1112,8 @@ bool EventsDataClass::saveSimulationAsText(const QString& fileName, bool addNumP
     }
   int size = Events.size();
   bool fTimed = isTimed();
-  int numPMs = (size>0) ? Events[0].size() : 0;
-  int tbins = (fTimed) ? TimedEvents[0].size() : 1;
+  int numPMs = Events.getNumChannels();
+  int tbins = (fTimed) ? TimedEvents.getNumTimeBins() : 1;
 
   QTextStream outStream(&outputFile);
   if (fTimed) outStream<<"Time bins "<<tbins<<"\r\n";  //header!
@@ -1064,7 +1123,7 @@ bool EventsDataClass::saveSimulationAsText(const QString& fileName, bool addNumP
       {
         if (fTimed)
           for (int ipm=0; ipm<numPMs; ipm++)
-            outStream << TimedEvents[iev][itime][ipm]<<" ";
+            outStream << TimedEvents.atTimeBin(iev, itime)[ipm]<<" ";
         else
           for (int ipm=0; ipm<numPMs; ipm++)
             outStream << Events[iev][ipm]<<" ";
@@ -1090,6 +1149,34 @@ bool EventsDataClass::saveSimulationAsText(const QString& fileName, bool addNumP
   return true;
 }
 
+bool EventsDataClass::saveSimulationAsBinary(const QString &fileName, bool bAppend)
+{
+  ErrorString = "";
+  const bool bTimed = isTimed();
+  const bool bScan = !Scan.isEmpty();
+
+  AEventFile file;
+  if (!file.create(fileName, Events.getNumChannels(), (bTimed ? TimedEvents.getNumTimeBins() : 0), bScan, ScanNumberOfRuns, bAppend))
+    {
+      ErrorString = file.ErrorString;
+      qWarning() << ErrorString;
+      return false;
+    }
+
+  for (int iev=0; iev<Events.size(); iev++)
+    {
+      const AConstEventSpan timed = (bTimed ? TimedEvents.at(iev) : AConstEventSpan());
+      if (!file.append(Events.at(iev), timed, (bScan ? Scan.at(iev) : nullptr)))
+        {
+          ErrorString = file.ErrorString;
+          qWarning() << ErrorString;
+          return false;
+        }
+    }
+  file.close();
+  return true;
+}
+
 int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPreprocessJson, APmHub *PMs)
 {
   ErrorString = "";
@@ -1151,7 +1238,7 @@ int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPr
   else
     {
       if (TimedEvents.isEmpty()) Forced_tBins = 1;
-      else Forced_tBins = TimedEvents[0].size();
+      else Forced_tBins = TimedEvents.getNumTimeBins();
       //qDebug()<<"Forced tBins is "<<Forced_tBins;
       if (Forced_tBins == 1)
         {
@@ -1243,6 +1330,10 @@ int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPr
   double tmpEnergy;
   double positionX = 0, positionY = 0, positionZ = 0;
 
+  //tmp storage for one event [timeBin][PM], reused for all events
+  std::vector<float> tmp(tBins * DataSize);
+  if (TimedEvents.isEmpty()) TimedEvents.setDimensions(DataSize, tBins);
+
   while(!in.atEnd())
      {
         //Stop from GUI?
@@ -1263,15 +1354,7 @@ int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPr
 
         // reading and storing data to LoadedTimedEvents
         bool error = false;
-        //creating and shaping tmp storage   [timeBin][PM]
-        QVector< QVector <float> > tmp;
-        tmp.resize(tBins);
-        tmp.squeeze();
-        for (int t=0; t<tBins; t++)
-          {
-            tmp[t].resize(DataSize);
-            tmp[t].squeeze();
-          }
+        std::fill(tmp.begin(), tmp.end(), 0);
 
         tmpEnergy = 0; //accumulating loaded energy over all time bins
         for (int t=0; t<tBins; t++)
@@ -1359,9 +1442,9 @@ int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPr
                           if (val < PreprocessingSettings.ThresholdMin ) error = true;
                           if (val > PreprocessingSettings.ThresholdMax ) error = true;
                         }
-                      tmp[t][i] = (val + PMs->at(i).PreprocessingAdd) * PMs->at(i).PreprocessingMultiply;                      
+                      tmp[t*DataSize + i] = (val + PMs->at(i).PreprocessingAdd) * PMs->at(i).PreprocessingMultiply;
                     }
-                  else tmp[t][i] = val;
+                  else tmp[t*DataSize + i] = val;
                 }
 
             } //end cycle by channels
@@ -1377,7 +1460,7 @@ int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPr
                   if (eventNumber > PreprocessingSettings.ManifestItem->LimitEvents) break;
               }
 
-            TimedEvents.append(tmp); //adding event
+            TimedEvents.append(AConstEventSpan(tmp.data(), tmp.size())); //adding event
 
             if (LoadEnergy || LoadPosition || LoadZPosition)
               {
@@ -1408,16 +1491,16 @@ int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPr
    file.close();
 
    //calculating total, deleting LoadedEventsTimed if tBins = 1
+   if (Events.isEmpty()) Events.setDimensions(DataSize);
    Events.resize(AppendedFrom + numEvents);
    //   qDebug()<<"      numEvents, tBins, DataSize:"<<numEvents<<tBins<<DataSize;
    for (int iev=0; iev<numEvents; iev++)
      {
-       Events[AppendedFrom + iev].resize(DataSize);
-       Events[AppendedFrom + iev].squeeze();
-       for (int ipm = 0; ipm<DataSize; ipm++)
+       AEventSpan event = Events[AppendedFrom + iev];
+       for (int t=0; t<tBins; t++)
          {
-            Events[AppendedFrom + iev][ipm]=0;
-            for (int t=0; t<tBins; t++) Events[AppendedFrom + iev][ipm] += TimedEvents[AppendedTimedFrom + iev][t][ipm];
+            const AConstEventSpan bin = TimedEvents.atTimeBin(AppendedTimedFrom + iev, t);
+            for (int ipm = 0; ipm<DataSize; ipm++) event[ipm] += bin[ipm];
          }
 
        if (PreprocessingSettings.fManifest) // this mode can not be together with LoadPositions
@@ -1464,7 +1547,7 @@ int EventsDataClass::loadEventsFromTxtFile(QString fileName, QJsonObject &jsonPr
    if (Forced_tBins == 1)
      {
        // qDebug()<<"  Deleting unused time-resolved data...";
-       TimedEvents.resize(0);
+       TimedEvents.clear();
      }
    fLoadedEventsHaveEnergyInfo = LoadEnergy;
    if (PreprocessingSettings.fManifest)
@@ -1557,7 +1640,8 @@ bool EventsDataClass::overlayAsciiFile(QString fileName, bool fAddMulti, APmHub*
       fields = line.split(rx, QString::SkipEmptyParts);
       if (fields.isEmpty()) continue; //allow empty lines
 
-      for (int i=0; i<fields.count(); i++)
+      const int numChannels = std::min(fields.count(), Events.getNumChannels());
+      for (int i=0; i<numChannels; i++)
         {
           float delta = fields[i].toFloat();
           if (fAddMulti) delta = (delta + PMs->at(i).PreprocessingAdd) * PMs->at(i).PreprocessingMultiply;
@@ -1574,16 +1658,86 @@ bool EventsDataClass::overlayAsciiFile(QString fileName, bool fAddMulti, APmHub*
 
 void EventsDataClass::addEmptyEvents(int numEmptyEvents, int numPMs, int numTimeBins)
 {
-    QVector<float> event(numPMs, 0);
-    Events = QVector<QVector<float>>(numEmptyEvents, event); // event pm
+    Events.setDimensions(numPMs);
+    Events.resize(numEmptyEvents); // event pm
 
     if (numTimeBins != 1)
     {
-        QVector<QVector<float>> timeEvent(numTimeBins, event);
-        TimedEvents = QVector<QVector<QVector<float>>>(numEmptyEvents, timeEvent); //event timebin pm
+        TimedEvents.setDimensions(numPMs, numTimeBins);
+        TimedEvents.resize(numEmptyEvents); //event timebin pm
     }
 }
 
+int EventsDataClass::loadEventsFromBinaryFile(const QString &fileName, const APmHub &PMs, int maxEvents)
+{
+  ErrorString = "";
+  std::shared_ptr<AEventFile> file(new AEventFile());
+  if (!file->open(fileName))
+    {
+      ErrorString = file->ErrorString;
+      qWarning() << ErrorString;
+      return -1;
+    }
+
+  const int numPMs = PMs.count();
+  if (file->getNumChannels() != numPMs)
+    {
+      ErrorString = "Error: File contains a different number of PMs than this detector configuration!";
+      qWarning() << ErrorString;
+      return -1;
+    }
+
+  const bool FirstDataSet = Events.isEmpty();
+  if (!FirstDataSet)
+    {
+      if (Events.getNumChannels() != numPMs)
+        ErrorString = "Cannot append: already loaded events have a different number of channels!";
+      else if (!Scan.isEmpty() && !file->hasScan())
+        ErrorString = "Binary file cannot be loaded - no required scan data present!";
+      else if (isTimed() != file->isTimed() || (file->isTimed() && TimedEvents.getNumTimeBins() != file->getNumTimeBins()))
+        ErrorString = "Cannot append: time bins of the file and of the already loaded events are different!";
+      if (!ErrorString.isEmpty())
+        {
+          qWarning() << ErrorString;
+          return -1;
+        }
+    }
+
+  int numEv = file->getNumEvents();
+  if (maxEvents > 0 && maxEvents < numEv) numEv = maxEvents;
+  const bool bScan = file->hasScan() && (FirstDataSet || !Scan.isEmpty());
+  if (file->hasScan() && !bScan) qWarning() << "Ignoring scan data in this file!";
+  if (bScan)
+    {
+      Scan.reserve(Scan.size() + numEv);
+      for (int iev=0; iev<numEv; iev++)
+        {
+          AScanRecord* scs = new AScanRecord();
+          file->readScan(iev, *scs);
+          Scan.append(scs);
+        }
+      ScanNumberOfRuns = file->getNumRuns();
+    }
+
+  // signals are not copied: the stores point to the mapped file, which is kept open while they use it
+  AEventStore mapped;
+  mapped.setExternal(file->getSignals(), numEv, file->getStride(), numPMs, 1, file);
+  if (FirstDataSet) Events = std::move(mapped);
+  else Events.append(mapped);
+
+  if (file->isTimed())
+    {
+      AEventStore mappedTimed;
+      mappedTimed.setExternal(file->getTimedSignals(), numEv, file->getStride(), numPMs, file->getNumTimeBins(), file);
+      if (FirstDataSet) TimedEvents = std::move(mappedTimed);
+      else TimedEvents.append(mappedTimed);
+    }
+  else if (FirstDataSet) TimedEvents.clear();
+
+  fSimulatedData = true;
+  return numEv;
+}
+
 int EventsDataClass::loadSimulatedEventsFromTree(QString fileName, const APmHub &PMs, int maxEvents)
 {
   ErrorString = "";
@@ -1747,47 +1901,36 @@ int EventsDataClass::loadSimulatedEventsFromTree(QString fileName, const APmHub
           Scan.append(scs);          
       }
 
-      QVector<float> PMsignals(numPMs);
+      if (Events.isEmpty()) Events.setDimensions(numPMs);
+      AEventSpan PMsignals = Events.appendEmpty();
       if (fDoubleSignals)
         {
-         for (int ipm=0; ipm<numPMs; ipm++) PMsignals[ipm] = signalD[ipm];
-         Events.append(PMsignals);
+         std::copy(signalD, signalD + numPMs, PMsignals.begin());
 
          if (TimedData)
            {
-             int timeBins = signalTimedD->size();
-             QVector< QVector <float> > PMsignalsTimed(timeBins);
-             for (int itime=0; itime<timeBins; itime++)
-               {
-                 PMsignalsTimed[itime].resize(numPMs);
-
-                 for (int ipm=0; ipm<numPMs; ipm++)
-                   PMsignalsTimed[itime][ipm] = (*signalTimedD)[itime][ipm];
-               }
-             TimedEvents.append(PMsignalsTimed);
+             const int timeBins = signalTimedD->size();
+             if (TimedEvents.isEmpty()) TimedEvents.setDimensions(numPMs, timeBins);
+             TimedEvents.appendEmpty();
+             for (int itime=0; itime<std::min(timeBins, TimedEvents.getNumTimeBins()); itime++)
+                 std::copy((*signalTimedD)[itime].begin(), (*signalTimedD)[itime].begin() + numPMs, TimedEvents.getTimeBin(TimedEvents.size()-1, itime).begin());
              delete signalTimedD;
            }
         }
       else
         {
-         for (int ipm=0; ipm<numPMs; ipm++) PMsignals[ipm] = signalF[ipm];
-         Events.append(PMsignals);
+         std::copy(signalF, signalF + numPMs, PMsignals.begin());
 
          if (TimedData)
            {
-             int timeBins = signalTimedF->size();
-             QVector< QVector <float> > PMsignalsTimed(timeBins);
-             for (int itime=0; itime<timeBins; itime++)
-               {
-                 PMsignalsTimed[itime].resize(numPMs);
-
-                 for (int ipm=0; ipm<numPMs; ipm++)
-                   PMsignalsTimed[itime][ipm] = (*signalTimedF)[itime][ipm];
-               }
-             TimedEvents.append(PMsignalsTimed);
+             const int timeBins = signalTimedF->size();
+             if (TimedEvents.isEmpty()) TimedEvents.setDimensions(numPMs, timeBins);
+             TimedEvents.appendEmpty();
+             for (int itime=0; itime<std::min(timeBins, TimedEvents.getNumTimeBins()); itime++)
+                 std::copy((*signalTimedF)[itime].begin(), (*signalTimedF)[itime].begin() + numPMs, TimedEvents.getTimeBin(TimedEvents.size()-1, itime).begin());
              delete signalTimedF;
            }
-        }      
+        }
     }
 
   TObject* tmp = T->GetUserInfo()->FindObject("numRuns");
@@ -9,6 +9,7 @@
 #include "ageneralsimsettings.h"
 #include "reconstructionsettings.h"
 #include "manifesthandling.h"
+#include "aeventstore.h"
 
 #include <QVector>
 #include <QObject>
@@ -22,6 +23,7 @@ struct AReconRecord;
 class TRandom2;
 class QJsonObject;
 class AEventTrackingRecord;
+class AEventFrame;
 
 class EventsDataClass : public QObject
 {
@@ -38,15 +40,15 @@ public:
     void purge1e10events();  //added after introduction of multithread to remove nodes outside the defined volume - they are marked as true x and y = 1e10
 
     // PM signal data
-    QVector< QVector <float> > Events; //[event][pm]  - remember, if events energy is loaded, one MORE CHANNEL IS ADDED: last channel is numPMs+1
-    QVector< QVector < QVector <float> > > TimedEvents; //event timebin pm
+    AEventStore Events;      //[event][pm]  - remember, if events energy is loaded, one MORE CHANNEL IS ADDED: last channel is numPMs+1
+    AEventStore TimedEvents; //event timebin pm
     int  countEvents() const {return Events.size();}
     bool isEmpty() const {return Events.isEmpty();}
     bool isTimed() const {return !TimedEvents.isEmpty();}
     int  getTimeBins() const;
     int  getNumPMs() const;
-    const QVector<float> *getEvent(int iev) const;
-    const QVector<QVector<float> > *getTimedEvent(int iev);
+    AConstEventSpan getEvent(int iev) const;
+    AConstEventSpan getTimedEvent(int iev, int iTimeBin) const;
 
 #ifdef SIM
     // Logs
@@ -83,6 +85,10 @@ public:
     bool packReconstructedToByteArray(QByteArray &ba) const;
     bool unpackReconstructedFromByteArray(int from, int to, const QByteArray &ba);  //run by client -> should respect the event range
 
+    //grid transfer in frames (see AEventFrame): data are appended / set as the frames arrive
+    bool appendFromEventFrame(const AEventFrame &frame);                    // run by server - the first frame of each type replaces the data
+    bool setReconstructedFromEventFrame(int from, const AEventFrame &frame); // run by client - frame events are counted from "from"
+
     //load data can have manifest file with holes/slits
     QVector<ManifestItemBaseClass*> Manifest;
     void clearManifest();
@@ -116,6 +122,7 @@ public:
     bool saveReconstructionAsText(QString fileName, int igroup=0);
     bool saveSimulationAsTree(QString fileName);
     bool saveSimulationAsText(const QString &fileName, bool addNumPhotons, bool addPositions);
+    bool saveSimulationAsBinary(const QString &fileName, bool bAppend = false);  // see AEventFile for the format
 
     //Data Load - ascii
     bool fLoadedEventsHaveEnergyInfo;
@@ -125,6 +132,9 @@ public:
     int loadSimulatedEventsFromTree(QString fileName, const APmHub &PMs, int maxEvents = -1); //returns -1 if failed, otherwise number of events added
     bool overlayAsciiFile(QString fileName, bool fAddMulti, APmHub *PMs); //true = success, if not, see ErrorString
 
+    //data load - binary, the file is memory-mapped and used directly as the event store
+    int loadEventsFromBinaryFile(const QString &fileName, const APmHub &PMs, int maxEvents = -1); //returns -1 if failed, otherwise number of events added
+
     // for load particle tracking history
     void addEmptyEvents(int numEmptyEvents, int numPMs, int numTimeBins);
 
@@ -16,6 +16,7 @@
 #include <QDebug>
 
 #include "flatfield.h"
+#include "aeventstore.h"
 
 const float Pi = (float)3.14159265358; //--// const
 const float sqrt3 = sqrt(3.0);   //--// const
@@ -55,7 +56,7 @@ void FlatField::Init(std::vector<double> xx_, std::vector<double> yy_, double Rm
   thresh.resize(npmt, Threshold);
 }
 
-void FlatField::SetEvents(std::vector <int> plist_, QVector< QVector< float> > *events)
+void FlatField::SetEvents(std::vector <int> plist_, const AEventStore *events)
 {
     plist = plist_;
     nevt = events->size();
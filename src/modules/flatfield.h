@@ -4,6 +4,8 @@
 #include <vector>
 #include <QVector>
 
+class AEventStore;
+
 struct Point {
         double x, y;
         int id;
@@ -26,7 +28,7 @@ class FlatField {
            FlatField(); //--//
         ~FlatField();
            void Init(std::vector <double> xx_, std::vector <double> yy_, double Rmax, double Threshold); //--//
-        void SetEvents(std::vector <int> plist_, QVector< QVector< float> > *events);
+        void SetEvents(std::vector <int> plist_, const AEventStore *events);
         void SetRmax(double r) {rmax = r;}
         void SetThreshold(double t) {thresh.resize(npmt, t);}
         void SetThreshold(std::vector <double> t) {thresh = t;}
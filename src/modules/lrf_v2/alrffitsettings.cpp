@@ -32,6 +32,8 @@ ALrfFitSettings::ALrfFitSettings()
   comprParams[2] = lam;
   fCompressed = false;
   compr = 0;
+
+  NumThreads = -1;
 }
 
 bool ALrfFitSettings::readFromJson(QJsonObject &json)
@@ -106,6 +108,10 @@ bool ALrfFitSettings::readFromJson(QJsonObject &json)
   parseJson(json, "LRF_compress", fCompressed);
   compr = (fCompressed) ? comprParams : 0;
 
+  //threads
+  NumThreads = -1;
+  parseJson(json, "NumThreads", NumThreads);
+
   return true;
 }
 
@@ -119,6 +125,7 @@ void ALrfFitSettings::dump()
   if (fLimitGroup) qDebug() << ">> GroupToMake:" << igrToMake;
   qDebug() << ">> LRF is 3D?" << f3D << "LRF type index:"<< LRFtype;
   qDebug() << ">> Nodes in x and y:"<< nodesx << nodesy;
+  qDebug() << ">> Threads:" << NumThreads;
   qDebug() << ">> Use compression?" << fCompressed  << " compr pointer:"<< compr;
   if (fCompressed)
     {
@@ -36,6 +36,8 @@ public:
   double k, r0, lam;
   double comprParams[3];
   double *compr;
+ //threads
+  int NumThreads;  //groups are fitted in parallel; -1 - use the global settings
 
   explicit ALrfFitSettings();
   bool readFromJson(QJsonObject &json);
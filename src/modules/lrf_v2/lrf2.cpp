@@ -22,3 +22,26 @@ double LRF2::fitError(int /*npts*/, const double * /*x*/, const double * /*y*/,
 {
     return 0;
 }
+
+void LRF2::evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const
+{
+    for (int i=0; i<npts; i++)
+        out[i] = eval(x[i], y[i], z[i]);
+}
+
+// evalDrvX/Y() of the spline-based LRFs give derivatives per spline interval, so the default is numerical
+void LRF2::evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const
+{
+    const double h = 1e-3;
+    for (int i=0; i<npts; i++) {
+        val[i]  = eval(x[i], y[i], z[i]);
+        drvx[i] = (eval(x[i]+h, y[i], z[i]) - eval(x[i]-h, y[i], z[i])) / (2.*h);
+        drvy[i] = (eval(x[i], y[i]+h, z[i]) - eval(x[i], y[i]-h, z[i])) / (2.*h);
+    }
+}
+
+void LRF2::evalErrBatch(int npts, const double *x, const double *y, const double *z, double *out) const
+{
+    for (int i=0; i<npts; i++)
+        out[i] = evalErr(x[i], y[i], z[i]);
+}
@@ -26,6 +26,12 @@ public:
     virtual double evalDrvX(double x, double y, double z=0.) const = 0;
     virtual double evalDrvY(double x, double y, double z=0.) const = 0;
     virtual double eval(double x, double y, double z, double *err) const = 0;
+    // batched evaluation: out[i] = eval(x[i], y[i], z[i]) - one virtual call for many points
+    // the default implementations just loop, the spline-based LRFs override them with SIMD evaluation of the splines
+    virtual void evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    virtual void evalErrBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    // values and derivatives over x and y in the same units as the coordinates (used by the gradient minimizers)
+    virtual void evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const;
     virtual double fit(int npts, const double *x, const double *y, const double *z, const double *data, bool grid) = 0;
     virtual double fitError(int npts, const double *x, const double *y, const double *z, const double *data, bool grid);
     virtual const char *type() const = 0;
@@ -38,6 +44,8 @@ public:
     static LRF2 *loadJson(const char *type, QJsonObject &lrf_json);
 
 protected:
+    enum {BatchBlock = 64}; // size of the stack buffers used by the batched evaluation
+
     bool valid; // indicates if the LRF can be used for reconstruction
 };
 
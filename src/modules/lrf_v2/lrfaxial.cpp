@@ -8,6 +8,7 @@
 #endif
 
 #include <math.h>
+#include <algorithm>
 
 #include <QDebug>
 #include <QJsonObject>
@@ -113,6 +114,64 @@ double LRFaxial::eval(double x, double y, double /*z*/, double *err) const
     return bsr->Eval(compress(r));
 }
 
+void LRFaxial::evalBatch(int npts, const double *x, const double *y, const double * /*z*/, double *out) const
+{
+    evalRadialBatch(bsr, npts, x, y, out);
+}
+
+void LRFaxial::evalErrBatch(int npts, const double *x, const double *y, const double * /*z*/, double *out) const
+{
+    evalRadialBatch(bse, npts, x, y, out);
+}
+
+void LRFaxial::evalDrvBatch(int npts, const double *x, const double *y, const double * /*z*/, double *val, double *drvx, double *drvy) const
+{
+    if (!bsr) {
+        for (int i=0; i<npts; i++) val[i] = drvx[i] = drvy[i] = 0.;
+        return;
+    }
+
+    double r[BatchBlock];
+    double cr[BatchBlock];
+    double drv[BatchBlock];
+    for (int i0=0; i0<npts; i0+=BatchBlock) {
+        const int n = std::min(npts-i0, (int)BatchBlock);
+        for (int i=0; i<n; i++)
+            cr[i] = r[i] = sqrt(x[i0+i]*x[i0+i] + y[i0+i]*y[i0+i]);
+        compressBatch(n, cr);
+        bsr->EvalDrvBatch(n, cr, val+i0, drv);
+        for (int i=0; i<n; i++) {
+            if (r[i] > rmax) {
+                val[i0+i] = drvx[i0+i] = drvy[i0+i] = 0.;
+                continue;
+            }
+            const double dr = (r[i] > 0 ? drv[i]*comprDev(r[i])/r[i] : 0.);
+            drvx[i0+i] = dr*x[i0+i];
+            drvy[i0+i] = dr*y[i0+i];
+        }
+    }
+}
+
+void LRFaxial::evalRadialBatch(const Bspline3 *bs, int npts, const double *x, const double *y, double *out) const
+{
+    if (!bs) {
+        for (int i=0; i<npts; i++) out[i] = 0.;
+        return;
+    }
+
+    double r[BatchBlock];
+    double cr[BatchBlock];
+    for (int i0=0; i0<npts; i0+=BatchBlock) {
+        const int n = std::min(npts-i0, (int)BatchBlock);
+        for (int i=0; i<n; i++)
+            cr[i] = r[i] = sqrt(x[i0+i]*x[i0+i] + y[i0+i]*y[i0+i]);
+        compressBatch(n, cr);
+        bs->EvalBatch(n, cr, out+i0);
+        for (int i=0; i<n; i++)
+            if (r[i] > rmax) out[i0+i] = 0.;
+    }
+}
+
 #ifdef NEWFIT
 double LRFaxial::fit(int npts, const double *x, const double *y, const double* /*z*/, const double *data, bool grid)
 {
@@ -26,6 +26,9 @@ public:
     virtual double evalDrvX(double x, double y, double z=0.) const;
     virtual double evalDrvY(double x, double y, double z=0.) const;
     virtual double eval(double x, double y, double z, double *err) const;
+    virtual void evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    virtual void evalErrBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    virtual void evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const;
     virtual double fit(int npts, const double *x, const double *y, const double *z, const double *data, bool grid);
     double fitRData(int npts, const double *r, const double *data);
     virtual double fitError(int npts, const double *x, const double *y, const double *z, const double *data, bool grid);
@@ -37,11 +40,14 @@ public:
 
     virtual double compress(double r) const { return r; }
     virtual double comprDev(double r) const;
+    virtual void compressBatch(int /*n*/, double * /*r*/) const {} // in place; has to be overriden together with compress()
     void SetFlatTop(bool val) {flattop = val;}
     void SetNonNegative(bool val) {non_negative = val;}
     void SetNonIncreasing(bool val) {non_increasing = val;}
 
 protected:
+    void evalRadialBatch(const Bspline3 *bs, int npts, const double *x, const double *y, double *out) const;
+
     double rmax;	// domain
     double rmax2;	// domain
     int nint;		// intervals
@@ -7,6 +7,7 @@
 #endif
 
 #include <math.h>
+#include <algorithm>
 
 #include <QJsonObject>
 
@@ -110,6 +111,55 @@ double LRFaxial3d::eval(double x, double y, double z, double *err) const
     return bsr->Eval(compress(r), z);
 }
 
+void LRFaxial3d::evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const
+{
+    if (!bsr) {
+        for (int i=0; i<npts; i++) out[i] = 0.;
+        return;
+    }
+
+    double r[BatchBlock];
+    double cr[BatchBlock];
+    for (int i0=0; i0<npts; i0+=BatchBlock) {
+        const int n = std::min(npts-i0, (int)BatchBlock);
+        for (int i=0; i<n; i++)
+            cr[i] = r[i] = sqrt(x[i0+i]*x[i0+i] + y[i0+i]*y[i0+i]);
+        compressBatch(n, cr);
+        bsr->EvalBatch(n, cr, z+i0, out+i0);
+        for (int i=0; i<n; i++)
+            if (r[i] > rmax || z[i0+i] < zmin || z[i0+i] > zmax) out[i0+i] = 0.;
+    }
+}
+
+void LRFaxial3d::evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const
+{
+    if (!bsr) {
+        for (int i=0; i<npts; i++) val[i] = drvx[i] = drvy[i] = 0.;
+        return;
+    }
+
+    double r[BatchBlock];
+    double cr[BatchBlock];
+    double drv[BatchBlock];
+    double drvz[BatchBlock];
+    for (int i0=0; i0<npts; i0+=BatchBlock) {
+        const int n = std::min(npts-i0, (int)BatchBlock);
+        for (int i=0; i<n; i++)
+            cr[i] = r[i] = sqrt(x[i0+i]*x[i0+i] + y[i0+i]*y[i0+i]);
+        compressBatch(n, cr);
+        bsr->EvalDrvBatch(n, cr, z+i0, val+i0, drv, drvz);
+        for (int i=0; i<n; i++) {
+            if (r[i] > rmax || z[i0+i] < zmin || z[i0+i] > zmax) {
+                val[i0+i] = drvx[i0+i] = drvy[i0+i] = 0.;
+                continue;
+            }
+            const double dr = (r[i] > 0 ? drv[i]*comprDev(r[i])/r[i] : 0.);
+            drvx[i0+i] = dr*x[i0+i];
+            drvy[i0+i] = dr*y[i0+i];
+        }
+    }
+}
+
 #ifdef NEWFIT
 double LRFaxial3d::fit(int npts, const double *x, const double *y, const double *z, const double *data, bool grid)
 {
@@ -27,6 +27,8 @@ public:
     virtual double evalDrvX(double x, double y, double z) const;
     virtual double evalDrvY(double x, double y, double z) const;
     virtual double eval(double x, double y, double z, double *err) const;
+    virtual void evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    virtual void evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const;
     virtual double fit(int npts, const double *x, const double *y, const double *z, const double *data, bool grid);
     void setSpline(TPspline3 *bs, bool log);
     virtual const char *type() const { return "Axial3D"; }
@@ -35,6 +37,7 @@ public:
 
     virtual double compress(double r) const { return r; }
     virtual double comprDev(double r) const;
+    virtual void compressBatch(int /*n*/, double * /*r*/) const {} // in place; has to be overriden together with compress()
 
     void SetFlatTop(bool val) {flat_top = val;}
     void SetNonNegative(bool val) {non_negative = val;}
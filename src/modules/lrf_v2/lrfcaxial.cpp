@@ -50,6 +50,14 @@ double LRFcAxial::comprDev(double r) const
     return dr/sqrt(dr*dr+lam2)+a;
 }
 
+void LRFcAxial::compressBatch(int n, double *r) const
+{
+    for (int i=0; i<n; i++) {
+        double dr=r[i]-r0;
+        r[i] = std::max(0., b+dr*a-sqrt(dr*dr+lam2));
+    }
+}
+
 void LRFcAxial::writeJSON(QJsonObject &json) const
 {
     LRFaxial::writeJSON(json);
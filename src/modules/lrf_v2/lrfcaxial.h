@@ -28,6 +28,7 @@ public:
 //    virtual double Uncompress(double x) {return (exp(x)-1.)*scale;}
     virtual double compress(double r) const;
     virtual double comprDev(double r) const;
+    virtual void compressBatch(int n, double *r) const;
 
 protected:
     double a;
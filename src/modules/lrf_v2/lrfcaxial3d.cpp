@@ -45,6 +45,14 @@ double LRFcAxial3d::compress(double r) const
     return std::max(0., b+dr*a-sqrt(dr*dr+lam2));
 }
 
+void LRFcAxial3d::compressBatch(int n, double *r) const
+{
+    for (int i=0; i<n; i++) {
+        double dr=r[i]-r0;
+        r[i] = std::max(0., b+dr*a-sqrt(dr*dr+lam2));
+    }
+}
+
 double LRFcAxial3d::comprDev(double r) const
 {
     double dr=r-r0;
@@ -15,6 +15,7 @@ public:
 
     virtual double compress(double r) const;
     virtual double comprDev(double r) const;
+    virtual void compressBatch(int n, double *r) const;
 
 protected:
     double a;
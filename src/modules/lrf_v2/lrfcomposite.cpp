@@ -5,6 +5,7 @@
 #include "jsonparser.h"
 
 #include <math.h>
+#include <algorithm>
 
 #include <QDebug>
 #include <QJsonObject>
@@ -121,6 +122,47 @@ double LRFcomposite::eval(double x, double y, double z, double *err) const
     return sum;
 }
 
+void LRFcomposite::evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const
+{
+    double tmp[BatchBlock];
+    for (int i0=0; i0<npts; i0+=BatchBlock) {
+        const int n = std::min(npts-i0, (int)BatchBlock);
+        double *res = out+i0;
+        for (int i=0; i<n; i++) res[i] = 0.;
+        for (int ilrf=0; ilrf<(int)lrfdeck.size(); ilrf++) {
+            lrfdeck[ilrf]->evalBatch(n, x+i0, y+i0, z+i0, tmp);
+            for (int i=0; i<n; i++) res[i] += tmp[i];
+        }
+        for (int i=0; i<n; i++)
+            if (!inDomain(x[i0+i], y[i0+i], z[i0+i])) res[i] = 0.;
+    }
+}
+
+void LRFcomposite::evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const
+{
+    double tv[BatchBlock], tdx[BatchBlock], tdy[BatchBlock];
+    for (int i0=0; i0<npts; i0+=BatchBlock) {
+        const int n = std::min(npts-i0, (int)BatchBlock);
+        for (int i=0; i<n; i++) val[i0+i] = drvx[i0+i] = drvy[i0+i] = 0.;
+        for (int ilrf=0; ilrf<(int)lrfdeck.size(); ilrf++) {
+            lrfdeck[ilrf]->evalDrvBatch(n, x+i0, y+i0, z+i0, tv, tdx, tdy);
+            for (int i=0; i<n; i++) {
+                val[i0+i]  += tv[i];
+                drvx[i0+i] += tdx[i];
+                drvy[i0+i] += tdy[i];
+            }
+        }
+        for (int i=0; i<n; i++)
+            if (!inDomain(x[i0+i], y[i0+i], z[i0+i])) val[i0+i] = drvx[i0+i] = drvy[i0+i] = 0.;
+    }
+}
+
+void LRFcomposite::evalErrBatch(int npts, const double *x, const double *y, const double *z, double *out) const
+{
+    // assume that error is stored in the last added component
+    lrfdeck.back()->evalErrBatch(npts, x, y, z, out);
+}
+
 double LRFcomposite::evalDrvX(double x, double y, double z) const
 {
     double sum = 0.;
@@ -23,6 +23,9 @@ public:
     double evalDrvX(double x, double y, double z=0.) const;
     double evalDrvY(double x, double y, double z=0.) const;
     double eval(double x, double y, double z, double *err) const;
+    void evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    void evalErrBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    void evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const;
     int getCount() const {return lrfdeck.size();}
     void add(LRF2* lrf);
     double fit(int npts, const double *x, const double *y, const double *z, const double *data, bool grid);
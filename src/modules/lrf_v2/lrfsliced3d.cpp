@@ -131,6 +131,44 @@ double LRFsliced3D::eval(double x, double y, double z) const
         return (1.-frac)*bsr[lr1]->Eval(x, y) + frac*bsr[lr1]->Eval(x, y);
 }
 
+// points with the same z (e.g. all sensors for one position) are evaluated with one call to the slice spline
+// as in eval(), only the lower of the two neighbouring slices contributes
+void LRFsliced3D::evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const
+{
+    int i0 = 0;
+    while (i0 < npts) {
+        int i1 = i0 + 1;
+        while (i1 < npts && z[i1] == z[i0]) i1++;
+
+        int lr1, lr2;
+        double frac;
+        get_layers(z[i0], &lr1, &lr2, &frac);
+        bsr[lr1]->EvalBatch(i1-i0, x+i0, y+i0, out+i0);
+        for (int i=i0; i<i1; i++)
+            if (!(x[i]>xmin && x[i]<xmax && y[i]>ymin && y[i]<ymax && z[i]>zmin && z[i]<zmax))
+                out[i] = 0.;
+        i0 = i1;
+    }
+}
+
+void LRFsliced3D::evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const
+{
+    int i0 = 0;
+    while (i0 < npts) {
+        int i1 = i0 + 1;
+        while (i1 < npts && z[i1] == z[i0]) i1++;
+
+        int lr1, lr2;
+        double frac;
+        get_layers(z[i0], &lr1, &lr2, &frac);
+        bsr[lr1]->EvalDrvBatch(i1-i0, x+i0, y+i0, val+i0, drvx+i0, drvy+i0);
+        for (int i=i0; i<i1; i++)
+            if (!(x[i]>xmin && x[i]<xmax && y[i]>ymin && y[i]<ymax && z[i]>zmin && z[i]<zmax))
+                val[i] = drvx[i] = drvy[i] = 0.;
+        i0 = i1;
+    }
+}
+
 double LRFsliced3D::evalErr(double /*x*/, double /*y*/, double /*z*/) const
 {
     return 0.;
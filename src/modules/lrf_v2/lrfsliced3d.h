@@ -33,6 +33,8 @@ public:
     virtual double evalDrvX(double x, double y, double z) const;
     virtual double evalDrvY(double x, double y, double z) const;
     virtual double eval(double x, double y, double z, double *err) const;
+    virtual void evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    virtual void evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const;
     virtual double fit(int npts, const double *x, const double *y, const double *z, const double *data, bool grid);
     void setSpline(TPspline3 *bs, int iz);
     TPspline3 *getSpline(int iz) {if (iz<nintz) return bsr[iz]; else return 0;}
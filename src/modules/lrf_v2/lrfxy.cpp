@@ -118,6 +118,41 @@ double LRFxy::eval(double x, double y, double /*z*/, double *err) const
     return logscale ? exp(bsr->Eval(x, y)) : bsr->Eval(x, y);
 }
 
+void LRFxy::evalBatch(int npts, const double *x, const double *y, const double * /*z*/, double *out) const
+{
+    if (!bsr) {
+        for (int i=0; i<npts; i++) out[i] = 0.;
+        return;
+    }
+
+    bsr->EvalBatch(npts, x, y, out);
+    for (int i=0; i<npts; i++) {
+        if (!(x[i]>xmin && x[i]<xmax && y[i]>ymin && y[i]<ymax))
+            out[i] = 0.;
+        else if (logscale)
+            out[i] = exp(out[i]);
+    }
+}
+
+void LRFxy::evalDrvBatch(int npts, const double *x, const double *y, const double * /*z*/, double *val, double *drvx, double *drvy) const
+{
+    if (!bsr) {
+        for (int i=0; i<npts; i++) val[i] = drvx[i] = drvy[i] = 0.;
+        return;
+    }
+
+    bsr->EvalDrvBatch(npts, x, y, val, drvx, drvy);
+    for (int i=0; i<npts; i++) {
+        if (!(x[i]>xmin && x[i]<xmax && y[i]>ymin && y[i]<ymax))
+            val[i] = drvx[i] = drvy[i] = 0.;
+        else if (logscale) {
+            val[i] = exp(val[i]);
+            drvx[i] *= val[i];
+            drvy[i] *= val[i];
+        }
+    }
+}
+
 #ifdef NEWFIT
 double LRFxy::fit(int npts, const double *x, const double *y, const double * /*z*/, const double *data, bool grid)
 {
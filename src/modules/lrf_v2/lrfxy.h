@@ -26,6 +26,8 @@ public:
     virtual double evalDrvX(double x, double y, double z=0.) const;
     virtual double evalDrvY(double x, double y, double z=0.) const;
     virtual double eval(double x, double y, double z, double *err) const;
+    virtual void evalBatch(int npts, const double *x, const double *y, const double *z, double *out) const;
+    virtual void evalDrvBatch(int npts, const double *x, const double *y, const double *z, double *val, double *drvx, double *drvy) const;
     virtual double fit(int npts, const double *x, const double *y, const double *z, const double *data, bool grid);
     void setSpline(TPspline3 *bs, bool log);
     TPspline3 *getSpline() const { return bsr; }
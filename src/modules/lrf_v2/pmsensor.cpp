@@ -116,6 +116,14 @@ void PMsensor::transformBack(const double *pos_local, double *pos_world) const
    pos_world[2] = pos_local[2];
 }
 
+void PMsensor::transformGradient(const double *grad_local, double *grad_world) const
+{
+    // local = R * (world + shift) -> grad_world = R^T * grad_local
+    const double gy = flip ? -grad_local[1] : grad_local[1];
+    grad_world[0] =  grad_local[0]*cosphi + gy*sinphi;
+    grad_world[1] = -grad_local[0]*sinphi + gy*cosphi;
+}
+
 /*
 double *PMsensor::transform(const double *pos_world) const
 {
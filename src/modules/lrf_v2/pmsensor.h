@@ -35,6 +35,7 @@ public:
 
   void transform(const double *pos_world, double *pos_local) const;
   void transformBack(const double *pos_local, double *pos_world) const;
+  void transformGradient(const double *grad_local, double *grad_world) const; // xy gradient of a function of the local coordinates
   ///double *transform(const double *pos_world) const; // returns pointer to local position
 
   void getGlobalMinMax(double *minmax) const; //minmax[0] = xmin; [1] = xmax; [2] = ymin; [3] = ymax;
@@ -16,6 +16,7 @@
 
 #include <QVector>
 #include <vector>
+#include <algorithm>
 #include <QDebug>
 
 #ifndef M_PI
@@ -255,6 +256,85 @@ void PMsensorGroup::setGains(const double *gains)
       sensors[i].SetGain(gains[i]);
 }
 
+void PMsensorGroup::evalAll(const double *pos_world, double *out, int numOut) const
+{
+    evalAll(pos_world, out, numOut, false);
+}
+
+void PMsensorGroup::evalErrAll(const double *pos_world, double *out, int numOut) const
+{
+    evalAll(pos_world, out, numOut, true);
+}
+
+void PMsensorGroup::evalAll(const double *pos_world, double *out, int numOut, bool bErr) const
+{
+    if (!lrf) return;
+
+    const int BlockSize = 64;
+    double lx[BlockSize], ly[BlockSize], lz[BlockSize], val[BlockSize];
+    double pos_local[3];
+    const int numSensors = sensors.size();
+    for (int i0 = 0; i0 < numSensors; i0 += BlockSize)
+    {
+        const int n = std::min(numSensors - i0, BlockSize);
+        for (int i = 0; i < n; i++)
+        {
+            sensors[i0+i].transform(pos_world, pos_local);
+            lx[i] = pos_local[0];
+            ly[i] = pos_local[1];
+            lz[i] = pos_local[2];
+        }
+
+        if (bErr) lrf->evalErrBatch(n, lx, ly, lz, val);
+        else      lrf->evalBatch(n, lx, ly, lz, val);
+
+        for (int i = 0; i < n; i++)
+        {
+            const PMsensor & sensor = sensors[i0+i];
+            const int ipm = sensor.GetIndex();
+            if (ipm >= 0 && ipm < numOut) out[ipm] = val[i] * sensor.GetGain();
+        }
+    }
+}
+
+void PMsensorGroup::evalDrvAll(const double *pos_world, double *out, double *gradX, double *gradY, int numOut) const
+{
+    if (!lrf) return;
+
+    const int BlockSize = 64;
+    double lx[BlockSize], ly[BlockSize], lz[BlockSize], val[BlockSize], dx[BlockSize], dy[BlockSize];
+    double pos_local[3];
+    const int numSensors = sensors.size();
+    for (int i0 = 0; i0 < numSensors; i0 += BlockSize)
+    {
+        const int n = std::min(numSensors - i0, BlockSize);
+        for (int i = 0; i < n; i++)
+        {
+            sensors[i0+i].transform(pos_world, pos_local);
+            lx[i] = pos_local[0];
+            ly[i] = pos_local[1];
+            lz[i] = pos_local[2];
+        }
+
+        lrf->evalDrvBatch(n, lx, ly, lz, val, dx, dy);
+
+        for (int i = 0; i < n; i++)
+        {
+            const PMsensor & sensor = sensors[i0+i];
+            const int ipm = sensor.GetIndex();
+            if (ipm < 0 || ipm >= numOut) continue;
+
+            const double gain = sensor.GetGain();
+            const double grad_local[2] = {dx[i], dy[i]};
+            double grad_world[2];
+            sensor.transformGradient(grad_local, grad_world);
+            out[ipm]   = val[i] * gain;
+            gradX[ipm] = grad_world[0] * gain;
+            gradY[ipm] = grad_world[1] * gain;
+        }
+    }
+}
+
 void PMsensorGroup::writeJSON(QJsonObject &json) const
 {
   //qDebug() << "----group save:";
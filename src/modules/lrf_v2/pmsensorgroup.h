@@ -37,6 +37,12 @@ public:
 
     void setGains(const double *gains);
 
+    // one position for all sensors of the group with one (batched) LRF call:
+    // out[index of the sensor in PM module] = LRF * gain; sensors with index >= numOut are skipped
+    void evalAll(const double *pos_world, double *out, int numOut) const;
+    void evalErrAll(const double *pos_world, double *out, int numOut) const;
+    void evalDrvAll(const double *pos_world, double *out, double *gradX, double *gradY, int numOut) const; // gradient in world coordinates
+
     std::vector<PMsensor> *getPMs() { return &sensors; }
 
     void writeJSON(QJsonObject &json) const;
@@ -44,6 +50,7 @@ public:
 
 private:
     void addSensor(const APmHub *PMs, int ipm, double phi, bool flip);
+    void evalAll(const double *pos_world, double *out, int numOut, bool bErr) const;
 
     std::vector<PMsensor> sensors;
     LRF2* lrf;
@@ -11,6 +11,7 @@
 #include "lrffactory.h"
 #include "apositionenergyrecords.h"
 #include "alrffitsettings.h"
+#include "aeventstore.h"
 
 #include <math.h>
 
@@ -18,11 +19,10 @@
 #include <QDebug>
 
 #include <TProfile2D.h>
-#include <TFile.h>
 #include <TGraph.h>
 
 SensorLocalCache::SensorLocalCache(int numGoodEvents, bool fDataRecon, bool fScaleByEnergy, const QVector<AReconRecord*> reconData,
-                                   const QVector<AScanRecord*> *scan, const QVector< QVector<float> > *events, ALrfFitSettings *LRFsettings) :
+                                   const QVector<AScanRecord*> *scan, const AEventStore *events, ALrfFitSettings *LRFsettings) :
     LRFsettings(LRFsettings),
     numGoodEvents(numGoodEvents), dataSize(0),
     xx(0), minx(1e10), maxx(-1e10),
@@ -32,7 +32,7 @@ SensorLocalCache::SensorLocalCache(int numGoodEvents, bool fDataRecon, bool fSca
 
 {
     //caching pointers to "Good" events, their positions and energies
-    const QVector<float> **goodEvents = new const QVector<float>*[numGoodEvents];
+    const float **goodEvents = new const float*[numGoodEvents];
     const double **r = new const double*[numGoodEvents];
     double *factors = new double[numGoodEvents];
 
@@ -75,7 +75,7 @@ SensorLocalCache::SensorLocalCache(int numGoodEvents, bool fDataRecon, bool fSca
         }
         else factors[i] = 1.0;
 
-        goodEvents[i] = &(*events)[ievent];
+        goodEvents[i] = events->at(ievent).data();
         i++;
     }
 
@@ -154,7 +154,7 @@ bool SensorLocalCache::cacheGroup(const std::vector<PMsensor> *sensors, bool adj
             x_loc[ipts] = rloc[0];
             y_loc[ipts] = rloc[1];
             z_loc[ipts] = rloc[2];
-            sig[ipts] = (*goodEvents[ipts])[ipm] * factors[ipts];
+            sig[ipts] = goodEvents[ipts][ipm] * factors[ipts];
 
             maxr2 = std::max(maxr2, rloc[0]*rloc[0] + rloc[1]*rloc[1]);
             minx = std::min(minx, rloc[0]);
@@ -189,15 +189,12 @@ bool SensorLocalCache::cacheGroup(const std::vector<PMsensor> *sensors, bool adj
 ///*** does it make a problem for axial lrf?
 void SensorLocalCache::calcRelativeGains2D(int ngrid, unsigned int pmsCount)
 {
+    //groups can be processed in parallel threads: no debug output to a root file here
     gains[0] = 1.0;
-    char filename[32];
     //qDebug() << "CalcGains: irgp=" << igrp << "; count: " << pmsCount;
-    //sprintf(filename, "gains%d.root", igrp);
-    TFile *file = new TFile(filename, "recreate");
     TProfile2D hp0("hpgains0", "hpgains0", ngrid, minx, maxx, ngrid, miny, maxy);
     for (int i = 0; i < numGoodEvents; i++)
         hp0.Fill(xx[i], yy[i], sigsig[i]);
-    hp0.Write();
 
     for (unsigned int ipm = 1; ipm < pmsCount; ipm++)
     {
@@ -210,7 +207,6 @@ void SensorLocalCache::calcRelativeGains2D(int ngrid, unsigned int pmsCount)
         TProfile2D hp1(histname, histname, ngrid, minx, maxx, ngrid, miny, maxy);
         for (int i = 0; i < numGoodEvents; i++)
             hp1.Fill(pmx[i], pmy[i], pmsig[i]);
-        hp1.Write();
 
         double sumxy = 0.;
         double sumxx = 0.;
@@ -228,7 +224,6 @@ void SensorLocalCache::calcRelativeGains2D(int ngrid, unsigned int pmsCount)
         if (sumxx == 0) gains[ipm] = 666.0; //Vladimir claims it will be exact 0 if there is no points
         else gains[ipm] = sumxy/sumxx;
     }
-    file->Close();
 }
 
 /*if (type == 2) { // Polar
@@ -17,13 +17,14 @@ class LRFsliced3D;
 struct AReconRecord;
 struct AScanRecord;
 class ALrfFitSettings;
+class AEventStore;
 //template<typename T> class QVector;
 
 class SensorLocalCache
 {
 public:
     SensorLocalCache(int numGoodEvents, bool fDataRecon, bool fScaleByEnergy, const QVector<AReconRecord*> reconData,
-                     const QVector<AScanRecord*> *scan, const QVector< QVector <float> > *events, ALrfFitSettings* LRFsettings);
+                     const QVector<AScanRecord*> *scan, const AEventStore *events, ALrfFitSettings* LRFsettings);
 
     ~SensorLocalCache();
 
@@ -53,7 +54,7 @@ public:
 private:
     int igrp; // Current Group ID  - needed for debugging (VS 20/10/14)
     int numGoodEvents, dataSize;
-    const QVector<float> * const *goodEvents;
+    const float * const *goodEvents;
     const double * const *r;
     const double *factors;
     double *xx, minx, maxx;
@@ -3,6 +3,8 @@
 #include <QJsonObject>
 #include <QDebug>
 
+#include <atomic>
+
 #include <TProfile2D.h>
 
 #include "acommonfunctions.h"
@@ -12,6 +14,7 @@
 #include "alrftypemanager.h"
 #include "atransform.h"
 #include "afitlayersensorgroup.h"
+#include "aparalleltasks.h"
 
 
 #ifndef M_PI
@@ -148,127 +151,171 @@ std::vector<AFitLayerSensorGroup> FitLayer::getSymmetryGroups(const AInstruction
   return symmetry_groups;
 }
 
-bool FitLayer::apply(ASensorGroup &group, const AInstructionInput &input) const
+bool FitLayer::isConcurrentFitSafe(const ASensorGroup &group, const std::vector<AFitLayerSensorGroup> &symmetry_groups) const
 {
-  std::vector<AFitLayerSensorGroup> symmetry_groups = getSymmetryGroups(input);
+  if(!lrf_type->isThreadSafe())
+    return false;
+  if(stack_op != 0) //overwrite: previous lrfs are not evaluated
+    return true;
+
+  for(auto &symmetry : symmetry_groups)
+    for(std::size_t i = 0; i < symmetry.size(); i++) {
+      const ASensor *sensor = group.getSensor(symmetry[i].first);
+      if(sensor == nullptr) continue;
+      for(const ASensor::Parcel &parcel : sensor->deck)
+        if(!ALrfTypeManager::instance().getTypeFast(parcel.lrf->type()).isThreadSafe())
+          return false;
+    }
+  return true;
+}
 
-  std::vector<ASensorGroup> resulting_groups;
+bool FitLayer::fitSymmetryGroup(const AFitLayerSensorGroup &symmetry, const ASensorGroup &group,
+                                const AInstructionInput &input, const std::function<bool(float)> &progress,
+                                ASensorGroup &result) const
+{
   const int num_events = input.eventCount(reconstruction_group);
-  if(num_events < 100) return false;
-  int symmetry_i = 0;
-  for(auto &symmetry : symmetry_groups) {
-    const int sensor_count = symmetry.size();
-    std::vector<double> group_signals;
-    std::vector<APoint> group_pos;
-    try {
-      group_signals.resize(num_events*sensor_count);
-      group_pos.resize(num_events*sensor_count);
-    } catch(std::bad_alloc) {
-      qDebug()<<"Failed to allocate memory to group event signals and positions.";
-      return false;
-    }
-    double minx = 0, miny = 0, maxx = 0, maxy = 0;
+  const int sensor_count = symmetry.size();
+  std::vector<double> group_signals;
+  std::vector<APoint> group_pos;
+  try {
+    group_signals.resize(num_events*sensor_count);
+    group_pos.resize(num_events*sensor_count);
+  } catch(std::bad_alloc) {
+    qDebug()<<"Failed to allocate memory to group event signals and positions.";
+    return false;
+  }
+  double minx = 0, miny = 0, maxx = 0, maxy = 0;
 
 
-    for(int i = 0; i < sensor_count; i++) {
-      auto ipm_transf = symmetry[i];
+  for(int i = 0; i < sensor_count; i++) {
+    auto ipm_transf = symmetry[i];
 
-      //Do not shift events if we aren't to transform lrfs later
-      //if(global_lrf)
-      //  ipm_transf.second->setShift(APoint());
+    //Do not shift events if we aren't to transform lrfs later
+    //if(global_lrf)
+    //  ipm_transf.second->setShift(APoint());
 
-      for(int iev = 0; iev < num_events; iev++) {
-        //Copy-transform event positions
-        auto trans_pos = ipm_transf.second->transform(input.eventPos(iev, reconstruction_group));
-        group_pos[i*num_events+iev] = trans_pos;
+    for(int iev = 0; iev < num_events; iev++) {
+      //Copy-transform event positions
+      auto trans_pos = ipm_transf.second->transform(input.eventPos(iev, reconstruction_group));
+      group_pos[i*num_events+iev] = trans_pos;
 
-        if(adjust_gains) {
-          minx = std::min(minx, trans_pos.x());
-          maxx = std::max(maxx, trans_pos.x());
-          miny = std::min(miny, trans_pos.y());
-          maxy = std::max(maxy, trans_pos.y());
-        }
+      if(adjust_gains) {
+        minx = std::min(minx, trans_pos.x());
+        maxx = std::max(maxx, trans_pos.x());
+        miny = std::min(miny, trans_pos.y());
+        maxy = std::max(maxy, trans_pos.y());
       }
-
-      if(!input.reportProgress((symmetry_i+(i+1)*0.1f*(adjust_gains?1:2)/sensor_count)/symmetry_groups.size()))
-        return false;
     }
 
-    std::vector<double> gains(sensor_count, 1.0);
-    if(adjust_gains) {
-      const int ngrid = sqrt(num_events/7.);
-      int ipm = symmetry[0].first;
-      TProfile2D hp0("hpgains0", "hpgains0", ngrid, minx, maxx, ngrid, miny, maxy);
-      for (int iev = 0; iev < num_events; iev++)
-        hp0.Fill(group_pos[iev].x(), group_pos[iev].y(), input.eventSignal(iev, ipm, reconstruction_group));
-
-      for(int i = 1; i < sensor_count; i++)
-      {
-        const APoint *pos = &group_pos[num_events*i];
-        ipm = symmetry[i].first;
-
-        TProfile2D hp1("hpgains", "hpgains", ngrid, minx, maxx, ngrid, miny, maxy);
-        for (int iev = 0; iev < num_events; iev++)
-          hp1.Fill(pos[iev].x(), pos[iev].y(), input.eventSignal(iev, ipm, reconstruction_group));
-
-        double sumxy = 0., sumxx = 0.;
-        for (int ix = 0; ix < ngrid; ix++)
-          for (int iy = 0; iy < ngrid; iy++) {
-            int bin0 = hp0.GetBin(ix, iy);
-            int bin1 = hp1.GetBin(ix, iy);
-            //must have something in both bins
-            if (hp0.GetBinEntries(bin0) && hp1.GetBinEntries(bin1))  {
-              double z0 = hp0.GetBinContent(bin0);
-              sumxy += z0*hp1.GetBinContent(bin1);
-              sumxx += z0*z0;
-            }
-          }
+    if(!progress((i+1)*0.1f*(adjust_gains?1:2)/sensor_count))
+      return false;
+  }
 
-        gains[i] = sumxx == 0 ? 666.0 : sumxy/sumxx;
-        //qDebug()<<"gain"<<symmetry[i].first<<"="<<gains[i];
+  std::vector<double> gains(sensor_count, 1.0);
+  if(adjust_gains) {
+    const int ngrid = sqrt(num_events/7.);
+    int ipm = symmetry[0].first;
+    TProfile2D hp0("hpgains0", "hpgains0", ngrid, minx, maxx, ngrid, miny, maxy);
+    for (int iev = 0; iev < num_events; iev++)
+      hp0.Fill(group_pos[iev].x(), group_pos[iev].y(), input.eventSignal(iev, ipm, reconstruction_group));
 
-        if(!input.reportProgress((symmetry_i+0.1f+(i+1)*0.1f/sensor_count)/symmetry_groups.size()))
-          return false;
-      }
-    }
+    for(int i = 1; i < sensor_count; i++)
+    {
+      const APoint *pos = &group_pos[num_events*i];
+      ipm = symmetry[i].first;
 
-    for(int i = 0; i < sensor_count; i++) {
-      int ipm = symmetry[i].first;
-      double inv_gain = 1./gains[i];
-      for(int iev = 0; iev < num_events; iev++) {
-        //Copy event signals with gain adjustment
-        group_signals[i*num_events+iev] = inv_gain * input.eventSignal(iev, ipm, reconstruction_group);
-        if(stack_op == 0) { //append
-          const ASensor *sensor = group.getSensor(ipm);
-          if(sensor != nullptr)
-            group_signals[i*num_events+iev] -= sensor->eval(input.eventPos(iev, reconstruction_group));
+      TProfile2D hp1("hpgains", "hpgains", ngrid, minx, maxx, ngrid, miny, maxy);
+      for (int iev = 0; iev < num_events; iev++)
+        hp1.Fill(pos[iev].x(), pos[iev].y(), input.eventSignal(iev, ipm, reconstruction_group));
+
+      double sumxy = 0., sumxx = 0.;
+      for (int ix = 0; ix < ngrid; ix++)
+        for (int iy = 0; iy < ngrid; iy++) {
+          int bin0 = hp0.GetBin(ix, iy);
+          int bin1 = hp1.GetBin(ix, iy);
+          //must have something in both bins
+          if (hp0.GetBinEntries(bin0) && hp1.GetBinEntries(bin1))  {
+            double z0 = hp0.GetBinContent(bin0);
+            sumxy += z0*hp1.GetBinContent(bin1);
+            sumxx += z0*z0;
+          }
         }
-      }
 
-      if(!input.reportProgress((symmetry_i+0.2f+(i+1)*0.2f/sensor_count)/symmetry_groups.size()))
+      gains[i] = sumxx == 0 ? 666.0 : sumxy/sumxx;
+      //qDebug()<<"gain"<<symmetry[i].first<<"="<<gains[i];
+
+      if(!progress(0.1f+(i+1)*0.1f/sensor_count))
         return false;
     }
+  }
 
-    ALrf *lrf = lrf_type->lrfFromData(lrf_settings, input.fitError(), group_pos, group_signals);
-    if(!lrf) return false;
+  for(int i = 0; i < sensor_count; i++) {
+    int ipm = symmetry[i].first;
+    double inv_gain = 1./gains[i];
+    for(int iev = 0; iev < num_events; iev++) {
+      //Copy event signals with gain adjustment
+      group_signals[i*num_events+iev] = inv_gain * input.eventSignal(iev, ipm, reconstruction_group);
+      if(stack_op == 0) { //append
+        const ASensor *sensor = group.getSensor(ipm);
+        if(sensor != nullptr)
+          group_signals[i*num_events+iev] -= sensor->eval(input.eventPos(iev, reconstruction_group));
+      }
+    }
 
-    if(!input.reportProgress((symmetry_i+0.98f)/symmetry_groups.size()))
+    if(!progress(0.2f+(i+1)*0.2f/sensor_count))
       return false;
+  }
 
-    ASensorGroup current_symmetry_group;
-    for(int i = 0; i < sensor_count; i++) {
-      auto ipm_transf = symmetry[i];
-      ATransform inverse = *ipm_transf.second;
-      inverse.invert();
-      std::shared_ptr<ALrf> tranfs_lrf(lrf->clone());
-      tranfs_lrf->transform(inverse);
-      current_symmetry_group.overwrite(ASensor(ipm_transf.first, gains[i], tranfs_lrf));
-    }
+  ALrf *lrf = lrf_type->lrfFromData(lrf_settings, input.fitError(), group_pos, group_signals);
+  if(!lrf) return false;
+
+  if(!progress(0.98f)) {
     delete lrf;
-    resulting_groups.push_back(current_symmetry_group);
+    return false;
+  }
 
-    symmetry_i++;
+  for(int i = 0; i < sensor_count; i++) {
+    auto ipm_transf = symmetry[i];
+    ATransform inverse = *ipm_transf.second;
+    inverse.invert();
+    std::shared_ptr<ALrf> tranfs_lrf(lrf->clone());
+    tranfs_lrf->transform(inverse);
+    result.overwrite(ASensor(ipm_transf.first, gains[i], tranfs_lrf));
   }
+  delete lrf;
+
+  return true;
+}
+
+bool FitLayer::apply(ASensorGroup &group, const AInstructionInput &input) const
+{
+  std::vector<AFitLayerSensorGroup> symmetry_groups = getSymmetryGroups(input);
+
+  const int num_events = input.eventCount(reconstruction_group);
+  if(num_events < 100) return false;
+  const int symmetry_count = symmetry_groups.size();
+
+  //Symmetry groups are fitted independently, each into its own slot, so the
+  //result does not depend on the order in which the threads finish
+  std::vector<ASensorGroup> resulting_groups(symmetry_count);
+  const int num_threads = isConcurrentFitSafe(group, symmetry_groups) ? input.numThreads() : 1;
+  std::atomic<bool> cancelled(false);
+
+  auto fit = [&](int symmetry_i, int /*thread*/) {
+    //Only the calling thread may report progress (it processes gui events)
+    auto progress = [&, symmetry_i](float p) {
+      if(num_threads > 1) return !cancelled.load();
+      return input.reportProgress((symmetry_i+p)/symmetry_count);
+    };
+    return fitSymmetryGroup(symmetry_groups[symmetry_i], group, input, progress, resulting_groups[symmetry_i]);
+  };
+  auto monitor = [&](int done) {
+    if(!input.reportProgress(float(done)/symmetry_count))
+      cancelled = true;
+    return !cancelled.load();
+  };
+  if(!runParallelTasks(symmetry_count, num_threads, fit, monitor))
+    return false;
 
   switch(stack_op) {
     case 0: //append
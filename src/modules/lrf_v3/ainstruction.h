@@ -1,6 +1,7 @@
 #ifndef ALRFINSTRUCTION_H
 #define ALRFINSTRUCTION_H
 
+#include <functional>
 #include <map>
 #include <vector>
 
@@ -83,6 +84,13 @@ class FitLayer : public AInstruction
   int reconstruction_group;
   int group_type, stack_op;
   bool group_enabled, adjust_gains;
+
+  //True if the symmetry groups can be fitted in parallel threads
+  bool isConcurrentFitSafe(const ASensorGroup &group, const std::vector<AFitLayerSensorGroup> &symmetry_groups) const;
+  //progress is in [0;1] for this symmetry group. Return value of false means stop!
+  bool fitSymmetryGroup(const AFitLayerSensorGroup &symmetry, const ASensorGroup &group,
+                        const AInstructionInput &input, const std::function<bool(float)> &progress,
+                        ASensorGroup &result) const;
 protected:
   QJsonObject toJsonImpl() const override;
 public:
@@ -2,6 +2,7 @@
 
 #include "apmgroupsmanager.h"
 #include "eventsdataclass.h"
+#include "aglobalsettings.h"
 
 namespace LRF {
 
@@ -17,6 +18,7 @@ AInstructionInput::AInstructionInput(const ARepository *repo,
   this->current_group = sensor_groups->getCurrentGroup();
   this->used_scan_data = fUseScanData;
   this->fit_error = fit_error;
+  this->num_threads = AGlobalSettings::getInstance().RecNumTreads;
 
   scale_by_energy = scale_by_energy && !fUseScanData;
 
@@ -33,7 +35,7 @@ AInstructionInput::AInstructionInput(const ARepository *repo,
     if(events_data_hub) {
       const int isize = events_data_hub->Events.size();
       const QVector<AReconRecord*> &reconData = events_data_hub->ReconstructionData[igrp];
-      std::vector<const QVector<float> *> grp_events;
+      std::vector<AConstEventSpan> grp_events;
       std::vector<const ABaseScanAndReconRecord *> grp_records;
       std::vector<double> grp_energy_factors;
       for(int i = 0; i < isize; i++) {
@@ -42,7 +44,7 @@ AInstructionInput::AInstructionInput(const ARepository *repo,
 
         if (fUseScanData)  grp_records.push_back(events_data_hub->Scan[i]);
         else               grp_records.push_back(reconData[i]);
-        grp_events.push_back(&events_data_hub->Events[i]);
+        grp_events.push_back(events_data_hub->Events.at(i));
         grp_energy_factors.push_back(scale_by_energy ? 1./reconData[i]->Points[0].energy : 1.);
       }
       grp_events.shrink_to_fit();
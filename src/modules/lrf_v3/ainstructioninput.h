@@ -7,6 +7,7 @@
 
 #include "apoint.h"
 #include "apositionenergyrecords.h"
+#include "aeventstore.h"
 
 class APmGroupsManager;
 class EventsDataClass;
@@ -27,12 +28,13 @@ class AInstructionInput
   const ARepository *repo;
   const APmGroupsManager *sensor_groups;
   std::vector<APoint> sensor_positions;
-  std::vector<std::vector<const QVector<float> *>> events;
+  std::vector<std::vector<AConstEventSpan>> events;
   std::vector<std::vector<const ABaseScanAndReconRecord *>> records;
   std::vector<std::vector<double>> energy_factors;
   //Values range of [0;1]. Return value of false means stop!
   std::function<bool(float)> progress_reporter;
   int current_group;
+  int num_threads;
   bool used_scan_data, fit_error;
 public:
   AInstructionInput(const ARepository *repo,
@@ -44,6 +46,11 @@ public:
   template<typename T> void setProgressReporter(T reporter) { progress_reporter = reporter; }
   bool reportProgress(float progress) const { return progress_reporter(progress); }
 
+  //Threads used by the instructions for independent fits. Progress should be
+  //reported only from the thread which called ARepository::updateRecipe()
+  void setNumThreads(int threads) { num_threads = threads < 1 ? 1 : threads; }
+  int numThreads() const { return num_threads; }
+
   const ARepository &repository() const { return *repo; }
   bool isPmBelongsToGroup(int ipm, int group) const;
   int getCurrentSensorGroup() const { return current_group; }
@@ -56,7 +63,7 @@ public:
     return APoint(records[sensor_group][iev]->Points[0].r);
   }
   float eventSignal(int iev, int ipm, int sensor_group) const {
-    return (*events[sensor_group][iev])[ipm] * energy_factors[sensor_group][iev];
+    return events[sensor_group][iev][ipm] * energy_factors[sensor_group][iev];
   }
 };
 
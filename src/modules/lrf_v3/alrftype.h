@@ -51,6 +51,11 @@ public:
   virtual std::string nameUi() const { return name_; }
 
   virtual bool isCudaCapable() const { return false; }
+  ///
+  /// \brief Returns true if lrfFromData() and the evaluation of the lrfs of
+  ///  this type can be run from several threads at the same time.
+  ///
+  virtual bool isThreadSafe() const { return true; }
   virtual void getCudaParameters(std::shared_ptr<const ALrf> /*lrf*/) { }
 
 #ifdef GUI
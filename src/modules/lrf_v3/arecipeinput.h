@@ -7,6 +7,7 @@
 #include "apositionenergyrecords.h"
 
 #include "ajsontools.h"
+#include "aeventstore.h"
 
 namespace LRF {
 
@@ -24,13 +25,13 @@ class ASensorGroup;
 class ARecipeInput
 {
   const std::vector<APoint> *sensor_positions;
-  std::vector<const QVector<float> *> events;
+  std::vector<AConstEventSpan> events;
   std::vector<const ABaseScanAndReconRecord *> records;
   bool fUsedScanData;
 public:
   //Designed to be compatible with EventsDataClass. Change at will if exporting.
   ARecipeInput(const std::vector<APoint> &sensor_positions,
-               const QVector<QVector<float>> &events,
+               const AEventStore &events,
                const QVector<AReconRecord*> &reconData,
                const QVector<AScanRecord*> &scanData)
   {
@@ -45,7 +46,7 @@ public:
 
       if (fUsedScanData)  records.push_back(scanData[i]);
       else                records.push_back(reconData[i]);
-      this->events.push_back(&events[i]);
+      this->events.push_back(events.at(i));
     }
 
     this->events.shrink_to_fit();
@@ -56,7 +57,7 @@ public:
 
   int size() const { return events.size(); }
   APoint eventPos(int ievent) const { return APoint(records[ievent]->Points[0].r); }
-  double eventSignal(int iev, int ipm) const { return (*events[iev])[ipm]; }
+  double eventSignal(int iev, int ipm) const { return events[iev][ipm]; }
 };
 
 } //namespace LRF
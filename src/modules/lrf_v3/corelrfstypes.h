@@ -117,6 +117,8 @@ protected:
 
 public:
   QJsonObject lrfToJson(const ALrf *lrf) const override;
+  //All lrfs and fits share the same script engine
+  bool isThreadSafe() const override { return false; }
 
 #ifdef GUI
   QWidget *newInternalsWidget(QWidget *parent) const override;
@@ -601,16 +601,16 @@ double *energy){ int nIn=nInputs(), iX, iP; double coleff=1, norm=1, val;
  if (isRecE() || FNorm==nsToSum){
   for (coleff=0, iP=0; iP<nIn; ++iP){ if (isValidPM(iP))
    //coleff+=(*Reconstructor->getEvent(ievent))[iP]; } }  ANDR
-   coleff+=(*EventsDataHub->getEvent(ievent))[iP]; } }   // ANDR
+   coleff+=EventsDataHub->getEvent(ievent)[iP]; } }   // ANDR
  // NORMALIZE FACTORS (INPUT NEURONS) +++++++++++++++++++++++++++++++++++++++++
  if (FNorm==nsToMax){
   for (norm=-DBL_MAX, iP=0; iP<nIn; ++iP) if (isValidPM(iP)){
-   if ((val=(*EventsDataHub->getEvent(ievent))[iP])>norm) norm=val; }
+   if ((val=EventsDataHub->getEvent(ievent)[iP])>norm) norm=val; }
  } else if (FNorm==nsToSum){ norm=coleff; }
  //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
  if (norm<=0){ return false; } else
   for (iP=0; iP<nIn; ++iP) if (isValidPM(iP)){
-   FVIn[iP]=(*EventsDataHub->getEvent(ievent))[iP]/norm; }
+   FVIn[iP]=EventsDataHub->getEvent(ievent)[iP]/norm; }
  //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
  for (run(FVIn,FVOut), iX=0; iX<spaceDims(); iX++) (*r)[iX]=scale_out(iX,FVOut[iX]);
  //if (!isRecZ()) (*r)[2]=Reconstructor->getSuggestedZ();
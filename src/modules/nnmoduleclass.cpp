@@ -6,6 +6,139 @@
 
 #include <QDebug>
 #include <QVariant>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QDataStream>
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+flann::SearchParams AKnnSearchSettings::makeSearchParams(int numPMs) const
+{
+  return flann::SearchParams( (Checks == 0 ? numPMs : Checks), Eps );
+}
+
+namespace
+{
+  const int MinQueriesPerThread = 1000; //smaller blocks are not worth starting a thread
+
+  //the index is only read during the search, so the blocks of queries can be processed concurrently
+  template <class TIndex>
+  void knnSearchParallel(TIndex & index, flann::Matrix<float> & queries, flann::Matrix<int> & indices, flann::Matrix<float> & dists,
+                         int n, const AKnnSearchSettings & settings, int numPMs)
+  {
+    const flann::SearchParams params = settings.makeSearchParams(numPMs);
+    const int numQueries = queries.rows;
+    const int numThreads = std::max(1, std::min(settings.NumThreads, numQueries / MinQueriesPerThread));
+    if (numThreads == 1)
+      {
+        index.knnSearch(queries, indices, dists, n, params);
+        return;
+      }
+
+    const int perThread = (numQueries + numThreads - 1) / numThreads;
+    std::vector<std::thread> threads;
+    for (int from = 0; from < numQueries; from += perThread)
+      {
+        const int rows = std::min(perThread, numQueries - from);
+        threads.emplace_back( [&index, &queries, &indices, &dists, &params, n, from, rows]()
+        {
+          flann::Matrix<float> q(queries[from], rows, queries.cols);
+          flann::Matrix<int>   i(indices[from], rows, indices.cols);
+          flann::Matrix<float> d(dists[from],   rows, dists.cols);
+          index.knnSearch(q, i, d, n, params);
+        } );
+      }
+    for (std::thread & t : threads) t.join();
+  }
+
+  // -- calibration files --
+  // the reconstructor and the script interface store different layouts
+  const quint32 KnnRecFileMagic    = 0x414b4e52; // "AKNR"
+  const quint32 KnnScriptFileMagic = 0x414b4e53; // "AKNS"
+  const qint32  KnnFileVersion = 1;
+
+  //QDataStream raw data calls take int sizes: large datasets are transferred in pieces
+  const qint64 RawDataPiece = 1 << 30;
+
+  void writeDataset(QDataStream & out, const flann::Matrix<float> * dataset)
+  {
+    out << (qint32)dataset->rows << (qint32)dataset->cols;
+    const char * data = (const char*)dataset->ptr();
+    for (qint64 size = (qint64)dataset->rows * dataset->cols * sizeof(float); size > 0; )
+      {
+        const int piece = std::min(size, RawDataPiece);
+        if (out.writeRawData(data, piece) != piece) return;
+        data += piece;
+        size -= piece;
+      }
+  }
+
+  flann::Matrix<float> * readDataset(QDataStream & in)
+  {
+    qint32 rows = 0, cols = 0;
+    in >> rows >> cols;
+    if (in.status() != QDataStream::Ok || rows < 1 || cols < 1) return nullptr;
+
+    qint64 size = (qint64)rows * cols * sizeof(float);
+    if (in.device() && size > in.device()->bytesAvailable()) return nullptr;  //corrupted header or truncated file
+
+    float * data = new float[(size_t)rows * cols];
+    char * p = (char*)data;
+    while (size > 0)
+      {
+        const int piece = std::min(size, RawDataPiece);
+        if (in.readRawData(p, piece) != piece)
+          {
+            delete[] data;
+            return nullptr;
+          }
+        p += piece;
+        size -= piece;
+      }
+    return new flann::Matrix<float>(data, rows, cols);
+  }
+
+  //FLANN saves an index only to a file: the content is embedded through a temporary file
+  bool writeIndex(QDataStream & out, flann::Index<flann::L1<float> > * index)
+  {
+    QTemporaryFile tmp;
+    if (!tmp.open()) return false;
+    tmp.close();
+    try
+    {
+      index->save(tmp.fileName().toStdString());
+    }
+    catch(...)
+    {
+      return false;
+    }
+    if (!tmp.open()) return false;
+    out << tmp.readAll();
+    return true;
+  }
+
+  flann::Index<flann::L1<float> > * readIndex(QDataStream & in, flann::Matrix<float> * dataset)
+  {
+    QByteArray ba;
+    in >> ba;
+    if (ba.isEmpty()) return nullptr;
+
+    QTemporaryFile tmp;
+    if (!tmp.open()) return nullptr;
+    tmp.write(ba);
+    tmp.close();
+    try
+    {
+      return new flann::Index<flann::L1<float> >(*dataset, flann::SavedIndexParams(tmp.fileName().toStdString()));
+    }
+    catch(...)
+    {
+      return nullptr;
+    }
+  }
+}
 
 void KNNfilterClass::clear()
 {
@@ -74,7 +207,8 @@ void KNNfilterClass::kNNsearch(int n)
   index.buildIndex();
 
   // do a knn search
-  index.knnSearch(*dataset, *indices, *dists, n, flann::SearchParams(numPMs));
+  knnSearchParallel(index, *dataset, *indices, *dists, n, SearchSettings, numPMs);
+  LastSearchSettings = SearchSettings;
 }
 
 bool KNNfilterClass::calculateAverageDists(int n)
@@ -109,11 +243,13 @@ bool KNNfilterClass::prepareNNfilter(int KNNfilterAverageOver)
     }
     //qDebug()<< "lastSearchN/LastAverageN/thisAverageN" << LastSearchN<<LastAveragedN<<KNNfilterAverageOver;
 
+  const bool bSameSearch = (SearchSettings == LastSearchSettings);
+
   //check if data are already there
-  if (LastAveragedN == KNNfilterAverageOver) return true;
+  if (LastAveragedN == KNNfilterAverageOver && bSameSearch) return true;
 
   //check if can reuse the search data
-  if (LastSearchN > -1  &&  KNNfilterAverageOver < LastSearchN)
+  if (LastSearchN > -1  &&  KNNfilterAverageOver < LastSearchN && bSameSearch)
     {
       calculateAverageDists(KNNfilterAverageOver);
       return true;
@@ -413,7 +549,7 @@ bool KNNreconstructorClass::reconstructEvents()
     }
 
      //qDebug() << "Running search" << (fTrainedXYwithSameEventSet?"in X and Y":"in X");
-   Xindex->knnSearch(eventData, indices, dists, numNeighbours, flann::SearchParams(numPMs));
+   knnSearchParallel(*Xindex, eventData, indices, dists, numNeighbours, SearchSettings, numPMs);
      //qDebug() << "Reconstructing X";
    reconstructPositions(0, &indices, &dists);
    //for (int i=0; i<numNeighbours; i++) qDebug() << dists[0][i];
@@ -425,7 +561,7 @@ bool KNNreconstructorClass::reconstructEvents()
    else
      {
          //qDebug() << "Running search in Y";
-       Yindex->knnSearch(eventData, indices, dists, numNeighbours, flann::SearchParams(numPMs));
+       knnSearchParallel(*Yindex, eventData, indices, dists, numNeighbours, SearchSettings, numPMs);
          //qDebug() << "Reconstructing Y";
        reconstructPositions(1, &indices, &dists);
      }
@@ -512,10 +648,112 @@ bool KNNreconstructorClass::readFromJson(QJsonObject &json)
   parseJson(json, "numTrees", numTrees);
   weightMode = 0; //compatibility - can be removed
   parseJson(json, "weightMode", weightMode);
+  SearchSettings.Checks = 0;
+  parseJson(json, "searchChecks", SearchSettings.Checks);
+  SearchSettings.Eps = 0;
+  parseJson(json, "searchEps", SearchSettings.Eps);
     //qDebug() << "kNNrecSet configured: numneighbours->"<<numNeighbours<<"Use neighbours in rec:"<<useNeighbours<<" Num trees:"<<numTrees<<" Weighting mode:"<<weightMode;
   return true;
 }
 
+bool KNNreconstructorClass::saveCalibration(const QString & fileName)
+{
+  ErrorString.clear();
+  const bool bX = (Xindex && Xdataset);
+  const bool bY = (Yindex && Ydataset && !fTrainedXYwithSameEventSet);
+  if (!bX && !bY)
+    {
+      ErrorString = "Calibration data are not ready";
+      return false;
+    }
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    {
+      ErrorString = "Cannot open file " + fileName;
+      return false;
+    }
+  QDataStream out(&file);
+  out << KnnRecFileMagic << KnnFileVersion << (qint32)PMs->count() << fTrainedXYwithSameEventSet << Xpositions << Ypositions;
+
+  out << bX;
+  if (bX)
+    {
+      writeDataset(out, Xdataset);
+      if (!writeIndex(out, Xindex)) ErrorString = "Failed to save knn index";
+    }
+  out << bY;
+  if (bY)
+    {
+      writeDataset(out, Ydataset);
+      if (!writeIndex(out, Yindex)) ErrorString = "Failed to save knn index";
+    }
+
+  if (out.status() != QDataStream::Ok) ErrorString = "Error while writing to file " + fileName;
+  return ErrorString.isEmpty();
+}
+
+bool KNNreconstructorClass::loadCalibration(const QString & fileName)
+{
+  ErrorString.clear();
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    {
+      ErrorString = "Cannot open file " + fileName;
+      return false;
+    }
+  QDataStream in(&file);
+  quint32 magic = 0;
+  qint32 version = 0, numPMs = 0;
+  in >> magic >> version;
+  if (magic != KnnRecFileMagic || version != KnnFileVersion)
+    {
+      ErrorString = "File " + fileName + " does not contain kNN reconstructor calibration data";
+      return false;
+    }
+  in >> numPMs;
+  if (numPMs != PMs->count())
+    {
+      ErrorString = QString("Calibration data were made for %1 PMs, while detector has %2").arg(numPMs).arg(PMs->count());
+      return false;
+    }
+
+  clear();
+  in >> fTrainedXYwithSameEventSet >> Xpositions >> Ypositions;
+
+  bool bX = false, bY = false;
+  in >> bX;
+  if (bX)
+    {
+      Xdataset = readDataset(in);
+      if (Xdataset) Xindex = readIndex(in, Xdataset);
+      if (!Xindex) ErrorString = "Failed to load knn index";
+    }
+  in >> bY;
+  if (bY && ErrorString.isEmpty())
+    {
+      Ydataset = readDataset(in);
+      if (Ydataset) Yindex = readIndex(in, Ydataset);
+      if (!Yindex) ErrorString = "Failed to load knn index";
+    }
+
+  if (!ErrorString.isEmpty())
+    {
+      clear();
+      Xpositions.clear();
+      Ypositions.clear();
+      return false;
+    }
+
+  if (fTrainedXYwithSameEventSet) emit readyXchanged(isXYready(), Xpositions.size());
+  else
+    {
+      emit readyXchanged(isXready(), Xpositions.size());
+      emit readyYchanged(isYready(), Ypositions.size());
+    }
+  return true;
+}
+
 // ------------------------ NN module --------------------------
 NNmoduleClass::NNmoduleClass(EventsDataClass *EventsDataHub, APmHub* PMs) : EventsDataHub(EventsDataHub)
 {  
@@ -533,7 +771,7 @@ NNmoduleClass::~NNmoduleClass()
 AScriptInterfacer::AScriptInterfacer(EventsDataClass *EventsDataHub, APmHub *PMs) :
   EventsDataHub(EventsDataHub), PMs(PMs), bCalibrationReady(false), NormSwitch(0), CalibrationEvents(0), FlannIndex(0) {}
 
-QVariant AScriptInterfacer::getNeighboursDirect(const QVector<float>& point, int numNeighbours)
+QVariant AScriptInterfacer::getNeighboursDirect(AConstEventSpan point, int numNeighbours)
 {
   if (point.size() != numPMs)
   {
@@ -563,7 +801,7 @@ QVariant AScriptInterfacer::getNeighboursDirect(const QVector<float>& point, int
    return vl;
 }
 
-const QVector<QPair<int, float> > AScriptInterfacer::neighbours(const QVector<float>& point, int numNeighbours)
+const QVector<QPair<int, float> > AScriptInterfacer::neighbours(AConstEventSpan point, int numNeighbours)
 {
   int* indicesContainer;
   try
@@ -599,7 +837,7 @@ const QVector<QPair<int, float> > AScriptInterfacer::neighbours(const QVector<fl
   for (int ipm = 0; ipm < numPMs; ipm++)
     eventData[0][ipm] = point.at(ipm) / norm;
 
-  FlannIndex->knnSearch(eventData, indices, dists, numNeighbours, flann::SearchParams(numPMs));
+  FlannIndex->knnSearch(eventData, indices, dists, numNeighbours, SearchSettings.makeSearchParams(numPMs));
 
   //packing results
   QVector<QPair<int, float> > res;
@@ -670,7 +908,7 @@ bool AScriptInterfacer::filterByDistance(int numNeighbours, float maxDistance, b
             eventData[iev][ipm] = EventsDataHub->Events.at(iev).at(ipm) / norm;
     }
 
-    FlannIndex->knnSearch(eventData, indices, dists, numNeighbours, flann::SearchParams(numPMs));
+    knnSearchParallel(*FlannIndex, eventData, indices, dists, numNeighbours, SearchSettings, numPMs);
 
     for (int iev=0; iev<numEvents; iev++)
     {
@@ -826,7 +1064,7 @@ bool AScriptInterfacer::setCalibrationDirect(const QVector< QVector<float>>& dat
     //filling data with optional normalization
     for (int iev = 0; iev < numCalibrationEvents; iev++)
         {
-          const float norm = ( NormSwitch > 0 ? calculateNorm(data.at(iev)) : 1.0f );
+          const float norm = ( NormSwitch > 0 ? calculateNorm(AConstEventSpan(data.at(iev).data(), data.at(iev).size())) : 1.0f );
           for (int ipm = 0; ipm < numPMs; ipm++)
              (*CalibrationEvents)[iev][ipm] = data.at(iev).at(ipm) / norm;
         }
@@ -848,6 +1086,67 @@ bool AScriptInterfacer::setCalibrationDirect(const QVector< QVector<float>>& dat
     return true;
 }
 
+bool AScriptInterfacer::saveCalibration(const QString & fileName)
+{
+  ErrorString.clear();
+  if (!bCalibrationReady)
+  {
+      ErrorString = "Calibration set is empty!";
+      return false;
+  }
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+      ErrorString = "Cannot open file " + fileName;
+      return false;
+  }
+  QDataStream out(&file);
+  out << KnnScriptFileMagic << KnnFileVersion << (qint32)numPMs << (qint32)NormSwitch << X << Y << Z << E;
+  writeDataset(out, CalibrationEvents);
+  if (!writeIndex(out, FlannIndex)) ErrorString = "Failed to save knn index";
+
+  if (out.status() != QDataStream::Ok) ErrorString = "Error while writing to file " + fileName;
+  return ErrorString.isEmpty();
+}
+
+bool AScriptInterfacer::loadCalibration(const QString & fileName)
+{
+  ErrorString.clear();
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+      ErrorString = "Cannot open file " + fileName;
+      return false;
+  }
+  QDataStream in(&file);
+  quint32 magic = 0;
+  qint32 version = 0, dim = 0, norm = 0;
+  in >> magic >> version;
+  if (magic != KnnScriptFileMagic || version != KnnFileVersion)
+  {
+      ErrorString = "File " + fileName + " does not contain kNN script calibration data";
+      return false;
+  }
+
+  clearCalibration();
+  in >> dim >> norm >> X >> Y >> Z >> E;
+  CalibrationEvents = readDataset(in);
+  if (CalibrationEvents) FlannIndex = readIndex(in, CalibrationEvents);
+  if (!FlannIndex || (int)CalibrationEvents->cols != dim)
+  {
+      clearCalibration();
+      ErrorString = "Failed to load knn calibration from file " + fileName;
+      return false;
+  }
+
+  numPMs = dim;
+  NormSwitch = norm;
+  numCalibrationEvents = CalibrationEvents->rows;
+  bCalibrationReady = true;
+  return true;
+}
+
 QVector<float> AScriptInterfacer::evaluatePhPerPhE(int numNeighbours, float upperDistanceLimit, float maxSignal)
 {
   if (!bCalibrationReady)
@@ -897,7 +1196,7 @@ QVector<float> AScriptInterfacer::evaluatePhPerPhE(int numNeighbours, float uppe
    return avSigma2OverAv;
 }
 
-float AScriptInterfacer::calculateNorm(const QVector<float>& data) const
+float AScriptInterfacer::calculateNorm(AConstEventSpan data) const
 {
     switch (NormSwitch)
     {
@@ -2,6 +2,7 @@
 #define NNMODULECLASS_H
 
 #include "flann/flann.hpp"
+#include "aeventstore.h"
 
 #include <QVector>
 #include <QJsonObject>
@@ -10,6 +11,18 @@
 
 class EventsDataClass;
 class APmHub;
+class QDataStream;
+
+// Options of the neighbour search, common for the filter, the reconstructor and the script interface
+struct AKnnSearchSettings
+{
+  int   NumThreads = 1; //queries are split in blocks between the threads, the index is shared
+  int   Checks = 0;     //leaves checked in the kd-trees, larger -> better recall but slower; 0 - number of PMs; -1 - unlimited (exact search)
+  float Eps = 0;        //approximate search: found neighbours can be up to (1+Eps) farther than the true ones
+
+  flann::SearchParams makeSearchParams(int numPMs) const;
+  bool operator==(const AKnnSearchSettings & other) const {return Checks == other.Checks && Eps == other.Eps;} //NumThreads does not change the result
+};
 
 class KNNfilterClass
 {
@@ -22,6 +35,9 @@ public:
   void clear(); //deletes/clears data and forces next filter call to recalculate data
   bool prepareNNfilter(int KNNfilterAverageOver); //MUST be used after events data changed
   float getAverageDist(int iev) {return averageDistNN[iev];} //assumes prepareNNfilter was already called
+  const QVector<float> & getAverageDists() const {return averageDistNN;}
+
+  AKnnSearchSettings SearchSettings;
 
   int getLastSearchN() {return LastSearchN;} //-1 if data not ready
   int getLastAveragedN() {return LastAveragedN;} //-1 if data not ready
@@ -38,6 +54,7 @@ private:
 
   int LastSearchN;   //-1 if not ready
   int LastAveragedN; //-1 if not ready
+  AKnnSearchSettings LastSearchSettings;
   int numEvents;
   int numPMs;
 
@@ -71,6 +88,11 @@ public:
 
   bool readFromJson(QJsonObject &json);
 
+  //calibration sets and kd-tree indexes are saved to one file, so they do not have to be rebuilt in the next session
+  bool saveCalibration(const QString & fileName);
+  bool loadCalibration(const QString & fileName);
+
+  AKnnSearchSettings SearchSettings;
   QString ErrorString;
 
 signals:
@@ -103,7 +125,7 @@ public:
    AScriptInterfacer(EventsDataClass *EventsDataHub, APmHub* PMs);
 
    QVariant getNeighbours(int ievent, int numNeighbours);
-   QVariant getNeighboursDirect(const QVector<float>& point, int numNeighbours);
+   QVariant getNeighboursDirect(AConstEventSpan point, int numNeighbours);
    bool filterByDistance(int numNeighbours, float maxDistance, bool filterOutEventsWithSmallerDistance);
 
    void SetSignalNormalization(int type) {NormSwitch = type;}
@@ -114,6 +136,11 @@ public:
 
    int countCalibrationEvents() {return numCalibrationEvents;}
 
+   bool saveCalibration(const QString & fileName);
+   bool loadCalibration(const QString & fileName);
+
+   AKnnSearchSettings SearchSettings;
+
    QVector<float> evaluatePhPerPhE(int numNeighbours, float upperDistanceLimit, float maxSignal);
    int countPMs() const {return numPMs;}
 
@@ -142,8 +169,8 @@ private:
 
    bool isValidEventIndex(int ievent);
 
-   float calculateNorm(const QVector<float>& data) const;
-   const QVector<QPair<int, float> > neighbours(const QVector<float> &point, int numNeighbours);
+   float calculateNorm(AConstEventSpan data) const;
+   const QVector<QPair<int, float> > neighbours(AConstEventSpan point, int numNeighbours);
 };
 
 class NNmoduleClass
@@ -8,6 +8,8 @@
 #include "sensorlocalcache.h"
 #include "afiletools.h"
 #include "amessage.h"
+#include "aparalleltasks.h"
+#include "aglobalsettings.h"
 
 #include "lrfaxial.h"
 #include "lrfcaxial.h"
@@ -210,6 +212,27 @@ double SensorLRFs::getLRF(int pmt, double x, double y, double z)
   return getLRF(pmt, r);
 }
 
+void SensorLRFs::getLRFs(const double *r, double *out, int numPMs)
+{
+  for (int ipm = 0; ipm < numPMs; ipm++) out[ipm] = 0;
+  for (int igrp = 0; igrp < currentIter->PMsensorGroups.size(); igrp++)
+    currentIter->PMsensorGroups.at(igrp).evalAll(r, out, numPMs);
+}
+
+void SensorLRFs::getLRFErrs(const double *r, double *out, int numPMs)
+{
+  for (int ipm = 0; ipm < numPMs; ipm++) out[ipm] = 0;
+  for (int igrp = 0; igrp < currentIter->PMsensorGroups.size(); igrp++)
+    currentIter->PMsensorGroups.at(igrp).evalErrAll(r, out, numPMs);
+}
+
+void SensorLRFs::getLRFsAndGradients(const double *r, double *out, double *gradX, double *gradY, int numPMs)
+{
+  for (int ipm = 0; ipm < numPMs; ipm++) out[ipm] = gradX[ipm] = gradY[ipm] = 0;
+  for (int igrp = 0; igrp < currentIter->PMsensorGroups.size(); igrp++)
+    currentIter->PMsensorGroups.at(igrp).evalDrvAll(r, out, gradX, gradY, numPMs);
+}
+
 double SensorLRFs::getLRF(int iter, int pmt, double x, double y, double z)
 {
   double r[3];
@@ -788,7 +811,7 @@ bool SensorLRFs::makeLRFs(QJsonObject &json, EventsDataClass *EventsDataHub, APm
   //LRFsettings.dump(); //debug output
 
   //alias for events
-  QVector < QVector <float> > *events = &EventsDataHub->Events;
+  const AEventStore *events = &EventsDataHub->Events;
 
   //-----------------------------------------------------------------------------
 
@@ -817,43 +840,51 @@ bool SensorLRFs::makeLRFs(QJsonObject &json, EventsDataClass *EventsDataHub, APm
       //qDebug()<<"Groups created => " << groups->size();
     }
 
-  //setup data cache for good events
-  SensorLocalCache lrfmaker(EventsDataHub->countGoodEvents(),
-                            LRFsettings.dataScanRecon,
-                            LRFsettings.scale_by_energy,
-                            EventsDataHub->ReconstructionData.at(0),
-                            &EventsDataHub->Scan,
-                            events,
-                            &LRFsettings);  
-  //qDebug() << "LRFmaker created and initialized";
-
   //making sensor groups (all or a single one)
-  bool OK = true;
-  if (LRFsettings.fLimitGroup)
-    { //making a single group
-      OK = makeGroupLRF(LRFsettings.igrToMake, LRFsettings, groups, &lrfmaker);
-    }
-  else
-    { //making all groups
-      int ngrp = groups->size();
-      double PrScale = (ngrp>0) ? 100.0/ngrp : 100.0;
+  const int ngrp = (LRFsettings.fLimitGroup ? 1 : groups->size());
+  int numThreads = LRFsettings.NumThreads;
+  if (numThreads < 1) numThreads = AGlobalSettings::getInstance().RecNumTreads;
+  numThreads = std::max(1, std::min(numThreads, ngrp));
+
+  //setup data cache for good events: one per thread, since the group data are cached there
+  QVector<SensorLocalCache*> lrfmakers;
+  for (int ithread = 0; ithread < numThreads; ithread++)
+      lrfmakers << new SensorLocalCache(EventsDataHub->countGoodEvents(),
+                                        LRFsettings.dataScanRecon,
+                                        LRFsettings.scale_by_energy,
+                                        EventsDataHub->ReconstructionData.at(0),
+                                        &EventsDataHub->Scan,
+                                        events,
+                                        &LRFsettings);
+  //qDebug() << "LRFmaker created and initialized";
 
-      for(int igrp = 0; igrp < ngrp; igrp++)
-        {
-          qApp->processEvents();
-          if (fStopRequest)
-            {
-              fStopRequest= false;
-              error_string = "Aborted by user";
-              return false;
-            }
+  //every task writes only to its own group -> the result does not depend on the thread scheduling
+  PMsensorGroup *groupData = groups->data(); //detach (if needed) here and not in the threads
+  const int igrFirst = (LRFsettings.fLimitGroup ? LRFsettings.igrToMake : 0);
+  const double PrScale = 100.0/ngrp;
 
-          OK = makeGroupLRF(igrp, LRFsettings, groups, &lrfmaker);
-          if (!OK) break;
+  bool fAborted = false;
+  auto fitGroup = [&](int itask, int ithread)
+  {
+      const int igrp = igrFirst + itask;
+      return makeGroupLRF(igrp, &groupData[igrp], lrfmakers[ithread]);
+  };
+  auto monitor = [&](int numDone)
+  {
+      if (!LRFsettings.fLimitGroup) emit ProgressReport(int(PrScale*numDone));
+      qApp->processEvents();
+      if (fStopRequest) fAborted = true;
+      return !fAborted;
+  };
+  bool OK = runParallelTasks(ngrp, numThreads, fitGroup, monitor);
+  qDeleteAll(lrfmakers);
 
-          int progress = PrScale*(igrp+1);
-          emit ProgressReport(progress);
-        }
+  if (fAborted)
+    {
+      fStopRequest = false;
+      error_string = "Aborted by user";
+      emit ProgressReport(0);
+      return false;
     }
 
   //Attempting to register the created iteration. Sets it as current if valid
@@ -936,7 +967,7 @@ bool SensorLRFs::onlyGains(QJsonObject &json, EventsDataClass *EventsDataHub, AP
   //LRFsettings.dump(); //debug output
 
   //alias for events
-  QVector < QVector <float> > *events = &EventsDataHub->Events;
+  const AEventStore *events = &EventsDataHub->Events;
 
   //-----------------------------------------------------------------------------
 
@@ -1001,10 +1032,10 @@ bool SensorLRFs::onlyGains(QJsonObject &json, EventsDataClass *EventsDataHub, AP
   return OK;
 }
 
-bool SensorLRFs::makeGroupLRF(int igrp, ALrfFitSettings &LRFsettings, QVector<PMsensorGroup> *groups, SensorLocalCache *lrfmaker)
+bool SensorLRFs::makeGroupLRF(int igrp, PMsensorGroup *group, SensorLocalCache *lrfmaker)
 {
+  //can be called from several threads simultaneously, each with its own group and lrfmaker
   //qDebug() << "Making LRFs for sensor group " << igrp;
-  PMsensorGroup *group = &(*groups)[igrp];
   //caching data for group processing
   if(!lrfmaker->cacheGroup(group->getPMs(), LRFsettings.fAdjustGains, igrp)) return false;
   //qDebug() << "Group data caching complete";
@@ -1012,7 +1043,7 @@ bool SensorLRFs::makeGroupLRF(int igrp, ALrfFitSettings &LRFsettings, QVector<PM
   //If we want, we can make multiple different lrfs for the same group
   //this is the right place, now that local data is cached for this group
   //we would of course need to manage the multiple group containers  
-  LRF2 *newLRF;
+  LRF2 *newLRF = 0;
   switch(LRFsettings.LRFtype)
     {
     case 0: newLRF = lrfmaker->mkLRFaxial(LRFsettings.nodesx, LRFsettings.compr); break;
@@ -99,6 +99,11 @@ public:
     double getLRFErr(int pmt, const double *r) {return currentIter->sensors[pmt]->evalErr(r);}
     double getLRFErrLocal(int pmt, double *r_local) {return currentIter->sensors[pmt]->evalErrLocal(r_local);}
        double getLRFErr(int pmt, double x, double y, double z);
+    // all sensors of the current iteration for one position: one batched LRF call per sensor group
+    // out has numPMs entries, sensors without LRF give 0
+    void getLRFs(const double *r, double *out, int numPMs);
+    void getLRFErrs(const double *r, double *out, int numPMs);
+    void getLRFsAndGradients(const double *r, double *out, double *gradX, double *gradY, int numPMs); // gradient over world x and y
     double getLRFDrvX(int pmt, double *r) {return currentIter->sensors[pmt]->evalDrvX(r);}
        double getLRFDrvX(int pmt, double x, double y, double z);
     double getLRFDrvY(int pmt, double *r) {return currentIter->sensors[pmt]->evalDrvY(r);}
@@ -156,7 +161,7 @@ private:
 
     bool fStopRequest;
 
-    bool makeGroupLRF(int igrp, ALrfFitSettings &LRFsettings, QVector<PMsensorGroup> *groups, SensorLocalCache *lrfmaker);
+    bool makeGroupLRF(int igrp, PMsensorGroup *group, SensorLocalCache *lrfmaker); //thread-safe for different groups and lrfmakers
 };
 
 #endif // SENSORLRFS_H
@@ -21,6 +21,7 @@ AConfig_SI::AConfig_SI(AConfiguration *config) :
   H["Replace"] = "Replace the value of the key in the configuration object with the new one. Key value can be basic types (bool, double, string) as well as arrays and objects. Changing detector-related settings (DetectorConfig top node) will automatically run RebuildDetector!";
   H["UpdateGui"] = "Update GUI during script execution according to current settings in Config.";
   H["GetKeyValue"] = "Return the value of the Key: it can be basic types (bool, double, string) as well as arrays and objects.";
+  H["SetConfigSections"] = "Load only the sections (DetectorConfig, SimulationConfig, ReconstructionConfig) present in the given object, the others are kept.\nDetector is rebuilt only if DetectorConfig is given.";
 
 }
 
@@ -499,6 +500,33 @@ bool AConfig_SI::SetConfig(const QVariant &conf)
     return false;
 }
 
+bool AConfig_SI::SetConfigSections(const QVariant &sections)
+{
+    if (!bGuiThread)
+      {
+        abort("Script in threads: cannot modify detector configuration!");
+        return false;
+      }
+
+    if (sections.type() == QVariant::Map)
+    {
+        QVariantMap vm = sections.toMap();
+        QJsonObject json = QJsonObject::fromVariantMap(vm);
+
+        const bool bDet = json.contains("DetectorConfig");
+        const bool bSim = json.contains("SimulationConfig");
+        const bool bRec = json.contains("ReconstructionConfig");
+        if (bDet || bSim || bRec)
+        {
+            Config->LoadConfig(json, bDet, bSim, bRec);
+            return true;
+        }
+    }
+
+    abort("Failed to set config sections from object: it does not contain any configuration section");
+    return false;
+}
+
 void AConfig_SI::ExportToGDML(QString FileName)
 {
     QString err = Config->GetDetector()->exportToGDML(FileName);
@@ -32,6 +32,7 @@ public slots:
 
   const QVariant GetConfig() const;
   bool SetConfig(const QVariant& conf);
+  bool SetConfigSections(const QVariant& sections);
 
   void ExportToGDML(QString FileName);
   void ExportToROOT(QString FileName);
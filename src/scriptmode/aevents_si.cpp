@@ -64,7 +64,7 @@ QVariant AEvents_SI::GetPMsignals(int ievent)
       return 0;
     }
 
-  const QVector< float >& sigs = EventsDataHub->Events.at(ievent);
+  const AConstEventSpan sigs = EventsDataHub->Events.at(ievent);
   QVariantList l;
   for (const float & f : sigs) l << QVariant(f);
   return l;
@@ -75,10 +75,10 @@ const QVariantList AEvents_SI::GetPMsignals() const
     QVariantList vl;
     vl.reserve(EventsDataHub->Events.size());
 
-    for (const QVector<float> & event : EventsDataHub->Events)
+    for (int iev = 0; iev < EventsDataHub->Events.size(); iev++)
     {
         QVariantList el;
-        for (const float & sig : event) el << sig;
+        for (const float & sig : EventsDataHub->Events.at(iev)) el << sig;
         vl.push_back(el);
     }
     return vl;
@@ -118,14 +118,14 @@ double AEvents_SI::GetPMsignalTimed(int ievent, int ipm, int iTimeBin)
         return 0;
       }
 
-    int numPMs = EventsDataHub->TimedEvents.at(ievent).at(iTimeBin).size();
+    int numPMs = EventsDataHub->TimedEvents.getNumChannels();
     if (ipm<0 || ipm>=numPMs)
       {
         abort("Wrong PM number "+QString::number(ipm)+"; PMs in the events data file: "+QString::number(numPMs));
         return 0;
       }
 
-    return EventsDataHub->TimedEvents.at(ievent).at(iTimeBin).at(ipm);
+    return EventsDataHub->TimedEvents.atTimeBin(ievent, iTimeBin).at(ipm);
 }
 
 QVariant AEvents_SI::GetPMsignalVsTime(int ievent, int ipm)
@@ -140,7 +140,7 @@ QVariant AEvents_SI::GetPMsignalVsTime(int ievent, int ipm)
     int numTimeBins = countTimeBins();
     if (numTimeBins == 0) return QVariantList();
 
-    int numPMs = EventsDataHub->TimedEvents.at(ievent).first().size();
+    int numPMs = EventsDataHub->TimedEvents.getNumChannels();
     if (ipm<0 || ipm>=numPMs)
       {
         abort("Wrong PM number "+QString::number(ipm)+"; PMs in the events data file: "+QString::number(numPMs));
@@ -149,20 +149,20 @@ QVariant AEvents_SI::GetPMsignalVsTime(int ievent, int ipm)
 
     QVariantList aa;
     for (int i=0; i<numTimeBins; i++)
-        aa << EventsDataHub->TimedEvents.at(ievent).at(i).at(ipm);
+        aa << EventsDataHub->TimedEvents.atTimeBin(ievent, i).at(ipm);
     return aa;
 }
 
 int AEvents_SI::GetNumPMs()
 {
   if (EventsDataHub->Events.isEmpty()) return 0;
-  return EventsDataHub->Events.first().size();
+  return EventsDataHub->Events.getNumChannels();
 }
 
 int AEvents_SI::countPMs()
 {
     if (EventsDataHub->Events.isEmpty()) return 0;
-    return EventsDataHub->Events.first().size();
+    return EventsDataHub->Events.getNumChannels();
 }
 
 int AEvents_SI::GetNumEvents()
@@ -183,7 +183,7 @@ int AEvents_SI::countTimedEvents()
 int AEvents_SI::countTimeBins()
 {
     if (EventsDataHub->TimedEvents.isEmpty()) return 0;
-    return EventsDataHub->TimedEvents.first().size();
+    return EventsDataHub->TimedEvents.getNumTimeBins();
 }
 
 bool AEvents_SI::checkEventNumber(int ievent)
@@ -835,6 +835,24 @@ void AEvents_SI::LoadEventsTree(QString fileName, bool Append, int MaxNumEvents)
   emit RequestEventsGuiUpdate();
 }
 
+void AEvents_SI::LoadEventsBinary(QString fileName, bool Append, int MaxNumEvents)
+{
+    if (!bGuiThread)
+    {
+        abort("Only GUI thread can do LoadEventsBinary()");
+        return;
+    }
+
+  if (!Append) EventsDataHub->clear();
+  if (EventsDataHub->loadEventsFromBinaryFile(fileName, *Config->GetDetector()->PMs, MaxNumEvents) < 0)
+  {
+      abort(EventsDataHub->ErrorString);
+      return;
+  }
+  EventsDataHub->createDefaultReconstructionData();
+  emit RequestEventsGuiUpdate();
+}
+
 void AEvents_SI::LoadEventsAscii(QString fileName, bool Append)
 {
     if (!bGuiThread)
@@ -114,6 +114,7 @@ public slots:
   //load data
   void LoadEventsTree(QString fileName, bool Append = false, int MaxNumEvents = -1);
   void LoadEventsAscii(QString fileName, bool Append = false);
+  void LoadEventsBinary(QString fileName, bool Append = false, int MaxNumEvents = -1);
 
   //clear data
   void ClearEvents();
@@ -9,6 +9,10 @@ AFarm_si::AFarm_si(const QJsonObject & Config, AGridRunner & GridRunner) :
     AScriptInterface(), Config(Config), GridRunner(GridRunner)
 {
     H["getServers"] = "Returns the list of all configured servers\nFormat: [ [NumThreads1, SpeedFactor1], [NumThreads2, SpeedFactor2], ... ])";
+    H["setFrameOptions"] = "Events and reconstruction results are transferred to/from the servers in frames of EventsPerFrame events\nIf Compress is true, the frames are compressed";
+    H["setBatchesPerServer"] = "Events are given to the servers in batches as the servers become free; on average there are Batches batches per server\nMore batches give better load balancing at the cost of more round trips";
+    H["setSessionKeepAlive"] = "Sessions with the servers are kept open between the jobs (e.g. evaluateScript in a loop) for KeepAlive_ms milliseconds\nConfig sections and files already present on the server are not sent again\n0 - the sessions are closed after each job";
+    H["closeSessions"] = "Close all open sessions, the servers are returned to the dispatchers";
 }
 
 void AFarm_si::ForceStop()
@@ -21,6 +25,41 @@ void AFarm_si::setTimeout(double Timeout_ms)
     GridRunner.SetTimeout(Timeout_ms);
 }
 
+void AFarm_si::setFrameOptions(int EventsPerFrame, bool Compress)
+{
+    if (EventsPerFrame < 1)
+    {
+        abort("Number of events per frame should be positive");
+        return;
+    }
+    GridRunner.SetFrameOptions(EventsPerFrame, Compress);
+}
+
+void AFarm_si::setSessionKeepAlive(int KeepAlive_ms)
+{
+    if (KeepAlive_ms < 0)
+    {
+        abort("Keep alive time cannot be negative");
+        return;
+    }
+    GridRunner.SetSessionKeepAlive(KeepAlive_ms);
+}
+
+void AFarm_si::closeSessions()
+{
+    GridRunner.CloseSessions();
+}
+
+void AFarm_si::setBatchesPerServer(int Batches)
+{
+    if (Batches < 1)
+    {
+        abort("Number of batches per server should be positive");
+        return;
+    }
+    GridRunner.SetBatchesPerServer(Batches);
+}
+
 QVariantList AFarm_si::getServers()
 {
     QVariantList res;
@@ -27,6 +27,10 @@ public slots:
     void         simulate();
 
     void         setTimeout(double Timeout_ms);
+    void         setFrameOptions(int EventsPerFrame, bool Compress);
+    void         setBatchesPerServer(int Batches);
+    void         setSessionKeepAlive(int KeepAlive_ms);
+    void         closeSessions();
 
 private:
     const QJsonObject & Config;
@@ -3,6 +3,7 @@
 
 #include <QDebug>
 #include <limits>
+#include <algorithm>
 
 AKnn_SI::AKnn_SI(NNmoduleClass* knnModule) : knnModule(knnModule)
 {
@@ -12,6 +13,14 @@ AKnn_SI::AKnn_SI(NNmoduleClass* knnModule) : knnModule(knnModule)
     H["filterByDistance"] = "Filters currently available events according to the distance to the calibration events. "
             "Average distance is calculated over numNeighbours, cut is performed in respect of the average distance = distanceLimit, "
             "filterOutEventsWithSmallerDistance option sets which events to cut - with smaller or large value than the limit.";
+    H["setSearchOptions"] = "Batch searches (filterByDistance) are split between numThreads threads.\n"
+            "checks: number of leaves checked in the kd-trees, larger value gives better recall but slower search; "
+            "0 - number of PMs (default), -1 - exact search.\n"
+            "eps: approximate search, found neighbours can be up to (1+eps) times farther than the true ones; 0 - default";
+    H["saveCalibration"] = "Save the calibration events together with the search index, so the index does not have to be rebuilt";
+    H["loadCalibration"] = "Load the calibration events and the search index saved with saveCalibration()";
+    H["saveReconstructorCalibration"] = "Save the calibration sets and indexes of the kNN reconstructor";
+    H["loadReconstructorCalibration"] = "Load the calibration sets and indexes of the kNN reconstructor saved with saveReconstructorCalibration()";
 }
 
 QVariant AKnn_SI::getNeighbours(int ievent, int numNeighbours)
@@ -38,7 +47,7 @@ QVariant AKnn_SI::getNeighboursDirect(QVariant onePoint, int numNeighbours)
       data << VarList.at(i).toFloat();
     }
 
-  QVariant res = knnModule->ScriptInterfacer->getNeighboursDirect(data, numNeighbours);
+  QVariant res = knnModule->ScriptInterfacer->getNeighboursDirect(AConstEventSpan(data.data(), data.size()), numNeighbours);
   if (res == QVariantList())
   {
       abort("kNN module reports fail:\n" + knnModule->ScriptInterfacer->ErrorString);
@@ -61,6 +70,14 @@ void AKnn_SI::SetSignalNormalizationType(int type_0None_1sum_2quadraSum)
   knnModule->ScriptInterfacer->SetSignalNormalization(type_0None_1sum_2quadraSum);
 }
 
+void AKnn_SI::setSearchOptions(int numThreads, int checks, double eps)
+{
+  AKnnSearchSettings & s = knnModule->ScriptInterfacer->SearchSettings;
+  s.NumThreads = std::max(1, numThreads);
+  s.Checks = checks;
+  s.Eps = eps;
+}
+
 void AKnn_SI::clearCalibrationEvents()
 {
   knnModule->ScriptInterfacer->clearCalibration();
@@ -124,6 +141,30 @@ QString AKnn_SI::setCalibrationDirect(QVariant arrayOfArrays)
   return knnModule->ScriptInterfacer->ErrorString;
 }
 
+void AKnn_SI::saveCalibration(QString fileName)
+{
+  if (!knnModule->ScriptInterfacer->saveCalibration(fileName))
+      abort("kNN module reports fail:\n" + knnModule->ScriptInterfacer->ErrorString);
+}
+
+void AKnn_SI::loadCalibration(QString fileName)
+{
+  if (!knnModule->ScriptInterfacer->loadCalibration(fileName))
+      abort("kNN module reports fail:\n" + knnModule->ScriptInterfacer->ErrorString);
+}
+
+void AKnn_SI::saveReconstructorCalibration(QString fileName)
+{
+  if (!knnModule->Reconstructor.saveCalibration(fileName))
+      abort("kNN module reports fail:\n" + knnModule->Reconstructor.ErrorString);
+}
+
+void AKnn_SI::loadReconstructorCalibration(QString fileName)
+{
+  if (!knnModule->Reconstructor.loadCalibration(fileName))
+      abort("kNN module reports fail:\n" + knnModule->Reconstructor.ErrorString);
+}
+
 QVariant AKnn_SI::evaluatePhPerPhE(int numNeighbours, float upperDistanceLimit, float maxSignal)
 {
     QVector<float> phe = knnModule->ScriptInterfacer->evaluatePhPerPhE(numNeighbours, upperDistanceLimit, maxSignal);
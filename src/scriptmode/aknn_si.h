@@ -22,6 +22,7 @@ public slots:
 
   // options - set BEFORE calibration dataset is given
   void SetSignalNormalizationType(int type_0None_1sum_2quadraSum);
+  void setSearchOptions(int numThreads, int checks, double eps);
 
   // Clear all calibration data
   void clearCalibrationEvents();
@@ -29,6 +30,11 @@ public slots:
   QString setGoodScanEventsAsCalibration();
   QString setGoodReconstructedEventsAsCalibration();
   QString setCalibrationDirect(QVariant arrayOfArrays);
+  // Save / load calibration data together with the search index
+  void saveCalibration(QString fileName);
+  void loadCalibration(QString fileName);
+  void saveReconstructorCalibration(QString fileName);
+  void loadReconstructorCalibration(QString fileName);
 
   //stat calibration
   QVariant evaluatePhPerPhE(int numNeighbours, float upperDistanceLimit, float maxSignal);
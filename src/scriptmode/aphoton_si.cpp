@@ -184,13 +184,14 @@ void APhoton_SI::handleEventData(bool AddToPreviousEvent)
     bool bDataContainersMatch = false;
     if (bAlreadyHaveEvent)
     {
-        if ( EventsDataHub->Events.last().size() == Event->PMsignals.size() )
+        if ( EventsDataHub->Events.getNumChannels() == Event->PMsignals.size() )
         {
             if (bTimed)
             {
-                if (EventsDataHub->TimedEvents.last().size() == Event->TimedPMsignals.size()) //matching number of time bins
+                if (EventsDataHub->TimedEvents.size() == EventsDataHub->Events.size() &&
+                    EventsDataHub->TimedEvents.getNumTimeBins() == Event->TimedPMsignals.size()) //matching number of time bins
                 {
-                    if (EventsDataHub->TimedEvents.last().last().size() == Event->TimedPMsignals.last().size()) //matching number of PMs
+                    if (EventsDataHub->TimedEvents.getNumChannels() == Event->TimedPMsignals.last().size()) //matching number of PMs
                        bDataContainersMatch = true;
                 }
             }
@@ -206,7 +207,7 @@ void APhoton_SI::handleEventData(bool AddToPreviousEvent)
         if (bTimed)
             for (int i=0; i<Event->TimedPMsignals.size(); i++)
                 for (int ii=0; ii<Event->TimedPMsignals.at(i).size(); ii++)
-                     EventsDataHub->TimedEvents.last()[i][ii] += Event->TimedPMsignals[i][ii];
+                     EventsDataHub->TimedEvents.getTimeBin(EventsDataHub->TimedEvents.size()-1, i)[ii] += Event->TimedPMsignals[i][ii];
     }
     else
     {
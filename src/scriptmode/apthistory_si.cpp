@@ -113,15 +113,11 @@ QString APTHistory_SI::cd_getProductionProcess()
             return "";
         }
 
-        const std::vector<ATrackingStepData *> & vecSteps = parent->getSteps();
+        const std::vector<ATrackingStepData> & vecSteps = parent->getSteps();
         const int numSteps = (int)vecSteps.size();
         for (int iS = numSteps - 1; iS > -1; iS--)
-        {
-            const std::vector<int> & thisStepSecs = vecSteps.at(iS)->Secondaries;
-            for (const int & iSec : thisStepSecs)
-                if (iSec == index)
-                    return vecSteps.at(iS)->Process;
-        }
+            if (vecSteps.at(iS).isSecondaryOfThisStep(index))
+                return vecSteps.at(iS).getProcess();
         abort("Corruption in secondary record detected: secondary not found in the parent record");
     }
     else abort("Record not set: use cd_set command");
@@ -169,7 +165,7 @@ bool APTHistory_SI::cd_stepToProcess(QString processName)
         while ( Step < (int)Rec->getSteps().size() - 1)
         {
             Step++;
-            if (Rec->getSteps().at(Step)->Process == processName) return true;
+            if (Rec->getSteps().at(Step).getProcess() == processName) return true;
         }
     }
     else abort("Record not set: use cd_set command");
@@ -215,7 +211,7 @@ bool APTHistory_SI::cd_firstNonTransportationStep()
         {
             Step++;
             if (Step == last) return false;
-            if (Rec->getSteps().at(Step)->Process != "T") return true;
+            if (Rec->getSteps().at(Step).ProcessId != ATrackingNameTable::Transportation) return true;
         }
     }
     else abort("Record not set: use cd_set command");
@@ -245,7 +241,7 @@ QVariantList APTHistory_SI::cd_getStepRecord()
         if (Step < 0) Step = 0; //forced first step
         if (Step < (int)Rec->getSteps().size())
         {
-            ATrackingStepData * s = Rec->getSteps().at(Step);
+            const ATrackingStepData * s = &Rec->getSteps().at(Step);
             vl.push_back( QVariantList() << s->Position[0] << s->Position[1] << s->Position[2] );
             vl << s->Time;
             QVariantList vnode;
@@ -256,20 +252,20 @@ QVariantList APTHistory_SI::cd_getStepRecord()
                     abort("Corrupted tracking history!");
                     return vl;
                 }
-                ATransportationStepData * trans = dynamic_cast<ATransportationStepData*>(Rec->getSteps().at(iStep));
-                if (!trans) continue;
+                const ATrackingStepData & trans = Rec->getSteps().at(iStep);
+                if (!trans.isTransportation()) continue;
 
-                vnode << trans->iMaterial;
-                vnode << trans->VolName;
-                vnode << trans->VolIndex;
+                vnode << trans.iMaterial;
+                vnode << trans.getVolName();
+                vnode << trans.VolIndex;
                 break;
             }
             vl.push_back(vnode);
             vl << s->Energy;
             vl << s->DepositedEnergy;
-            vl << s->Process;
+            vl << s->getProcess();
             QVariantList svl;
-            for (int & iSec : s->Secondaries) svl << iSec;
+            for (int iSec = s->FirstSecondary; iSec < s->FirstSecondary + s->NumSecondaries; iSec++) svl << iSec;
             vl.push_back(svl);
         }
         else abort("Error: bad current step!");
@@ -302,17 +298,17 @@ QVariantList APTHistory_SI::cd_getDirections()
         QVariantList inDir;
         QVariantList outDir;
         double delta[3];
-        const ATrackingStepData * thisStep = Rec->getSteps().at(Step);
+        const ATrackingStepData * thisStep = &Rec->getSteps().at(Step);
         if (Step != 0)
         {
-            const ATrackingStepData * lastStep = Rec->getSteps().at(Step-1);
+            const ATrackingStepData * lastStep = &Rec->getSteps().at(Step-1);
             for (int i=0; i<3; i++) delta[i] = thisStep->Position[i] - lastStep->Position[i];
             bool ok = normVector(delta);
             if (ok) inDir << delta[0] << delta[1] << delta[2];
         }
         if (Step != (int)Rec->getSteps().size())
         {
-            const ATrackingStepData * nextStep = Rec->getSteps().at(Step+1);
+            const ATrackingStepData * nextStep = &Rec->getSteps().at(Step+1);
             for (int i=0; i<3; i++) delta[i] = nextStep->Position[i] - thisStep->Position[i];
             bool ok = normVector(delta);
             if (ok) outDir << delta[0] << delta[1] << delta[2];
@@ -352,8 +348,7 @@ bool APTHistory_SI::cd_hadPriorInteraction()
         while ( Step > 2 && Step < (int)Rec->getSteps().size() ) // note Step-- below: no need to test Step=0 and the last step
         {
             Step--;
-            const QString & Proc = Rec->getSteps().at(Step)->Process;
-            if (Proc != "T") return true;
+            if (Rec->getSteps().at(Step).ProcessId != ATrackingNameTable::Transportation) return true;
         }
     }
     else abort("Record not set: use cd_set command");
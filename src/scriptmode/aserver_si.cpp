@@ -1,16 +1,39 @@
 #include "aserver_si.h"
 #include "awebsocketsessionserver.h"
 #include "eventsdataclass.h"
+#include "aeventframe.h"
 
 #include <QDebug>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QFile>
+#include <QCryptographicHash>
+
+#include <algorithm>
 
 AServer_SI::AServer_SI(AWebSocketSessionServer &Server, EventsDataClass *EventsDataHub) :
     AScriptInterface(), Server(Server), EventsDataHub(EventsDataHub)
 {
     QObject::connect(&Server, &AWebSocketSessionServer::requestAbort, this, &AServer_SI::AbortScriptEvaluation);
+
+    Server.SetBinaryFrameHandler( [this](const QByteArray & ba, QString & error){return onBinaryFrame(ba, error);} );
+}
+
+AServer_SI::~AServer_SI()
+{
+    Server.SetBinaryFrameHandler(nullptr);
+}
+
+bool AServer_SI::onBinaryFrame(const QByteArray &ba, QString &error)
+{
+    if (!AEventFrame::isFrame(ba)) return false;
+
+    AEventFrame frame;
+    if (!frame.read(ba))
+        error = frame.ErrorString;
+    else if (!EventsDataHub->appendFromEventFrame(frame))
+        error = "Failed to set events from the binary frame";
+    return true;
 }
 
 void AServer_SI::SendText(const QString &message)
@@ -41,6 +64,67 @@ void AServer_SI::SendReconstructionData()
     Server.ReplyWithQByteArray(ba);
 }
 
+void AServer_SI::sendEventFrames(const AEventStore &store, bool bTimed, int EventsPerFrame, bool Compress)
+{
+    const int numEvents = store.size();
+    QByteArray ba;
+    for (int from = 0; from < numEvents; from += EventsPerFrame)
+    {
+        const int to = std::min(from + EventsPerFrame, numEvents);
+        AEventFrame::packEvents(store, bTimed, from, to, from, numEvents, Compress, ba);
+        Server.SendBinaryFrame(ba);
+    }
+}
+
+void AServer_SI::SendSimulationFrames(int EventsPerFrame, bool Compress)
+{
+    if (EventsPerFrame < 1)
+    {
+        abort("Number of events per frame should be positive");
+        return;
+    }
+
+    sendEventFrames(EventsDataHub->Events, false, EventsPerFrame, Compress);
+    if (EventsDataHub->isTimed())
+        sendEventFrames(EventsDataHub->TimedEvents, true, EventsPerFrame, Compress);
+
+    const QVector<AScanRecord*> & Scan = EventsDataHub->Scan;
+    QByteArray ba;
+    for (int from = 0; from < Scan.size(); from += EventsPerFrame)
+    {
+        const int to = std::min(from + EventsPerFrame, Scan.size());
+        AEventFrame::packScan(Scan, from, to, from, Scan.size(), Compress, ba);
+        Server.SendBinaryFrame(ba);
+    }
+
+    Server.ReplyWithText( QString("{ \"binary\" : \"frames\", \"numRuns\" : %1 }").arg(EventsDataHub->ScanNumberOfRuns) );
+}
+
+void AServer_SI::SendReconstructionFrames(int EventsPerFrame, bool Compress)
+{
+    if (EventsPerFrame < 1)
+    {
+        abort("Number of events per frame should be positive");
+        return;
+    }
+    if (EventsDataHub->ReconstructionData.isEmpty())
+    {
+        abort("There are no reconstruction data");
+        return;
+    }
+
+    const QVector<AReconRecord*> & Rec = EventsDataHub->ReconstructionData.at(0);
+    QByteArray ba;
+    for (int from = 0; from < Rec.size(); from += EventsPerFrame)
+    {
+        const int to = std::min(from + EventsPerFrame, Rec.size());
+        AEventFrame::packReconstruction(Rec, from, to, from, Rec.size(), Compress, ba);
+        Server.SendBinaryFrame(ba);
+    }
+
+    Server.ReplyWithText("{ \"binary\" : \"frames\" }");
+}
+
 bool AServer_SI::IsBufferEmpty() const
 {
     return Server.isBinaryEmpty();
@@ -87,6 +171,40 @@ bool AServer_SI::SaveBufferToFile(const QString &fileName)
     return true;
 }
 
+QString AServer_SI::GetFileHash(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return "";
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file)) return "";
+    return hash.result().toHex();
+}
+
+const QVariant AServer_SI::GetConfigHashes(const QVariant &currentConfig) const
+{
+    const QJsonObject json = QJsonObject::fromVariantMap(currentConfig.toMap());
+
+    QVariantMap res;
+    for (auto it = ConfigCache.constBegin(); it != ConfigCache.constEnd(); ++it)
+        if (json[it.key()].toObject() == it.value().Section)
+            res[it.key()] = it.value().Hash;
+    return res;
+}
+
+void AServer_SI::StoreConfigHashes(const QVariant &hashes, const QVariant &currentConfig)
+{
+    const QJsonObject json = QJsonObject::fromVariantMap(currentConfig.toMap());
+
+    const QVariantMap hm = hashes.toMap();
+    for (auto it = hm.constBegin(); it != hm.constEnd(); ++it)
+    {
+        AConfigSectionRecord & r = ConfigCache[it.key()];
+        r.Hash    = it.value().toString();
+        r.Section = json[it.key()].toObject();
+    }
+}
+
 void AServer_SI::SendProgressReport(int percents)
 {
     Server.ReplyProgress(percents);
@@ -5,9 +5,12 @@
 
 #include <QObject>
 #include <QVariant>
+#include <QMap>
+#include <QJsonObject>
 
 class AWebSocketSessionServer;
 class EventsDataClass;
+class AEventStore;
 
 class AServer_SI: public AScriptInterface
 {
@@ -15,7 +18,7 @@ class AServer_SI: public AScriptInterface
 
 public:
     AServer_SI(AWebSocketSessionServer& Server, EventsDataClass* EventsDataHub);
-    ~AServer_SI() {}
+    ~AServer_SI();
 
 public slots:
     void           SendText(const QString& message);
@@ -23,6 +26,8 @@ public slots:
     void           SendObject(const QVariant& object);
     void           SendObjectAsJSON(const QVariant& object);
     void           SendReconstructionData();
+    void           SendSimulationFrames(int EventsPerFrame = 10000, bool Compress = false);      //events, timed events and scan as a stream of binary frames
+    void           SendReconstructionFrames(int EventsPerFrame = 10000, bool Compress = false);
 
     bool           IsBufferEmpty() const;
     void           ClearBuffer();
@@ -30,6 +35,11 @@ public slots:
     const QVariant GetBufferAsObject() const;
     void           GetBufferAsEvents();  //abort on fail, otherwise reply with OK
     bool           SaveBufferToFile(const QString& fileName);
+    QString        GetFileHash(const QString& fileName) const;   //md5 of the file, empty string if it cannot be read
+
+    //config sections set by the grid client are remembered with the hashes computed by the client, so a persistent session sends only the changed ones
+    const QVariant GetConfigHashes(const QVariant& currentConfig) const;  //hashes of the sections which were not modified since they were set
+    void           StoreConfigHashes(const QVariant& hashes, const QVariant& currentConfig);
 
     void           SendProgressReport(int percents);
     void           SetAcceptExternalProgressReport(bool flag);
@@ -37,6 +47,16 @@ public slots:
 private:
     AWebSocketSessionServer& Server;
     EventsDataClass* EventsDataHub;
+
+    struct AConfigSectionRecord
+    {
+        QString     Hash;
+        QJsonObject Section;  //as it was after the client has set it
+    };
+    QMap<QString, AConfigSectionRecord> ConfigCache;
+
+    bool onBinaryFrame(const QByteArray & ba, QString & error);  //events sent by the client as frames are appended directly to EventsDataHub
+    void sendEventFrames(const AEventStore & store, bool bTimed, int EventsPerFrame, bool Compress);
 };
 
 #endif // AWEBSERVERINTERFACE_H
@@ -28,6 +28,7 @@ ASim_SI::ASim_SI(ASimulationManager* SimulationManager, EventsDataClass *EventsD
   H["SetSeed"] = "Set random generator seed";
   H["GetSeed"] = "Get random generator seed";
   H["SaveAsTree"] = "Save simulation results as a ROOT tree file";
+  H["SaveAsBinary"] = "Save simulation results as a binary event file (memory-mapped on load). If Append is true, events are added to the existing file";
   H["SaveAsText"] = "Save simulation results as an ASCII file";
 
   H["getMonitorTime"] = "returns array of arrays: [time, value]";
@@ -260,6 +261,11 @@ bool ASim_SI::SaveAsTree(QString fileName)
   return EventsDataHub->saveSimulationAsTree(fileName);
 }
 
+bool ASim_SI::SaveAsBinary(QString fileName, bool Append)
+{
+  return EventsDataHub->saveSimulationAsBinary(fileName, Append);
+}
+
 bool ASim_SI::SaveAsText(QString fileName, bool IncludeTruePositionAndNumPhotons)
 {
   return EventsDataHub->saveSimulationAsText(fileName, IncludeTruePositionAndNumPhotons, IncludeTruePositionAndNumPhotons);
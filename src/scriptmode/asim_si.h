@@ -38,6 +38,7 @@ public slots:
   void AddNodesAndSubnodes(QVariantList nodes);
 
   bool SaveAsTree(QString fileName);
+  bool SaveAsBinary(QString fileName, bool Append = false);
   bool SaveAsText(QString fileName, bool IncludeTruePositionAndNumPhotons = true);
 
   int countMonitors() const;